@@ -0,0 +1,304 @@
+/*
+ * Copyright (C) 2015 NIPE-SYSTEMS
+ * Copyright (C) 2015 Jonas Krug
+ * Copyright (C) 2015 Tim Gevers
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "ai-background.h"
+#include "ai-planner.h"
+#include "ai-state.h"
+#include "gameplay-players.h"
+#include "core-log.h"
+
+static void *ai_background_main(void *argument);
+
+struct ai_background_context_s
+{
+	pthread_t thread;
+	pthread_mutex_t mutex;
+	pthread_cond_t condition;
+	char running;
+	unsigned int tick;
+	unsigned int planned_tick;
+	// every AI player plans on a window of the field around itself, so there
+	// is one snapshot per player id
+	ai_state_t snapshots[AI_STATE_PLAYERS_MAX];
+	char captured[AI_STATE_PLAYERS_MAX];
+	ai_background_decision_t decisions[AI_STATE_PLAYERS_MAX];
+	unsigned int applied_tick[AI_STATE_PLAYERS_MAX];
+};
+
+/**
+ * This function is the main loop of the background thread. It waits for new
+ * snapshots and plans the actions of all AI players on it. The search depth is
+ * increased until a newer snapshot is published, every finished depth
+ * replaces the previous decision.
+ * 
+ * @param argument The context of the match.
+ * @return Always NULL.
+ */
+static void *ai_background_main(void *argument)
+{
+	game_context_t *context = argument;
+	int i = 0;
+	int player_index = 0;
+	int depth = 0;
+	char outdated = 0;
+	char captured[AI_STATE_PLAYERS_MAX];
+	ai_state_t states[AI_STATE_PLAYERS_MAX];
+	ai_state_t *state = NULL;
+	ai_state_action_t action = AI_STATE_ACTION_WAIT;
+	ai_background_decision_t *decision = NULL;
+	
+	pthread_mutex_lock(&context->background->mutex);
+	
+	while(context->background->running == 1)
+	{
+		while(context->background->running == 1 && context->background->planned_tick == context->background->tick)
+		{
+			pthread_cond_wait(&context->background->condition, &context->background->mutex);
+		}
+		
+		if(context->background->running == 0)
+		{
+			break;
+		}
+		
+		memcpy(states, context->background->snapshots, sizeof(states));
+		memcpy(captured, context->background->captured, sizeof(captured));
+		context->background->planned_tick = context->background->tick;
+		
+		pthread_mutex_unlock(&context->background->mutex);
+		
+		outdated = 0;
+		for(depth = AI_PLANNER_DEPTH_MIN; outdated == 0 && depth <= AI_PLANNER_DEPTH_MAX; depth += AI_BACKGROUND_DEPTH_STEP)
+		{
+			for(i = 0; outdated == 0 && i < AI_STATE_PLAYERS_MAX; i++)
+			{
+				if(captured[i] == 0)
+				{
+					continue;
+				}
+				
+				state = &(states[i]);
+				player_index = ai_state_find_player(state, i);
+				if(player_index == -1)
+				{
+					continue;
+				}
+				
+				action = ai_planner_decide(state, player_index, depth);
+				
+				pthread_mutex_lock(&context->background->mutex);
+				
+				// the position of the decision is stored in field coordinates
+				decision = &(context->background->decisions[i]);
+				decision->valid = 1;
+				decision->tick = state->tick;
+				decision->position_x = state->offset_x + state->players[player_index].position_x;
+				decision->position_y = state->offset_y + state->players[player_index].position_y;
+				decision->depth = depth;
+				decision->action = action;
+				
+				outdated = (context->background->planned_tick != context->background->tick || context->background->running == 0);
+				
+				pthread_mutex_unlock(&context->background->mutex);
+			}
+		}
+		
+		pthread_mutex_lock(&context->background->mutex);
+	}
+	
+	pthread_mutex_unlock(&context->background->mutex);
+	
+	return NULL;
+}
+
+/**
+ * This function starts the background thread for AI planning. Every match
+ * has its own thread.
+ * 
+ * @param context The context of the match.
+ * @return 0 on success, -1 on error.
+ */
+int ai_background_init(game_context_t *context)
+{
+	int i = 0;
+	
+	if(context->background != NULL)
+	{
+		return 0;
+	}
+	
+	context->background = calloc(1, sizeof(ai_background_context_t));
+	if(context->background == NULL)
+	{
+		return -1;
+	}
+	
+	pthread_mutex_init(&context->background->mutex, NULL);
+	pthread_cond_init(&context->background->condition, NULL);
+	
+	context->background->tick = 0;
+	context->background->planned_tick = 0;
+	
+	for(i = 0; i < AI_STATE_PLAYERS_MAX; i++)
+	{
+		context->background->decisions[i].valid = 0;
+		context->background->captured[i] = 0;
+		context->background->applied_tick[i] = 0;
+	}
+	
+	context->background->running = 1;
+	
+	if(pthread_create(&context->background->thread, NULL, ai_background_main, context) != 0)
+	{
+		core_error("Failed to start AI background thread.");
+		context->background->running = 0;
+		ai_background_cleanup(context);
+		return -1;
+	}
+	
+	return 0;
+}
+
+/**
+ * This function stops the background thread, waits for it and frees its
+ * snapshots.
+ * 
+ * @param context The context of the match.
+ */
+void ai_background_cleanup(game_context_t *context)
+{
+	if(context->background == NULL)
+	{
+		return;
+	}
+	
+	if(context->background->running == 1)
+	{
+		pthread_mutex_lock(&context->background->mutex);
+		context->background->running = 0;
+		pthread_cond_signal(&context->background->condition);
+		pthread_mutex_unlock(&context->background->mutex);
+		
+		pthread_join(context->background->thread, NULL);
+	}
+	
+	pthread_cond_destroy(&context->background->condition);
+	pthread_mutex_destroy(&context->background->mutex);
+	free(context->background);
+	context->background = NULL;
+}
+
+/**
+ * This function publishes a snapshot of the current gameplay state around
+ * every AI player to the background thread. It is called once per tick by the
+ * main loop. The snapshots are captured before the mutex is locked, so the
+ * background thread can store its decisions in the meantime.
+ * 
+ * @param context The context of the match.
+ */
+void ai_background_publish(game_context_t *context)
+{
+	int i = 0;
+	int amount = 0;
+	unsigned int tick = 0;
+	char captured[AI_STATE_PLAYERS_MAX];
+	ai_state_t snapshots[AI_STATE_PLAYERS_MAX];
+	gameplay_players_player_t *player = NULL;
+	
+	if(context->background == NULL || context->background->running == 0)
+	{
+		return;
+	}
+	
+	// only this thread changes the tick, so it is read without the mutex
+	tick = context->background->tick + 1;
+	
+	for(i = 0; i < AI_STATE_PLAYERS_MAX; i++)
+	{
+		captured[i] = 0;
+	}
+	
+	amount = gameplay_players_amount(context);
+	for(i = 0; i < amount; i++)
+	{
+		player = gameplay_players_get(context, i);
+		if(player == NULL || player->type != GAMEPLAY_PLAYERS_TYPE_AI || player->id < 0 || player->id >= AI_STATE_PLAYERS_MAX)
+		{
+			continue;
+		}
+		
+		ai_state_capture(context, &(snapshots[player->id]), tick, player->position_x, player->position_y);
+		captured[player->id] = 1;
+	}
+	
+	pthread_mutex_lock(&context->background->mutex);
+	
+	for(i = 0; i < AI_STATE_PLAYERS_MAX; i++)
+	{
+		if(captured[i] == 1)
+		{
+			memcpy(&(context->background->snapshots[i]), &(snapshots[i]), sizeof(ai_state_t));
+		}
+	}
+	
+	memcpy(context->background->captured, captured, sizeof(captured));
+	context->background->tick = tick;
+	
+	pthread_cond_signal(&context->background->condition);
+	pthread_mutex_unlock(&context->background->mutex);
+}
+
+/**
+ * This function returns the newest decision for an AI player. A decision is
+ * only returned once and only if it was made for the current position of the
+ * player.
+ * 
+ * @param context The context of the match.
+ * @param player The AI player.
+ * @param action The decided action (write by pointer).
+ * @return 1 if a decision is available, 0 if not.
+ */
+int ai_background_consume(game_context_t *context, gameplay_players_player_t *player, ai_state_action_t *action)
+{
+	int available = 0;
+	ai_background_decision_t *decision = NULL;
+	
+	if(context->background == NULL || player->id < 0 || player->id >= AI_STATE_PLAYERS_MAX)
+	{
+		return 0;
+	}
+	
+	pthread_mutex_lock(&context->background->mutex);
+	
+	decision = &(context->background->decisions[player->id]);
+	if(decision->valid == 1 && decision->tick > context->background->applied_tick[player->id] && decision->position_x == player->position_x && decision->position_y == player->position_y)
+	{
+		*action = decision->action;
+		context->background->applied_tick[player->id] = decision->tick;
+		available = 1;
+	}
+	
+	pthread_mutex_unlock(&context->background->mutex);
+	
+	return available;
+}
@@ -0,0 +1,43 @@
+/*
+ * Copyright (C) 2015 NIPE-SYSTEMS
+ * Copyright (C) 2015 Jonas Krug
+ * Copyright (C) 2015 Tim Gevers
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __AI_BACKGROUND_H__
+#define __AI_BACKGROUND_H__
+
+#include "ai-state.h"
+#include "gameplay-players.h"
+
+#define AI_BACKGROUND_DEPTH_STEP 4
+
+typedef struct ai_background_decision_s
+{
+	char valid;
+	unsigned int tick;
+	int position_x;
+	int position_y;
+	int depth;
+	ai_state_action_t action;
+} ai_background_decision_t;
+
+int ai_background_init(game_context_t *context);
+void ai_background_cleanup(game_context_t *context);
+void ai_background_publish(game_context_t *context);
+int ai_background_consume(game_context_t *context, gameplay_players_player_t *player, ai_state_action_t *action);
+
+#endif /* __AI_BACKGROUND_H__ */
@@ -0,0 +1,534 @@
+/*
+ * Copyright (C) 2015 NIPE-SYSTEMS
+ * Copyright (C) 2015 Jonas Krug
+ * Copyright (C) 2015 Tim Gevers
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "ai-beam.h"
+#include "ai-planner.h"
+#include "ai-state.h"
+#include "gameplay.h"
+#include "gameplay-bombs.h"
+#include "core-log.h"
+
+static void ai_beam_rays_init(game_context_t *context, ai_state_t *state);
+static float ai_beam_count(game_context_t *context, ai_state_t *state, int index, int explosion_radius, char *blast);
+static void ai_beam_distance(ai_state_t *state, int start, short *distance);
+static int ai_beam_escape(ai_state_t *state, int spot, char *blast, int limit);
+static void ai_beam_candidate_insert(ai_beam_candidate_t *candidates, int *amount, ai_beam_candidate_t *candidate);
+static void ai_beam_expand(ai_beam_node_t *node, int player_index, ai_beam_candidate_t *candidate, ai_beam_node_t *child);
+static void ai_beam_node_insert(ai_beam_node_t *nodes, int *amount, ai_beam_node_t *node);
+
+struct ai_beam_context_s
+{
+	// rays of the explosions from every tile in every direction until the
+	// first indestructible wall, they only change with the window and the
+	// size of the field because walls stay
+	short rays[AI_STATE_TILES][4][AI_BEAM_RAY_MAX];
+	unsigned char rays_length[AI_STATE_TILES][4];
+	int rays_offset_x;
+	int rays_offset_y;
+	int rays_field_width;
+	int rays_field_height;
+	char rays_ready;
+	ai_beam_node_t layers[2][AI_BEAM_WIDTH];
+};
+
+/**
+ * This function allocates the rays and the layers of the searches of a
+ * context. They are kept between the matches.
+ * 
+ * @param context The context of the match.
+ * @return 0 on success, -1 on error.
+ */
+int ai_beam_init(game_context_t *context)
+{
+	if(context->beam != NULL)
+	{
+		return 0;
+	}
+	
+	context->beam = calloc(1, sizeof(ai_beam_context_t));
+	if(context->beam == NULL)
+	{
+		return -1;
+	}
+	
+	return 0;
+}
+
+/**
+ * This function frees the rays and the layers.
+ * 
+ * @param context The context of the match.
+ */
+void ai_beam_release(game_context_t *context)
+{
+	free(context->beam);
+	context->beam = NULL;
+}
+
+/**
+ * This function precomputes the explosion rays of every tile. The rays follow
+ * the same limits as the explosion on the field and do not contain the center
+ * tile. They belong to the window of the state.
+ * 
+ * @param context The context of the match.
+ * @param state A state with the walls of the field.
+ */
+static void ai_beam_rays_init(game_context_t *context, ai_state_t *state)
+{
+	int i = 0;
+	int direction = 0;
+	int distance = 0;
+	int x = 0;
+	int y = 0;
+	int index = 0;
+	int direction_x[] = { 0, 1, 0, -1 };
+	int direction_y[] = { -1, 0, 1, 0 };
+	
+	for(i = 0; i < AI_STATE_TILES; i++)
+	{
+		for(direction = 0; direction < 4; direction++)
+		{
+			context->beam->rays_length[i][direction] = 0;
+			
+			for(distance = 1; distance < AI_BEAM_RAY_MAX; distance++)
+			{
+				x = i % AI_STATE_WIDTH + direction_x[direction] * distance;
+				y = i / AI_STATE_WIDTH + direction_y[direction] * distance;
+				
+				// explosions never reach the first row and column
+				if(x < 0 || y < 0 || x + state->offset_x <= 0 || y + state->offset_y <= 0 || x >= AI_STATE_WIDTH || y >= AI_STATE_HEIGHT)
+				{
+					break;
+				}
+				
+				index = AI_STATE_INDEX(x, y);
+				if(state->type[index] == WALL)
+				{
+					break;
+				}
+				
+				context->beam->rays[i][direction][context->beam->rays_length[i][direction]++] = index;
+			}
+		}
+	}
+	
+	context->beam->rays_offset_x = state->offset_x;
+	context->beam->rays_offset_y = state->offset_y;
+	context->beam->rays_field_width = GAMEPLAY_FIELD_WIDTH(context);
+	context->beam->rays_field_height = GAMEPLAY_FIELD_HEIGHT(context);
+	context->beam->rays_ready = 1;
+}
+
+/**
+ * This function counts the destructive walls which are destroyed by a bomb.
+ * Items in the explosion are lost and reduce the value.
+ * 
+ * @param context The context of the match.
+ * @param state The state.
+ * @param index The tile index of the bomb.
+ * @param explosion_radius The explosion radius of the bomb.
+ * @param blast An array with AI_STATE_TILES elements in which the tiles of the
+ *              explosion are marked or NULL.
+ * @return The value of the bomb.
+ */
+static float ai_beam_count(game_context_t *context, ai_state_t *state, int index, int explosion_radius, char *blast)
+{
+	int direction = 0;
+	int distance = 0;
+	int tile = 0;
+	float value = 0;
+	
+	if(blast != NULL)
+	{
+		blast[index] = 1;
+	}
+	
+	for(direction = 0; direction < 4; direction++)
+	{
+		for(distance = 0; distance < context->beam->rays_length[index][direction] && distance < explosion_radius - 1; distance++)
+		{
+			tile = context->beam->rays[index][direction][distance];
+			
+			if(blast != NULL)
+			{
+				blast[tile] = 1;
+			}
+			
+			if(state->type[tile] == DESTRUCTIVE)
+			{
+				value += 1;
+				break;
+			}
+			
+			if(state->item[tile] != 0)
+			{
+				value -= AI_BEAM_ITEM_PENALTY;
+				break;
+			}
+		}
+	}
+	
+	return value;
+}
+
+/**
+ * This function calculates a distance map over the walkable tiles.
+ * 
+ * @param state The state.
+ * @param start The start tile index.
+ * @param distance An array with AI_STATE_TILES elements which is filled with
+ *                 the amount of steps to every tile (-1 if unreachable).
+ */
+static void ai_beam_distance(ai_state_t *state, int start, short *distance)
+{
+	int queue[AI_STATE_TILES];
+	int queue_start = 0;
+	int queue_end = 0;
+	int current = 0;
+	int next_x = 0;
+	int next_y = 0;
+	int action = 0;
+	
+	for(current = 0; current < AI_STATE_TILES; current++)
+	{
+		distance[current] = -1;
+	}
+	
+	distance[start] = 0;
+	queue[queue_end++] = start;
+	
+	while(queue_start < queue_end)
+	{
+		current = queue[queue_start++];
+		
+		for(action = AI_STATE_ACTION_UP; action <= AI_STATE_ACTION_LEFT; action++)
+		{
+			ai_state_action_target(action, current % AI_STATE_WIDTH, current / AI_STATE_WIDTH, &next_x, &next_y);
+			if(ai_state_get_walkable(state, next_x, next_y) == 0 || distance[AI_STATE_INDEX(next_x, next_y)] != -1)
+			{
+				continue;
+			}
+			
+			distance[AI_STATE_INDEX(next_x, next_y)] = distance[current] + 1;
+			queue[queue_end++] = AI_STATE_INDEX(next_x, next_y);
+		}
+	}
+}
+
+/**
+ * This function searches the nearest hiding place after a bomb drop.
+ * 
+ * @param state The state.
+ * @param spot The tile index of the bomb.
+ * @param blast The tiles of the explosion (see ai_beam_count()).
+ * @param limit The maximum amount of steps.
+ * @return The amount of steps to the hiding place or -1 if there is none.
+ */
+static int ai_beam_escape(ai_state_t *state, int spot, char *blast, int limit)
+{
+	int i = 0;
+	int best = -1;
+	short distance[AI_STATE_TILES];
+	
+	ai_beam_distance(state, spot, distance);
+	
+	for(i = 0; i < AI_STATE_TILES; i++)
+	{
+		if(distance[i] <= 0 || distance[i] > limit || blast[i] == 1 || (best != -1 && distance[i] >= best))
+		{
+			continue;
+		}
+		
+		if(ai_state_get_threatened(state, i % AI_STATE_WIDTH, i / AI_STATE_WIDTH) == 0)
+		{
+			best = distance[i];
+		}
+	}
+	
+	return best;
+}
+
+/**
+ * This function inserts a candidate into a list which is sorted by the score
+ * and limited to AI_BEAM_BRANCH elements.
+ * 
+ * @param candidates The list of candidates.
+ * @param amount The amount of candidates in the list (read and write by
+ *               pointer).
+ * @param candidate The candidate which should be inserted.
+ */
+static void ai_beam_candidate_insert(ai_beam_candidate_t *candidates, int *amount, ai_beam_candidate_t *candidate)
+{
+	int i = 0;
+	
+	if(*amount == AI_BEAM_BRANCH && candidates[*amount - 1].score >= candidate->score)
+	{
+		return;
+	}
+	
+	if(*amount < AI_BEAM_BRANCH)
+	{
+		(*amount)++;
+	}
+	
+	for(i = *amount - 1; i > 0 && candidates[i - 1].score < candidate->score; i--)
+	{
+		candidates[i] = candidates[i - 1];
+	}
+	
+	candidates[i] = *candidate;
+}
+
+/**
+ * This function creates the child of a node in which the player walks to a
+ * bomb spot, drops the bomb, hides and waits for the explosion. Items do not
+ * drop in the child because they are random.
+ * 
+ * @param node The parent node.
+ * @param player_index The index of the player.
+ * @param candidate The bomb spot.
+ * @param child The child node which should be filled.
+ */
+static void ai_beam_expand(ai_beam_node_t *node, int player_index, ai_beam_candidate_t *candidate, ai_beam_node_t *child)
+{
+	int i = 0;
+	int amount = 0;
+	int period = 0;
+	int tiles[AI_STATE_BLAST_MAX];
+	ai_state_player_t *player = NULL;
+	
+	*child = *node;
+	player = &(child->state.players[player_index]);
+	period = (player->movement_cooldown_initial > 0)?(player->movement_cooldown_initial):(1);
+	
+	// the player returns to the spot after the explosion
+	player->position_x = candidate->index % AI_STATE_WIDTH;
+	player->position_y = candidate->index / AI_STATE_WIDTH;
+	
+	amount = ai_state_blast_tiles(&(child->state), player->position_x, player->position_y, player->explosion_radius, tiles);
+	for(i = 0; i < amount; i++)
+	{
+		if(child->state.type[tiles[i]] == DESTRUCTIVE)
+		{
+			child->state.type[tiles[i]] = FLOOR;
+		}
+		
+		child->state.item[tiles[i]] = 0;
+	}
+	
+	child->walls += candidate->walls;
+	child->ticks += candidate->steps * period + GAMEPLAY_BOMBS_EXPLOSION_TIMEOUT + 1 + candidate->escape_steps * period;
+	
+	if(child->first_spot == -1)
+	{
+		child->first_spot = candidate->index;
+	}
+}
+
+/**
+ * This function inserts a node into a beam which is sorted by destroyed walls
+ * per tick and limited to AI_BEAM_WIDTH nodes.
+ * 
+ * @param nodes The beam.
+ * @param amount The amount of nodes in the beam (read and write by pointer).
+ * @param node The node which should be inserted.
+ */
+static void ai_beam_node_insert(ai_beam_node_t *nodes, int *amount, ai_beam_node_t *node)
+{
+	int i = 0;
+	float rate = 0;
+	
+	rate = node->walls / node->ticks;
+	
+	if(*amount == AI_BEAM_WIDTH && nodes[*amount - 1].walls / nodes[*amount - 1].ticks >= rate)
+	{
+		return;
+	}
+	
+	if(*amount < AI_BEAM_WIDTH)
+	{
+		(*amount)++;
+	}
+	
+	for(i = *amount - 1; i > 0 && nodes[i - 1].walls / nodes[i - 1].ticks < rate; i--)
+	{
+		nodes[i] = nodes[i - 1];
+	}
+	
+	nodes[i] = *node;
+}
+
+/**
+ * This function chooses the next action of an AI player by a beam search over
+ * sequences of bomb drops (walk, drop, hide) which destroy as many walls per
+ * tick as possible. The first drop uses the timing-aware bomb spots of the
+ * planner, the following drops are scored with the precomputed explosion rays
+ * and distance maps. The work per call is limited by AI_BEAM_WIDTH,
+ * AI_BEAM_BRANCH and AI_BEAM_DEPTH. When the player is in danger or no walls
+ * are left, the planner decides.
+ * 
+ * @param context The context of the match.
+ * @param state The state.
+ * @param player_index The index of the AI player in the state.
+ * @return The chosen action.
+ */
+ai_state_action_t ai_beam_decide(game_context_t *context, ai_state_t *state, int player_index)
+{
+	int i = 0;
+	int j = 0;
+	int layer = 0;
+	int start = 0;
+	int period = 0;
+	int amount = 0;
+	int nodes_amount = 0;
+	int next_amount = 0;
+	int candidates_amount = 0;
+	int limit = 0;
+	float best_rate = 0;
+	short best_spot = -1;
+	short steps[AI_STATE_TILES];
+	short distance[AI_STATE_TILES];
+	signed char first[AI_STATE_TILES];
+	char blast[AI_STATE_TILES];
+	ai_planner_danger_t danger;
+	ai_planner_spot_t spots[AI_STATE_TILES];
+	ai_beam_candidate_t candidates[AI_BEAM_BRANCH];
+	ai_beam_candidate_t candidate;
+	ai_beam_node_t child;
+	ai_beam_node_t *node = NULL;
+	ai_state_player_t *player = NULL;
+	
+	player = &(state->players[player_index]);
+	start = AI_STATE_INDEX(player->position_x, player->position_y);
+	period = (player->movement_cooldown_initial > 0)?(player->movement_cooldown_initial):(1);
+	limit = GAMEPLAY_BOMBS_EXPLOSION_TIMEOUT / period;
+	
+	// the rays are reused as long as the window does not move and the field
+	// keeps its size, also in the next matches of the context
+	if(context->beam->rays_ready == 0 || context->beam->rays_offset_x != state->offset_x || context->beam->rays_offset_y != state->offset_y || context->beam->rays_field_width != GAMEPLAY_FIELD_WIDTH(context) || context->beam->rays_field_height != GAMEPLAY_FIELD_HEIGHT(context))
+	{
+		ai_beam_rays_init(context, state);
+	}
+	
+	ai_planner_danger(state, &danger);
+	if(ai_planner_danger_get_stay_safe(&danger, start, 0) == 0 || player->placed_bombs >= player->placeable_bombs)
+	{
+		return ai_planner_decide(state, player_index, AI_PLANNER_DEPTH_MAX);
+	}
+	
+	ai_planner_reach(state, &danger, start, player->movement_cooldown, period, AI_PLANNER_DEPTH_MAX, steps, first);
+	
+	node = &(context->beam->layers[0][0]);
+	node->state = *state;
+	node->walls = 0;
+	node->ticks = 0;
+	node->first_spot = -1;
+	nodes_amount = 1;
+	
+	for(layer = 0; layer < AI_BEAM_DEPTH && nodes_amount > 0; layer++)
+	{
+		next_amount = 0;
+		
+		for(i = 0; i < nodes_amount; i++)
+		{
+			node = &(context->beam->layers[layer % 2][i]);
+			player = &(node->state.players[player_index]);
+			candidates_amount = 0;
+			
+			if(layer == 0)
+			{
+				// the first drop must be safe with the current bombs and fire
+				amount = ai_planner_spots(&(node->state), player_index, AI_PLANNER_DEPTH_MAX, &danger, steps, spots);
+				for(j = 0; j < amount; j++)
+				{
+					candidate.index = spots[j].index;
+					candidate.steps = spots[j].steps;
+					candidate.escape_steps = spots[j].escape_steps;
+					candidate.walls = ai_beam_count(context, &(node->state), spots[j].index, player->explosion_radius, NULL);
+					candidate.score = candidate.walls / (candidate.steps * period + GAMEPLAY_BOMBS_EXPLOSION_TIMEOUT + 1 + candidate.escape_steps * period);
+					if(candidate.walls > 0)
+					{
+						ai_beam_candidate_insert(candidates, &candidates_amount, &candidate);
+					}
+				}
+			}
+			else
+			{
+				ai_beam_distance(&(node->state), AI_STATE_INDEX(player->position_x, player->position_y), distance);
+				for(j = 0; j < AI_STATE_TILES; j++)
+				{
+					if(distance[j] == -1)
+					{
+						continue;
+					}
+					
+					memset(blast, 0, sizeof(blast));
+					candidate.walls = ai_beam_count(context, &(node->state), j, player->explosion_radius, blast);
+					if(candidate.walls <= 0)
+					{
+						continue;
+					}
+					
+					candidate.escape_steps = ai_beam_escape(&(node->state), j, blast, limit);
+					if(candidate.escape_steps == -1)
+					{
+						continue;
+					}
+					
+					candidate.index = j;
+					candidate.steps = distance[j];
+					candidate.score = candidate.walls / (candidate.steps * period + GAMEPLAY_BOMBS_EXPLOSION_TIMEOUT + 1 + candidate.escape_steps * period);
+					ai_beam_candidate_insert(candidates, &candidates_amount, &candidate);
+				}
+			}
+			
+			for(j = 0; j < candidates_amount; j++)
+			{
+				ai_beam_expand(node, player_index, &(candidates[j]), &child);
+				ai_beam_node_insert(context->beam->layers[(layer + 1) % 2], &next_amount, &child);
+				
+				if(child.walls / child.ticks > best_rate)
+				{
+					best_rate = child.walls / child.ticks;
+					best_spot = child.first_spot;
+				}
+			}
+		}
+		
+		nodes_amount = next_amount;
+	}
+	
+	// no walls left to clear, hunt the user player
+	if(best_spot == -1)
+	{
+		return ai_planner_decide(state, player_index, AI_PLANNER_DEPTH_MAX);
+	}
+	
+	core_debug("Beam: spot (%i, %i), %f walls per tick", best_spot % AI_STATE_WIDTH, best_spot / AI_STATE_WIDTH, best_rate);
+	
+	if(best_spot == start)
+	{
+		return AI_STATE_ACTION_BOMB;
+	}
+	
+	return first[best_spot];
+}
@@ -0,0 +1,56 @@
+/*
+ * Copyright (C) 2015 NIPE-SYSTEMS
+ * Copyright (C) 2015 Jonas Krug
+ * Copyright (C) 2015 Tim Gevers
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __AI_BEAM_H__
+#define __AI_BEAM_H__
+
+#include "ai-state.h"
+
+#define AI_BEAM_WIDTH 6
+#define AI_BEAM_BRANCH 6
+#define AI_BEAM_DEPTH 3
+#define AI_BEAM_RAY_MAX (AI_STATE_WIDTH > AI_STATE_HEIGHT ? AI_STATE_WIDTH : AI_STATE_HEIGHT)
+#define AI_BEAM_ITEM_PENALTY 0.5
+
+/**
+ * A node of the beam contains the field after a sequence of bomb drops. The
+ * first bomb spot of the sequence decides the action of the AI player.
+ */
+typedef struct ai_beam_node_s
+{
+	ai_state_t state;
+	float walls;
+	int ticks;
+	short first_spot;
+} ai_beam_node_t;
+
+typedef struct ai_beam_candidate_s
+{
+	short index;
+	short steps;
+	short escape_steps;
+	float walls;
+	float score;
+} ai_beam_candidate_t;
+
+int ai_beam_init(game_context_t *context);
+void ai_beam_release(game_context_t *context);
+ai_state_action_t ai_beam_decide(game_context_t *context, ai_state_t *state, int player_index);
+
+#endif /* __AI_BEAM_H__ */
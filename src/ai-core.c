@@ -22,149 +22,187 @@
 #include "ai-core.h"
 #include "ai-pathfinding.h"
 #include "ai-simulation.h"
+#include "ai-background.h"
+#include "ai-state.h"
+#include "ai-mcts.h"
+#include "ai-endgame.h"
+#include "ai-beam.h"
+#include "ai-openings.h"
 #include "gameplay-players.h"
 #include "gameplay.h"
-#include "core.h"
+#include "core-log.h"
+
+static void ai_core_apply_action(game_context_t *context, gameplay_players_player_t *player, ai_state_action_t action);
+#ifndef AI_BACKGROUND
+static void ai_core_update_jobs(game_context_t *context, gameplay_players_player_t *player, gameplay_players_player_t *player_user);
+#endif /* AI_BACKGROUND */
 
 /**
- * This function updates the player actions. This is only processed for AI
- * players. It generates a job list and chooses a job by AI criteria. As final
- * step it moves the player to execute the choosed job.
+ * This function executes an action of a planner for an AI player. Movements
+ * are only executed if the target tile is walkable.
  * 
- * @param player The player to process.
+ * @param context The context of the match.
+ * @param player The AI player.
+ * @param action The action which should be executed.
  */
-void ai_core_update(gameplay_players_player_t *player)
+static void ai_core_apply_action(game_context_t *context, gameplay_players_player_t *player, ai_state_action_t action)
 {
 	int x = 0;
 	int y = 0;
-	ai_jobs_t *job = NULL;
-	gameplay_players_player_t *player_user = NULL;
 	
-	player_user = gameplay_players_get_user();
-	if(player_user == NULL)
+	if(action == AI_STATE_ACTION_WAIT)
 	{
-		core_error("Failed to find user controlled player.");
 		return;
 	}
 	
-	if(player->type != GAMEPLAY_PLAYERS_TYPE_AI)
+	if(action == AI_STATE_ACTION_BOMB)
 	{
+		gameplay_players_place_bomb(context, player);
 		return;
 	}
 	
+	ai_state_action_target(action, player->position_x, player->position_y, &x, &y);
+	
+	if(gameplay_get_walkable(context, x, y, 0) == 1)
+	{
+		gameplay_players_set_position(context, player, x, y);
+		gameplay_players_set_movement_cooldown(context, player, player->movement_cooldown_initial);
+	}
+}
+
+#ifndef AI_BACKGROUND
+/**
+ * This function generates the job list of an AI player on the window around
+ * it, chooses the optimal job and moves the player to execute it.
+ * 
+ * @param context The context of the match.
+ * @param player The AI player.
+ * @param player_user The user player, the target of the AI player.
+ */
+static void ai_core_update_jobs(game_context_t *context, gameplay_players_player_t *player, gameplay_players_player_t *player_user)
+{
+	int x = 0;
+	int y = 0;
+	int window_x = 0;
+	int window_y = 0;
+	ai_jobs_t *job = NULL;
+	
 	if(player->jobs != NULL)
 	{
-		ai_jobs_free(&(player->jobs));
+		ai_jobs_free(context, &(player->jobs));
 	}
 	
+	// only the window around the player is searched, so the costs do not
+	// depend on the size of the field
+	ai_state_window(context, player->position_x, player->position_y, &window_x, &window_y);
+	ai_pathfinding_set_window(context, window_x, window_y);
+	
 	// all tiles are potential bomb drop spots
-	for(y = 0; y < GAMEPLAY_FIELD_HEIGHT; y++)
+	for(y = window_y; y < window_y + AI_STATE_HEIGHT; y++)
 	{
-		for(x = 0; x < GAMEPLAY_FIELD_WIDTH; x++)
+		for(x = window_x; x < window_x + AI_STATE_WIDTH; x++)
 		{
-			job = ai_jobs_allocate(x, y, BOMB_DROP);
+			job = ai_jobs_allocate(context, x, y, BOMB_DROP);
 			ai_jobs_insert(&(player->jobs), job);
 		}
 	}
 	
 	// remove tiles which are not walkable (a.k.a. non floor tiles)
-	for(y = 0; y < GAMEPLAY_FIELD_HEIGHT; y++)
+	for(y = window_y; y < window_y + AI_STATE_HEIGHT; y++)
 	{
-		for(x = 0; x < GAMEPLAY_FIELD_WIDTH; x++)
+		for(x = window_x; x < window_x + AI_STATE_WIDTH; x++)
 		{
-			if(gameplay_get_walkable(x, y, 0) == 0)
+			if(gameplay_get_walkable(context, x, y, 0) == 0)
 			{
 				// core_debug("Remove (%i, %i), cause: walkable", x, y);
-				ai_jobs_remove(&(player->jobs), x, y, BOMB_DROP);
+				ai_jobs_remove(context, &(player->jobs), x, y, BOMB_DROP);
 			}
 		}
 	}
 	
 	// remove tiles which are not accessable
-	for(y = 0; y < GAMEPLAY_FIELD_HEIGHT; y++)
+	for(y = window_y; y < window_y + AI_STATE_HEIGHT; y++)
 	{
-		for(x = 0; x < GAMEPLAY_FIELD_WIDTH; x++)
+		for(x = window_x; x < window_x + AI_STATE_WIDTH; x++)
 		{
-			if(ai_pathfinding_move_to_length(player->position_x, player->position_y, x, y, 0) == -1)
+			if(ai_pathfinding_move_to_length(context, player->position_x, player->position_y, x, y, 0) == -1)
 			{
 				// core_debug("Remove (%i, %i), cause: pathfinding", x, y);
-				ai_jobs_remove(&(player->jobs), x, y, BOMB_DROP);
+				ai_jobs_remove(context, &(player->jobs), x, y, BOMB_DROP);
 			}
 		}
 	}
 	
 	// remove tiles which have no save place for hiding
-	for(y = 0; y < GAMEPLAY_FIELD_HEIGHT; y++)
+	for(y = window_y; y < window_y + AI_STATE_HEIGHT; y++)
 	{
-		for(x = 0; x < GAMEPLAY_FIELD_WIDTH; x++)
+		for(x = window_x; x < window_x + AI_STATE_WIDTH; x++)
 		{
-			if(ai_simulation_validate_tile(player->explosion_radius, x, y) == 0)
+			if(ai_simulation_validate_tile(context, player->explosion_radius, x, y) == 0)
 			{
 				// core_debug("Remove (%i, %i), cause: unsafe", x, y);
-				ai_jobs_remove(&(player->jobs), x, y, BOMB_DROP);
+				ai_jobs_remove(context, &(player->jobs), x, y, BOMB_DROP);
 			}
 		}
 	}
 	
 	// add escape job
-	if(ai_simulation_get_walkable(player->position_x, player->position_y) == 0)
+	if(ai_simulation_get_walkable(context, player->position_x, player->position_y) == 0)
 	{
 		// all tiles are potential escape spots
-		for(y = 0; y < GAMEPLAY_FIELD_HEIGHT; y++)
+		for(y = window_y; y < window_y + AI_STATE_HEIGHT; y++)
 		{
-			for(x = 0; x < GAMEPLAY_FIELD_WIDTH; x++)
+			for(x = window_x; x < window_x + AI_STATE_WIDTH; x++)
 			{
-				job = ai_jobs_allocate(x, y, ESCAPE);
+				job = ai_jobs_allocate(context, x, y, ESCAPE);
 				ai_jobs_insert(&(player->jobs), job);
 			}
 		}
 		
 		// remove tiles which are not walkable (a.k.a. non floor tiles)
-		for(y = 0; y < GAMEPLAY_FIELD_HEIGHT; y++)
+		for(y = window_y; y < window_y + AI_STATE_HEIGHT; y++)
 		{
-			for(x = 0; x < GAMEPLAY_FIELD_WIDTH; x++)
+			for(x = window_x; x < window_x + AI_STATE_WIDTH; x++)
 			{
-				if(gameplay_get_walkable(x, y, 0) == 0)
+				if(gameplay_get_walkable(context, x, y, 0) == 0)
 				{
-					ai_jobs_remove(&(player->jobs), x, y, ESCAPE);
+					ai_jobs_remove(context, &(player->jobs), x, y, ESCAPE);
 				}
 			}
 		}
 	}
 	
 	// remove current tile
-	// ai_jobs_remove(&(player->jobs), player->position_x, player->position_y, BOMB_DROP);
+	// ai_jobs_remove(context, &(player->jobs), player->position_x, player->position_y, BOMB_DROP);
 	
-	job = ai_jobs_get_optimal(player->jobs, player_user->position_x, player_user->position_y, player->position_x, player->position_y);
+	job = ai_jobs_get_optimal(context, player->jobs, player_user->position_x, player_user->position_y, player->position_x, player->position_y, player->explosion_radius);
 	
 	// ai_jobs_print(player->jobs);
 	
-	if(job != NULL && player->movement_cooldown == 0)
+	if(job != NULL && gameplay_players_get_movement_cooldown(context, player) == 0)
 	{
 		switch(job->type)
 		{
 			case ESCAPE:
 			{
-				if(ai_pathfinding_move_to_next(player->position_x, player->position_y, job->position_x, job->position_y, &x, &y, 2) != -1)
+				if(ai_pathfinding_move_to_next(context, player->position_x, player->position_y, job->position_x, job->position_y, &x, &y, 2) != -1)
 				{
-					player->position_x = x;
-					player->position_y = y;
-					player->movement_cooldown = player->movement_cooldown_initial;
+					gameplay_players_set_position(context, player, x, y);
+					gameplay_players_set_movement_cooldown(context, player, player->movement_cooldown_initial);
 				}
 				
 				break;
 			}
 			case BOMB_DROP:
 			{
-				if(ai_pathfinding_move_to_next(player->position_x, player->position_y, job->position_x, job->position_y, &x, &y, 0) != -1)
+				if(ai_pathfinding_move_to_next(context, player->position_x, player->position_y, job->position_x, job->position_y, &x, &y, 0) != -1)
 				{
-					player->position_x = x;
-					player->position_y = y;
-					player->movement_cooldown = player->movement_cooldown_initial;
+					gameplay_players_set_position(context, player, x, y);
+					gameplay_players_set_movement_cooldown(context, player, player->movement_cooldown_initial);
 					
 					if(player->position_x == job->position_x && player->position_y == job->position_y)
 					{
-						gameplay_players_place_bomb(player);
+						gameplay_players_place_bomb(context, player);
 					}
 				}
 				
@@ -173,13 +211,104 @@ void ai_core_update(gameplay_players_player_t *player)
 		}
 	}
 }
+#endif /* AI_BACKGROUND */
+
+/**
+ * This function updates the player actions. This is only processed for AI
+ * players. It generates a job list and chooses a job by AI criteria. As final
+ * step it moves the player to execute the choosed job.
+ * 
+ * @param context The context of the match.
+ * @param player The player to process.
+ */
+void ai_core_update(game_context_t *context, gameplay_players_player_t *player)
+{
+	int player_index = 0;
+	char endgame = 0;
+	gameplay_players_player_t *player_user = NULL;
+	ai_state_action_t action = AI_STATE_ACTION_WAIT;
+	ai_state_t state;
+	
+	player_user = gameplay_players_get_user(context);
+	if(player_user == NULL)
+	{
+		core_error("Failed to find user controlled player.");
+		return;
+	}
+	
+	if(player->type != GAMEPLAY_PLAYERS_TYPE_AI)
+	{
+		return;
+	}
+	
+	// replay the precomputed opening as long as the field is as expected
+	if(gameplay_players_get_movement_cooldown(context, player) == 0 && ai_openings_next(context, player, &action) == 1)
+	{
+		ai_core_apply_action(context, player, action);
+		return;
+	}
+
+#ifdef AI_ENDGAME
+	// the last AI player has enough time to search deeper
+	endgame = (gameplay_players_ai_amount(context) == 1);
+#endif /* AI_ENDGAME */
+	
+	if(endgame == 1 || player->ai == GAMEPLAY_PLAYERS_AI_MCTS || player->ai == GAMEPLAY_PLAYERS_AI_BEAM)
+	{
+		if(gameplay_players_get_movement_cooldown(context, player) > 0)
+		{
+			return;
+		}
+		
+		ai_state_capture(context, &state, 0, player->position_x, player->position_y);
+		player_index = ai_state_find_player(&state, player->id);
+		if(player_index == -1)
+		{
+			return;
+		}
+		
+		// the endgame search needs the user in the window around the player
+		if(endgame == 1 && ai_state_find_user(&state) == -1)
+		{
+			action = ai_beam_decide(context, &state, player_index);
+		}
+		else if(endgame == 1)
+		{
+			action = ai_endgame_decide(context, &state, player_index, AI_ENDGAME_BUDGET);
+		}
+		else if(player->ai == GAMEPLAY_PLAYERS_AI_MCTS)
+		{
+			action = ai_mcts_decide(context, &state, player_index, AI_MCTS_BUDGET);
+		}
+		else
+		{
+			action = ai_beam_decide(context, &state, player_index);
+		}
+		
+		ai_core_apply_action(context, player, action);
+		
+		return;
+	}
+
+#ifdef AI_BACKGROUND
+	// the planning happens in the background thread, only execute the newest
+	// decision
+	if(gameplay_players_get_movement_cooldown(context, player) == 0 && ai_background_consume(context, player, &action) == 1)
+	{
+		ai_core_apply_action(context, player, action);
+	}
+#else
+	ai_core_update_jobs(context, player, player_user);
+#endif /* AI_BACKGROUND */
+}
 
 /**
  * This function cleans the job list of a player.
  * 
+ * @param context The context of the match.
  * @param player The player to be cleaned.
  */
-void ai_core_cleanup(gameplay_players_player_t *player)
+void ai_core_cleanup(game_context_t *context, gameplay_players_player_t *player)
 {
 	if(player->type != GAMEPLAY_PLAYERS_TYPE_AI)
 	{
@@ -188,6 +317,6 @@ void ai_core_cleanup(gameplay_players_player_t *player)
 	
 	if(player->jobs != NULL)
 	{
-		ai_jobs_free(&(player->jobs));
+		ai_jobs_free(context, &(player->jobs));
 	}
 }
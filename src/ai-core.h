@@ -22,7 +22,7 @@
 
 #include "gameplay-players.h"
 
-void ai_core_update(gameplay_players_player_t *player);
-void ai_core_cleanup(gameplay_players_player_t *player);
+void ai_core_update(game_context_t *context, gameplay_players_player_t *player);
+void ai_core_cleanup(game_context_t *context, gameplay_players_player_t *player);
 
 #endif /* __AI_CORE_H__ */
@@ -0,0 +1,635 @@
+/*
+ * Copyright (C) 2015 NIPE-SYSTEMS
+ * Copyright (C) 2015 Jonas Krug
+ * Copyright (C) 2015 Tim Gevers
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <time.h>
+
+#include "ai-endgame.h"
+#include "ai-state.h"
+#include "gameplay.h"
+#include "core-log.h"
+
+static long ai_endgame_time(void);
+static int ai_endgame_get_ready(ai_state_t *state, int player_index);
+static int ai_endgame_distance(ai_state_t *state, int start, int target);
+static int ai_endgame_evaluate(game_context_t *context, ai_state_t *state, int depth);
+static int ai_endgame_order(ai_state_t *state, int player_index, int opponent_index, ai_state_action_t preferred, ai_state_action_t *actions);
+static int ai_endgame_search(game_context_t *context, ai_state_t *state, int depth, int alpha, int beta);
+
+struct ai_endgame_context_s
+{
+	// the table is kept between the searches, so later searches find the
+	// results of the previous ticks
+	ai_endgame_entry_t table[AI_ENDGAME_TABLE_SIZE];
+	ai_endgame_statistics_t statistics;
+	long deadline;
+	char aborted;
+	int player;
+	int user;
+};
+
+/**
+ * This function allocates the table and the statistics of the searches of a
+ * context.
+ * 
+ * @param context The context of the match.
+ * @return 0 on success, -1 on error.
+ */
+int ai_endgame_init(game_context_t *context)
+{
+	if(context->endgame != NULL)
+	{
+		return 0;
+	}
+	
+	context->endgame = calloc(1, sizeof(ai_endgame_context_t));
+	if(context->endgame == NULL)
+	{
+		return -1;
+	}
+	
+	return 0;
+}
+
+/**
+ * This function frees the table and the statistics.
+ * 
+ * @param context The context of the match.
+ */
+void ai_endgame_release(game_context_t *context)
+{
+	free(context->endgame);
+	context->endgame = NULL;
+}
+
+/**
+ * This function returns the current time of a monotonic clock.
+ * 
+ * @return The time in microseconds.
+ */
+static long ai_endgame_time(void)
+{
+	struct timespec now;
+	
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	
+	return now.tv_sec * 1000000L + now.tv_nsec / 1000L;
+}
+
+/**
+ * This function tests if a player executes an action in the next step of a
+ * state.
+ * 
+ * @param state The state.
+ * @param player_index The index of the player.
+ * @return 1 if the player executes an action, 0 if not.
+ */
+static int ai_endgame_get_ready(ai_state_t *state, int player_index)
+{
+	return (ai_state_get_alive(state, player_index) == 1 && state->players[player_index].movement_cooldown <= 1);
+}
+
+/**
+ * This function calculates the walking distance between two tiles in which
+ * destructive walls count as a detour (they must be blown up first). It uses
+ * Dijkstra with a ring of buckets, because all costs are small.
+ * 
+ * @param state The state.
+ * @param start The start tile index.
+ * @param target The target tile index.
+ * @return The distance or AI_ENDGAME_UNREACHABLE if the target is unreachable.
+ */
+static int ai_endgame_distance(ai_state_t *state, int start, int target)
+{
+	int i = 0;
+	int index = 0;
+	int next = 0;
+	int cost = 0;
+	int next_cost = 0;
+	int bucket = 0;
+	int pending = 0;
+	int x = 0;
+	int y = 0;
+	int direction_x[] = { 0, 1, 0, -1 };
+	int direction_y[] = { -1, 0, 1, 0 };
+	short distance[AI_STATE_TILES];
+	unsigned char buckets[AI_ENDGAME_BUCKETS][AI_STATE_TILES];
+	short buckets_amount[AI_ENDGAME_BUCKETS];
+	
+	for(i = 0; i < AI_STATE_TILES; i++)
+	{
+		distance[i] = AI_ENDGAME_UNREACHABLE;
+	}
+	
+	for(i = 0; i < AI_ENDGAME_BUCKETS; i++)
+	{
+		buckets_amount[i] = 0;
+	}
+	
+	distance[start] = 0;
+	buckets[0][buckets_amount[0]++] = start;
+	pending = 1;
+	
+	for(cost = 0; pending > 0; cost++)
+	{
+		while(buckets_amount[cost % AI_ENDGAME_BUCKETS] > 0)
+		{
+			index = buckets[cost % AI_ENDGAME_BUCKETS][--buckets_amount[cost % AI_ENDGAME_BUCKETS]];
+			pending--;
+			
+			// outdated entry
+			if(distance[index] != cost)
+			{
+				continue;
+			}
+			
+			if(index == target)
+			{
+				return cost;
+			}
+			
+			for(i = 0; i < 4; i++)
+			{
+				x = index % AI_STATE_WIDTH + direction_x[i];
+				y = index / AI_STATE_WIDTH + direction_y[i];
+				if(x < 0 || y < 0 || x >= AI_STATE_WIDTH || y >= AI_STATE_HEIGHT)
+				{
+					continue;
+				}
+				
+				next = AI_STATE_INDEX(x, y);
+				if(state->type[next] == WALL)
+				{
+					continue;
+				}
+				
+				next_cost = cost + ((state->type[next] == DESTRUCTIVE)?(AI_ENDGAME_DESTRUCTIVE_COST):(1));
+				bucket = next_cost % AI_ENDGAME_BUCKETS;
+				if(distance[next] > next_cost && buckets_amount[bucket] < AI_STATE_TILES)
+				{
+					distance[next] = next_cost;
+					buckets[bucket][buckets_amount[bucket]++] = next;
+					pending++;
+				}
+			}
+		}
+	}
+	
+	return AI_ENDGAME_UNREACHABLE;
+}
+
+/**
+ * This function evaluates a state from the view of the searching AI player.
+ * Dead players decide the game, a win in fewer ticks is preferred. Otherwise
+ * health points, threatening bombs and the walking distance to the user player
+ * count.
+ * 
+ * @param context The context of the match.
+ * @param state The state.
+ * @param depth The remaining depth of the search.
+ * @return The value of the state, positive values are good for the AI player.
+ */
+static int ai_endgame_evaluate(game_context_t *context, ai_state_t *state, int depth)
+{
+	int value = 0;
+	ai_state_player_t *player = NULL;
+	ai_state_player_t *user = NULL;
+	
+	player = &(state->players[context->endgame->player]);
+	user = &(state->players[context->endgame->user]);
+	
+	if(player->health_points <= 0)
+	{
+		return -AI_ENDGAME_WIN - depth;
+	}
+	
+	if(user->health_points <= 0)
+	{
+		return AI_ENDGAME_WIN + depth;
+	}
+	
+	value += 100 * (player->health_points - user->health_points);
+	
+	if(ai_state_get_threatened(state, player->position_x, player->position_y) == 1 || state->fire[AI_STATE_INDEX(player->position_x, player->position_y)] > 1)
+	{
+		value -= 30;
+	}
+	
+	if(ai_state_get_threatened(state, user->position_x, user->position_y) == 1)
+	{
+		value += 15;
+	}
+	
+	value -= 2 * ai_endgame_distance(state, AI_STATE_INDEX(player->position_x, player->position_y), AI_STATE_INDEX(user->position_x, user->position_y));
+	
+	return value;
+}
+
+/**
+ * This function collects the legal actions of a player sorted by their
+ * chances to be good, so alpha-beta cuts off more branches. The preferred
+ * action (from the transposition table) comes first, then escapes from
+ * threatened tiles and bombs which hit the opponent.
+ * 
+ * @param state The state.
+ * @param player_index The index of the acting player.
+ * @param opponent_index The index of the opponent.
+ * @param preferred The preferred action.
+ * @param actions An array with AI_STATE_ACTIONS elements which is filled with
+ *                the sorted actions.
+ * @return The amount of actions.
+ */
+static int ai_endgame_order(ai_state_t *state, int player_index, int opponent_index, ai_state_action_t preferred, ai_state_action_t *actions)
+{
+	int i = 0;
+	int j = 0;
+	int x = 0;
+	int y = 0;
+	int action = 0;
+	int amount = 0;
+	int threatened = 0;
+	int distance = 0;
+	int blast_amount = 0;
+	int opponent_tile = 0;
+	int score = 0;
+	int tiles[AI_STATE_BLAST_MAX];
+	int scores[AI_STATE_ACTIONS];
+	ai_state_player_t *player = NULL;
+	ai_state_player_t *opponent = NULL;
+	
+	player = &(state->players[player_index]);
+	opponent = &(state->players[opponent_index]);
+	opponent_tile = AI_STATE_INDEX(opponent->position_x, opponent->position_y);
+	threatened = ai_state_get_threatened(state, player->position_x, player->position_y);
+	distance = abs(opponent->position_x - player->position_x) + abs(opponent->position_y - player->position_y);
+	
+	for(action = 0; action < AI_STATE_ACTIONS; action++)
+	{
+		if(ai_state_get_legal(state, player_index, action) == 0)
+		{
+			continue;
+		}
+		
+		score = 0;
+		
+		if(action == AI_STATE_ACTION_BOMB)
+		{
+			score = (threatened == 1)?(-50):(-10);
+			blast_amount = ai_state_blast_tiles(state, player->position_x, player->position_y, player->explosion_radius, tiles);
+			for(i = 0; i < blast_amount; i++)
+			{
+				if(tiles[i] == opponent_tile)
+				{
+					score += 90;
+					break;
+				}
+			}
+		}
+		else if(action == AI_STATE_ACTION_WAIT)
+		{
+			score = (threatened == 1)?(-50):(0);
+		}
+		else
+		{
+			ai_state_action_target(action, player->position_x, player->position_y, &x, &y);
+			
+			if(threatened == 1 && ai_state_get_threatened(state, x, y) == 0)
+			{
+				score += 100;
+			}
+			
+			if(state->fire[AI_STATE_INDEX(x, y)] > 1)
+			{
+				score -= 100;
+			}
+			
+			if(abs(opponent->position_x - x) + abs(opponent->position_y - y) < distance)
+			{
+				score += 10;
+			}
+		}
+		
+		if(action == (int)preferred)
+		{
+			score += 1000;
+		}
+		
+		// insertion sort, the lists are tiny
+		for(j = amount; j > 0 && scores[j - 1] < score; j--)
+		{
+			scores[j] = scores[j - 1];
+			actions[j] = actions[j - 1];
+		}
+		scores[j] = score;
+		actions[j] = action;
+		amount++;
+	}
+	
+	return amount;
+}
+
+/**
+ * This function searches a state with alpha-beta pruning. In every turn the AI
+ * player maximizes and the user player, who knows the action of the AI player,
+ * minimizes. Ticks in which nobody can act are skipped without using depth.
+ * The state is modified by skipped ticks.
+ * 
+ * @param context The context of the match.
+ * @param state The state before the next step.
+ * @param depth The remaining depth in turns.
+ * @param alpha The lower bound of the search window.
+ * @param beta The upper bound of the search window.
+ * @return The value of the state.
+ */
+static int ai_endgame_search(game_context_t *context, ai_state_t *state, int depth, int alpha, int beta)
+{
+	int i = 0;
+	int j = 0;
+	int ticks = 0;
+	int value = 0;
+	int best = -AI_ENDGAME_INFINITY;
+	int worst = 0;
+	int beta_user = 0;
+	int alpha_original = alpha;
+	int player_amount = 0;
+	int user_amount = 0;
+	unsigned long long hash = 0;
+	ai_state_action_t best_action = AI_STATE_ACTION_WAIT;
+	ai_state_action_t preferred = AI_STATE_ACTION_WAIT;
+	ai_state_action_t player_actions[AI_STATE_ACTIONS];
+	ai_state_action_t user_actions[AI_STATE_ACTIONS];
+	ai_state_action_t actions[AI_STATE_PLAYERS_MAX];
+	ai_endgame_entry_t *entry = NULL;
+	ai_state_t child;
+	
+	context->endgame->statistics.nodes++;
+	if((context->endgame->statistics.nodes & 1023) == 0 && ai_endgame_time() > context->endgame->deadline)
+	{
+		context->endgame->aborted = 1;
+	}
+	
+	if(context->endgame->aborted == 1)
+	{
+		return 0;
+	}
+	
+	if(depth == 0 || ai_state_get_alive(state, context->endgame->player) == 0 || ai_state_get_alive(state, context->endgame->user) == 0)
+	{
+		return ai_endgame_evaluate(context, state, depth);
+	}
+	
+	// nobody can act, skip the ticks
+	for(ticks = 0; ticks < AI_ENDGAME_SKIP_MAX && ai_endgame_get_ready(state, context->endgame->player) == 0 && ai_endgame_get_ready(state, context->endgame->user) == 0; ticks++)
+	{
+		ai_state_step(state, NULL);
+		
+		if(ai_state_get_alive(state, context->endgame->player) == 0 || ai_state_get_alive(state, context->endgame->user) == 0)
+		{
+			return ai_endgame_evaluate(context, state, depth);
+		}
+	}
+	
+	hash = ai_state_hash(state);
+	entry = &(context->endgame->table[hash % AI_ENDGAME_TABLE_SIZE]);
+	if(entry->bound != AI_ENDGAME_BOUND_NONE && entry->hash == hash)
+	{
+		context->endgame->statistics.hits++;
+		preferred = entry->action;
+		
+		if(entry->depth >= depth)
+		{
+			if(entry->bound == AI_ENDGAME_BOUND_EXACT)
+			{
+				return entry->value;
+			}
+			
+			if(entry->bound == AI_ENDGAME_BOUND_LOWER && entry->value > alpha)
+			{
+				alpha = entry->value;
+			}
+			
+			if(entry->bound == AI_ENDGAME_BOUND_UPPER && entry->value < beta)
+			{
+				beta = entry->value;
+			}
+			
+			if(alpha >= beta)
+			{
+				return entry->value;
+			}
+		}
+	}
+	
+	if(ai_endgame_get_ready(state, context->endgame->player) == 1)
+	{
+		player_amount = ai_endgame_order(state, context->endgame->player, context->endgame->user, preferred, player_actions);
+	}
+	else
+	{
+		player_actions[player_amount++] = AI_STATE_ACTION_WAIT;
+	}
+	
+	if(ai_endgame_get_ready(state, context->endgame->user) == 1)
+	{
+		user_amount = ai_endgame_order(state, context->endgame->user, context->endgame->player, AI_STATE_ACTION_WAIT, user_actions);
+	}
+	else
+	{
+		user_actions[user_amount++] = AI_STATE_ACTION_WAIT;
+	}
+	
+	for(i = 0; i < AI_STATE_PLAYERS_MAX; i++)
+	{
+		actions[i] = AI_STATE_ACTION_WAIT;
+	}
+	
+	for(i = 0; i < player_amount; i++)
+	{
+		worst = AI_ENDGAME_INFINITY;
+		beta_user = beta;
+		
+		for(j = 0; j < user_amount; j++)
+		{
+			child = *state;
+			actions[context->endgame->player] = player_actions[i];
+			actions[context->endgame->user] = user_actions[j];
+			ai_state_step(&child, actions);
+			
+			value = ai_endgame_search(context, &child, depth - 1, (alpha > best)?(alpha):(best), beta_user);
+			if(value < worst)
+			{
+				worst = value;
+			}
+			
+			if(worst < beta_user)
+			{
+				beta_user = worst;
+			}
+			
+			// the user player already refutes this action
+			if(worst <= alpha || worst <= best)
+			{
+				break;
+			}
+		}
+		
+		if(worst > best)
+		{
+			best = worst;
+			best_action = player_actions[i];
+		}
+		
+		if(best > alpha)
+		{
+			alpha = best;
+		}
+		
+		if(alpha >= beta)
+		{
+			break;
+		}
+	}
+	
+	if(context->endgame->aborted == 1)
+	{
+		return 0;
+	}
+	
+	if(entry->hash != hash || entry->depth <= depth)
+	{
+		entry->hash = hash;
+		entry->value = best;
+		entry->depth = depth;
+		entry->action = best_action;
+		
+		if(best <= alpha_original)
+		{
+			entry->bound = AI_ENDGAME_BOUND_UPPER;
+		}
+		else if(best >= beta)
+		{
+			entry->bound = AI_ENDGAME_BOUND_LOWER;
+		}
+		else
+		{
+			entry->bound = AI_ENDGAME_BOUND_EXACT;
+		}
+	}
+	
+	return best;
+}
+
+/**
+ * This function chooses the action of the last AI player against the user
+ * player by an iterative deepening alpha-beta search. Every finished depth
+ * replaces the result of the previous one until the time budget is used up.
+ * 
+ * @param context The context of the match.
+ * @param state The state in which the player has to decide (the player must be
+ *              able to act).
+ * @param player_index The index of the searching player.
+ * @param budget The time budget in microseconds.
+ * @return The chosen action.
+ */
+ai_state_action_t ai_endgame_decide(game_context_t *context, ai_state_t *state, int player_index, long budget)
+{
+	int i = 0;
+	int depth = 0;
+	int value = 0;
+	int best = 0;
+	int alpha = 0;
+	int amount = 0;
+	long start = 0;
+	ai_state_action_t result = AI_STATE_ACTION_WAIT;
+	ai_state_action_t best_action = AI_STATE_ACTION_WAIT;
+	ai_state_action_t actions[AI_STATE_ACTIONS];
+	ai_state_t child;
+	
+	context->endgame->player = player_index;
+	context->endgame->user = ai_state_find_user(state);
+	if(context->endgame->user == -1 || ai_state_get_alive(state, player_index) == 0 || ai_state_get_alive(state, context->endgame->user) == 0)
+	{
+		return AI_STATE_ACTION_WAIT;
+	}
+	
+	start = ai_endgame_time();
+	context->endgame->deadline = start + budget;
+	context->endgame->aborted = 0;
+	context->endgame->statistics.depth = 0;
+	context->endgame->statistics.nodes = 0;
+	context->endgame->statistics.hits = 0;
+	
+	for(depth = 1; depth <= AI_ENDGAME_DEPTH_MAX; depth++)
+	{
+		// the action is executed immediately, the user player reacts afterwards
+		amount = ai_endgame_order(state, context->endgame->player, context->endgame->user, result, actions);
+		best = -AI_ENDGAME_INFINITY;
+		alpha = -AI_ENDGAME_INFINITY;
+		best_action = AI_STATE_ACTION_WAIT;
+		
+		for(i = 0; i < amount && context->endgame->aborted == 0; i++)
+		{
+			child = *state;
+			ai_state_apply(&child, context->endgame->player, actions[i]);
+			
+			value = ai_endgame_search(context, &child, depth - 1, alpha, AI_ENDGAME_INFINITY);
+			if(value > best)
+			{
+				best = value;
+				best_action = actions[i];
+			}
+			
+			if(best > alpha)
+			{
+				alpha = best;
+			}
+		}
+		
+		if(context->endgame->aborted == 1)
+		{
+			break;
+		}
+		
+		result = best_action;
+		context->endgame->statistics.depth = depth;
+		
+		// the outcome is decided
+		if(best >= AI_ENDGAME_WIN || best <= -AI_ENDGAME_WIN)
+		{
+			break;
+		}
+	}
+	
+	context->endgame->statistics.elapsed = ai_endgame_time() - start;
+	
+	core_debug("Endgame: depth %i, %li nodes, %li table hits in %li us, action %i", context->endgame->statistics.depth, context->endgame->statistics.nodes, context->endgame->statistics.hits, context->endgame->statistics.elapsed, result);
+	
+	return result;
+}
+
+/**
+ * This function returns the statistics of the last search.
+ * 
+ * @param context The context of the match.
+ * @return The statistics.
+ */
+ai_endgame_statistics_t *ai_endgame_get_statistics(game_context_t *context)
+{
+	return &context->endgame->statistics;
+}
@@ -0,0 +1,69 @@
+/*
+ * Copyright (C) 2015 NIPE-SYSTEMS
+ * Copyright (C) 2015 Jonas Krug
+ * Copyright (C) 2015 Tim Gevers
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __AI_ENDGAME_H__
+#define __AI_ENDGAME_H__
+
+#include "ai-state.h"
+
+// time budget of one search, specified in microseconds
+#ifndef AI_ENDGAME_BUDGET
+#define AI_ENDGAME_BUDGET 20000
+#endif /* AI_ENDGAME_BUDGET */
+
+#define AI_ENDGAME_DEPTH_MAX 32
+#define AI_ENDGAME_TABLE_SIZE 65536
+#define AI_ENDGAME_SKIP_MAX 8
+#define AI_ENDGAME_INFINITY 1000000
+#define AI_ENDGAME_WIN 100000
+#define AI_ENDGAME_UNREACHABLE 1000
+#define AI_ENDGAME_DESTRUCTIVE_COST 4
+#define AI_ENDGAME_BUCKETS (AI_ENDGAME_DESTRUCTIVE_COST + 1)
+
+typedef enum ai_endgame_bound_e
+{
+	AI_ENDGAME_BOUND_NONE = 0,
+	AI_ENDGAME_BOUND_EXACT = 1,
+	AI_ENDGAME_BOUND_LOWER = 2,
+	AI_ENDGAME_BOUND_UPPER = 3
+} ai_endgame_bound_t;
+
+typedef struct ai_endgame_entry_s
+{
+	unsigned long long hash;
+	int value;
+	signed char depth;
+	unsigned char bound;
+	unsigned char action;
+} ai_endgame_entry_t;
+
+typedef struct ai_endgame_statistics_s
+{
+	int depth;
+	long nodes;
+	long hits;
+	long elapsed;
+} ai_endgame_statistics_t;
+
+int ai_endgame_init(game_context_t *context);
+void ai_endgame_release(game_context_t *context);
+ai_state_action_t ai_endgame_decide(game_context_t *context, ai_state_t *state, int player_index, long budget);
+ai_endgame_statistics_t *ai_endgame_get_statistics(game_context_t *context);
+
+#endif /* __AI_ENDGAME_H__ */
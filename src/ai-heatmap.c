@@ -0,0 +1,348 @@
+/*
+ * Copyright (C) 2015 NIPE-SYSTEMS
+ * Copyright (C) 2015 Jonas Krug
+ * Copyright (C) 2015 Tim Gevers
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "ai-heatmap.h"
+#include "gameplay.h"
+#include "gameplay-events.h"
+#include "gameplay-items.h"
+#include "gameplay-players.h"
+#include "core-log.h"
+
+static void ai_heatmap_update_spot(game_context_t *context, int position_x, int position_y, int user_x, int user_y);
+static void ai_heatmap_update(game_context_t *context, int position_x, int position_y);
+static void ai_heatmap_consume(game_context_t *context);
+static int ai_heatmap_prepare(game_context_t *context);
+
+struct ai_heatmap_context_s
+{
+	// the values of every bomb spot for every explosion radius, so a
+	// changed explosion radius only selects another layer. They are
+	// allocated when the first value is needed.
+	ai_heatmap_value_t *values;
+	int tiles;
+	
+	// a bomb spot is only up to date if its stamp equals the generation, so
+	// all spots are invalidated at once by a new generation and calculated
+	// again when they are needed
+	unsigned int *stamps;
+	unsigned int generation;
+	
+	// the position in the gameplay events up to which the stamps are up to
+	// date
+	unsigned int cursor;
+};
+
+#define AI_HEATMAP_VALUE(context, radius, index) ((context)->heatmap->values[(radius) * GAMEPLAY_FIELD_TILES(context) + (index)])
+
+/**
+ * This function allocates the context of the values. The values themselves
+ * are only allocated when the first one is needed, so matches without the
+ * jobs AI never pay for them.
+ * 
+ * @param context The context of the match.
+ * @return 0 on success, -1 on error.
+ */
+int ai_heatmap_allocate(game_context_t *context)
+{
+	if(context->heatmap == NULL)
+	{
+		context->heatmap = calloc(1, sizeof(ai_heatmap_context_t));
+		if(context->heatmap == NULL)
+		{
+			return -1;
+		}
+	}
+	
+	return 0;
+}
+
+/**
+ * This function allocates the values and the stamps for the size of the
+ * field unless they fit already. New stamps are invalid.
+ * 
+ * @param context The context of the match.
+ * @return 0 on success, -1 on error.
+ */
+static int ai_heatmap_prepare(game_context_t *context)
+{
+	int i = 0;
+	
+	if(context->heatmap->values != NULL && context->heatmap->tiles == GAMEPLAY_FIELD_TILES(context))
+	{
+		return 0;
+	}
+	
+	context->heatmap->tiles = 0;
+	context->heatmap->values = gameplay_allocate_tiles(context, context->heatmap->values, (AI_HEATMAP_RADIUS_MAX + 1) * sizeof(ai_heatmap_value_t));
+	context->heatmap->stamps = gameplay_allocate_tiles(context, context->heatmap->stamps, sizeof(unsigned int));
+	if(context->heatmap->values == NULL || context->heatmap->stamps == NULL)
+	{
+		free(context->heatmap->values);
+		free(context->heatmap->stamps);
+		context->heatmap->values = NULL;
+		context->heatmap->stamps = NULL;
+		return -1;
+	}
+	
+	for(i = 0; i < GAMEPLAY_FIELD_TILES(context); i++)
+	{
+		context->heatmap->stamps[i] = context->heatmap->generation - 1;
+	}
+	
+	context->heatmap->tiles = GAMEPLAY_FIELD_TILES(context);
+	
+	return 0;
+}
+
+/**
+ * This function releases the memory of the values.
+ * 
+ * @param context The context of the match.
+ */
+void ai_heatmap_release(game_context_t *context)
+{
+	if(context->heatmap == NULL)
+	{
+		return;
+	}
+	
+	free(context->heatmap->values);
+	free(context->heatmap->stamps);
+	free(context->heatmap);
+	context->heatmap = NULL;
+}
+
+/**
+ * This function recalculates the values of one bomb spot for all explosion
+ * radii. The rays follow the rules of the explosion: They start next to the
+ * bomb and stop at the first wall or item.
+ * 
+ * @param context The context of the match.
+ * @param position_x The x coordinate of the bomb spot.
+ * @param position_y The y coordinate of the bomb spot.
+ * @param user_x The x coordinate of the user player (-1 if there is none).
+ * @param user_y The y coordinate of the user player (-1 if there is none).
+ */
+static void ai_heatmap_update_spot(game_context_t *context, int position_x, int position_y, int user_x, int user_y)
+{
+	int i = 0;
+	int radius = 0;
+	int distance = 0;
+	int x = 0;
+	int y = 0;
+	int index = 0;
+	int direction_x[] = { 0, 1, 0, -1 };
+	int direction_y[] = { -1, 0, 1, 0 };
+	gameplay_field_t *field = NULL;
+	
+	field = gameplay_get_field(context);
+	index = position_y * GAMEPLAY_FIELD_WIDTH(context) + position_x;
+	
+	for(radius = 0; radius <= AI_HEATMAP_RADIUS_MAX; radius++)
+	{
+		AI_HEATMAP_VALUE(context, radius, index).walls = 0;
+		AI_HEATMAP_VALUE(context, radius, index).items = 0;
+		AI_HEATMAP_VALUE(context, radius, index).exposure = (position_x == user_x && position_y == user_y && radius > 0);
+	}
+	
+	if(field->type[index] != FLOOR)
+	{
+		return;
+	}
+	
+	for(i = 0; i < 4; i++)
+	{
+		for(distance = 1; distance < AI_HEATMAP_RADIUS_MAX; distance++)
+		{
+			x = position_x + direction_x[i] * distance;
+			y = position_y + direction_y[i] * distance;
+			
+			// explosions never reach the first row and column
+			if(x <= 0 || y <= 0 || x >= GAMEPLAY_FIELD_WIDTH(context) || y >= GAMEPLAY_FIELD_HEIGHT(context) || GAMEPLAY_FIELD(context, field->type, x, y) == WALL)
+			{
+				break;
+			}
+			
+			// a ray of the distance is contained in all greater radii
+			for(radius = distance + 1; radius <= AI_HEATMAP_RADIUS_MAX; radius++)
+			{
+				if(x == user_x && y == user_y)
+				{
+					AI_HEATMAP_VALUE(context, radius, index).exposure++;
+				}
+				
+				if(GAMEPLAY_FIELD(context, field->type, x, y) == DESTRUCTIVE)
+				{
+					AI_HEATMAP_VALUE(context, radius, index).walls++;
+				}
+				else if(gameplay_items_item_placed(context, x, y) == 1)
+				{
+					AI_HEATMAP_VALUE(context, radius, index).items++;
+				}
+			}
+			
+			if(GAMEPLAY_FIELD(context, field->type, x, y) == DESTRUCTIVE || gameplay_items_item_placed(context, x, y) == 1)
+			{
+				break;
+			}
+		}
+	}
+}
+
+/**
+ * This function invalidates the values of all bomb spots. It is called at the
+ * start of the game, afterwards the values are calculated when they are
+ * needed and invalidated incrementally from the gameplay events.
+ * 
+ * @param context The context of the match.
+ */
+void ai_heatmap_init(game_context_t *context)
+{
+	context->heatmap->cursor = gameplay_events_cursor(context);
+	context->heatmap->generation++;
+}
+
+/**
+ * This function invalidates the values after a tile has changed (destroyed
+ * wall, added or removed item, user player entered or left). Only bomb spots
+ * in the same row and column within the greatest radius can reach the tile,
+ * so only they are calculated again.
+ * 
+ * @param context The context of the match.
+ * @param position_x The x coordinate of the changed tile.
+ * @param position_y The y coordinate of the changed tile.
+ */
+static void ai_heatmap_update(game_context_t *context, int position_x, int position_y)
+{
+	int x = 0;
+	int y = 0;
+	
+	for(x = position_x - AI_HEATMAP_RADIUS_MAX; x <= position_x + AI_HEATMAP_RADIUS_MAX; x++)
+	{
+		if(x >= 0 && x < GAMEPLAY_FIELD_WIDTH(context))
+		{
+			context->heatmap->stamps[position_y * GAMEPLAY_FIELD_WIDTH(context) + x] = context->heatmap->generation - 1;
+		}
+	}
+	
+	for(y = position_y - AI_HEATMAP_RADIUS_MAX; y <= position_y + AI_HEATMAP_RADIUS_MAX; y++)
+	{
+		if(y >= 0 && y < GAMEPLAY_FIELD_HEIGHT(context))
+		{
+			context->heatmap->stamps[y * GAMEPLAY_FIELD_WIDTH(context) + position_x] = context->heatmap->generation - 1;
+		}
+	}
+}
+
+/**
+ * This function applies the gameplay events since the last call to the
+ * stamps. Only destroyed walls, added or removed items and movements of the
+ * user player change values. If events were lost all values are invalidated.
+ * 
+ * @param context The context of the match.
+ */
+static void ai_heatmap_consume(game_context_t *context)
+{
+	int result = 0;
+	gameplay_events_event_t event;
+	gameplay_players_player_t *user = NULL;
+	
+	user = gameplay_players_get_user(context);
+	
+	while((result = gameplay_events_next(context, &context->heatmap->cursor, &event)) == 1)
+	{
+		switch(event.type)
+		{
+			case GAMEPLAY_EVENTS_TILE_DESTROYED: case GAMEPLAY_EVENTS_ITEM_SPAWNED: case GAMEPLAY_EVENTS_ITEM_REMOVED:
+			{
+				ai_heatmap_update(context, event.position_x, event.position_y);
+				
+				break;
+			}
+			case GAMEPLAY_EVENTS_PLAYER_MOVED:
+			{
+				// the user player is the target of the AI players
+				if(user != NULL && event.value == user->id)
+				{
+					ai_heatmap_update(context, event.position_x, event.position_y);
+					ai_heatmap_update(context, event.previous_x, event.previous_y);
+				}
+				
+				break;
+			}
+			default:
+			{
+				break;
+			}
+		}
+	}
+	
+	if(result == -1)
+	{
+		context->heatmap->generation++;
+	}
+}
+
+/**
+ * This function returns the value of a bomb spot. The stamps are brought up
+ * to date with the gameplay events first, the value is calculated again if
+ * the spot was invalidated.
+ * 
+ * @param context The context of the match.
+ * @param position_x The x coordinate of the bomb spot.
+ * @param position_y The y coordinate of the bomb spot.
+ * @param explosion_radius The explosion radius of the bomb.
+ * @return The value of the bomb spot or NULL if the values could not be
+ *         allocated.
+ */
+ai_heatmap_value_t *ai_heatmap_get(game_context_t *context, int position_x, int position_y, int explosion_radius)
+{
+	int index = 0;
+	gameplay_players_player_t *user = NULL;
+	
+	if(ai_heatmap_prepare(context) == -1)
+	{
+		return NULL;
+	}
+	
+	ai_heatmap_consume(context);
+	
+	index = position_y * GAMEPLAY_FIELD_WIDTH(context) + position_x;
+	if(context->heatmap->stamps[index] != context->heatmap->generation)
+	{
+		user = gameplay_players_get_user(context);
+		ai_heatmap_update_spot(context, position_x, position_y, (user == NULL)?(-1):(user->position_x), (user == NULL)?(-1):(user->position_y));
+		context->heatmap->stamps[index] = context->heatmap->generation;
+	}
+	
+	if(explosion_radius > AI_HEATMAP_RADIUS_MAX)
+	{
+		explosion_radius = AI_HEATMAP_RADIUS_MAX;
+	}
+	
+	if(explosion_radius < 0)
+	{
+		explosion_radius = 0;
+	}
+	
+	return &(AI_HEATMAP_VALUE(context, explosion_radius, index));
+}
@@ -0,0 +1,44 @@
+/*
+ * Copyright (C) 2015 NIPE-SYSTEMS
+ * Copyright (C) 2015 Jonas Krug
+ * Copyright (C) 2015 Tim Gevers
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __AI_HEATMAP_H__
+#define __AI_HEATMAP_H__
+
+#include "gameplay.h"
+
+// the greatest explosion radius which is distinguished, this is the size of
+// the classic field and keeps the updates independent of the field size
+#define AI_HEATMAP_RADIUS_MAX 9
+
+/**
+ * The value of a bomb spot for one explosion radius.
+ */
+typedef struct ai_heatmap_value_s
+{
+	unsigned char walls;
+	unsigned char items;
+	unsigned char exposure;
+} ai_heatmap_value_t;
+
+int ai_heatmap_allocate(game_context_t *context);
+void ai_heatmap_release(game_context_t *context);
+void ai_heatmap_init(game_context_t *context);
+ai_heatmap_value_t *ai_heatmap_get(game_context_t *context, int position_x, int position_y, int explosion_radius);
+
+#endif /* __AI_HEATMAP_H__ */
@@ -23,10 +23,18 @@
 #include "ai-jobs.h"
 #include "ai-pathfinding.h"
 #include "ai-simulation.h"
-#include "core.h"
+#include "ai-heatmap.h"
+#include "core-log.h"
+#include "core-pool.h"
 
 static int ai_jobs_test_occurrence(ai_jobs_t *list, int position_x, int position_y, ai_jobs_type_t type);
 
+// the jobs of all players, the job lists are rebuilt every update
+struct ai_jobs_context_s
+{
+	core_pool_t pool;
+};
+
 static int ai_jobs_test_occurrence(ai_jobs_t *list, int position_x, int position_y, ai_jobs_type_t type)
 {
 	ai_jobs_t *job_iterator = list;
@@ -48,18 +56,19 @@ static int ai_jobs_test_occurrence(ai_jobs_t *list, int position_x, int position
  * This function allocates a new job and returns it for saving in a player job
  * list.
  * 
+ * @param context The context of the match.
  * @param position_x The x coordinate of the target position of the new job.
  * @param position_y The y coordinate of the target position of the new job.
  * @param type The type of the new job. This determines what action should be
  *             executed when the target is reached.
  * @return The new allocated job.
  */
-ai_jobs_t *ai_jobs_allocate(int position_x, int position_y, ai_jobs_type_t type)
+ai_jobs_t *ai_jobs_allocate(game_context_t *context, int position_x, int position_y, ai_jobs_type_t type)
 {
 	ai_jobs_t *job = NULL;
 	
 	// allocate new job
-	job = malloc(sizeof(ai_jobs_t));
+	job = core_pool_allocate(&context->jobs->pool);
 	if(job == NULL)
 	{
 		core_error("Failed to allocate job.");
@@ -154,9 +163,10 @@ void ai_jobs_print(ai_jobs_t *root)
 /**
  * This function cleans all jobs of a existing job list.
  * 
+ * @param context The context of the match.
  * @param root The list root element. This element is stored in the player.
  */
-void ai_jobs_free(ai_jobs_t **root)
+void ai_jobs_free(game_context_t *context, ai_jobs_t **root)
 {
 	ai_jobs_t *job_iterator = *root;
 	ai_jobs_t *job_iterator_backup = NULL;
@@ -164,23 +174,83 @@ void ai_jobs_free(ai_jobs_t **root)
 	while(job_iterator != NULL)
 	{
 		job_iterator_backup = job_iterator->next;
-		free(job_iterator);
+		core_pool_free(&context->jobs->pool, job_iterator);
 		job_iterator = job_iterator_backup;
 	}
 	
 	*root = NULL;
 }
 
+/**
+ * This function creates the job pool of a context. It is kept between the
+ * matches.
+ * 
+ * @param context The context of the match.
+ * @return 0 on success, -1 on error.
+ */
+int ai_jobs_init(game_context_t *context)
+{
+	if(context->jobs != NULL)
+	{
+		return 0;
+	}
+	
+	context->jobs = malloc(sizeof(ai_jobs_context_t));
+	if(context->jobs == NULL)
+	{
+		return -1;
+	}
+	
+	context->jobs->pool = (core_pool_t)CORE_POOL_INITIALIZER(ai_jobs_t, AI_JOBS_POOL_CHUNK);
+	
+	return 0;
+}
+
+/**
+ * This function frees the jobs of all players at once. The job lists of the
+ * players become invalid.
+ * 
+ * @param context The context of the match.
+ */
+void ai_jobs_cleanup(game_context_t *context)
+{
+	if(context->jobs == NULL)
+	{
+		return;
+	}
+	
+	core_pool_reset(&context->jobs->pool);
+}
+
+/**
+ * This function releases the memory of the jobs. It is called when the game
+ * is shut down.
+ * 
+ * @param context The context of the match.
+ */
+void ai_jobs_release(game_context_t *context)
+{
+	if(context->jobs == NULL)
+	{
+		return;
+	}
+	
+	core_pool_release(&context->jobs->pool);
+	free(context->jobs);
+	context->jobs = NULL;
+}
+
 /**
  * This function removes an existing job out of a job list. The job will be
  * searched by position and type.
  * 
+ * @param context The context of the match.
  * @param root The list root element. This element is stored in the player.
  * @param position_x The x coordinate of the job which should be removed.
  * @param position_y The y coordinate of the job which should be removed.
  * @param type The type of the job which should be removed.
  */
-void ai_jobs_remove(ai_jobs_t **root, int position_x, int position_y, ai_jobs_type_t type)
+void ai_jobs_remove(game_context_t *context, ai_jobs_t **root, int position_x, int position_y, ai_jobs_type_t type)
 {
 	ai_jobs_t *job_iterator = NULL;
 	ai_jobs_t *next_backup = NULL;
@@ -194,7 +264,7 @@ void ai_jobs_remove(ai_jobs_t **root, int position_x, int position_y, ai_jobs_ty
 	if((*root)->position_x == position_x && (*root)->position_y == position_y && (*root)->type == type)
 	{
 		next_backup = (*root)->next;
-		free(*root);
+		core_pool_free(&context->jobs->pool, *root);
 		*root = next_backup;
 		return;
 	}
@@ -205,7 +275,7 @@ void ai_jobs_remove(ai_jobs_t **root, int position_x, int position_y, ai_jobs_ty
 		if(job_iterator->next != NULL && job_iterator->next->position_x == position_x && job_iterator->next->position_y == position_y && job_iterator->next->type == type)
 		{
 			next_backup = job_iterator->next->next;
-			free(job_iterator->next);
+			core_pool_free(&context->jobs->pool, job_iterator->next);
 			job_iterator->next = next_backup;
 			return;
 		}
@@ -217,16 +287,19 @@ void ai_jobs_remove(ai_jobs_t **root, int position_x, int position_y, ai_jobs_ty
  * choose the best job. The criteria depend on the position of the user player,
  * the own position of the AI player and the distances between them.
  * 
+ * @param context The context of the match.
  * @param root The list root element. This element is stored in the player.
  * @param position_x_user The x coordinate of the user player.
  * @param position_y_user The y coordinate of the user player.
  * @param position_x_ai The x coordinate of the AI player.
  * @param position_y_ai The y coordinate of the AI player.
+ * @param explosion_radius The explosion radius of the AI player.
  * @return The optimal choosed job.
  */
-ai_jobs_t *ai_jobs_get_optimal(ai_jobs_t *root, int position_x_user, int position_y_user, int position_x_ai, int position_y_ai)
+ai_jobs_t *ai_jobs_get_optimal(game_context_t *context, ai_jobs_t *root, int position_x_user, int position_y_user, int position_x_ai, int position_y_ai, int explosion_radius)
 {
 	ai_jobs_t *job_iterator = NULL;
+	ai_heatmap_value_t *value = NULL;
 	int distance_to_player = 0;
 	int distance_to_walk = 0;
 	float saved_score = -1;
@@ -240,8 +313,8 @@ ai_jobs_t *ai_jobs_get_optimal(ai_jobs_t *root, int position_x_user, int positio
 		{
 			case ESCAPE:
 			{
-				distance_to_walk = ai_pathfinding_move_to_length(position_x_ai, position_y_ai, job_iterator->position_x, job_iterator->position_y, 2);
-				distance_to_player = ai_pathfinding_move_to_length(job_iterator->position_x, job_iterator->position_y, position_x_user, position_y_user, 2);
+				distance_to_walk = ai_pathfinding_move_to_length(context, position_x_ai, position_y_ai, job_iterator->position_x, job_iterator->position_y, 2);
+				distance_to_player = ai_pathfinding_move_to_length(context, job_iterator->position_x, job_iterator->position_y, position_x_user, position_y_user, 2);
 				
 				if(distance_to_walk == -1)
 				{
@@ -257,7 +330,7 @@ ai_jobs_t *ai_jobs_get_optimal(ai_jobs_t *root, int position_x_user, int positio
 					job_iterator->score += distance_to_player * 0.05;
 				}
 				
-				if(ai_simulation_get_walkable(job_iterator->position_x, job_iterator->position_y) == 0)
+				if(ai_simulation_get_walkable(context, job_iterator->position_x, job_iterator->position_y) == 0)
 				{
 					job_iterator->score += 5;
 				}
@@ -266,8 +339,8 @@ ai_jobs_t *ai_jobs_get_optimal(ai_jobs_t *root, int position_x_user, int positio
 			}
 			case BOMB_DROP:
 			{
-				distance_to_walk = ai_pathfinding_move_to_length(position_x_ai, position_y_ai, job_iterator->position_x, job_iterator->position_y, 0);
-				distance_to_player = ai_pathfinding_move_to_length(job_iterator->position_x, job_iterator->position_y, position_x_user, position_y_user, 0);
+				distance_to_walk = ai_pathfinding_move_to_length(context, position_x_ai, position_y_ai, job_iterator->position_x, job_iterator->position_y, 0);
+				distance_to_player = ai_pathfinding_move_to_length(context, job_iterator->position_x, job_iterator->position_y, position_x_user, position_y_user, 0);
 				
 				if(distance_to_player == -1)
 				{
@@ -280,6 +353,14 @@ ai_jobs_t *ai_jobs_get_optimal(ai_jobs_t *root, int position_x_user, int positio
 				
 				job_iterator->score += distance_to_walk * 0.1;
 				
+				// prefer spots which destroy walls or hit the user player
+				value = ai_heatmap_get(context, job_iterator->position_x, job_iterator->position_y, explosion_radius);
+				if(value != NULL)
+				{
+					job_iterator->score -= value->walls * 0.3 + value->exposure * 1.0;
+					job_iterator->score += value->items * 0.2;
+				}
+				
 				break;
 			}
 		}
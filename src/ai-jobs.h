@@ -20,6 +20,10 @@
 #ifndef __AI_JOBS_H__
 #define __AI_JOBS_H__
 
+#include "game-context.h"
+
+#define AI_JOBS_POOL_CHUNK 512
+
 typedef enum ai_jobs_type_e
 {
 	ESCAPE = 1,
@@ -36,11 +40,14 @@ typedef struct ai_jobs_s
 	struct ai_jobs_s *next;
 } ai_jobs_t;
 
-ai_jobs_t *ai_jobs_allocate(int position_x, int position_y, ai_jobs_type_t type);
+ai_jobs_t *ai_jobs_allocate(game_context_t *context, int position_x, int position_y, ai_jobs_type_t type);
 void ai_jobs_insert(ai_jobs_t **root, ai_jobs_t *insertion);
 void ai_jobs_print(ai_jobs_t *root);
-void ai_jobs_free(ai_jobs_t **root);
-void ai_jobs_remove(ai_jobs_t **root, int position_x, int position_y, ai_jobs_type_t type);
-ai_jobs_t *ai_jobs_get_optimal(ai_jobs_t *root, int position_x_user, int position_y_user, int position_x_ai, int position_y_ai);
+void ai_jobs_free(game_context_t *context, ai_jobs_t **root);
+int ai_jobs_init(game_context_t *context);
+void ai_jobs_cleanup(game_context_t *context);
+void ai_jobs_release(game_context_t *context);
+void ai_jobs_remove(game_context_t *context, ai_jobs_t **root, int position_x, int position_y, ai_jobs_type_t type);
+ai_jobs_t *ai_jobs_get_optimal(game_context_t *context, ai_jobs_t *root, int position_x_user, int position_y_user, int position_x_ai, int position_y_ai, int explosion_radius);
 
 #endif /* __AI_JOBS_H__ */
@@ -0,0 +1,489 @@
+/*
+ * Copyright (C) 2015 NIPE-SYSTEMS
+ * Copyright (C) 2015 Jonas Krug
+ * Copyright (C) 2015 Tim Gevers
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+
+#include "ai-mcts.h"
+#include "ai-state.h"
+#include "gameplay.h"
+#include "gameplay-players.h"
+#include "core-log.h"
+
+static unsigned int ai_mcts_random(game_context_t *context);
+static long ai_mcts_time(void);
+static int ai_mcts_get_ready(ai_state_t *state, int player_index);
+static ai_state_action_t ai_mcts_policy(game_context_t *context, ai_state_t *state, int player_index);
+static ai_state_action_t ai_mcts_tree_policy(game_context_t *context, ai_state_t *state, int player_index, int *node, char *tree);
+static float ai_mcts_evaluate(ai_state_t *root, ai_state_t *state, int player_index);
+
+struct ai_mcts_context_s
+{
+	// the nodes are reused by every search, so no memory is allocated while
+	// searching
+	ai_mcts_node_t nodes[AI_MCTS_NODES_MAX];
+	int nodes_amount;
+	unsigned int random_state;
+	// a fixed amount of rollouts replaces the time budget if it is set, so
+	// the searches are reproducible
+	int rollouts_max;
+	ai_mcts_statistics_t statistics;
+};
+
+/**
+ * This function allocates the nodes of the searches of a context. They are
+ * kept between the matches, the random numbers start again in every match.
+ * 
+ * @param context The context of the match.
+ * @return 0 on success, -1 on error.
+ */
+int ai_mcts_init(game_context_t *context)
+{
+	if(context->mcts == NULL)
+	{
+		context->mcts = calloc(1, sizeof(ai_mcts_context_t));
+		if(context->mcts == NULL)
+		{
+			return -1;
+		}
+	}
+	
+	context->mcts->random_state = 2463534242u;
+	
+	return 0;
+}
+
+/**
+ * This function frees the nodes of the searches.
+ * 
+ * @param context The context of the match.
+ */
+void ai_mcts_release(game_context_t *context)
+{
+	free(context->mcts);
+	context->mcts = NULL;
+}
+
+/**
+ * This function sets a fixed amount of rollouts for all following searches
+ * instead of their time budget, e.g. to repeat a batch of matches with the
+ * same results on any machine.
+ * 
+ * @param context The context of the match.
+ * @param rollouts The rollouts of one search, 0 to use the time budget again.
+ */
+void ai_mcts_set_rollouts(game_context_t *context, int rollouts)
+{
+	context->mcts->rollouts_max = rollouts;
+}
+
+/**
+ * This function generates a pseudo random number (xorshift). It is much
+ * faster than rand() and does not disturb the random drops.
+ * 
+ * @param context The context of the match.
+ * @return The random number.
+ */
+static unsigned int ai_mcts_random(game_context_t *context)
+{
+	context->mcts->random_state ^= context->mcts->random_state << 13;
+	context->mcts->random_state ^= context->mcts->random_state >> 17;
+	context->mcts->random_state ^= context->mcts->random_state << 5;
+	
+	return context->mcts->random_state;
+}
+
+/**
+ * This function returns the current time of a monotonic clock.
+ * 
+ * @return The time in microseconds.
+ */
+static long ai_mcts_time(void)
+{
+	struct timespec now;
+	
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	
+	return now.tv_sec * 1000000L + now.tv_nsec / 1000L;
+}
+
+/**
+ * This function tests if a player executes an action in the next step of a
+ * state. The movement cooldown is decremented before the actions are
+ * executed.
+ * 
+ * @param state The state.
+ * @param player_index The index of the player.
+ * @return 1 if the player executes an action, 0 if not.
+ */
+static int ai_mcts_get_ready(ai_state_t *state, int player_index)
+{
+	return (ai_state_get_alive(state, player_index) == 1 && state->players[player_index].movement_cooldown <= 1);
+}
+
+/**
+ * This function chooses the action of a player in a rollout. Threatened
+ * players flee from bombs, all others walk around randomly and sometimes drop
+ * a bomb. Burning tiles are never entered.
+ * 
+ * @param context The context of the match.
+ * @param state The state.
+ * @param player_index The index of the player.
+ * @return The chosen action.
+ */
+static ai_state_action_t ai_mcts_policy(game_context_t *context, ai_state_t *state, int player_index)
+{
+	int action = 0;
+	int x = 0;
+	int y = 0;
+	int threatened = 0;
+	int candidates_amount = 0;
+	int fallbacks_amount = 0;
+	ai_state_action_t candidates[AI_STATE_ACTIONS];
+	ai_state_action_t fallbacks[AI_STATE_ACTIONS];
+	ai_state_player_t *player = NULL;
+	
+	player = &(state->players[player_index]);
+	threatened = ai_state_get_threatened(state, player->position_x, player->position_y);
+	
+	if(threatened == 0)
+	{
+		if(ai_mcts_random(context) % 8 == 0 && ai_state_get_legal(state, player_index, AI_STATE_ACTION_BOMB) == 1)
+		{
+			return AI_STATE_ACTION_BOMB;
+		}
+		
+		candidates[candidates_amount++] = AI_STATE_ACTION_WAIT;
+	}
+	
+	for(action = AI_STATE_ACTION_UP; action <= AI_STATE_ACTION_LEFT; action++)
+	{
+		if(ai_state_get_legal(state, player_index, action) == 0)
+		{
+			continue;
+		}
+		
+		ai_state_action_target(action, player->position_x, player->position_y, &x, &y);
+		if(state->fire[AI_STATE_INDEX(x, y)] > 1)
+		{
+			continue;
+		}
+		
+		if(ai_state_get_threatened(state, x, y) == 0)
+		{
+			candidates[candidates_amount++] = action;
+		}
+		else
+		{
+			fallbacks[fallbacks_amount++] = action;
+		}
+	}
+	
+	if(candidates_amount > 0)
+	{
+		return candidates[ai_mcts_random(context) % candidates_amount];
+	}
+	
+	if(fallbacks_amount > 0)
+	{
+		return fallbacks[ai_mcts_random(context) % fallbacks_amount];
+	}
+	
+	return AI_STATE_ACTION_WAIT;
+}
+
+/**
+ * This function chooses the action of the searching player while the search
+ * is in the tree. Untried actions are expanded first (which leaves the tree),
+ * otherwise the child with the best upper confidence bound is selected.
+ * 
+ * @param context The context of the match.
+ * @param state The state.
+ * @param player_index The index of the searching player.
+ * @param node The index of the current node, it is replaced by the index of
+ *             the selected child (read and write by pointer).
+ * @param tree 1 while the search is in the tree, set to 0 if the tree is left
+ *             (write by pointer).
+ * @return The chosen action.
+ */
+static ai_state_action_t ai_mcts_tree_policy(game_context_t *context, ai_state_t *state, int player_index, int *node, char *tree)
+{
+	int action = 0;
+	int child = 0;
+	int untried_amount = 0;
+	int best_action = AI_STATE_ACTION_WAIT;
+	float best_value = -1;
+	float value = 0;
+	ai_state_action_t untried[AI_STATE_ACTIONS];
+	ai_mcts_node_t *current = NULL;
+	
+	current = &(context->mcts->nodes[*node]);
+	
+	for(action = 0; action < AI_STATE_ACTIONS; action++)
+	{
+		if(current->children[action] == AI_MCTS_NO_NODE && ai_state_get_legal(state, player_index, action) == 1)
+		{
+			untried[untried_amount++] = action;
+		}
+	}
+	
+	// expansion
+	if(untried_amount > 0)
+	{
+		*tree = 0;
+		
+		if(context->mcts->nodes_amount == AI_MCTS_NODES_MAX)
+		{
+			return ai_mcts_policy(context, state, player_index);
+		}
+		
+		action = untried[ai_mcts_random(context) % untried_amount];
+		child = context->mcts->nodes_amount++;
+		context->mcts->nodes[child].visits = 0;
+		context->mcts->nodes[child].reward = 0;
+		for(best_action = 0; best_action < AI_STATE_ACTIONS; best_action++)
+		{
+			context->mcts->nodes[child].children[best_action] = AI_MCTS_NO_NODE;
+		}
+		
+		current->children[action] = child;
+		*node = child;
+		
+		return action;
+	}
+	
+	// selection
+	for(action = 0; action < AI_STATE_ACTIONS; action++)
+	{
+		child = current->children[action];
+		if(child == AI_MCTS_NO_NODE || ai_state_get_legal(state, player_index, action) == 0)
+		{
+			continue;
+		}
+		
+		value = context->mcts->nodes[child].reward / context->mcts->nodes[child].visits + AI_MCTS_EXPLORATION * sqrtf(logf(current->visits + 1) / context->mcts->nodes[child].visits);
+		if(value > best_value)
+		{
+			best_value = value;
+			best_action = action;
+		}
+	}
+	
+	*node = current->children[best_action];
+	
+	return best_action;
+}
+
+/**
+ * This function evaluates the end of a rollout for the searching player. Dead
+ * players get no reward, lost health points are punished while damage of the
+ * user player, destroyed walls and closeness to the user player are rewarded.
+ * 
+ * @param root The state at the beginning of the search.
+ * @param state The state at the end of the rollout.
+ * @param player_index The index of the searching player.
+ * @return The reward in the range of [0, 1].
+ */
+static float ai_mcts_evaluate(ai_state_t *root, ai_state_t *state, int player_index)
+{
+	int i = 0;
+	int user_index = 0;
+	int walls = 0;
+	float reward = 0.5;
+	ai_state_player_t *player = NULL;
+	ai_state_player_t *user = NULL;
+	
+	player = &(state->players[player_index]);
+	if(player->health_points <= 0)
+	{
+		return 0;
+	}
+	
+	reward -= 0.15 * (root->players[player_index].health_points - player->health_points);
+	
+	user_index = ai_state_find_user(state);
+	if(user_index != -1)
+	{
+		user = &(state->players[user_index]);
+		reward += 0.15 * (root->players[user_index].health_points - user->health_points);
+		reward -= 0.01 * (abs(user->position_x - player->position_x) + abs(user->position_y - player->position_y));
+	}
+	
+	for(i = 0; i < AI_STATE_TILES; i++)
+	{
+		if(root->type[i] == DESTRUCTIVE && state->type[i] == FLOOR)
+		{
+			walls++;
+		}
+	}
+	reward += 0.02 * walls;
+	
+	if(reward < 0)
+	{
+		return 0;
+	}
+	
+	if(reward > 1)
+	{
+		return 1;
+	}
+	
+	return reward;
+}
+
+/**
+ * This function chooses the action of an AI player by a Monte Carlo tree
+ * search. The tree contains the decisions of the searching player, the other
+ * players are simulated by the rollout policy. Every iteration starts at the
+ * given state, so the tree is open loop and the state is never stored in the
+ * nodes. The search runs until the time budget (or the fixed amount of
+ * rollouts) is used up.
+ * 
+ * @param context The context of the match.
+ * @param state The state in which the player has to decide (the player must be
+ *              able to act).
+ * @param player_index The index of the searching player.
+ * @param budget The time budget in microseconds.
+ * @return The chosen action.
+ */
+ai_state_action_t ai_mcts_decide(game_context_t *context, ai_state_t *state, int player_index, long budget)
+{
+	int i = 0;
+	int tick = 0;
+	int node = 0;
+	int path_length = 0;
+	int action = 0;
+	int best_action = AI_STATE_ACTION_WAIT;
+	int best_visits = -1;
+	char tree = 0;
+	long start = 0;
+	long elapsed = 0;
+	float reward = 0;
+	int path[AI_MCTS_HORIZON + 2];
+	ai_state_action_t actions[AI_STATE_PLAYERS_MAX];
+	ai_state_t simulation;
+	
+	if(ai_state_get_alive(state, player_index) == 0)
+	{
+		return AI_STATE_ACTION_WAIT;
+	}
+	
+	start = ai_mcts_time();
+	
+	context->mcts->statistics.rollouts = 0;
+	context->mcts->nodes_amount = 1;
+	context->mcts->nodes[0].visits = 0;
+	context->mcts->nodes[0].reward = 0;
+	for(action = 0; action < AI_STATE_ACTIONS; action++)
+	{
+		context->mcts->nodes[0].children[action] = AI_MCTS_NO_NODE;
+	}
+	
+	do
+	{
+		simulation = *state;
+		node = 0;
+		tree = 1;
+		path_length = 0;
+		path[path_length++] = node;
+		
+		// the decision at the root is executed immediately
+		action = ai_mcts_tree_policy(context, &simulation, player_index, &node, &tree);
+		path[path_length++] = node;
+		ai_state_apply(&simulation, player_index, action);
+		
+		for(tick = 0; tick < AI_MCTS_HORIZON && ai_state_get_alive(&simulation, player_index) == 1; tick++)
+		{
+			for(i = 0; i < simulation.players_amount; i++)
+			{
+				actions[i] = AI_STATE_ACTION_WAIT;
+				if(ai_mcts_get_ready(&simulation, i) == 0)
+				{
+					continue;
+				}
+				
+				if(i == player_index && tree == 1)
+				{
+					actions[i] = ai_mcts_tree_policy(context, &simulation, player_index, &node, &tree);
+					path[path_length++] = node;
+				}
+				else
+				{
+					actions[i] = ai_mcts_policy(context, &simulation, i);
+				}
+			}
+			
+			ai_state_step(&simulation, actions);
+		}
+		
+		reward = ai_mcts_evaluate(state, &simulation, player_index);
+		
+		// backpropagation (nodes are only appended once after leaving the tree)
+		for(i = 0; i < path_length; i++)
+		{
+			if(i > 0 && path[i] == path[i - 1])
+			{
+				continue;
+			}
+			
+			context->mcts->nodes[path[i]].visits++;
+			context->mcts->nodes[path[i]].reward += reward;
+		}
+		
+		context->mcts->statistics.rollouts++;
+		
+		// reading the clock is expensive compared to a rollout
+		if(context->mcts->statistics.rollouts % 16 == 0)
+		{
+			elapsed = ai_mcts_time() - start;
+		}
+	}
+	while((context->mcts->rollouts_max > 0)?(context->mcts->statistics.rollouts < context->mcts->rollouts_max):(elapsed < budget));
+	
+	for(action = 0; action < AI_STATE_ACTIONS; action++)
+	{
+		node = context->mcts->nodes[0].children[action];
+		if(node != AI_MCTS_NO_NODE && context->mcts->nodes[node].visits > best_visits)
+		{
+			best_visits = context->mcts->nodes[node].visits;
+			best_action = action;
+		}
+	}
+	
+	elapsed = ai_mcts_time() - start;
+	context->mcts->statistics.nodes = context->mcts->nodes_amount;
+	context->mcts->statistics.elapsed = elapsed;
+	context->mcts->statistics.rollouts_per_second = (elapsed > 0)?(context->mcts->statistics.rollouts * 1000000L / elapsed):(0);
+	
+	core_debug("MCTS: %i rollouts in %li us (%li rollouts/s, %i nodes), action %i", context->mcts->statistics.rollouts, elapsed, context->mcts->statistics.rollouts_per_second, context->mcts->nodes_amount, best_action);
+	
+	return best_action;
+}
+
+/**
+ * This function returns the statistics of the last search.
+ * 
+ * @param context The context of the match.
+ * @return The statistics.
+ */
+ai_mcts_statistics_t *ai_mcts_get_statistics(game_context_t *context)
+{
+	return &context->mcts->statistics;
+}
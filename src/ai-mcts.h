@@ -0,0 +1,56 @@
+/*
+ * Copyright (C) 2015 NIPE-SYSTEMS
+ * Copyright (C) 2015 Jonas Krug
+ * Copyright (C) 2015 Tim Gevers
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __AI_MCTS_H__
+#define __AI_MCTS_H__
+
+#include "ai-state.h"
+
+// time budget of one search, specified in microseconds
+#ifndef AI_MCTS_BUDGET
+#define AI_MCTS_BUDGET 15000
+#endif /* AI_MCTS_BUDGET */
+
+#define AI_MCTS_NODES_MAX 8192
+#define AI_MCTS_HORIZON 60
+#define AI_MCTS_EXPLORATION 0.7
+#define AI_MCTS_NO_NODE -1
+
+typedef struct ai_mcts_node_s
+{
+	int visits;
+	float reward;
+	int children[AI_STATE_ACTIONS];
+} ai_mcts_node_t;
+
+typedef struct ai_mcts_statistics_s
+{
+	int rollouts;
+	int nodes;
+	long elapsed;
+	long rollouts_per_second;
+} ai_mcts_statistics_t;
+
+int ai_mcts_init(game_context_t *context);
+void ai_mcts_release(game_context_t *context);
+void ai_mcts_set_rollouts(game_context_t *context, int rollouts);
+ai_state_action_t ai_mcts_decide(game_context_t *context, ai_state_t *state, int player_index, long budget);
+ai_mcts_statistics_t *ai_mcts_get_statistics(game_context_t *context);
+
+#endif /* __AI_MCTS_H__ */
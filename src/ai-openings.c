@@ -0,0 +1,549 @@
+/*
+ * Copyright (C) 2015 NIPE-SYSTEMS
+ * Copyright (C) 2015 Jonas Krug
+ * Copyright (C) 2015 Tim Gevers
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "ai-openings.h"
+#include "ai-state.h"
+#include "ai-beam.h"
+#include "gameplay.h"
+#include "gameplay-players.h"
+#include "core-log.h"
+
+static void ai_openings_region_add(ai_openings_plan_t *plan, int index, int tick);
+static void ai_openings_region_add_blast(ai_openings_plan_t *plan, int position_x, int position_y, int explosion_radius, int tick);
+static int ai_openings_region_get(ai_openings_plan_t *plan, int index, int tick);
+static unsigned long long ai_openings_signature(ai_state_t *state, int player_index, ai_openings_plan_t *plan, int tick);
+static void ai_openings_get_path(game_context_t *context, char *path, int length);
+static int ai_openings_get_supported(game_context_t *context);
+
+struct ai_openings_context_s
+{
+	ai_openings_plan_t plans[AI_STATE_PLAYERS_MAX];
+	int plans_amount;
+	char loaded;
+	int active[AI_STATE_PLAYERS_MAX];
+	int step[AI_STATE_PLAYERS_MAX];
+};
+
+/**
+ * This function adds a tile to the region of a plan.
+ * 
+ * @param plan The plan.
+ * @param index The index of the tile.
+ * @param tick The tick at which the tile is touched.
+ */
+static void ai_openings_region_add(ai_openings_plan_t *plan, int index, int tick)
+{
+	if(tick < plan->region_first[index])
+	{
+		plan->region_first[index] = tick;
+	}
+	
+	if(tick > plan->region_last[index])
+	{
+		plan->region_last[index] = tick;
+	}
+}
+
+/**
+ * This function adds the tiles of an explosion to the region of a plan. The
+ * complete cross is added regardless of walls, because in the real game the
+ * walls may be destroyed in a different order.
+ * 
+ * @param plan The plan.
+ * @param position_x The x coordinate of the bomb.
+ * @param position_y The y coordinate of the bomb.
+ * @param explosion_radius The explosion radius of the bomb.
+ * @param tick The tick at which the bomb is placed.
+ */
+static void ai_openings_region_add_blast(ai_openings_plan_t *plan, int position_x, int position_y, int explosion_radius, int tick)
+{
+	int distance = 0;
+	
+	for(distance = -explosion_radius; distance <= explosion_radius; distance++)
+	{
+		if(position_x + distance >= 0 && position_x + distance < AI_STATE_WIDTH)
+		{
+			ai_openings_region_add(plan, AI_STATE_INDEX(position_x + distance, position_y), tick);
+		}
+		
+		if(position_y + distance >= 0 && position_y + distance < AI_STATE_HEIGHT)
+		{
+			ai_openings_region_add(plan, AI_STATE_INDEX(position_x, position_y + distance), tick);
+		}
+	}
+}
+
+/**
+ * This function tests if a tile of the region of a plan is relevant at a tick.
+ * 
+ * @param plan The plan.
+ * @param index The index of the tile.
+ * @param tick The tick.
+ * @return 1 if the tile is relevant, 0 otherwise.
+ */
+static int ai_openings_region_get(ai_openings_plan_t *plan, int index, int tick)
+{
+	return (plan->region_first[index] <= tick + AI_OPENINGS_WINDOW && plan->region_last[index] + AI_OPENINGS_WINDOW >= tick);
+}
+
+/**
+ * This function calculates the signature of the region of a plan at a tick. It
+ * contains the tiles, fire, bombs and the other players in the tiles of the
+ * region which are relevant at the tick. Items are left out, because they are
+ * dropped randomly and only shorten explosions, so they do not make a plan
+ * unsafe.
+ * 
+ * @param state The state.
+ * @param player_index The index of the player which executes the plan.
+ * @param plan The plan.
+ * @param tick The tick of the decision.
+ * @return The signature.
+ */
+static unsigned long long ai_openings_signature(ai_state_t *state, int player_index, ai_openings_plan_t *plan, int tick)
+{
+	int i = 0;
+	int index = 0;
+	unsigned long long signature = 0;
+	ai_state_bomb_t *bomb = NULL;
+	
+	for(i = 0; i < AI_STATE_TILES; i++)
+	{
+		if(ai_openings_region_get(plan, i, tick) == 0)
+		{
+			continue;
+		}
+		
+		if(state->type[i] == DESTRUCTIVE)
+		{
+			signature ^= ai_state_hash_key(AI_STATE_HASH_DESTRUCTIVE, i);
+		}
+		
+		if(state->fire[i] > 0)
+		{
+			signature ^= ai_state_hash_key(AI_STATE_HASH_FIRE + i, state->fire[i]);
+		}
+		
+		if(state->bomb[i] != AI_STATE_NO_BOMB)
+		{
+			bomb = &(state->bombs[(int)state->bomb[i]]);
+			signature ^= ai_state_hash_key(AI_STATE_HASH_BOMB + i, bomb->explosion_timeout << 8 | bomb->explosion_radius);
+		}
+	}
+	
+	for(i = 0; i < state->players_amount; i++)
+	{
+		index = AI_STATE_INDEX(state->players[i].position_x, state->players[i].position_y);
+		if(i != player_index && ai_state_get_alive(state, i) == 1 && ai_openings_region_get(plan, index, tick) == 1)
+		{
+			signature ^= ai_state_hash_key(AI_STATE_HASH_PLAYER + i, index);
+		}
+	}
+	
+	return signature;
+}
+
+/**
+ * This function tests if openings can be used on the current field. The plans
+ * are made on the AI state, so the field has to fit into its window.
+ * 
+ * @param context The context of the match.
+ * @return 1 if openings are supported, 0 if not.
+ */
+static int ai_openings_get_supported(game_context_t *context)
+{
+	return (GAMEPLAY_FIELD_WIDTH(context) == AI_STATE_WIDTH && GAMEPLAY_FIELD_HEIGHT(context) == AI_STATE_HEIGHT);
+}
+
+/**
+ * This function builds the path of the cache file for the current field size.
+ * 
+ * @param context The context of the match.
+ * @param path The buffer for the path.
+ * @param length The length of the buffer.
+ */
+static void ai_openings_get_path(game_context_t *context, char *path, int length)
+{
+	snprintf(path, length, AI_OPENINGS_PATH, GAMEPLAY_FIELD_WIDTH(context), GAMEPLAY_FIELD_HEIGHT(context));
+}
+
+/**
+ * This function precomputes the opening of a player. The player is simulated
+ * alone with the beam search planner while all other players wait. The
+ * decisions are made at the same point of the tick as in the real game, so
+ * the recorded states match the states the AI sees while playing.
+ * 
+ * @param context The context of the match.
+ * @param state The state at the start of the game.
+ * @param player_index The index of the player.
+ * @param plan The plan which is filled.
+ */
+void ai_openings_compute(game_context_t *context, ai_state_t *state, int player_index, ai_openings_plan_t *plan)
+{
+	int pass = 0;
+	int tick = 0;
+	int i = 0;
+	ai_state_t simulation;
+	ai_state_player_t *player = NULL;
+	ai_state_action_t action = AI_STATE_ACTION_WAIT;
+	ai_openings_step_t *step = NULL;
+	
+	memset(plan, 0, sizeof(ai_openings_plan_t));
+	plan->spawn_x = state->players[player_index].position_x;
+	plan->spawn_y = state->players[player_index].position_y;
+	
+	for(i = 0; i < AI_STATE_TILES; i++)
+	{
+		plan->region_first[i] = AI_OPENINGS_TICKS;
+		plan->region_last[i] = 0;
+	}
+	
+	// the first pass collects the region, the second pass calculates the
+	// signatures on the complete region (the planner is deterministic)
+	for(pass = 0; pass < 2; pass++)
+	{
+		simulation = *state;
+		plan->steps_amount = 0;
+		
+		for(tick = 0; tick < AI_OPENINGS_TICKS && plan->steps_amount < AI_OPENINGS_STEPS_MAX; tick++)
+		{
+			ai_state_step(&simulation, NULL);
+			
+			player = &(simulation.players[player_index]);
+			if(ai_state_get_alive(&simulation, player_index) == 0)
+			{
+				break;
+			}
+			
+			if(player->movement_cooldown > 0)
+			{
+				continue;
+			}
+			
+			ai_openings_region_add(plan, AI_STATE_INDEX(player->position_x, player->position_y), tick);
+			
+			action = ai_beam_decide(context, &simulation, player_index);
+			
+			step = &(plan->steps[plan->steps_amount++]);
+			step->tick = tick;
+			step->action = action;
+			step->position_x = player->position_x;
+			step->position_y = player->position_y;
+			step->signature = ai_openings_signature(&simulation, player_index, plan, tick);
+			
+			if(action == AI_STATE_ACTION_BOMB && ai_state_get_legal(&simulation, player_index, action) == 1)
+			{
+				ai_openings_region_add_blast(plan, player->position_x, player->position_y, player->explosion_radius, tick);
+			}
+			
+			ai_state_apply(&simulation, player_index, action);
+		}
+	}
+	
+	core_debug("Opening at (%i, %i): %i steps", plan->spawn_x, plan->spawn_y, plan->steps_amount);
+}
+
+/**
+ * This function precomputes the openings of all spawn corners of the current
+ * field.
+ * 
+ * @param context The context of the match.
+ */
+void ai_openings_compute_all(game_context_t *context)
+{
+	int i = 0;
+	ai_state_t state;
+	
+	context->openings->plans_amount = 0;
+	if(ai_openings_get_supported(context) == 0)
+	{
+		core_error("Openings are only supported on a %ix%i field.", AI_STATE_WIDTH, AI_STATE_HEIGHT);
+		return;
+	}
+	
+	ai_state_capture(context, &state, 0, AI_STATE_WIDTH / 2, AI_STATE_HEIGHT / 2);
+	
+	for(i = 0; i < state.players_amount && i < AI_STATE_PLAYERS_MAX; i++)
+	{
+		ai_openings_compute(context, &state, i, &(context->openings->plans[context->openings->plans_amount]));
+		context->openings->plans_amount++;
+	}
+	
+	context->openings->loaded = 1;
+}
+
+/**
+ * This function writes the openings into the cache file of the current field
+ * size.
+ * 
+ * @param context The context of the match.
+ * @return 0 on success, -1 on failure.
+ */
+int ai_openings_save(game_context_t *context)
+{
+	char path[80];
+	FILE *file = NULL;
+	ai_openings_header_t header;
+	
+	ai_openings_get_path(context, path, sizeof(path));
+	
+	core_debug("Writing openings: %s", path);
+	
+	file = fopen(path, "wb");
+	if(file == NULL)
+	{
+		core_error("Failed to open openings: %s", path);
+		return -1;
+	}
+	
+	header.magic = AI_OPENINGS_MAGIC;
+	header.version = AI_OPENINGS_VERSION;
+	header.field_width = GAMEPLAY_FIELD_WIDTH(context);
+	header.field_height = GAMEPLAY_FIELD_HEIGHT(context);
+	header.plans_amount = context->openings->plans_amount;
+	
+	if(fwrite(&header, sizeof(ai_openings_header_t), 1, file) != 1 || fwrite(context->openings->plans, sizeof(ai_openings_plan_t), context->openings->plans_amount, file) != (size_t)context->openings->plans_amount)
+	{
+		core_error("Failed to write openings: %s", path);
+		fclose(file);
+		return -1;
+	}
+	
+	fclose(file);
+	
+	return 0;
+}
+
+/**
+ * This function reads the openings from the cache file of the current field
+ * size. A missing or outdated cache file leaves the AI without openings.
+ * 
+ * @param context The context of the match.
+ * @return 0 on success, -1 on failure.
+ */
+int ai_openings_load(game_context_t *context)
+{
+	char path[80];
+	FILE *file = NULL;
+	ai_openings_header_t header;
+	
+	ai_openings_get_path(context, path, sizeof(path));
+	
+	context->openings->loaded = 1;
+	context->openings->plans_amount = 0;
+	
+	core_debug("Reading openings: %s", path);
+	
+	file = fopen(path, "rb");
+	if(file == NULL)
+	{
+		core_debug("No openings found: %s", path);
+		return -1;
+	}
+	
+	if(fread(&header, sizeof(ai_openings_header_t), 1, file) != 1 || header.magic != AI_OPENINGS_MAGIC || header.version != AI_OPENINGS_VERSION || header.field_width != GAMEPLAY_FIELD_WIDTH(context) || header.field_height != GAMEPLAY_FIELD_HEIGHT(context) || header.plans_amount < 0 || header.plans_amount > AI_STATE_PLAYERS_MAX)
+	{
+		core_error("Invalid openings: %s", path);
+		fclose(file);
+		return -1;
+	}
+	
+	if(fread(context->openings->plans, sizeof(ai_openings_plan_t), header.plans_amount, file) != (size_t)header.plans_amount)
+	{
+		core_error("Failed to read openings: %s", path);
+		fclose(file);
+		return -1;
+	}
+	
+	fclose(file);
+	
+	context->openings->plans_amount = header.plans_amount;
+	
+	return 0;
+}
+
+/**
+ * This function assigns the openings to the AI players by their spawn corner.
+ * The cache file is only read at the first game of a context.
+ * 
+ * @param context The context of the match.
+ * @return 0 on success, -1 if the openings could not be allocated.
+ */
+int ai_openings_start(game_context_t *context)
+{
+	int i = 0;
+	int j = 0;
+	gameplay_players_player_t *player = NULL;
+	
+	if(context->openings == NULL)
+	{
+		context->openings = calloc(1, sizeof(ai_openings_context_t));
+		if(context->openings == NULL)
+		{
+			return -1;
+		}
+	}
+	
+	for(i = 0; i < AI_STATE_PLAYERS_MAX; i++)
+	{
+		context->openings->active[i] = -1;
+		context->openings->step[i] = 0;
+	}
+	
+	if(ai_openings_get_supported(context) == 0)
+	{
+		return 0;
+	}
+	
+	if(context->openings->loaded == 0)
+	{
+		ai_openings_load(context);
+	}
+	
+	for(i = 0; i < gameplay_players_amount(context); i++)
+	{
+		player = gameplay_players_get(context, i);
+		if(player == NULL || player->type != GAMEPLAY_PLAYERS_TYPE_AI || player->id < 0 || player->id >= AI_STATE_PLAYERS_MAX)
+		{
+			continue;
+		}
+		
+		for(j = 0; j < context->openings->plans_amount; j++)
+		{
+			if(context->openings->plans[j].spawn_x == player->position_x && context->openings->plans[j].spawn_y == player->position_y && context->openings->plans[j].steps_amount > 0)
+			{
+				context->openings->active[player->id] = j;
+			}
+		}
+	}
+	
+	return 0;
+}
+
+/**
+ * This function frees the openings.
+ * 
+ * @param context The context of the match.
+ */
+void ai_openings_release(game_context_t *context)
+{
+	free(context->openings);
+	context->openings = NULL;
+}
+
+/**
+ * This function returns the next action of the opening of an AI player. The
+ * opening is dropped as soon as the player or the region of the opening
+ * differs from the precomputed state, the live AI takes over from then on.
+ * 
+ * @param context The context of the match.
+ * @param player The AI player.
+ * @param action The action which should be executed.
+ * @return 1 if the opening is still valid, 0 otherwise.
+ */
+int ai_openings_next(game_context_t *context, gameplay_players_player_t *player, ai_state_action_t *action)
+{
+	int player_index = 0;
+	ai_openings_plan_t *plan = NULL;
+	ai_openings_step_t *step = NULL;
+	ai_state_t state;
+	
+	if(player->id < 0 || player->id >= AI_STATE_PLAYERS_MAX || context->openings->active[player->id] == -1)
+	{
+		return 0;
+	}
+	
+	plan = &(context->openings->plans[context->openings->active[player->id]]);
+	step = &(plan->steps[context->openings->step[player->id]]);
+	
+	ai_state_capture(context, &state, 0, AI_STATE_WIDTH / 2, AI_STATE_HEIGHT / 2);
+	player_index = ai_state_find_player(&state, player->id);
+	
+	if(player_index == -1 || player->position_x != step->position_x || player->position_y != step->position_y || ai_openings_signature(&state, player_index, plan, step->tick) != step->signature)
+	{
+		core_debug("Opening of player %i left at step %i", player->id, context->openings->step[player->id]);
+		context->openings->active[player->id] = -1;
+		return 0;
+	}
+	
+	*action = step->action;
+	
+	context->openings->step[player->id]++;
+	if(context->openings->step[player->id] >= plan->steps_amount)
+	{
+		context->openings->active[player->id] = -1;
+	}
+	
+	return 1;
+}
+
+/**
+ * This function writes the progress of the replayed openings into the
+ * players of a snapshot. The players must be written before.
+ * 
+ * @param context The context of the match.
+ * @param snapshot The snapshot.
+ */
+void ai_openings_capture(game_context_t *context, gameplay_snapshot_t *snapshot)
+{
+	int i = 0;
+	gameplay_snapshot_player_t *records = NULL;
+	
+	records = GAMEPLAY_SNAPSHOT_SECTION(snapshot, gameplay_snapshot_player_t, players);
+	for(i = 0; i < snapshot->players_amount; i++)
+	{
+		if(records[i].id >= 0 && records[i].id < AI_STATE_PLAYERS_MAX)
+		{
+			records[i].opening = context->openings->active[records[i].id];
+			records[i].opening_step = context->openings->step[records[i].id];
+		}
+	}
+}
+
+/**
+ * This function replaces the progress of the replayed openings by the one of
+ * the players of a snapshot.
+ * 
+ * @param context The context of the match.
+ * @param snapshot The snapshot.
+ */
+void ai_openings_restore(game_context_t *context, const gameplay_snapshot_t *snapshot)
+{
+	int i = 0;
+	const gameplay_snapshot_player_t *records = NULL;
+	
+	for(i = 0; i < AI_STATE_PLAYERS_MAX; i++)
+	{
+		context->openings->active[i] = -1;
+		context->openings->step[i] = 0;
+	}
+	
+	records = GAMEPLAY_SNAPSHOT_SECTION(snapshot, gameplay_snapshot_player_t, players);
+	for(i = 0; i < snapshot->players_amount; i++)
+	{
+		if(records[i].id >= 0 && records[i].id < AI_STATE_PLAYERS_MAX && records[i].opening >= 0 && records[i].opening < context->openings->plans_amount && records[i].opening_step < context->openings->plans[records[i].opening].steps_amount)
+		{
+			context->openings->active[records[i].id] = records[i].opening;
+			context->openings->step[records[i].id] = records[i].opening_step;
+		}
+	}
+}
@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) 2015 NIPE-SYSTEMS
+ * Copyright (C) 2015 Jonas Krug
+ * Copyright (C) 2015 Tim Gevers
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __AI_OPENINGS_H__
+#define __AI_OPENINGS_H__
+
+#include "ai-state.h"
+#include "gameplay-players.h"
+#include "gameplay-bombs.h"
+
+#ifndef AI_OPENINGS_PATH
+#define AI_OPENINGS_PATH "assets/openings-%ix%i.cache"
+#endif /* AI_OPENINGS_PATH */
+
+#define AI_OPENINGS_MAGIC 0x504f4254
+#define AI_OPENINGS_VERSION 1
+#define AI_OPENINGS_TICKS 400
+#define AI_OPENINGS_STEPS_MAX 256
+
+// tiles are part of the region from one bomb lifetime before until one bomb
+// lifetime after they are touched by the plan
+#define AI_OPENINGS_WINDOW (GAMEPLAY_BOMBS_EXPLOSION_TIMEOUT + GAMEPLAY_FIRE_DESPAWN + 1)
+
+typedef struct ai_openings_step_s
+{
+	unsigned short tick;
+	unsigned char action;
+	unsigned char position_x;
+	unsigned char position_y;
+	unsigned long long signature;
+} ai_openings_step_t;
+
+/**
+ * A precomputed opening of a player at a spawn corner. The region contains all
+ * tiles which the opening depends on: The tiles the player walks over and the
+ * blast tiles of its bombs, each with the first and last tick it is touched.
+ * Every step stores the signature of the tiles of the region which are near in
+ * time, so the plan is only replayed as long as the field around the player is
+ * exactly as expected.
+ */
+typedef struct ai_openings_plan_s
+{
+	unsigned char spawn_x;
+	unsigned char spawn_y;
+	int steps_amount;
+	unsigned short region_first[AI_STATE_TILES];
+	unsigned short region_last[AI_STATE_TILES];
+	ai_openings_step_t steps[AI_OPENINGS_STEPS_MAX];
+} ai_openings_plan_t;
+
+typedef struct ai_openings_header_s
+{
+	unsigned int magic;
+	int version;
+	int field_width;
+	int field_height;
+	int plans_amount;
+} ai_openings_header_t;
+
+void ai_openings_compute(game_context_t *context, ai_state_t *state, int player_index, ai_openings_plan_t *plan);
+void ai_openings_compute_all(game_context_t *context);
+int ai_openings_save(game_context_t *context);
+int ai_openings_load(game_context_t *context);
+int ai_openings_start(game_context_t *context);
+void ai_openings_release(game_context_t *context);
+int ai_openings_next(game_context_t *context, gameplay_players_player_t *player, ai_state_action_t *action);
+void ai_openings_capture(game_context_t *context, gameplay_snapshot_t *snapshot);
+void ai_openings_restore(game_context_t *context, const gameplay_snapshot_t *snapshot);
+
+#endif /* __AI_OPENINGS_H__ */
@@ -21,46 +21,150 @@
 #include <stdlib.h>
 
 #include "ai-pathfinding.h"
+#include "ai-simulation.h"
+#include "ai-state.h"
 #include "gameplay.h"
-#include "core.h"
+#include "core-log.h"
 
-static void ai_pathfinding_reset(void);
-static void ai_pathfinding_expand_numbers(int x, int y, int number, int ignore_simulated);
-static int ai_pathfinding_fill_numbers(int start_x, int start_y, int end_x, int end_y, int ignore_simulated);
-static int ai_pathfinding_link_tile(int x, int y, int number);
+static void ai_pathfinding_reset(game_context_t *context);
+static void ai_pathfinding_expand_numbers(game_context_t *context, int x, int y, int number, int ignore_simulated);
+static int ai_pathfinding_fill_numbers(game_context_t *context, int start_x, int start_y, int end_x, int end_y, int ignore_simulated);
+static int ai_pathfinding_link_tile(game_context_t *context, int x, int y, int number);
+
+struct ai_pathfinding_context_s
+{
+	// the flooded numbers of the tiles and the tile index of the next tile
+	// of the path (-1 if the tile is not part of the path)
+	int *numbers;
+	int *next;
+	
+	// the tiles in the order they were numbered (the wavefront), a reset
+	// only visits these tiles
+	int *queue;
+	int queue_amount;
+	
+	// the upper left corner of the window in which paths are searched
+	int window_x;
+	int window_y;
+};
 
 /**
- * This function resets all pathfinding properties of all tiles in the field.
+ * This function allocates the pathfinding properties for the size of the
+ * field.
+ * 
+ * @param context The context of the match.
+ * @return 0 on success, -1 on error.
  */
-static void ai_pathfinding_reset(void)
+int ai_pathfinding_init(game_context_t *context)
 {
-	int x = 0;
-	int y = 0;
-	gameplay_field_t *field = NULL;
+	int i = 0;
 	
-	field = gameplay_get_field();
+	if(context->pathfinding == NULL)
+	{
+		context->pathfinding = calloc(1, sizeof(ai_pathfinding_context_t));
+		if(context->pathfinding == NULL)
+		{
+			return -1;
+		}
+	}
+	
+	context->pathfinding->numbers = gameplay_allocate_tiles(context, context->pathfinding->numbers, sizeof(int));
+	context->pathfinding->next = gameplay_allocate_tiles(context, context->pathfinding->next, sizeof(int));
+	context->pathfinding->queue = gameplay_allocate_tiles(context, context->pathfinding->queue, sizeof(int));
+	if(context->pathfinding->numbers == NULL || context->pathfinding->next == NULL || context->pathfinding->queue == NULL)
+	{
+		return -1;
+	}
 	
-	if(field == NULL)
+	for(i = 0; i < GAMEPLAY_FIELD_TILES(context); i++)
+	{
+		context->pathfinding->numbers[i] = -1;
+		context->pathfinding->next[i] = -1;
+	}
+	
+	context->pathfinding->queue_amount = 0;
+	context->pathfinding->window_x = 0;
+	context->pathfinding->window_y = 0;
+	
+	return 0;
+}
+
+/**
+ * This function releases the memory of the pathfinding properties.
+ * 
+ * @param context The context of the match.
+ */
+void ai_pathfinding_release(game_context_t *context)
+{
+	if(context->pathfinding == NULL)
 	{
 		return;
 	}
 	
+	free(context->pathfinding->numbers);
+	free(context->pathfinding->next);
+	free(context->pathfinding->queue);
+	free(context->pathfinding);
+	context->pathfinding = NULL;
+}
+
+/**
+ * This function sets the window in which paths are searched. Tiles outside of
+ * the window are unobtainable, so the costs of a search do not depend on the
+ * size of the field.
+ * 
+ * @param context The context of the match.
+ * @param position_x The x coordinate of the upper left corner.
+ * @param position_y The y coordinate of the upper left corner.
+ */
+void ai_pathfinding_set_window(game_context_t *context, int position_x, int position_y)
+{
+	context->pathfinding->window_x = position_x;
+	context->pathfinding->window_y = position_y;
+}
+
+/**
+ * This function returns the window in which paths are searched.
+ * 
+ * @param context The context of the match.
+ * @param position_x The x coordinate of the upper left corner (write by
+ *                   pointer).
+ * @param position_y The y coordinate of the upper left corner (write by
+ *                   pointer).
+ */
+void ai_pathfinding_get_window(game_context_t *context, int *position_x, int *position_y)
+{
+	*position_x = context->pathfinding->window_x;
+	*position_y = context->pathfinding->window_y;
+}
+
+/**
+ * This function resets all pathfinding properties of the tiles which were
+ * numbered by the last search.
+ * 
+ * @param context The context of the match.
+ */
+static void ai_pathfinding_reset(game_context_t *context)
+{
+	int i = 0;
+	
 	// core_debug("Pathfinding: Resetting field");
 	
-	for(y = 0; y < GAMEPLAY_FIELD_HEIGHT; y++)
+	for(i = 0; i < context->pathfinding->queue_amount; i++)
 	{
-		for(x = 0; x < GAMEPLAY_FIELD_WIDTH; x++)
-		{
-			GAMEPLAY_FIELD(field, x, y).ai_pathfinding_next = NULL;
-			GAMEPLAY_FIELD(field, x, y).ai_pathfinding_number = -1;
-		}
+		context->pathfinding->next[context->pathfinding->queue[i]] = -1;
+		context->pathfinding->numbers[context->pathfinding->queue[i]] = -1;
 	}
+	
+	context->pathfinding->queue_amount = 0;
 }
 
 /**
  * This function tries to expand numbers to neighbor tiles. It respects if it
- * should expand numbers to blocked tiles from the simulation.
+ * should expand numbers to blocked tiles from the simulation. Numbered tiles
+ * are appended to the wavefront.
  * 
+ * @param context The context of the match.
  * @param x The x coordinate of a tile.
  * @param y The y coordinate of a tile.
  * @param number The number which should be set to obtainable tiles.
@@ -71,47 +175,40 @@ static void ai_pathfinding_reset(void)
  *                         2 means that all simulated tiles are ignored (are
  *                         obtainable).
  */
-static void ai_pathfinding_expand_numbers(int x, int y, int number, int ignore_simulated)
+static void ai_pathfinding_expand_numbers(game_context_t *context, int x, int y, int number, int ignore_simulated)
 {
-	gameplay_field_t *field = NULL;
-	
-	field = gameplay_get_field();
-	
-	if(field == NULL)
-	{
-		return;
-	}
-	
-	// try north
-	if(y > 0 && GAMEPLAY_FIELD(field, x, y - 1).ai_pathfinding_number == -1 && gameplay_get_walkable(x, y - 1, 0) == 1 && (ignore_simulated > 1 || (ignore_simulated < 2 && GAMEPLAY_FIELD(field, x, y - 1).ai_simulation_walkable == 1)) && (ignore_simulated > 0 || (ignore_simulated == 0 && GAMEPLAY_FIELD(field, x, y - 1).ai_simulation_walkable_simulated == 1)))
+	int i = 0;
+	int next_x = 0;
+	int next_y = 0;
+	int direction_x[] = { 0, 1, 0, -1 };
+	int direction_y[] = { -1, 0, 1, 0 };
+	
+	// try north, east, south and west
+	for(i = 0; i < 4; i++)
 	{
-		GAMEPLAY_FIELD(field, x, y - 1).ai_pathfinding_number = number;
-	}
-	
-	// try east
-	if(x < GAMEPLAY_FIELD_WIDTH - 1 && GAMEPLAY_FIELD(field, x + 1, y).ai_pathfinding_number == -1 && gameplay_get_walkable(x + 1, y, 0) == 1 && (ignore_simulated > 1 || (ignore_simulated < 2 && GAMEPLAY_FIELD(field, x + 1, y).ai_simulation_walkable == 1)) && (ignore_simulated > 0 || (ignore_simulated == 0 && GAMEPLAY_FIELD(field, x + 1, y).ai_simulation_walkable_simulated == 1)))
-	{
-		GAMEPLAY_FIELD(field, x + 1, y).ai_pathfinding_number = number;
-	}
-	
-	// try south
-	if(y < GAMEPLAY_FIELD_HEIGHT - 1 && GAMEPLAY_FIELD(field, x, y + 1).ai_pathfinding_number == -1 && gameplay_get_walkable(x, y + 1, 0) == 1 && (ignore_simulated > 1 || (ignore_simulated < 2 && GAMEPLAY_FIELD(field, x, y + 1).ai_simulation_walkable == 1)) && (ignore_simulated > 0 || (ignore_simulated == 0 && GAMEPLAY_FIELD(field, x, y + 1).ai_simulation_walkable_simulated == 1)))
-	{
-		GAMEPLAY_FIELD(field, x, y + 1).ai_pathfinding_number = number;
-	}
-	
-	// try west
-	if(x > 0 && GAMEPLAY_FIELD(field, x - 1, y).ai_pathfinding_number == -1 && gameplay_get_walkable(x - 1, y, 0) == 1 && (ignore_simulated > 1 || (ignore_simulated < 2 && GAMEPLAY_FIELD(field, x - 1, y).ai_simulation_walkable == 1)) && (ignore_simulated > 0 || (ignore_simulated == 0 && GAMEPLAY_FIELD(field, x - 1, y).ai_simulation_walkable_simulated == 1)))
-	{
-		GAMEPLAY_FIELD(field, x - 1, y).ai_pathfinding_number = number;
+		next_x = x + direction_x[i];
+		next_y = y + direction_y[i];
+		
+		if(next_x < context->pathfinding->window_x || next_y < context->pathfinding->window_y || next_x >= context->pathfinding->window_x + AI_STATE_WIDTH || next_y >= context->pathfinding->window_y + AI_STATE_HEIGHT)
+		{
+			continue;
+		}
+		
+		if(GAMEPLAY_FIELD(context, context->pathfinding->numbers, next_x, next_y) == -1 && gameplay_get_walkable(context, next_x, next_y, 0) == 1 && (ignore_simulated > 1 || (ignore_simulated < 2 && ai_simulation_get_walkable(context, next_x, next_y) == 1)) && (ignore_simulated > 0 || (ignore_simulated == 0 && ai_simulation_get_walkable_simulated(context, next_x, next_y) == 1)))
+		{
+			GAMEPLAY_FIELD(context, context->pathfinding->numbers, next_x, next_y) = number;
+			context->pathfinding->queue[context->pathfinding->queue_amount++] = next_y * GAMEPLAY_FIELD_WIDTH(context) + next_x;
+		}
 	}
 }
 
 /**
  * This function fills the field with pathfinding numbers for the wavefront/
  * floodfill algorithm. It fills the numbers from a given start position to
- * a given target/end position.
+ * a given target/end position. The wavefront is processed as a queue, so
+ * every reached tile is visited once.
  * 
+ * @param context The context of the match.
  * @param start_x The x coordinate of the start position.
  * @param start_y The y coordinate of the start position.
  * @param end_x The x coordinate of the end position.
@@ -124,62 +221,34 @@ static void ai_pathfinding_expand_numbers(int x, int y, int number, int ignore_s
  *                         obtainable).
  * @return 0 on succes, -1 on error.
  */
-static int ai_pathfinding_fill_numbers(int start_x, int start_y, int end_x, int end_y, int ignore_simulated)
+static int ai_pathfinding_fill_numbers(game_context_t *context, int start_x, int start_y, int end_x, int end_y, int ignore_simulated)
 {
-	int number = 0;
-	int exit = 0;
-	int x = 0;
-	int y = 0;
-	int count = 0;
-	gameplay_field_t *field = NULL;
-	
-	field = gameplay_get_field();
-	
-	if(field == NULL)
-	{
-		return -1;
-	}
+	int current = 0;
+	int index = 0;
+	int end = 0;
 	
 	// core_debug("Pathfinding: Filling numbers (%i, %i) -> (%i, %i)", start_x, start_y, end_x, end_y);
 	
-	GAMEPLAY_FIELD(field, start_x, start_y).ai_pathfinding_number = 0;
+	end = end_y * GAMEPLAY_FIELD_WIDTH(context) + end_x;
 	
-	while(exit == 0)
+	GAMEPLAY_FIELD(context, context->pathfinding->numbers, start_x, start_y) = 0;
+	context->pathfinding->queue[context->pathfinding->queue_amount++] = start_y * GAMEPLAY_FIELD_WIDTH(context) + start_x;
+	
+	for(current = 0; current < context->pathfinding->queue_amount; current++)
 	{
-		count = 0;
-		
-		for(y = 0; exit == 0 && y < GAMEPLAY_FIELD_WIDTH; y++)
+		index = context->pathfinding->queue[current];
+		if(index == end)
 		{
-			for(x = 0; exit == 0 && x < GAMEPLAY_FIELD_HEIGHT; x++)
-			{
-				if(GAMEPLAY_FIELD(field, x, y).ai_pathfinding_number == number)
-				{
-					count++;
-					
-					if(x == end_x && y == end_y)
-					{
-						exit = 1;
-					}
-					else
-					{
-						ai_pathfinding_expand_numbers(x, y, number + 1, ignore_simulated);
-					}
-				}
-			}
+			return 0;
 		}
 		
-		// when no more tiles can be filled with numbers return error
-		if(count == 0)
-		{
-			// core_error("Pathfinding: Impossible to reach target!");
-			exit = 1;
-			return -1;
-		}
-		
-		number++;
+		ai_pathfinding_expand_numbers(context, index % GAMEPLAY_FIELD_WIDTH(context), index / GAMEPLAY_FIELD_WIDTH(context), context->pathfinding->numbers[index] + 1, ignore_simulated);
 	}
 	
-	return 0;
+	// when no more tiles can be filled with numbers return error
+	// core_error("Pathfinding: Impossible to reach target!");
+	
+	return -1;
 }
 
 /**
@@ -187,50 +256,42 @@ static int ai_pathfinding_fill_numbers(int start_x, int start_y, int end_x, int
  * field by backtracking the flooded numbers. This function works with
  * recursion.
  * 
+ * @param context The context of the match.
  * @param x The x coordinate of the processed tile.
  * @param y The y coordinate of the processed tile.
  * @param number The number which should be searched.
  * @return The length of the calculated subpath.
  */
-static int ai_pathfinding_link_tile(int x, int y, int number)
+static int ai_pathfinding_link_tile(game_context_t *context, int x, int y, int number)
 {
-	gameplay_field_t *field = NULL;
-	
-	field = gameplay_get_field();
-	
-	if(field == NULL)
-	{
-		return -1;
-	}
-	
 	if(number == -1)
 	{
 		return 0;
 	}
 	
 	// try north
-	if(y > 0 && GAMEPLAY_FIELD(field, x, y - 1).ai_pathfinding_number == number)
+	if(y > 0 && GAMEPLAY_FIELD(context, context->pathfinding->numbers, x, y - 1) == number)
 	{
-		GAMEPLAY_FIELD(field, x, y - 1).ai_pathfinding_next = &GAMEPLAY_FIELD(field, x, y);
-		return ai_pathfinding_link_tile(x, y - 1, number - 1) + 1;
+		GAMEPLAY_FIELD(context, context->pathfinding->next, x, y - 1) = y * GAMEPLAY_FIELD_WIDTH(context) + x;
+		return ai_pathfinding_link_tile(context, x, y - 1, number - 1) + 1;
 	}
 	// try east
-	else if(x < GAMEPLAY_FIELD_WIDTH - 1 && GAMEPLAY_FIELD(field, x + 1, y).ai_pathfinding_number == number)
+	else if(x < GAMEPLAY_FIELD_WIDTH(context) - 1 && GAMEPLAY_FIELD(context, context->pathfinding->numbers, x + 1, y) == number)
 	{
-		GAMEPLAY_FIELD(field, x + 1, y).ai_pathfinding_next = &GAMEPLAY_FIELD(field, x, y);
-		return ai_pathfinding_link_tile(x + 1, y, number - 1) + 1;
+		GAMEPLAY_FIELD(context, context->pathfinding->next, x + 1, y) = y * GAMEPLAY_FIELD_WIDTH(context) + x;
+		return ai_pathfinding_link_tile(context, x + 1, y, number - 1) + 1;
 	}
 	// try south
-	else if(y < GAMEPLAY_FIELD_HEIGHT - 1 && GAMEPLAY_FIELD(field, x, y + 1).ai_pathfinding_number == number)
+	else if(y < GAMEPLAY_FIELD_HEIGHT(context) - 1 && GAMEPLAY_FIELD(context, context->pathfinding->numbers, x, y + 1) == number)
 	{
-		GAMEPLAY_FIELD(field, x, y + 1).ai_pathfinding_next = &GAMEPLAY_FIELD(field, x, y);
-		return ai_pathfinding_link_tile(x, y + 1, number - 1) + 1;
+		GAMEPLAY_FIELD(context, context->pathfinding->next, x, y + 1) = y * GAMEPLAY_FIELD_WIDTH(context) + x;
+		return ai_pathfinding_link_tile(context, x, y + 1, number - 1) + 1;
 	}
 	// try west
-	else if(x > 0 && GAMEPLAY_FIELD(field, x - 1, y).ai_pathfinding_number == number)
+	else if(x > 0 && GAMEPLAY_FIELD(context, context->pathfinding->numbers, x - 1, y) == number)
 	{
-		GAMEPLAY_FIELD(field, x - 1, y).ai_pathfinding_next = &GAMEPLAY_FIELD(field, x, y);
-		return ai_pathfinding_link_tile(x - 1, y, number - 1) + 1;
+		GAMEPLAY_FIELD(context, context->pathfinding->next, x - 1, y) = y * GAMEPLAY_FIELD_WIDTH(context) + x;
+		return ai_pathfinding_link_tile(context, x - 1, y, number - 1) + 1;
 	}
 	
 	return 0;
@@ -240,6 +301,7 @@ static int ai_pathfinding_link_tile(int x, int y, int number)
  * This function floods all numbers and backtracks the shortest way. It returns
  * the length of the shortest way.
  * 
+ * @param context The context of the match.
  * @param start_x The x coordinate of the start position.
  * @param start_y The y coordinate of the start position.
  * @param end_x The x coordinate of the end position.
@@ -252,36 +314,30 @@ static int ai_pathfinding_link_tile(int x, int y, int number)
  *                         obtainable).
  * @return The length of the calculated path.
  */
-int ai_pathfinding_move_to(int start_x, int start_y, int end_x, int end_y, int ignore_simulated)
+int ai_pathfinding_move_to(game_context_t *context, int start_x, int start_y, int end_x, int end_y, int ignore_simulated)
 {
-	gameplay_field_t *field = NULL;
-	
-	field = gameplay_get_field();
-	
-	if(field == NULL)
-	{
-		return -1;
-	}
+	ai_pathfinding_reset(context);
 	
 	if(start_x == end_x && start_y == end_y)
 	{
-		GAMEPLAY_FIELD(field, start_x, start_y).ai_pathfinding_next = &GAMEPLAY_FIELD(field, start_x, start_y);
+		GAMEPLAY_FIELD(context, context->pathfinding->numbers, start_x, start_y) = 0;
+		GAMEPLAY_FIELD(context, context->pathfinding->next, start_x, start_y) = start_y * GAMEPLAY_FIELD_WIDTH(context) + start_x;
+		context->pathfinding->queue[context->pathfinding->queue_amount++] = start_y * GAMEPLAY_FIELD_WIDTH(context) + start_x;
 		return 0;
 	}
 	
-	ai_pathfinding_reset();
-	
-	if(ai_pathfinding_fill_numbers(start_x, start_y, end_x, end_y, ignore_simulated) < 0)
+	if(ai_pathfinding_fill_numbers(context, start_x, start_y, end_x, end_y, ignore_simulated) < 0)
 	{
 		return -1;
 	}
 	
-	return ai_pathfinding_link_tile(end_x, end_y, GAMEPLAY_FIELD(field, end_x, end_y).ai_pathfinding_number - 1);
+	return ai_pathfinding_link_tile(context, end_x, end_y, GAMEPLAY_FIELD(context, context->pathfinding->numbers, end_x, end_y) - 1);
 }
 
 /**
  * This function calculates the length of a path through the field.
  * 
+ * @param context The context of the match.
  * @param start_x The x coordinate of the start position.
  * @param start_y The y coordinate of the start position.
  * @param end_x The x coordinate of the end position.
@@ -294,14 +350,15 @@ int ai_pathfinding_move_to(int start_x, int start_y, int end_x, int end_y, int i
  *                         obtainable).
  * @return The length of the calculated path.
  */
-int ai_pathfinding_move_to_length(int start_x, int start_y, int end_x, int end_y, int ignore_simulated)
+int ai_pathfinding_move_to_length(game_context_t *context, int start_x, int start_y, int end_x, int end_y, int ignore_simulated)
 {
-	return ai_pathfinding_move_to(start_x, start_y, end_x, end_y, ignore_simulated);
+	return ai_pathfinding_move_to(context, start_x, start_y, end_x, end_y, ignore_simulated);
 }
 
 /**
  * This function calculates the next element of a path.
  * 
+ * @param context The context of the match.
  * @param start_x The x coordinate of the start position.
  * @param start_y The y coordinate of the start position.
  * @param end_x The x coordinate of the end position.
@@ -316,31 +373,25 @@ int ai_pathfinding_move_to_length(int start_x, int start_y, int end_x, int end_y
  *                         obtainable).
  * @return The length of the calculated path.
  */
-int ai_pathfinding_move_to_next(int start_x, int start_y, int end_x, int end_y, int *next_x, int *next_y, int ignore_simulated)
+int ai_pathfinding_move_to_next(game_context_t *context, int start_x, int start_y, int end_x, int end_y, int *next_x, int *next_y, int ignore_simulated)
 {
 	int return_length = 0;
-	gameplay_field_t *field = NULL;
-	
-	field = gameplay_get_field();
-	
-	if(field == NULL)
-	{
-		return -1;
-	}
+	int next = 0;
 	
-	return_length = ai_pathfinding_move_to(start_x, start_y, end_x, end_y, ignore_simulated);
+	return_length = ai_pathfinding_move_to(context, start_x, start_y, end_x, end_y, ignore_simulated);
 	if(return_length < 0)
 	{
 		return -1;
 	}
 	
-	if(GAMEPLAY_FIELD(field, start_x, start_y).ai_pathfinding_next == NULL)
+	next = GAMEPLAY_FIELD(context, context->pathfinding->next, start_x, start_y);
+	if(next == -1)
 	{
 		return -1;
 	}
 	
-	*next_x = GAMEPLAY_FIELD(field, start_x, start_y).ai_pathfinding_next->ai_position_x;
-	*next_y = GAMEPLAY_FIELD(field, start_x, start_y).ai_pathfinding_next->ai_position_y;
+	*next_x = next % GAMEPLAY_FIELD_WIDTH(context);
+	*next_y = next / GAMEPLAY_FIELD_WIDTH(context);
 	
 	return return_length;
 }
@@ -22,8 +22,12 @@
 
 #include "gameplay.h"
 
-int ai_pathfinding_move_to(int start_x, int start_y, int end_x, int end_y, int ignore_simulated);
-int ai_pathfinding_move_to_length(int start_x, int start_y, int end_x, int end_y, int ignore_simulated);
-int ai_pathfinding_move_to_next(int start_x, int start_y, int end_x, int end_y, int *next_x, int *next_y, int ignore_simulated);
+int ai_pathfinding_init(game_context_t *context);
+void ai_pathfinding_release(game_context_t *context);
+void ai_pathfinding_set_window(game_context_t *context, int position_x, int position_y);
+void ai_pathfinding_get_window(game_context_t *context, int *position_x, int *position_y);
+int ai_pathfinding_move_to(game_context_t *context, int start_x, int start_y, int end_x, int end_y, int ignore_simulated);
+int ai_pathfinding_move_to_length(game_context_t *context, int start_x, int start_y, int end_x, int end_y, int ignore_simulated);
+int ai_pathfinding_move_to_next(game_context_t *context, int start_x, int start_y, int end_x, int end_y, int *next_x, int *next_y, int ignore_simulated);
 
 #endif /* __AI_PATHFINDING_H__ */
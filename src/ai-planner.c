@@ -0,0 +1,437 @@
+/*
+ * Copyright (C) 2015 NIPE-SYSTEMS
+ * Copyright (C) 2015 Jonas Krug
+ * Copyright (C) 2015 Tim Gevers
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "ai-planner.h"
+#include "ai-state.h"
+#include "gameplay.h"
+#include "gameplay-bombs.h"
+#include "core-log.h"
+
+static void ai_planner_danger_mark(ai_planner_danger_t *danger, int *tiles, int amount, int explosion_tick);
+
+/**
+ * This function marks tiles as burning from the explosion tick until the fire
+ * despawns.
+ * 
+ * @param danger The danger map.
+ * @param tiles The tile indices which are hit by the explosion.
+ * @param amount The amount of tiles.
+ * @param explosion_tick The tick of the explosion (relative to the state).
+ */
+static void ai_planner_danger_mark(ai_planner_danger_t *danger, int *tiles, int amount, int explosion_tick)
+{
+	int i = 0;
+	
+	for(i = 0; i < amount; i++)
+	{
+		if(danger->start[tiles[i]] > explosion_tick)
+		{
+			danger->start[tiles[i]] = explosion_tick;
+		}
+		
+		if(danger->end[tiles[i]] < explosion_tick + GAMEPLAY_FIRE_DESPAWN)
+		{
+			danger->end[tiles[i]] = explosion_tick + GAMEPLAY_FIRE_DESPAWN;
+		}
+	}
+}
+
+/**
+ * This function calculates the danger map of a state. Every tile gets the
+ * interval of ticks in which it burns. Chain reactions of bombs are respected.
+ * 
+ * @param state The state.
+ * @param danger The danger map which should be filled.
+ */
+void ai_planner_danger(ai_state_t *state, ai_planner_danger_t *danger)
+{
+	int i = 0;
+	int j = 0;
+	int amount = 0;
+	int other = 0;
+	char changed = 1;
+	int tiles[AI_STATE_BLAST_MAX];
+	short explosion_tick[AI_STATE_BOMBS_MAX];
+	
+	for(i = 0; i < AI_STATE_TILES; i++)
+	{
+		danger->start[i] = AI_PLANNER_SAFE;
+		danger->end[i] = -1;
+		
+		if(state->fire[i] > 0)
+		{
+			danger->start[i] = 0;
+			danger->end[i] = state->fire[i];
+		}
+	}
+	
+	for(i = 0; i < state->bombs_amount; i++)
+	{
+		explosion_tick[i] = state->bombs[i].explosion_timeout + 1;
+	}
+	
+	// chain reactions: a bomb explodes with the first explosion which hits it
+	while(changed == 1)
+	{
+		changed = 0;
+		
+		for(i = 0; i < state->bombs_amount; i++)
+		{
+			amount = ai_state_bomb_tiles(state, &(state->bombs[i]), tiles);
+			
+			for(j = 0; j < amount; j++)
+			{
+				other = state->bomb[tiles[j]];
+				if(other != AI_STATE_NO_BOMB && explosion_tick[other] > explosion_tick[i])
+				{
+					explosion_tick[other] = explosion_tick[i];
+					changed = 1;
+				}
+			}
+		}
+	}
+	
+	for(i = 0; i < state->bombs_amount; i++)
+	{
+		amount = ai_state_bomb_tiles(state, &(state->bombs[i]), tiles);
+		ai_planner_danger_mark(danger, tiles, amount, explosion_tick[i]);
+	}
+}
+
+/**
+ * This function adds a virtual bomb to a danger map. The bomb explodes earlier
+ * if it is hit by another explosion and it lets hit bombs explode earlier.
+ * 
+ * @param state The state.
+ * @param danger The danger map.
+ * @param position_x The x coordinate of the virtual bomb.
+ * @param position_y The y coordinate of the virtual bomb.
+ * @param explosion_radius The explosion radius of the virtual bomb.
+ * @param explosion_tick The tick in which the virtual bomb explodes.
+ */
+void ai_planner_danger_add_bomb(ai_state_t *state, ai_planner_danger_t *danger, int position_x, int position_y, int explosion_radius, int explosion_tick)
+{
+	int i = 0;
+	int amount = 0;
+	int amount_other = 0;
+	int other = 0;
+	int tiles[AI_STATE_BLAST_MAX];
+	int tiles_other[AI_STATE_BLAST_MAX];
+	
+	if(danger->start[AI_STATE_INDEX(position_x, position_y)] < explosion_tick)
+	{
+		explosion_tick = danger->start[AI_STATE_INDEX(position_x, position_y)];
+	}
+	
+	amount = ai_state_blast_tiles(state, position_x, position_y, explosion_radius, tiles);
+	ai_planner_danger_mark(danger, tiles, amount, explosion_tick);
+	
+	for(i = 0; i < amount; i++)
+	{
+		other = state->bomb[tiles[i]];
+		if(other != AI_STATE_NO_BOMB)
+		{
+			amount_other = ai_state_bomb_tiles(state, &(state->bombs[other]), tiles_other);
+			ai_planner_danger_mark(danger, tiles_other, amount_other, explosion_tick);
+		}
+	}
+}
+
+/**
+ * This function tests if a tile does not burn in a given interval of ticks.
+ * 
+ * @param danger The danger map.
+ * @param index The index of the tile.
+ * @param tick_from The first tick of the interval (relative to the state).
+ * @param tick_to The last tick of the interval (relative to the state).
+ * @return 1 if the tile is safe, 0 if it burns.
+ */
+int ai_planner_danger_get_safe(ai_planner_danger_t *danger, int index, int tick_from, int tick_to)
+{
+	return (tick_to < danger->start[index] || tick_from > danger->end[index]);
+}
+
+/**
+ * This function tests if it is safe to stay on a tile from a given tick on.
+ * 
+ * @param danger The danger map.
+ * @param index The index of the tile.
+ * @param tick The tick (relative to the state) from which the tile is used.
+ * @return 1 if the tile is safe, 0 if it will burn.
+ */
+int ai_planner_danger_get_stay_safe(ai_planner_danger_t *danger, int index, int tick)
+{
+	return (danger->start[index] == AI_PLANNER_SAFE || danger->end[index] < tick);
+}
+
+/**
+ * This function floods the field from a start tile (breadth first). A tile is
+ * only entered if it is walkable and does not burn while the player stands on
+ * it. The tile of the n-th step is entered in tick start_tick + (n - 1) *
+ * period and left one period later. One tick of tolerance is added on both
+ * sides because the decisions may be executed with a delay.
+ * 
+ * @param state The state.
+ * @param danger The danger map or NULL if fire should be ignored.
+ * @param start The index of the start tile.
+ * @param start_tick The tick in which the first step can be made.
+ * @param period The amount of ticks per step.
+ * @param depth The maximum amount of steps.
+ * @param steps The amount of steps to every tile (-1 if unreachable).
+ * @param first The first action of the path to every tile.
+ */
+void ai_planner_reach(ai_state_t *state, ai_planner_danger_t *danger, int start, int start_tick, int period, int depth, short *steps, signed char *first)
+{
+	int queue[AI_STATE_TILES];
+	int queue_start = 0;
+	int queue_end = 0;
+	int current = 0;
+	int next_x = 0;
+	int next_y = 0;
+	int next = 0;
+	int action = 0;
+	
+	for(current = 0; current < AI_STATE_TILES; current++)
+	{
+		steps[current] = -1;
+		first[current] = AI_STATE_ACTION_WAIT;
+	}
+	
+	steps[start] = 0;
+	queue[queue_end++] = start;
+	
+	while(queue_start < queue_end)
+	{
+		current = queue[queue_start++];
+		
+		if(steps[current] >= depth)
+		{
+			continue;
+		}
+		
+		for(action = AI_STATE_ACTION_UP; action <= AI_STATE_ACTION_LEFT; action++)
+		{
+			ai_state_action_target(action, current % AI_STATE_WIDTH, current / AI_STATE_WIDTH, &next_x, &next_y);
+			if(ai_state_get_walkable(state, next_x, next_y) == 0)
+			{
+				continue;
+			}
+			
+			next = AI_STATE_INDEX(next_x, next_y);
+			if(steps[next] != -1)
+			{
+				continue;
+			}
+			
+			if(danger != NULL && ai_planner_danger_get_safe(danger, next, start_tick + steps[current] * period - 1, start_tick + (steps[current] + 1) * period + 1) == 0)
+			{
+				continue;
+			}
+			
+			steps[next] = steps[current] + 1;
+			first[next] = (current == start)?(action):(first[current]);
+			queue[queue_end++] = next;
+		}
+	}
+}
+
+/**
+ * This function collects all bomb spots of an AI player which are reachable
+ * without getting hurt and which leave a reachable hiding place after the bomb
+ * is placed.
+ * 
+ * @param state The state.
+ * @param player_index The index of the AI player in the state.
+ * @param depth The maximum amount of steps of the considered paths.
+ * @param danger The danger map of the state.
+ * @param steps The amount of steps to every tile (see ai_planner_reach()).
+ * @param spots An array with AI_STATE_TILES elements which is filled with the
+ *              bomb spots.
+ * @return The amount of bomb spots.
+ */
+int ai_planner_spots(ai_state_t *state, int player_index, int depth, ai_planner_danger_t *danger, short *steps, ai_planner_spot_t *spots)
+{
+	int i = 0;
+	int j = 0;
+	int period = 0;
+	int arrival = 0;
+	int placement = 0;
+	int amount = 0;
+	int blast_amount = 0;
+	int tiles[AI_STATE_BLAST_MAX];
+	short steps_escape[AI_STATE_TILES];
+	signed char first_escape[AI_STATE_TILES];
+	ai_planner_danger_t danger_bomb;
+	ai_planner_spot_t *spot = NULL;
+	ai_state_player_t *player = NULL;
+	
+	player = &(state->players[player_index]);
+	period = (player->movement_cooldown_initial > 0)?(player->movement_cooldown_initial):(1);
+	
+	for(i = 0; i < AI_STATE_TILES; i++)
+	{
+		if(steps[i] == -1 || ai_planner_danger_get_stay_safe(danger, i, 0) == 0)
+		{
+			continue;
+		}
+		
+		// the bomb is placed as soon as the player can act after the arrival
+		// and the player can move away in the next tick
+		placement = (steps[i] == 0)?(player->movement_cooldown):(player->movement_cooldown + steps[i] * period);
+		
+		danger_bomb = *danger;
+		ai_planner_danger_add_bomb(state, &danger_bomb, i % AI_STATE_WIDTH, i / AI_STATE_WIDTH, player->explosion_radius, placement + GAMEPLAY_BOMBS_EXPLOSION_TIMEOUT + 1);
+		ai_planner_reach(state, &danger_bomb, i, placement + 1, period, depth, steps_escape, first_escape);
+		
+		spot = &(spots[amount]);
+		spot->escape_steps = -1;
+		for(j = 0; j < AI_STATE_TILES; j++)
+		{
+			arrival = placement + 1 + (steps_escape[j] - 1) * period;
+			if(steps_escape[j] > 0 && (spot->escape_steps == -1 || steps_escape[j] < spot->escape_steps) && ai_planner_danger_get_stay_safe(&danger_bomb, j, arrival - 1) == 1)
+			{
+				spot->escape_steps = steps_escape[j];
+			}
+		}
+		
+		// no hiding place
+		if(spot->escape_steps == -1)
+		{
+			continue;
+		}
+		
+		spot->index = i;
+		spot->steps = steps[i];
+		spot->walls = 0;
+		blast_amount = ai_state_blast_tiles(state, i % AI_STATE_WIDTH, i / AI_STATE_WIDTH, player->explosion_radius, tiles);
+		for(j = 0; j < blast_amount; j++)
+		{
+			if(state->type[tiles[j]] == DESTRUCTIVE)
+			{
+				spot->walls++;
+			}
+		}
+		
+		amount++;
+	}
+	
+	return amount;
+}
+
+/**
+ * This function chooses the next action of an AI player on a state. It escapes
+ * from upcoming explosions and otherwise chooses a bomb spot near the user
+ * player which leaves a safe hiding place. The depth limits the length of the
+ * considered paths: A greater depth finds better spots but takes more time.
+ * 
+ * @param state The state.
+ * @param player_index The index of the AI player in the state.
+ * @param depth The maximum amount of steps of the considered paths.
+ * @return The choosed action.
+ */
+ai_state_action_t ai_planner_decide(ai_state_t *state, int player_index, int depth)
+{
+	int i = 0;
+	int start = 0;
+	int user = 0;
+	int period = 0;
+	int amount = 0;
+	int best = -1;
+	float score = 0;
+	float best_score = 0;
+	short steps[AI_STATE_TILES];
+	short steps_user[AI_STATE_TILES];
+	signed char first[AI_STATE_TILES];
+	signed char first_user[AI_STATE_TILES];
+	ai_planner_danger_t danger;
+	ai_planner_spot_t spots[AI_STATE_TILES];
+	ai_state_player_t *player = NULL;
+	
+	player = &(state->players[player_index]);
+	start = AI_STATE_INDEX(player->position_x, player->position_y);
+	period = (player->movement_cooldown_initial > 0)?(player->movement_cooldown_initial):(1);
+	
+	ai_planner_danger(state, &danger);
+	ai_planner_reach(state, &danger, start, player->movement_cooldown, period, depth, steps, first);
+	
+	for(i = 0; i < AI_STATE_TILES; i++)
+	{
+		steps_user[i] = -1;
+	}
+	
+	user = ai_state_find_user(state);
+	if(user != -1)
+	{
+		ai_planner_reach(state, NULL, AI_STATE_INDEX(state->players[user].position_x, state->players[user].position_y), 0, 1, AI_STATE_TILES, steps_user, first_user);
+	}
+	
+	// escape: the current tile will burn, search the nearest safe tile
+	if(ai_planner_danger_get_stay_safe(&danger, start, 0) == 0)
+	{
+		for(i = 0; i < AI_STATE_TILES; i++)
+		{
+			if(steps[i] <= 0 || ai_planner_danger_get_stay_safe(&danger, i, player->movement_cooldown + (steps[i] - 1) * period - 1) == 0)
+			{
+				continue;
+			}
+			
+			score = steps[i] + ((steps_user[i] == -1)?(25):(steps_user[i] * 0.05));
+			if(best == -1 || score < best_score)
+			{
+				best = i;
+				best_score = score;
+			}
+		}
+		
+		return (best == -1)?(AI_STATE_ACTION_WAIT):(first[best]);
+	}
+	
+	if(player->placed_bombs >= player->placeable_bombs)
+	{
+		return AI_STATE_ACTION_WAIT;
+	}
+	
+	amount = ai_planner_spots(state, player_index, depth, &danger, steps, spots);
+	for(i = 0; i < amount; i++)
+	{
+		score = spots[i].steps * 0.1 - spots[i].walls * 0.3;
+		score += (steps_user[spots[i].index] == -1)?(25):(steps_user[spots[i].index] * 0.2);
+		
+		if(best == -1 || score < best_score)
+		{
+			best = spots[i].index;
+			best_score = score;
+		}
+	}
+	
+	if(best == -1)
+	{
+		return AI_STATE_ACTION_WAIT;
+	}
+	
+	if(best == start)
+	{
+		return AI_STATE_ACTION_BOMB;
+	}
+	
+	return first[best];
+}
@@ -0,0 +1,51 @@
+/*
+ * Copyright (C) 2015 NIPE-SYSTEMS
+ * Copyright (C) 2015 Jonas Krug
+ * Copyright (C) 2015 Tim Gevers
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __AI_PLANNER_H__
+#define __AI_PLANNER_H__
+
+#include "ai-state.h"
+
+#define AI_PLANNER_DEPTH_MIN 4
+#define AI_PLANNER_DEPTH_MAX 24
+#define AI_PLANNER_SAFE 0x7fff
+
+typedef struct ai_planner_danger_s
+{
+	short start[AI_STATE_TILES];
+	short end[AI_STATE_TILES];
+} ai_planner_danger_t;
+
+typedef struct ai_planner_spot_s
+{
+	short index;
+	short steps;
+	short escape_steps;
+	short walls;
+} ai_planner_spot_t;
+
+void ai_planner_danger(ai_state_t *state, ai_planner_danger_t *danger);
+void ai_planner_danger_add_bomb(ai_state_t *state, ai_planner_danger_t *danger, int position_x, int position_y, int explosion_radius, int explosion_tick);
+int ai_planner_danger_get_safe(ai_planner_danger_t *danger, int index, int tick_from, int tick_to);
+int ai_planner_danger_get_stay_safe(ai_planner_danger_t *danger, int index, int tick);
+void ai_planner_reach(ai_state_t *state, ai_planner_danger_t *danger, int start, int start_tick, int period, int depth, short *steps, signed char *first);
+int ai_planner_spots(ai_state_t *state, int player_index, int depth, ai_planner_danger_t *danger, short *steps, ai_planner_spot_t *spots);
+ai_state_action_t ai_planner_decide(ai_state_t *state, int player_index, int depth);
+
+#endif /* __AI_PLANNER_H__ */
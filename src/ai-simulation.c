@@ -19,92 +19,151 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "ai-simulation.h"
 #include "ai-pathfinding.h"
+#include "ai-state.h"
 #include "gameplay.h"
-#include "core.h"
+#include "core-log.h"
 
-static void ai_simulation_reset_simulated(void);
+static void ai_simulation_reset_simulated(game_context_t *context);
+
+struct ai_simulation_context_s
+{
+	// the simulation flags of the tiles (scratch of the AI, 1 means
+	// walkable)
+	char *walkable;
+	char *walkable_simulated;
+	
+	// the tiles which are marked as unwalkable, a reset only visits them
+	int *marked;
+	int marked_amount;
+	int *marked_simulated;
+	int marked_simulated_amount;
+};
 
 /**
- * This function resets all normal simulation flags of the field.
+ * This function allocates the simulation flags for the size of the field and
+ * marks all tiles as walkable.
+ * 
+ * @param context The context of the match.
+ * @return 0 on success, -1 on error.
  */
-void ai_simulation_reset(void)
+int ai_simulation_init(game_context_t *context)
 {
-	int x = 0;
-	int y = 0;
-	gameplay_field_t *field = NULL;
+	if(context->simulation == NULL)
+	{
+		context->simulation = calloc(1, sizeof(ai_simulation_context_t));
+		if(context->simulation == NULL)
+		{
+			return -1;
+		}
+	}
 	
-	field = gameplay_get_field();
+	context->simulation->walkable = gameplay_allocate_tiles(context, context->simulation->walkable, sizeof(char));
+	context->simulation->walkable_simulated = gameplay_allocate_tiles(context, context->simulation->walkable_simulated, sizeof(char));
+	context->simulation->marked = gameplay_allocate_tiles(context, context->simulation->marked, sizeof(int));
+	context->simulation->marked_simulated = gameplay_allocate_tiles(context, context->simulation->marked_simulated, sizeof(int));
+	if(context->simulation->walkable == NULL || context->simulation->walkable_simulated == NULL || context->simulation->marked == NULL || context->simulation->marked_simulated == NULL)
+	{
+		return -1;
+	}
 	
-	if(field == NULL)
+	memset(context->simulation->walkable, 1, GAMEPLAY_FIELD_TILES(context));
+	memset(context->simulation->walkable_simulated, 1, GAMEPLAY_FIELD_TILES(context));
+	context->simulation->marked_amount = 0;
+	context->simulation->marked_simulated_amount = 0;
+	
+	return 0;
+}
+
+/**
+ * This function releases the memory of the simulation flags.
+ * 
+ * @param context The context of the match.
+ */
+void ai_simulation_release(game_context_t *context)
+{
+	if(context->simulation == NULL)
 	{
 		return;
 	}
 	
-	for(y = 0; y < GAMEPLAY_FIELD_HEIGHT; y++)
+	free(context->simulation->walkable);
+	free(context->simulation->walkable_simulated);
+	free(context->simulation->marked);
+	free(context->simulation->marked_simulated);
+	free(context->simulation);
+	context->simulation = NULL;
+}
+
+/**
+ * This function resets all normal simulation flags of the field.
+ * 
+ * @param context The context of the match.
+ */
+void ai_simulation_reset(game_context_t *context)
+{
+	int i = 0;
+	
+	for(i = 0; i < context->simulation->marked_amount; i++)
 	{
-		for(x = 0; x < GAMEPLAY_FIELD_WIDTH; x++)
-		{
-			GAMEPLAY_FIELD(field, x, y).ai_simulation_walkable = 1;
-		}
+		context->simulation->walkable[context->simulation->marked[i]] = 1;
 	}
+	
+	context->simulation->marked_amount = 0;
 }
 
-static void ai_simulation_reset_simulated(void)
+static void ai_simulation_reset_simulated(game_context_t *context)
 /**
  * This function resets all special simulation flags of the field.
+ * 
+ * @param context The context of the match.
  */
 {
-	int x = 0;
-	int y = 0;
-	gameplay_field_t *field = NULL;
+	int i = 0;
 	
-	field = gameplay_get_field();
-	
-	if(field == NULL)
+	for(i = 0; i < context->simulation->marked_simulated_amount; i++)
 	{
-		return;
+		context->simulation->walkable_simulated[context->simulation->marked_simulated[i]] = 1;
 	}
 	
-	for(y = 0; y < GAMEPLAY_FIELD_HEIGHT; y++)
-	{
-		for(x = 0; x < GAMEPLAY_FIELD_WIDTH; x++)
-		{
-			GAMEPLAY_FIELD(field, x, y).ai_simulation_walkable_simulated = 1;
-		}
-	}
+	context->simulation->marked_simulated_amount = 0;
 }
 
 /**
  * This function acts as a helper function to store a simulation flag in the
  * field.
  * 
+ * @param context The context of the match.
  * @param position_x The x coordinate of the tile.
  * @param position_y The y coordinate of the tile.
  * @param simulated The simulation flag which should be set. 0 means normal bomb
  *                  on the field (placed by other players), 1 means virtual bomb
  *                  (placed by the simulation algorithm).
  */
-void ai_simulation_explosion_set_unwalkable(int position_x, int position_y, char simulated)
+void ai_simulation_explosion_set_unwalkable(game_context_t *context, int position_x, int position_y, char simulated)
 {
-	gameplay_field_t *field = NULL;
-	
-	field = gameplay_get_field();
+	int index = 0;
 	
-	if(field == NULL)
-	{
-		return;
-	}
+	index = position_y * GAMEPLAY_FIELD_WIDTH(context) + position_x;
 	
 	if(simulated == 0) // bombs on the field
 	{
-		GAMEPLAY_FIELD(field, position_x, position_y).ai_simulation_walkable = 0;
+		if(context->simulation->walkable[index] == 1)
+		{
+			context->simulation->walkable[index] = 0;
+			context->simulation->marked[context->simulation->marked_amount++] = index;
+		}
 	}
 	else // virtual bombs
 	{
-		GAMEPLAY_FIELD(field, position_x, position_y).ai_simulation_walkable_simulated = 0;
+		if(context->simulation->walkable_simulated[index] == 1)
+		{
+			context->simulation->walkable_simulated[index] = 0;
+			context->simulation->marked_simulated[context->simulation->marked_simulated_amount++] = index;
+		}
 	}
 }
 
@@ -113,63 +172,53 @@ void ai_simulation_explosion_set_unwalkable(int position_x, int position_y, char
  * or virtual bombs. After the execution of the function it is possible to test
  * where the explosions will be. This can be called multiple times.
  * 
+ * @param context The context of the match.
  * @param position_x The x coordinate of the simulated bomb.
  * @param position_y The y coordinate of the simulated bomb.
  * @param simulated The simulation flag which should be set. 0 means normal bomb
  *                  on the field (placed by other players), 1 means virtual bomb
  *                  (placed by the simulation algorithm).
  */
-void ai_simulation_explosion(int position_x, int position_y, int explosion_radius, char simulated)
+void ai_simulation_explosion(game_context_t *context, int position_x, int position_y, int explosion_radius, char simulated)
 {
 	int x = 0;
 	int y = 0;
 	
-	for(x = position_x; x < GAMEPLAY_FIELD_WIDTH && x < position_x + explosion_radius && gameplay_get_walkable(x, position_y, 1); x++)
+	for(x = position_x; x < GAMEPLAY_FIELD_WIDTH(context) && x < position_x + explosion_radius && gameplay_get_walkable(context, x, position_y, 1); x++)
 	{
-		ai_simulation_explosion_set_unwalkable(x, position_y, simulated);
+		ai_simulation_explosion_set_unwalkable(context, x, position_y, simulated);
 	}
 	
-	for(x = position_x - 1; x > 0 && x > position_x - explosion_radius && gameplay_get_walkable(x, position_y, 1); x--)
+	for(x = position_x - 1; x > 0 && x > position_x - explosion_radius && gameplay_get_walkable(context, x, position_y, 1); x--)
 	{
-		ai_simulation_explosion_set_unwalkable(x, position_y, simulated);
+		ai_simulation_explosion_set_unwalkable(context, x, position_y, simulated);
 	}
 	
-	for(y = position_y; y < GAMEPLAY_FIELD_HEIGHT && y < position_y + explosion_radius && gameplay_get_walkable(position_x, y, 1); y++)
+	for(y = position_y; y < GAMEPLAY_FIELD_HEIGHT(context) && y < position_y + explosion_radius && gameplay_get_walkable(context, position_x, y, 1); y++)
 	{
-		ai_simulation_explosion_set_unwalkable(position_x, y, simulated);
+		ai_simulation_explosion_set_unwalkable(context, position_x, y, simulated);
 	}
 	
-	for(y = position_y - 1; y > 0 && y > position_y - explosion_radius && gameplay_get_walkable(position_x, y, 1); y--)
+	for(y = position_y - 1; y > 0 && y > position_y - explosion_radius && gameplay_get_walkable(context, position_x, y, 1); y--)
 	{
-		ai_simulation_explosion_set_unwalkable(position_x, y, simulated);
+		ai_simulation_explosion_set_unwalkable(context, position_x, y, simulated);
 	}
 }
 
 /**
  * This function copies all fire flags from the field to the simulation field.
+ * 
+ * @param context The context of the match.
  */
-void ai_simulation_copy_fire(void)
+void ai_simulation_copy_fire(game_context_t *context)
 {
-	int x = 0;
-	int y = 0;
-	gameplay_field_t *field = NULL;
+	int i = 0;
+	int index = 0;
 	
-	field = gameplay_get_field();
-	
-	if(field == NULL)
+	for(i = 0; i < gameplay_fire_amount(context); i++)
 	{
-		return;
-	}
-	
-	for(y = 0; y < GAMEPLAY_FIELD_HEIGHT; y++)
-	{
-		for(x = 0; x < GAMEPLAY_FIELD_WIDTH; x++)
-		{
-			if(GAMEPLAY_FIELD(field, x, y).fire == 1)
-			{
-				ai_simulation_explosion_set_unwalkable(x, y, 0);
-			}
-		}
+		index = gameplay_fire_get(context, i);
+		ai_simulation_explosion_set_unwalkable(context, index % GAMEPLAY_FIELD_WIDTH(context), index / GAMEPLAY_FIELD_WIDTH(context), 0);
 	}
 }
 
@@ -178,33 +227,31 @@ void ai_simulation_copy_fire(void)
  * bomb by the AI. The validation tests if there are spots to hide from the
  * explosion. It returns the amount of possible hiding places.
  * 
+ * @param context The context of the match.
  * @param explosion_radius The explosion radius of the simulated bomb.
  * @param position_x The x coordinate of the simulated bomb.
  * @param position_y The y coordinate of the simulated bomb.
  * @return The amount of possible hiding places. 0 on error.
  */
-int ai_simulation_validate_tile(int explosion_radius, int position_x, int position_y)
+int ai_simulation_validate_tile(game_context_t *context, int explosion_radius, int position_x, int position_y)
 {
 	int x = 0;
 	int y = 0;
+	int window_x = 0;
+	int window_y = 0;
 	int count_hiding_places = 0;
-	gameplay_field_t *field = NULL;
 	
-	field = gameplay_get_field();
-	
-	if(field == NULL)
-	{
-		return 0;
-	}
+	ai_simulation_reset_simulated(context);
+	ai_simulation_explosion(context, position_x, position_y, explosion_radius, 1);
 	
-	ai_simulation_reset_simulated();
-	ai_simulation_explosion(position_x, position_y, explosion_radius, 1);
+	// hiding places outside of the pathfinding window are unreachable anyway
+	ai_pathfinding_get_window(context, &window_x, &window_y);
 	
-	for(y = 0; y < GAMEPLAY_FIELD_HEIGHT; y++)
+	for(y = window_y; y < window_y + AI_STATE_HEIGHT; y++)
 	{
-		for(x = 0; x < GAMEPLAY_FIELD_WIDTH; x++)
+		for(x = window_x; x < window_x + AI_STATE_WIDTH; x++)
 		{
-			if(gameplay_get_walkable(x, y, 0) == 1 && GAMEPLAY_FIELD(field, x, y).ai_simulation_walkable == 1 && GAMEPLAY_FIELD(field, x, y).ai_simulation_walkable_simulated == 1 && ai_pathfinding_move_to_length(position_x, position_y, x, y, 1) != -1)
+			if(gameplay_get_walkable(context, x, y, 0) == 1 && GAMEPLAY_FIELD(context, context->simulation->walkable, x, y) == 1 && GAMEPLAY_FIELD(context, context->simulation->walkable_simulated, x, y) == 1 && ai_pathfinding_move_to_length(context, position_x, position_y, x, y, 1) != -1)
 			{
 				count_hiding_places++;
 			}
@@ -217,20 +264,26 @@ int ai_simulation_validate_tile(int explosion_radius, int position_x, int positi
 /**
  * This function returns if a simulated tile is walkable.
  * 
+ * @param context The context of the match.
  * @param position_x The x coordinate of the tile.
  * @param position_y The y coordinate of the tile.
  * @return The simulation walkable flag. 0 on error.
  */
-int ai_simulation_get_walkable(int position_x, int position_y)
+int ai_simulation_get_walkable(game_context_t *context, int position_x, int position_y)
 {
-	gameplay_field_t *field = NULL;
-	
-	field = gameplay_get_field();
-	
-	if(field == NULL)
-	{
-		return 0;
-	}
-	
-	return GAMEPLAY_FIELD(field, position_x, position_y).ai_simulation_walkable;
+	return GAMEPLAY_FIELD(context, context->simulation->walkable, position_x, position_y);
+}
+
+/**
+ * This function returns if a tile is walkable regarding the virtual bombs of
+ * the simulation.
+ * 
+ * @param context The context of the match.
+ * @param position_x The x coordinate of the tile.
+ * @param position_y The y coordinate of the tile.
+ * @return The special simulation walkable flag.
+ */
+int ai_simulation_get_walkable_simulated(game_context_t *context, int position_x, int position_y)
+{
+	return GAMEPLAY_FIELD(context, context->simulation->walkable_simulated, position_x, position_y);
 }
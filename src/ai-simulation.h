@@ -20,10 +20,15 @@
 #ifndef __AI_SIMULATION_H__
 #define __AI_SIMULATION_H__
 
-void ai_simulation_reset(void);
-void ai_simulation_explosion(int position_x, int position_y, int explosion_radius, char simulated);
-void ai_simulation_copy_fire(void);
-int ai_simulation_validate_tile(int explosion_radius, int position_x, int position_y);
-int ai_simulation_get_walkable(int position_x, int position_y);
+#include "game-context.h"
+
+int ai_simulation_init(game_context_t *context);
+void ai_simulation_release(game_context_t *context);
+void ai_simulation_reset(game_context_t *context);
+void ai_simulation_explosion(game_context_t *context, int position_x, int position_y, int explosion_radius, char simulated);
+void ai_simulation_copy_fire(game_context_t *context);
+int ai_simulation_validate_tile(game_context_t *context, int explosion_radius, int position_x, int position_y);
+int ai_simulation_get_walkable(game_context_t *context, int position_x, int position_y);
+int ai_simulation_get_walkable_simulated(game_context_t *context, int position_x, int position_y);
 
 #endif /* __AI_SIMULATION_H__ */
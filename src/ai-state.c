@@ -0,0 +1,892 @@
+/*
+ * Copyright (C) 2015 NIPE-SYSTEMS
+ * Copyright (C) 2015 Jonas Krug
+ * Copyright (C) 2015 Tim Gevers
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "ai-state.h"
+#include "gameplay.h"
+#include "gameplay-players.h"
+#include "gameplay-bombs.h"
+#include "gameplay-items.h"
+#include "core-log.h"
+#include "core-random.h"
+
+static int ai_state_project(game_context_t *context, ai_state_t *state, int *position_x, int *position_y, int *explosion_radius, unsigned char *rays);
+static void ai_state_harm(ai_state_t *state, int index);
+static void ai_state_explosion(ai_state_t *state, int bomb_index, int *queue, int *queue_amount);
+
+/**
+ * This function calculates the upper left corner of the window around a
+ * position. The window is moved into the field at the borders.
+ * 
+ * @param context The context of the match.
+ * @param center_x The x coordinate of the center of the window.
+ * @param center_y The y coordinate of the center of the window.
+ * @param position_x The x coordinate of the upper left corner (write by
+ *                   pointer).
+ * @param position_y The y coordinate of the upper left corner (write by
+ *                   pointer).
+ */
+void ai_state_window(game_context_t *context, int center_x, int center_y, int *position_x, int *position_y)
+{
+	*position_x = center_x - AI_STATE_WIDTH / 2;
+	*position_y = center_y - AI_STATE_HEIGHT / 2;
+	
+	if(*position_x > GAMEPLAY_FIELD_WIDTH(context) - AI_STATE_WIDTH)
+	{
+		*position_x = GAMEPLAY_FIELD_WIDTH(context) - AI_STATE_WIDTH;
+	}
+	
+	if(*position_y > GAMEPLAY_FIELD_HEIGHT(context) - AI_STATE_HEIGHT)
+	{
+		*position_y = GAMEPLAY_FIELD_HEIGHT(context) - AI_STATE_HEIGHT;
+	}
+	
+	if(*position_x < 0)
+	{
+		*position_x = 0;
+	}
+	
+	if(*position_y < 0)
+	{
+		*position_y = 0;
+	}
+}
+
+/**
+ * This function projects a bomb outside of the window onto the window. Only
+ * bombs in the rows and columns of the window reach into it, their ray
+ * follows the same rules as the explosion on the field.
+ * 
+ * @param context The context of the match.
+ * @param state The state with the window.
+ * @param position_x The x coordinate of the bomb relative to the window, the
+ *                   tile at which the ray enters the window (read and write
+ *                   by pointer).
+ * @param position_y The y coordinate of the bomb relative to the window, the
+ *                   tile at which the ray enters the window (read and write
+ *                   by pointer).
+ * @param explosion_radius The explosion radius of the bomb, the rest of the
+ *                         ray in the window (read and write by pointer).
+ * @param rays The rays of the bomb in the window (write by pointer).
+ * @return 1 if the bomb reaches into the window, 0 if not.
+ */
+static int ai_state_project(game_context_t *context, ai_state_t *state, int *position_x, int *position_y, int *explosion_radius, unsigned char *rays)
+{
+	int i = 0;
+	int direction = 0;
+	int distance = 0;
+	int direction_x[] = { 0, 1, 0, -1 };
+	int direction_y[] = { -1, 0, 1, 0 };
+	
+	*rays = AI_STATE_RAYS_ALL;
+	
+	if(*position_x >= 0 && *position_y >= 0 && *position_x < AI_STATE_WIDTH && *position_y < AI_STATE_HEIGHT)
+	{
+		return 1;
+	}
+	
+	if(*position_y >= 0 && *position_y < AI_STATE_HEIGHT)
+	{
+		direction = (*position_x < 0)?(1):(3);
+		distance = (*position_x < 0)?(-*position_x):(*position_x - (AI_STATE_WIDTH - 1));
+	}
+	else if(*position_x >= 0 && *position_x < AI_STATE_WIDTH)
+	{
+		direction = (*position_y < 0)?(2):(0);
+		distance = (*position_y < 0)?(-*position_y):(*position_y - (AI_STATE_HEIGHT - 1));
+	}
+	else
+	{
+		return 0;
+	}
+	
+	if(distance >= *explosion_radius)
+	{
+		return 0;
+	}
+	
+	// the ray stops at the first tile which is no floor or has an item
+	for(i = 1; i < distance; i++)
+	{
+		if(!gameplay_get_walkable(context, state->offset_x + *position_x + direction_x[direction] * i, state->offset_y + *position_y + direction_y[direction] * i, 1) || gameplay_items_item_placed(context, state->offset_x + *position_x + direction_x[direction] * i, state->offset_y + *position_y + direction_y[direction] * i) == 1)
+		{
+			return 0;
+		}
+	}
+	
+	*position_x += direction_x[direction] * distance;
+	*position_y += direction_y[direction] * distance;
+	*explosion_radius -= distance;
+	*rays = 1 << direction;
+	
+	return 1;
+}
+
+/**
+ * This function copies the current gameplay state of the window around a
+ * position into a compact AI state. Players outside of the window are not
+ * part of the state, bombs outside of the window are projected onto it if
+ * their explosion reaches into it.
+ * 
+ * @param context The context of the match.
+ * @param state The state which should be filled.
+ * @param tick The tick number which is stored in the state.
+ * @param center_x The x coordinate of the center of the window.
+ * @param center_y The y coordinate of the center of the window.
+ */
+void ai_state_capture(game_context_t *context, ai_state_t *state, unsigned int tick, int center_x, int center_y)
+{
+	int i = 0;
+	int j = 0;
+	int x = 0;
+	int y = 0;
+	int amount = 0;
+	int explosion_radius = 0;
+	unsigned char rays = 0;
+	gameplay_field_t *field = NULL;
+	gameplay_players_player_t *player = NULL;
+	gameplay_bombs_bomb_t *bomb = NULL;
+	ai_state_player_t *state_player = NULL;
+	ai_state_bomb_t *state_bomb = NULL;
+	
+	field = gameplay_get_field(context);
+	
+	state->tick = tick;
+	ai_state_window(context, center_x, center_y, &(state->offset_x), &(state->offset_y));
+	
+	for(i = 0; i < AI_STATE_TILES; i++)
+	{
+		x = state->offset_x + i % AI_STATE_WIDTH;
+		y = state->offset_y + i / AI_STATE_WIDTH;
+		state->type[i] = GAMEPLAY_FIELD(context, field->type, x, y);
+		state->fire[i] = gameplay_get_fire_timeout(context, x, y);
+		state->item[i] = gameplay_items_get_item_type(context, x, y);
+		state->bomb[i] = AI_STATE_NO_BOMB;
+	}
+	
+	amount = gameplay_players_amount(context);
+	state->players_amount = 0;
+	for(i = 0; i < amount && state->players_amount < AI_STATE_PLAYERS_MAX; i++)
+	{
+		player = gameplay_players_get(context, i);
+		if(player == NULL)
+		{
+			continue;
+		}
+		
+		x = player->position_x - state->offset_x;
+		y = player->position_y - state->offset_y;
+		if(x < 0 || y < 0 || x >= AI_STATE_WIDTH || y >= AI_STATE_HEIGHT)
+		{
+			continue;
+		}
+		
+		state_player = &(state->players[state->players_amount++]);
+		state_player->id = player->id;
+		state_player->type = player->type;
+		state_player->health_points = player->health_points;
+		state_player->position_x = x;
+		state_player->position_y = y;
+		state_player->placeable_bombs = player->placeable_bombs;
+		state_player->placed_bombs = player->placed_bombs;
+		state_player->explosion_radius = player->explosion_radius;
+		state_player->movement_cooldown = gameplay_players_get_movement_cooldown(context, player);
+		state_player->movement_cooldown_initial = player->movement_cooldown_initial;
+		state_player->damage_cooldown = gameplay_players_get_damage_cooldown(context, player);
+		state_player->damage_cooldown_initial = player->damage_cooldown_initial;
+	}
+	
+	state->bombs_amount = 0;
+	for(bomb = gameplay_bombs_get_list(context); bomb != NULL && state->bombs_amount < AI_STATE_BOMBS_MAX; bomb = bomb->next)
+	{
+		x = bomb->position_x - state->offset_x;
+		y = bomb->position_y - state->offset_y;
+		explosion_radius = bomb->explosion_radius;
+		if(ai_state_project(context, state, &x, &y, &explosion_radius, &rays) == 0)
+		{
+			continue;
+		}
+		
+		state_bomb = &(state->bombs[state->bombs_amount]);
+		state_bomb->position_x = x;
+		state_bomb->position_y = y;
+		state_bomb->explosion_radius = explosion_radius;
+		state_bomb->rays = rays;
+		state_bomb->explosion_timeout = gameplay_bombs_get_explosion_timeout(context, bomb);
+		state_bomb->owner = -1;
+		
+		for(j = 0; j < state->players_amount; j++)
+		{
+			if(bomb->owner != NULL && state->players[j].id == bomb->owner->id)
+			{
+				state_bomb->owner = j;
+				break;
+			}
+		}
+		
+		if(rays == AI_STATE_RAYS_ALL)
+		{
+			state->bomb[AI_STATE_INDEX(x, y)] = state->bombs_amount;
+		}
+		
+		state->bombs_amount++;
+	}
+}
+
+/**
+ * This function searches a player in a state by its id.
+ * 
+ * @param state The state.
+ * @param id The id of the player.
+ * @return The index of the player in the state or -1 if it was not found.
+ */
+int ai_state_find_player(ai_state_t *state, int id)
+{
+	int i = 0;
+	
+	for(i = 0; i < state->players_amount; i++)
+	{
+		if(state->players[i].id == id)
+		{
+			return i;
+		}
+	}
+	
+	return -1;
+}
+
+/**
+ * This function searches the user player in a state.
+ * 
+ * @param state The state.
+ * @return The index of the user player in the state or -1 if it was not found.
+ */
+int ai_state_find_user(ai_state_t *state)
+{
+	int i = 0;
+	
+	for(i = 0; i < state->players_amount; i++)
+	{
+		if(state->players[i].type == GAMEPLAY_PLAYERS_TYPE_USER)
+		{
+			return i;
+		}
+	}
+	
+	return -1;
+}
+
+/**
+ * This function tests if a tile of a state is walkable. Bombs are interpreted
+ * as walls.
+ * 
+ * @param state The state.
+ * @param position_x The x coordinate of the tile.
+ * @param position_y The y coordinate of the tile.
+ * @return 0 if the tile is not walkable, 1 if it is walkable.
+ */
+int ai_state_get_walkable(ai_state_t *state, int position_x, int position_y)
+{
+	int index = 0;
+	
+	if(position_x < 0 || position_y < 0 || position_x >= AI_STATE_WIDTH || position_y >= AI_STATE_HEIGHT)
+	{
+		return 0;
+	}
+	
+	index = AI_STATE_INDEX(position_x, position_y);
+	
+	return (state->type[index] == FLOOR && state->bomb[index] == AI_STATE_NO_BOMB);
+}
+
+/**
+ * This function collects all tiles which are hit by an explosion. It follows
+ * the same rules as the explosion on the field: A ray stops at the first wall
+ * or item, which is hit as well.
+ * 
+ * @param state The state.
+ * @param position_x The x coordinate of the bomb.
+ * @param position_y The y coordinate of the bomb.
+ * @param explosion_radius The explosion radius of the bomb.
+ * @param tiles An array with at least AI_STATE_BLAST_MAX elements which is
+ *              filled with the tile indices.
+ * @return The amount of tiles which are hit.
+ */
+int ai_state_blast_tiles(ai_state_t *state, int position_x, int position_y, int explosion_radius, int *tiles)
+{
+	int x = 0;
+	int y = 0;
+	int index = 0;
+	int amount = 0;
+	
+	for(x = position_x; x < AI_STATE_WIDTH && x < position_x + explosion_radius; x++)
+	{
+		index = AI_STATE_INDEX(x, position_y);
+		tiles[amount++] = index;
+		if(state->type[index] != FLOOR || state->item[index] != 0)
+		{
+			break;
+		}
+	}
+	
+	for(x = position_x - 1; x >= 0 && x + state->offset_x > 0 && x > position_x - explosion_radius; x--)
+	{
+		index = AI_STATE_INDEX(x, position_y);
+		tiles[amount++] = index;
+		if(state->type[index] != FLOOR || state->item[index] != 0)
+		{
+			break;
+		}
+	}
+	
+	for(y = position_y + 1; y < AI_STATE_HEIGHT && y < position_y + explosion_radius; y++)
+	{
+		index = AI_STATE_INDEX(position_x, y);
+		tiles[amount++] = index;
+		if(state->type[index] != FLOOR || state->item[index] != 0)
+		{
+			break;
+		}
+	}
+	
+	for(y = position_y - 1; y >= 0 && y + state->offset_y > 0 && y > position_y - explosion_radius; y--)
+	{
+		index = AI_STATE_INDEX(position_x, y);
+		tiles[amount++] = index;
+		if(state->type[index] != FLOOR || state->item[index] != 0)
+		{
+			break;
+		}
+	}
+	
+	return amount;
+}
+
+/**
+ * This function collects all tiles which are hit by the explosion of a bomb
+ * of a state. Projected bombs only hit the tiles of their ray.
+ * 
+ * @param state The state.
+ * @param bomb The bomb.
+ * @param tiles An array with at least AI_STATE_BLAST_MAX elements which is
+ *              filled with the tile indices.
+ * @return The amount of tiles which are hit.
+ */
+int ai_state_bomb_tiles(ai_state_t *state, ai_state_bomb_t *bomb, int *tiles)
+{
+	int x = 0;
+	int y = 0;
+	int index = 0;
+	int amount = 0;
+	int direction = 0;
+	int distance = 0;
+	int direction_x[] = { 0, 1, 0, -1 };
+	int direction_y[] = { -1, 0, 1, 0 };
+	
+	if(bomb->rays == AI_STATE_RAYS_ALL)
+	{
+		return ai_state_blast_tiles(state, bomb->position_x, bomb->position_y, bomb->explosion_radius, tiles);
+	}
+	
+	for(direction = 0; direction < 3 && (bomb->rays & (1 << direction)) == 0; direction++);
+	
+	for(distance = 0; distance < bomb->explosion_radius; distance++)
+	{
+		x = bomb->position_x + direction_x[direction] * distance;
+		y = bomb->position_y + direction_y[direction] * distance;
+		if(x < 0 || y < 0 || x >= AI_STATE_WIDTH || y >= AI_STATE_HEIGHT)
+		{
+			break;
+		}
+		
+		index = AI_STATE_INDEX(x, y);
+		tiles[amount++] = index;
+		if(state->type[index] != FLOOR || state->item[index] != 0)
+		{
+			break;
+		}
+	}
+	
+	return amount;
+}
+
+/**
+ * This function calculates the target tile of an action.
+ * 
+ * @param action The action.
+ * @param position_x The x coordinate of the current tile.
+ * @param position_y The y coordinate of the current tile.
+ * @param target_x The x coordinate of the target tile (write by pointer).
+ * @param target_y The y coordinate of the target tile (write by pointer).
+ */
+void ai_state_action_target(ai_state_action_t action, int position_x, int position_y, int *target_x, int *target_y)
+{
+	*target_x = position_x;
+	*target_y = position_y;
+	
+	switch(action)
+	{
+		case AI_STATE_ACTION_UP:
+		{
+			(*target_y)--;
+			break;
+		}
+		case AI_STATE_ACTION_RIGHT:
+		{
+			(*target_x)++;
+			break;
+		}
+		case AI_STATE_ACTION_DOWN:
+		{
+			(*target_y)++;
+			break;
+		}
+		case AI_STATE_ACTION_LEFT:
+		{
+			(*target_x)--;
+			break;
+		}
+		default:
+		{
+			break;
+		}
+	}
+}
+
+/**
+ * This function tests if a player of a state is still alive. AI players with
+ * no health points left are removed from the field.
+ * 
+ * @param state The state.
+ * @param player_index The index of the player.
+ * @return 1 if the player is alive, 0 if not.
+ */
+int ai_state_get_alive(ai_state_t *state, int player_index)
+{
+	return (state->players[player_index].health_points > 0);
+}
+
+/**
+ * This function tests if a tile is in the explosion range of any bomb. The
+ * rays of the explosions are followed until they are blocked.
+ * 
+ * @param state The state.
+ * @param position_x The x coordinate of the tile.
+ * @param position_y The y coordinate of the tile.
+ * @return 1 if the tile is threatened, 0 if not.
+ */
+int ai_state_get_threatened(ai_state_t *state, int position_x, int position_y)
+{
+	int i = 0;
+	int j = 0;
+	int amount = 0;
+	int tiles[AI_STATE_BLAST_MAX];
+	int x = 0;
+	int y = 0;
+	int distance = 0;
+	int index = 0;
+	int direction_x[] = { 0, 1, 0, -1 };
+	int direction_y[] = { -1, 0, 1, 0 };
+	
+	for(i = 0; i < 4; i++)
+	{
+		for(distance = (i == 0)?(0):(1); distance < AI_STATE_BLAST_MAX; distance++)
+		{
+			x = position_x + direction_x[i] * distance;
+			y = position_y + direction_y[i] * distance;
+			if(x < 0 || y < 0 || x >= AI_STATE_WIDTH || y >= AI_STATE_HEIGHT)
+			{
+				break;
+			}
+			
+			index = AI_STATE_INDEX(x, y);
+			if(state->bomb[index] != AI_STATE_NO_BOMB && state->bombs[(int)state->bomb[index]].explosion_radius > distance)
+			{
+				return 1;
+			}
+			
+			if(state->type[index] != FLOOR || state->item[index] != 0)
+			{
+				break;
+			}
+		}
+	}
+	
+	// projected bombs do not lie on a tile of the window
+	for(i = 0; i < state->bombs_amount; i++)
+	{
+		if(state->bombs[i].rays == AI_STATE_RAYS_ALL)
+		{
+			continue;
+		}
+		
+		amount = ai_state_bomb_tiles(state, &(state->bombs[i]), tiles);
+		for(j = 0; j < amount; j++)
+		{
+			if(tiles[j] == AI_STATE_INDEX(position_x, position_y))
+			{
+				return 1;
+			}
+		}
+	}
+	
+	return 0;
+}
+
+/**
+ * This function tests if an action can be executed by a player. Movements
+ * need a walkable target tile, bombs need an available bomb and a free tile.
+ * 
+ * @param state The state.
+ * @param player_index The index of the player.
+ * @param action The action.
+ * @return 1 if the action can be executed, 0 if not.
+ */
+int ai_state_get_legal(ai_state_t *state, int player_index, ai_state_action_t action)
+{
+	int x = 0;
+	int y = 0;
+	ai_state_player_t *player = NULL;
+	
+	player = &(state->players[player_index]);
+	
+	if(action == AI_STATE_ACTION_WAIT)
+	{
+		return 1;
+	}
+	
+	if(action == AI_STATE_ACTION_BOMB)
+	{
+		return (player->placed_bombs < player->placeable_bombs && state->bombs_amount < AI_STATE_BOMBS_MAX && state->bomb[AI_STATE_INDEX(player->position_x, player->position_y)] == AI_STATE_NO_BOMB);
+	}
+	
+	ai_state_action_target(action, player->position_x, player->position_y, &x, &y);
+	
+	return ai_state_get_walkable(state, x, y);
+}
+
+/**
+ * This function harms all players on a tile of a state. It follows the rules
+ * of the damage cooldown.
+ * 
+ * @param state The state.
+ * @param index The tile index.
+ */
+static void ai_state_harm(ai_state_t *state, int index)
+{
+	int i = 0;
+	ai_state_player_t *player = NULL;
+	
+	for(i = 0; i < state->players_amount; i++)
+	{
+		player = &(state->players[i]);
+		if(player->health_points <= 0 || AI_STATE_INDEX(player->position_x, player->position_y) != index)
+		{
+			continue;
+		}
+		
+		if(player->damage_cooldown == 0)
+		{
+			player->health_points--;
+			player->damage_cooldown = player->damage_cooldown_initial;
+		}
+	}
+}
+
+/**
+ * This function explodes a bomb of a state. Bombs in the explosion are
+ * triggered, walls are destroyed (without item drops) and items are removed.
+ * The bomb is only marked as exploded, it is removed from the bomb array by
+ * the caller.
+ * 
+ * @param state The state.
+ * @param bomb_index The index of the bomb.
+ * @param queue The queue of exploding bombs, triggered bombs are appended.
+ * @param queue_amount The amount of bombs in the queue.
+ */
+static void ai_state_explosion(ai_state_t *state, int bomb_index, int *queue, int *queue_amount)
+{
+	int i = 0;
+	int index = 0;
+	int amount = 0;
+	int tiles[AI_STATE_BLAST_MAX];
+	ai_state_bomb_t *bomb = NULL;
+	
+	bomb = &(state->bombs[bomb_index]);
+	bomb->explosion_timeout = -1;
+	if(bomb->rays == AI_STATE_RAYS_ALL)
+	{
+		state->bomb[AI_STATE_INDEX(bomb->position_x, bomb->position_y)] = AI_STATE_NO_BOMB;
+	}
+	
+	if(bomb->owner >= 0)
+	{
+		state->players[(int)bomb->owner].placed_bombs--;
+	}
+	
+	amount = ai_state_bomb_tiles(state, bomb, tiles);
+	for(i = 0; i < amount; i++)
+	{
+		index = tiles[i];
+		
+		ai_state_harm(state, index);
+		
+		// trigger bombs in the explosion
+		if(state->bomb[index] != AI_STATE_NO_BOMB && state->bombs[(int)state->bomb[index]].explosion_timeout > 0)
+		{
+			state->bombs[(int)state->bomb[index]].explosion_timeout = 0;
+			queue[(*queue_amount)++] = state->bomb[index];
+		}
+		
+		if(state->type[index] == DESTRUCTIVE)
+		{
+			state->type[index] = FLOOR;
+		}
+		
+		state->item[index] = 0;
+		
+		if(state->type[index] == FLOOR)
+		{
+			state->fire[index] = GAMEPLAY_FIRE_DESPAWN;
+		}
+	}
+}
+
+/**
+ * This function executes the action of a player in a state. Illegal actions
+ * and actions of dead players are ignored. The movement cooldown is not
+ * tested.
+ * 
+ * @param state The state.
+ * @param player_index The index of the player.
+ * @param action The action.
+ */
+void ai_state_apply(ai_state_t *state, int player_index, ai_state_action_t action)
+{
+	int x = 0;
+	int y = 0;
+	int index = 0;
+	ai_state_player_t *player = NULL;
+	ai_state_bomb_t *bomb = NULL;
+	
+	player = &(state->players[player_index]);
+	
+	if(player->health_points <= 0 || action == AI_STATE_ACTION_WAIT || ai_state_get_legal(state, player_index, action) == 0)
+	{
+		return;
+	}
+	
+	if(action == AI_STATE_ACTION_BOMB)
+	{
+		index = AI_STATE_INDEX(player->position_x, player->position_y);
+		
+		bomb = &(state->bombs[state->bombs_amount]);
+		bomb->position_x = player->position_x;
+		bomb->position_y = player->position_y;
+		bomb->explosion_radius = player->explosion_radius;
+		bomb->rays = AI_STATE_RAYS_ALL;
+		bomb->owner = player_index;
+		bomb->explosion_timeout = GAMEPLAY_BOMBS_EXPLOSION_TIMEOUT;
+		
+		state->bomb[index] = state->bombs_amount;
+		state->item[index] = 0;
+		state->bombs_amount++;
+		player->placed_bombs++;
+		return;
+	}
+	
+	ai_state_action_target(action, player->position_x, player->position_y, &x, &y);
+	player->position_x = x;
+	player->position_y = y;
+	player->movement_cooldown = player->movement_cooldown_initial;
+}
+
+/**
+ * This function advances a state by one tick. It follows the order of the
+ * gameplay update: Fire, cooldowns, bombs and at last the actions of the
+ * players. Only players without movement cooldown execute their actions.
+ * Items are neither dropped nor picked up. The function does not allocate any
+ * memory, so it is fast enough to be called very often by the AI.
+ * 
+ * @param state The state which should be advanced.
+ * @param actions The actions of all players (indexed like the players of the
+ *                state) or NULL if all players wait.
+ */
+void ai_state_step(ai_state_t *state, ai_state_action_t *actions)
+{
+	int i = 0;
+	int amount = 0;
+	int queue[AI_STATE_BOMBS_MAX];
+	int queue_amount = 0;
+	ai_state_player_t *player = NULL;
+	ai_state_bomb_t *bomb = NULL;
+	
+	state->tick++;
+	
+	// fire
+	for(i = 0; i < AI_STATE_TILES; i++)
+	{
+		if(state->fire[i] > 0)
+		{
+			state->fire[i]--;
+			ai_state_harm(state, i);
+		}
+	}
+	
+	// cooldowns
+	for(i = 0; i < state->players_amount; i++)
+	{
+		player = &(state->players[i]);
+		
+		if(player->movement_cooldown > 0)
+		{
+			player->movement_cooldown--;
+		}
+		
+		if(player->damage_cooldown > 0)
+		{
+			player->damage_cooldown--;
+		}
+	}
+	
+	// bombs, the due bombs explode first and triggered bombs explode in the
+	// same tick (like the timer wheel of the gameplay)
+	for(i = 0; i < state->bombs_amount; i++)
+	{
+		if(state->bombs[i].explosion_timeout == 0)
+		{
+			queue[queue_amount++] = i;
+		}
+	}
+	
+	for(i = 0; i < queue_amount; i++)
+	{
+		ai_state_explosion(state, queue[i], queue, &queue_amount);
+	}
+	
+	for(i = 0; i < state->bombs_amount; i++)
+	{
+		bomb = &(state->bombs[i]);
+		
+		if(bomb->explosion_timeout > 0)
+		{
+			bomb->explosion_timeout--;
+		}
+	}
+	
+	// remove exploded bombs and keep the order of the others
+	for(i = 0; i < state->bombs_amount; i++)
+	{
+		if(state->bombs[i].explosion_timeout < 0)
+		{
+			continue;
+		}
+		
+		if(i != amount)
+		{
+			state->bombs[amount] = state->bombs[i];
+			if(state->bombs[amount].rays == AI_STATE_RAYS_ALL)
+			{
+				state->bomb[AI_STATE_INDEX(state->bombs[amount].position_x, state->bombs[amount].position_y)] = amount;
+			}
+		}
+		
+		amount++;
+	}
+	state->bombs_amount = amount;
+	
+	if(actions == NULL)
+	{
+		return;
+	}
+	
+	// actions
+	for(i = 0; i < state->players_amount; i++)
+	{
+		if(state->players[i].movement_cooldown == 0)
+		{
+			ai_state_apply(state, i, actions[i]);
+		}
+	}
+}
+
+/**
+ * This function calculates the Zobrist key of a feature of a state. Instead of
+ * a big table of random numbers the key is derived from the feature and its
+ * value by the SplitMix64 finalizer, which gives the same properties.
+ * 
+ * @param feature The feature (e.g. the fire of a tile).
+ * @param value The value of the feature.
+ * @return The key.
+ */
+unsigned long long ai_state_hash_key(unsigned int feature, unsigned int value)
+{
+	return core_random_mix64(((unsigned long long)feature << 32 | value) + 0x9e3779b97f4a7c15ULL);
+}
+
+/**
+ * This function calculates the Zobrist hash of a state. The tick is not part
+ * of the hash, so equal situations at different ticks have equal hashes.
+ * 
+ * @param state The state.
+ * @return The hash.
+ */
+unsigned long long ai_state_hash(ai_state_t *state)
+{
+	int i = 0;
+	unsigned long long hash = 0;
+	ai_state_player_t *player = NULL;
+	ai_state_bomb_t *bomb = NULL;
+	
+	// walls are fixed and floor is the default, only the rest is hashed
+	for(i = 0; i < AI_STATE_TILES; i++)
+	{
+		if(state->type[i] == DESTRUCTIVE)
+		{
+			hash ^= ai_state_hash_key(AI_STATE_HASH_DESTRUCTIVE, i);
+		}
+		
+		if(state->fire[i] > 0)
+		{
+			hash ^= ai_state_hash_key(AI_STATE_HASH_FIRE + i, state->fire[i]);
+		}
+		
+		if(state->item[i] != 0)
+		{
+			hash ^= ai_state_hash_key(AI_STATE_HASH_ITEM + i, state->item[i]);
+		}
+	}
+	
+	for(i = 0; i < state->bombs_amount; i++)
+	{
+		bomb = &(state->bombs[i]);
+		hash ^= ai_state_hash_key(AI_STATE_HASH_BOMB + AI_STATE_INDEX(bomb->position_x, bomb->position_y), (bomb->rays ^ AI_STATE_RAYS_ALL) << 16 | bomb->explosion_timeout << 8 | bomb->explosion_radius);
+	}
+	
+	for(i = 0; i < state->players_amount; i++)
+	{
+		player = &(state->players[i]);
+		hash ^= ai_state_hash_key(AI_STATE_HASH_PLAYER + i, AI_STATE_INDEX(player->position_x, player->position_y) << 16 | (unsigned char)player->health_points << 8 | player->placed_bombs);
+		hash ^= ai_state_hash_key(AI_STATE_HASH_PLAYER_COOLDOWNS + i, player->movement_cooldown << 8 | player->damage_cooldown);
+	}
+	
+	return hash;
+}
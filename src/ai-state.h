@@ -0,0 +1,129 @@
+/*
+ * Copyright (C) 2015 NIPE-SYSTEMS
+ * Copyright (C) 2015 Jonas Krug
+ * Copyright (C) 2015 Tim Gevers
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __AI_STATE_H__
+#define __AI_STATE_H__
+
+#include "gameplay.h"
+
+#define AI_STATE_PLAYERS_MAX 4
+#define AI_STATE_BOMBS_MAX 48
+// the AI plans on a window of the field around the player, so the costs of
+// the planners do not depend on the size of the field
+#define AI_STATE_WIDTH 9
+#define AI_STATE_HEIGHT 9
+#define AI_STATE_TILES (AI_STATE_WIDTH * AI_STATE_HEIGHT)
+#define AI_STATE_NO_BOMB -1
+#define AI_STATE_BLAST_MAX (AI_STATE_WIDTH + AI_STATE_HEIGHT)
+
+#define AI_STATE_INDEX(x, y) ((y) * AI_STATE_WIDTH + (x))
+
+// the rays of a bomb (in the order up, right, down, left), bombs outside of
+// the window are projected onto the window with the one ray which reaches it
+#define AI_STATE_RAYS_ALL 0x0f
+
+// features of the Zobrist hash (features per tile are added to the tile index)
+#define AI_STATE_HASH_DESTRUCTIVE 0x01000000
+#define AI_STATE_HASH_FIRE 0x02000000
+#define AI_STATE_HASH_ITEM 0x03000000
+#define AI_STATE_HASH_BOMB 0x04000000
+#define AI_STATE_HASH_PLAYER 0x05000000
+#define AI_STATE_HASH_PLAYER_COOLDOWNS 0x06000000
+
+typedef enum ai_state_action_e
+{
+	AI_STATE_ACTION_WAIT = 0,
+	AI_STATE_ACTION_UP = 1,
+	AI_STATE_ACTION_RIGHT = 2,
+	AI_STATE_ACTION_DOWN = 3,
+	AI_STATE_ACTION_LEFT = 4,
+	AI_STATE_ACTION_BOMB = 5
+} ai_state_action_t;
+
+#define AI_STATE_ACTIONS 6
+
+typedef struct ai_state_player_s
+{
+	int id;
+	signed char type;
+	signed char health_points;
+	unsigned char position_x;
+	unsigned char position_y;
+	unsigned char placeable_bombs;
+	unsigned char placed_bombs;
+	unsigned char explosion_radius;
+	unsigned char movement_cooldown;
+	unsigned char movement_cooldown_initial;
+	unsigned char damage_cooldown;
+	unsigned char damage_cooldown_initial;
+} ai_state_player_t;
+
+/**
+ * A bomb of a state. Projected bombs lie outside of the window: Their
+ * position is the tile at which their ray enters the window, the explosion
+ * radius is what is left of the ray there. They do not occupy their tile.
+ */
+typedef struct ai_state_bomb_s
+{
+	unsigned char position_x;
+	unsigned char position_y;
+	unsigned char explosion_radius;
+	unsigned char rays;
+	signed char owner;
+	short explosion_timeout;
+} ai_state_bomb_t;
+
+/**
+ * A compact copy of the gameplay state which contains no pointers. It can be
+ * copied with a plain assignment and is used by the AI to plan on a snapshot
+ * of the field instead of the live gameplay data. All positions are relative
+ * to the upper left corner of the window (offset_x, offset_y) in the field.
+ */
+typedef struct ai_state_s
+{
+	unsigned int tick;
+	int offset_x;
+	int offset_y;
+	unsigned char type[AI_STATE_TILES];
+	unsigned char fire[AI_STATE_TILES];
+	unsigned char item[AI_STATE_TILES];
+	signed char bomb[AI_STATE_TILES];
+	int players_amount;
+	ai_state_player_t players[AI_STATE_PLAYERS_MAX];
+	int bombs_amount;
+	ai_state_bomb_t bombs[AI_STATE_BOMBS_MAX];
+} ai_state_t;
+
+void ai_state_window(game_context_t *context, int center_x, int center_y, int *position_x, int *position_y);
+void ai_state_capture(game_context_t *context, ai_state_t *state, unsigned int tick, int center_x, int center_y);
+int ai_state_find_player(ai_state_t *state, int id);
+int ai_state_find_user(ai_state_t *state);
+int ai_state_get_walkable(ai_state_t *state, int position_x, int position_y);
+int ai_state_blast_tiles(ai_state_t *state, int position_x, int position_y, int explosion_radius, int *tiles);
+int ai_state_bomb_tiles(ai_state_t *state, ai_state_bomb_t *bomb, int *tiles);
+void ai_state_action_target(ai_state_action_t action, int position_x, int position_y, int *target_x, int *target_y);
+int ai_state_get_alive(ai_state_t *state, int player_index);
+int ai_state_get_threatened(ai_state_t *state, int position_x, int position_y);
+int ai_state_get_legal(ai_state_t *state, int player_index, ai_state_action_t action);
+void ai_state_apply(ai_state_t *state, int player_index, ai_state_action_t action);
+void ai_state_step(ai_state_t *state, ai_state_action_t *actions);
+unsigned long long ai_state_hash_key(unsigned int feature, unsigned int value);
+unsigned long long ai_state_hash(ai_state_t *state);
+
+#endif /* __AI_STATE_H__ */
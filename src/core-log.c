@@ -0,0 +1,143 @@
+/*
+ * Copyright (C) 2015 NIPE-SYSTEMS
+ * Copyright (C) 2015 Jonas Krug
+ * Copyright (C) 2015 Tim Gevers
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "core-log.h"
+
+#ifdef DEBUG
+
+static void core_log(FILE *file, char *fmt, va_list args);
+static FILE *core_file_debug = NULL;
+static FILE *core_file_error = NULL;
+
+/**
+ * This function initializes output files.
+ */
+void core_log_init(void)
+{
+	core_file_debug = fopen("debug.log", "a");
+	if(core_file_debug == NULL)
+	{
+		fprintf(stderr, "Failed to open debug log file.\n");
+		exit(1);
+		return;
+	}
+	
+	core_file_error = fopen("error.log", "a");
+	if(core_file_error == NULL)
+	{
+		fprintf(stderr, "Failed to open error log file.\n");
+		fclose(core_file_debug);
+		exit(1);
+		return;
+	}
+	
+	core_debug("");
+	core_debug(" +----------------------+");
+	core_debug(" | TURBO BOMBER STARTED |");
+	core_debug(" +----------------------+");
+	core_debug("");
+	core_debug("Log system initialized.");
+}
+
+/**
+ * This function cleans up output files.
+ */
+void core_log_cleanup(void)
+{
+	core_debug("");
+	core_debug(" +----------------------+");
+	core_debug(" | TURBO BOMBER STOPPED |");
+	core_debug(" +----------------------+");
+	core_debug("");
+	
+	if(core_file_debug != NULL)
+	{
+		fclose(core_file_debug);
+	}
+	
+	if(core_file_error != NULL)
+	{
+		fclose(core_file_error);
+	}
+}
+
+/**
+ * This function generates a log message and writes it to a file pointer.
+ */
+static void core_log(FILE *file, char *fmt, va_list args)
+{
+	char time_buffer[80];
+	time_t rawtime;
+	struct tm * timeinfo;
+	
+	// tools which run without the core have no log files
+	if(file == NULL)
+	{
+		return;
+	}
+	
+	time(&rawtime);
+	timeinfo = localtime(&rawtime);
+	
+	strftime(time_buffer, 80, "%c: ", timeinfo);
+	
+	fwrite(time_buffer, strlen(time_buffer), 1, file);
+	
+	vfprintf(file, fmt, args);
+	
+	fwrite("\n", strlen("\n"), 1, file);
+	
+	fflush(file);
+}
+
+/**
+ * This function outputs a debug message to the debug logging file.
+ * 
+ * @param fmt The format string like in "printf".
+ * @param ... The arguments for the format like in "printf".
+ */
+void core_debug(char *fmt, ...)
+{
+	va_list args;
+	
+	va_start(args, fmt);
+	core_log(core_file_debug, fmt, args);
+	va_end(args);
+}
+
+/**
+ * This function outputs an error message to the error logging file.
+ * 
+ * @param fmt The format string like in "printf".
+ * @param ... The arguments for the format like in "printf".
+ */
+void core_error(char *fmt, ...)
+{
+	va_list args;
+	
+	va_start(args, fmt);
+	core_log(core_file_error, fmt, args);
+	va_end(args);
+}
+
+#endif /* DEBUG */
@@ -0,0 +1,139 @@
+/*
+ * Copyright (C) 2015 NIPE-SYSTEMS
+ * Copyright (C) 2015 Jonas Krug
+ * Copyright (C) 2015 Tim Gevers
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+
+#include "core-pool.h"
+#include "core-log.h"
+
+/**
+ * This function allocates an object of a pool. Freed objects are reused
+ * first, otherwise the object is taken from the current chunk. Only if all
+ * chunks are used up a new chunk is allocated on the heap, so a pool which
+ * has grown to the size of a match never calls malloc again.
+ * 
+ * @param pool The pool.
+ * @return The object or NULL if no chunk could be allocated.
+ */
+void *core_pool_allocate(core_pool_t *pool)
+{
+	core_pool_free_t *object = NULL;
+	core_pool_chunk_t *chunk = NULL;
+	
+	// reuse a freed object
+	if(pool->free_list != NULL)
+	{
+		object = pool->free_list;
+		pool->free_list = object->next;
+		return object;
+	}
+	
+	// continue with the next chunk (allocated by an earlier match) or
+	// allocate a new one
+	if(pool->chunk == NULL || pool->chunk_used == pool->chunk_capacity)
+	{
+		if(pool->chunk != NULL && pool->chunk->next != NULL)
+		{
+			chunk = pool->chunk->next;
+		}
+		else if(pool->chunk == NULL && pool->chunks != NULL)
+		{
+			chunk = pool->chunks;
+		}
+		else
+		{
+			chunk = malloc(sizeof(core_pool_chunk_t) + pool->object_size * pool->chunk_capacity);
+			if(chunk == NULL)
+			{
+				core_error("Failed to allocate pool chunk.");
+				return NULL;
+			}
+			
+			chunk->next = NULL;
+			
+			if(pool->chunk == NULL)
+			{
+				pool->chunks = chunk;
+			}
+			else
+			{
+				pool->chunk->next = chunk;
+			}
+		}
+		
+		pool->chunk = chunk;
+		pool->chunk_used = 0;
+	}
+	
+	return (char *)(pool->chunk + 1) + pool->object_size * pool->chunk_used++;
+}
+
+/**
+ * This function returns an object to its pool. The object is reused by the
+ * next allocation.
+ * 
+ * @param pool The pool.
+ * @param object The object.
+ */
+void core_pool_free(core_pool_t *pool, void *object)
+{
+	core_pool_free_t *freed = object;
+	
+	if(object == NULL)
+	{
+		return;
+	}
+	
+	freed->next = pool->free_list;
+	pool->free_list = freed;
+}
+
+/**
+ * This function frees all objects of a pool at once. The chunks are kept for
+ * the next match.
+ * 
+ * @param pool The pool.
+ */
+void core_pool_reset(core_pool_t *pool)
+{
+	pool->chunk = NULL;
+	pool->chunk_used = 0;
+	pool->free_list = NULL;
+}
+
+/**
+ * This function releases the memory of a pool. All objects of the pool
+ * become invalid.
+ * 
+ * @param pool The pool.
+ */
+void core_pool_release(core_pool_t *pool)
+{
+	core_pool_chunk_t *current = NULL;
+	core_pool_chunk_t *next_backup = NULL;
+	
+	for(current = pool->chunks; current != NULL; current = next_backup)
+	{
+		next_backup = current->next;
+		free(current);
+	}
+	
+	pool->chunks = NULL;
+	core_pool_reset(pool);
+}
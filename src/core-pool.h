@@ -0,0 +1,54 @@
+/*
+ * Copyright (C) 2015 NIPE-SYSTEMS
+ * Copyright (C) 2015 Jonas Krug
+ * Copyright (C) 2015 Tim Gevers
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __CORE_POOL_H__
+#define __CORE_POOL_H__
+
+#include <stddef.h>
+
+// the size of an object in a pool, rounded up to keep the objects aligned
+#define CORE_POOL_OBJECT_SIZE(size) ((((size) + sizeof(void *) - 1) / sizeof(void *)) * sizeof(void *))
+#define CORE_POOL_INITIALIZER(type, capacity) { CORE_POOL_OBJECT_SIZE(sizeof(type)), (capacity), NULL, NULL, 0, NULL }
+
+typedef struct core_pool_chunk_s
+{
+	struct core_pool_chunk_s *next;
+} core_pool_chunk_t;
+
+typedef struct core_pool_free_s
+{
+	struct core_pool_free_s *next;
+} core_pool_free_t;
+
+typedef struct core_pool_s
+{
+	size_t object_size;
+	int chunk_capacity;
+	core_pool_chunk_t *chunks;
+	core_pool_chunk_t *chunk;
+	int chunk_used;
+	core_pool_free_t *free_list;
+} core_pool_t;
+
+void *core_pool_allocate(core_pool_t *pool);
+void core_pool_free(core_pool_t *pool, void *object);
+void core_pool_reset(core_pool_t *pool);
+void core_pool_release(core_pool_t *pool);
+
+#endif /* __CORE_POOL_H__ */
@@ -0,0 +1,93 @@
+/*
+ * Copyright (C) 2015 NIPE-SYSTEMS
+ * Copyright (C) 2015 Jonas Krug
+ * Copyright (C) 2015 Tim Gevers
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "core-random.h"
+
+static unsigned long long core_random_rotate(unsigned long long value, int bits);
+
+/**
+ * This function rotates a 64 bit value to the left.
+ * 
+ * @param value The value.
+ * @param bits The amount of bits in [1, 63].
+ * @return The rotated value.
+ */
+static unsigned long long core_random_rotate(unsigned long long value, int bits)
+{
+	return (value << bits) | (value >> (64 - bits));
+}
+
+/**
+ * This function seeds a generator. The state is filled by SplitMix64 from the
+ * seed and the stream, so the streams of one seed are independent of each
+ * other and the state is never all zero.
+ * 
+ * @param random The generator.
+ * @param seed The seed, e.g. the seed of a match.
+ * @param stream The stream which is derived from the seed.
+ */
+void core_random_seed(core_random_t *random, unsigned long long seed, unsigned int stream)
+{
+	int i = 0;
+	
+	seed ^= (unsigned long long)stream * 0xd1342543de82ef95ULL;
+	
+	for(i = 0; i < 4; i++)
+	{
+		seed += 0x9e3779b97f4a7c15ULL;
+		random->state[i] = core_random_mix64(seed);
+	}
+}
+
+/**
+ * This function generates the next pseudo random number of a generator.
+ * 
+ * @param random The generator.
+ * @return The random number.
+ */
+unsigned long long core_random_next(core_random_t *random)
+{
+	unsigned long long result = 0;
+	unsigned long long t = 0;
+	
+	result = core_random_rotate(random->state[1] * 5, 7) * 9;
+	t = random->state[1] << 17;
+	
+	random->state[2] ^= random->state[0];
+	random->state[3] ^= random->state[1];
+	random->state[1] ^= random->state[2];
+	random->state[0] ^= random->state[3];
+	random->state[2] ^= t;
+	random->state[3] = core_random_rotate(random->state[3], 45);
+	
+	return result;
+}
+
+/**
+ * This function generates a pseudo random number in [0, range). The upper
+ * bits are scaled to the range instead of using a modulo.
+ * 
+ * @param random The generator.
+ * @param range The amount of possible numbers, must be greater than 0.
+ * @return The random number.
+ */
+unsigned int core_random_range(core_random_t *random, unsigned int range)
+{
+	return (unsigned int)(((core_random_next(random) >> 32) * range) >> 32);
+}
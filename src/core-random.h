@@ -0,0 +1,58 @@
+/*
+ * Copyright (C) 2015 NIPE-SYSTEMS
+ * Copyright (C) 2015 Jonas Krug
+ * Copyright (C) 2015 Tim Gevers
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __CORE_RANDOM_H__
+#define __CORE_RANDOM_H__
+
+// the independent streams which are derived from the seed of a match
+#define CORE_RANDOM_STREAM_DROPS 1
+#define CORE_RANDOM_STREAM_COSMETIC 2
+#define CORE_RANDOM_STREAM_SEEDS 3
+
+/**
+ * A pseudo random number generator (xoshiro256**). Every user owns its own
+ * generator, so the sequence only depends on the seed and not on other
+ * matches or threads.
+ */
+typedef struct core_random_s
+{
+	unsigned long long state[4];
+} core_random_t;
+
+/**
+ * This function mixes the bits of a 64 bit value by the SplitMix64
+ * finalizer. The seeding of the generators and the Zobrist keys of the
+ * gameplay and of the AI states share it.
+ * 
+ * @param value The value.
+ * @return The mixed value.
+ */
+static inline unsigned long long core_random_mix64(unsigned long long value)
+{
+	value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+	
+	return value ^ (value >> 31);
+}
+
+void core_random_seed(core_random_t *random, unsigned long long seed, unsigned int stream);
+unsigned long long core_random_next(core_random_t *random);
+unsigned int core_random_range(core_random_t *random, unsigned int range);
+
+#endif /* __CORE_RANDOM_H__ */
@@ -24,31 +24,47 @@
 #include <time.h>
 
 #include "core.h"
-#include "random-drop.h"
+#include "core-random.h"
 #include "graphics.h"
 #include "gameplay.h"
-#include "gameplay-players.h"
+#include "gameplay-sim.h"
+#include "gameplay-replay.h"
+#include "gameplay-replay-file.h"
 #include "graphics-sprites.h"
 #include "ai-core.h"
 
-#ifdef DEBUG
-static void core_init_files(void);
-static void core_cleanup_files(void);
-static void core_log(FILE *file, char *fmt, va_list args);
-static FILE *core_file_debug = NULL;
-static FILE *core_file_error = NULL;
-#endif /* DEBUG */
-
 static core_state_t core_state = CORE_START_SCREEN;
 static char core_cutscene_reset = 0;
+static gameplay_sim_state_t core_sim;
+// the terminal shows one match at a time
+static game_context_t *core_context = NULL;
+// every match in the terminal gets a new seed
+static core_random_t core_seeds;
+// the matches are recorded into the replay file, or the replay is played back
+static const char *core_replay_path = NULL;
+static char core_replay_playing = 0;
+static char core_match_running = 0;
+static gameplay_replay_t core_replay;
+static gameplay_replay_file_t core_replay_file;
+static gameplay_replay_playback_t core_playback;
+
+static void core_match_start(void);
+static void core_match_end(void);
+static void core_replay_seek(int ticks);
+
 /**
  * This function initializes everything. It initializes ncurses.
+ * 
+ * @param context The context in which the matches of the terminal run.
  */
-void core_init(void)
+void core_init(game_context_t *context)
 {
-#ifdef DEBUG
-	core_init_files();
-#endif /* DEBUG */
+	unsigned long long seed = 0;
+	
+	core_context = context;
+	seed = time(NULL);
+	
+	core_log_init();
 	
 	initscr();
 	cbreak();
@@ -60,8 +76,124 @@ void core_init(void)
 	curs_set(0);
 	clear();
 	
-	random_drop_init();
-	graphics_sprites_init();
+	core_random_seed(&core_seeds, seed, CORE_RANDOM_STREAM_SEEDS);
+	graphics_sprites_init(seed);
+}
+
+/**
+ * This function records all following matches into a replay file. The file
+ * is written at the end of every match.
+ * 
+ * @param path The path of the replay file.
+ */
+void core_replay_record(const char *path)
+{
+	core_replay_path = path;
+	core_replay_playing = 0;
+}
+
+/**
+ * This function plays back a replay file in real time instead of the first
+ * match.
+ * 
+ * @param path The path of the replay file.
+ * @return 0 on success, -1 if the replay could not be read.
+ */
+int core_replay_play(const char *path)
+{
+	if(gameplay_replay_file_open(&core_replay_file, path) == -1)
+	{
+		return -1;
+	}
+	
+	core_replay_path = NULL;
+	core_replay_playing = 1;
+	
+	return 0;
+}
+
+/**
+ * This function starts a match, a recorded one or the playback of a replay.
+ */
+static void core_match_start(void)
+{
+	core_state = CORE_RUNNING;
+	
+	if(core_replay_playing == 1)
+	{
+		if(gameplay_replay_playback_init(&core_playback, &(core_replay_file.replay), &core_sim, core_context) == -1)
+		{
+			core_state = CORE_MENU;
+			core_replay_playing = 0;
+			gameplay_replay_file_close(&core_replay_file);
+			return;
+		}
+		
+		core_match_running = 1;
+		return;
+	}
+	
+	gameplay_set_seed(core_context, core_random_next(&core_seeds));
+	if(core_replay_path != NULL)
+	{
+		gameplay_replay_init(&core_replay, core_context, GAMEPLAY_REPLAY_HASH_PERIOD, 1);
+	}
+	
+	if(gameplay_sim_init(&core_sim, core_context) == -1)
+	{
+		core_state = CORE_MENU;
+		gameplay_replay_release(&core_replay);
+		return;
+	}
+	
+	core_match_running = 1;
+}
+
+/**
+ * This function ends the current match. A recorded match is written into the
+ * replay file, after a playback the terminal continues with normal matches.
+ */
+static void core_match_end(void)
+{
+	if(core_match_running == 0)
+	{
+		return;
+	}
+	
+	gameplay_sim_cleanup(&core_sim);
+	core_match_running = 0;
+	
+	if(core_replay_playing == 1)
+	{
+		core_replay_playing = 0;
+		gameplay_replay_file_close(&core_replay_file);
+		return;
+	}
+	
+	// the keyframes of the file are created by playing the match back
+	if(core_replay_path != NULL && gameplay_replay_file_save(&core_replay, core_context, core_replay_path) == -1)
+	{
+		core_error("Failed to record match.");
+	}
+	
+	gameplay_replay_release(&core_replay);
+}
+
+/**
+ * This function scrubs through the replay which is played back.
+ * 
+ * @param ticks The amount of ticks to skip, negative values seek backwards.
+ */
+static void core_replay_seek(int ticks)
+{
+	unsigned int tick = 0;
+	
+	tick = (ticks < 0 && core_sim.tick < (unsigned int)-ticks)?(0):(core_sim.tick + ticks);
+	
+	if(gameplay_replay_file_seek(&core_replay_file, &core_playback, tick) == -1)
+	{
+		core_error("Failed to seek to tick %u.", tick);
+	}
 }
 
 /**
@@ -72,17 +204,20 @@ void core_main(void)
 {
 	int character = 0;
 	core_state_t saved_state = CORE_RUNNING;
-	gameplay_players_player_t *player = NULL;
 	char screenshot_request = 0;
+	gameplay_sim_inputs_t inputs;
+	
+	// a replay starts right away
+	if(core_replay_playing == 1)
+	{
+		core_match_start();
+	}
 	
 	while(core_state != CORE_SHUTDOWN)
 	{
 		clear();
 		
-		if(core_state == CORE_RUNNING)
-		{
-			gameplay_update();
-		}
+		gameplay_sim_inputs_clear(&inputs);
 		
 		while((character = getch()) != ERR)
 		{
@@ -93,9 +228,9 @@ void core_main(void)
 				// <V>: Take screenshot
 				// <P>: Pause or resume game loop updating
 				// <W>: Move user player up
-				// <A>: Move user player left
+				// <A>: Move user player left (seek backwards in replays)
 				// <S>: Move user player down
-				// <D>: Move user player right
+				// <D>: Move user player right (seek forwards in replays)
 				// <E>: Pick up item (user player)
 				// <SPACE>: Place bomb (user player), skip start screen, return to menu
 				// <T>: TURBO-MODE
@@ -174,8 +309,8 @@ void core_main(void)
 					// start game
 					if(character == ' ' && core_state == CORE_MENU)
 					{
-						core_state = CORE_RUNNING;
-						gameplay_init();
+						core_match_start();
+						
 						break;
 					}
 					
@@ -191,7 +326,7 @@ void core_main(void)
 					{
 						if(core_state == CORE_RUNNING || core_state == CORE_PAUSED)
 						{
-							gameplay_cleanup();
+							core_match_end();
 						}
 						
 						core_state = CORE_MENU;
@@ -199,10 +334,19 @@ void core_main(void)
 						break;
 					}
 					
-					// only process keyboard input when game is unpaused
-					if(core_state != CORE_PAUSED)
+					// scrub through a replay, also while it is paused
+					if((core_state == CORE_RUNNING || core_state == CORE_PAUSED) && core_replay_playing == 1 && (character == 'a' || character == 'd'))
+					{
+						core_replay_seek((character == 'a')?(-CORE_REPLAY_SEEK):(CORE_REPLAY_SEEK));
+						break;
+					}
+					
+					// only process keyboard input when game is running, the keys
+					// are applied in the next step of the simulation (a replay
+					// brings its own keys)
+					if(core_state == CORE_RUNNING && core_replay_playing == 0)
 					{
-						gameplay_key(character);
+						gameplay_sim_inputs_add(&inputs, character);
 					}
 					
 					break;
@@ -215,6 +359,19 @@ void core_main(void)
 			}
 		}
 		
+		if(core_state == CORE_RUNNING && core_replay_playing == 1)
+		{
+			gameplay_replay_playback_step(&core_playback);
+		}
+		else if(core_state == CORE_RUNNING)
+		{
+			gameplay_sim_step(&core_sim, &inputs);
+			if(core_replay_path != NULL && gameplay_replay_record(&core_replay, &core_sim, &inputs) == -1)
+			{
+				core_error("Failed to record tick %u.", core_sim.tick);
+			}
+		}
+		
 		switch(core_state)
 		{
 			case CORE_START_SCREEN:
@@ -234,25 +391,30 @@ void core_main(void)
 			}
 			case CORE_RUNNING: case CORE_PAUSED:
 			{
-				graphics_render_field();
-				graphics_render_players();
+				graphics_render_field(core_context);
+				graphics_render_players(core_context);
 #ifdef DEBUG_INFO
-				graphics_render_debug();
+				graphics_render_debug(core_context);
 #else
-				graphics_render_information();
+				graphics_render_information(core_context);
 #endif /* DEBUG_INFO */
 				
-				player = gameplay_players_get_user();
-				if(player->health_points == 0)
+				if(core_sim.result == GAMEPLAY_SIM_GAME_OVER)
 				{
 					core_cutscene_reset = 1;
 					core_state = CORE_GAME_OVER;
-					gameplay_cleanup();
+					core_match_end();
 				}
-				else if(gameplay_players_ai_amount() == 0)
+				else if(core_sim.result == GAMEPLAY_SIM_WIN)
 				{
 					core_state = CORE_WIN;
-					gameplay_cleanup();
+					core_match_end();
+				}
+				else if(core_replay_playing == 1 && gameplay_replay_playback_finished(&core_playback) == 1)
+				{
+					// the recording stopped before the match ended
+					core_state = CORE_MENU;
+					core_match_end();
 				}
 				
 				break;
@@ -300,125 +462,15 @@ void core_main(void)
 }
 
 /**
- * This function cleans everything up.
+ * This function cleans everything up. The context is destroyed by the caller.
  */
 void core_cleanup(void)
 {
 	graphics_sprites_cleanup();
-	gameplay_cleanup();
+	core_match_end();
+	gameplay_cleanup(core_context);
 	
 	endwin();
 	
-#ifdef DEBUG
-	core_cleanup_files();
-#endif /* DEBUG */
-}
-
-#ifdef DEBUG
-
-/**
- * This function initializes output files.
- */
-static void core_init_files(void)
-{
-	core_file_debug = fopen("debug.log", "a");
-	if(core_file_debug == NULL)
-	{
-		fprintf(stderr, "Failed to open debug log fvoid core_init(void)ile.\n");
-		exit(1);
-		return;
-	}
-	
-	core_file_error = fopen("error.log", "a");
-	if(core_file_error == NULL)
-	{
-		fprintf(stderr, "Failed to open error log file.\n");
-		fclose(core_file_debug);
-		exit(1);
-		return;
-	}
-	
-	core_debug("");
-	core_debug(" +----------------------+");
-	core_debug(" | TURBO BOMBER STARTED |");
-	core_debug(" +----------------------+");
-	core_debug("");
-	core_debug("Log system initialized.");
-}
-
-/**
- * This function cleans up output files.
- */
-static void core_cleanup_files(void)
-{
-	core_debug("");
-	core_debug(" +----------------------+");
-	core_debug(" | TURBO BOMBER STOPPED |");
-	core_debug(" +----------------------+");
-	core_debug("");
-	
-	if(core_file_debug != NULL)
-	{
-		fclose(core_file_debug);
-	}
-	
-	if(core_file_error != NULL)
-	{
-		fclose(core_file_error);
-	}
+	core_log_cleanup();
 }
-
-/**
- * This function generates a log message and writes it to a file pointer.
- */
-static void core_log(FILE *file, char *fmt, va_list args)
-{
-	char time_buffer[80];
-	time_t rawtime;
-	struct tm * timeinfo;
-	
-	time(&rawtime);
-	timeinfo = localtime(&rawtime);
-	
-	strftime(time_buffer, 80, "%c: ", timeinfo);
-	
-	fwrite(time_buffer, strlen(time_buffer), 1, file);
-	
-	vfprintf(file, fmt, args);
-	
-	fwrite("\n", strlen("\n"), 1, file);
-	
-	fflush(file);
-}
-
-/**
- * This function outputs a debug message to the debug logging file.
- * 
- * @param fmt The format string like in "printf".
- * @param ... The arguments for the format like in "printf".
- */
-void core_debug(char *fmt, ...)
-{
-	va_list args;
-	
-	va_start(args, fmt);
-	core_log(core_file_debug, fmt, args);
-	va_end(args);
-}
-
-/**
- * This function outputs an error message to the error logging file.
- * 
- * @param fmt The format string like in "printf".
- * @param ... The arguments for the format like in "printf".
- */
-void core_error(char *fmt, ...)
-{
-	va_list args;
-	
-	va_start(args, fmt);
-	core_log(core_file_error, fmt, args);
-	va_end(args);
-}
-
-#endif /* DEBUG */
@@ -20,11 +20,12 @@
 #ifndef __CORE_H__
 #define __CORE_H__
 
-#include <stdarg.h>
-#include <stdio.h>
+#include "core-log.h"
+#include "game-context.h"
 
 // #define CORE_FRAME_TIME 100000 // -> 10 fps, specified in microseconds (usleep)
 #define CORE_FRAME_TIME 75000 // -> 10 fps, specified in microseconds (usleep)
+#define CORE_REPLAY_SEEK (10000000 / CORE_FRAME_TIME) // ticks skipped when scrubbing through a replay (10 seconds)
 
 typedef enum core_state_e
 {
@@ -38,16 +39,10 @@ typedef enum core_state_e
 	CORE_SHUTDOWN
 } core_state_t;
 
-void core_init(void);
+void core_init(game_context_t *context);
+void core_replay_record(const char *path);
+int core_replay_play(const char *path);
 void core_main(void);
 void core_cleanup(void);
 
-#ifdef DEBUG
-void core_debug(char *fmt, ...);
-void core_error(char *fmt, ...);
-#else
-#define core_debug(...) ((void)0)
-#define core_error(...) ((void)0)
-#endif /* DEBUG */
-
 #endif /* __CORE_H__ */
\ No newline at end of file
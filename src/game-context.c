@@ -0,0 +1,67 @@
+/*
+ * Copyright (C) 2015 NIPE-SYSTEMS
+ * Copyright (C) 2015 Jonas Krug
+ * Copyright (C) 2015 Tim Gevers
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+
+#include "game-context.h"
+#include "gameplay.h"
+#include "core-log.h"
+
+/**
+ * This function creates the context of a match with the default field size.
+ * The modules allocate their parts when the first match is initialized.
+ * 
+ * @return The context or NULL on error.
+ */
+game_context_t *game_context_create(void)
+{
+	game_context_t *context = NULL;
+	
+	context = calloc(1, sizeof(game_context_t));
+	if(context == NULL)
+	{
+		core_error("Failed to allocate game context.");
+		return NULL;
+	}
+	
+	context->field_width = GAMEPLAY_FIELD_SIZE_DEFAULT;
+	context->field_height = GAMEPLAY_FIELD_SIZE_DEFAULT;
+	context->size_width = GAMEPLAY_FIELD_SIZE_DEFAULT;
+	context->size_height = GAMEPLAY_FIELD_SIZE_DEFAULT;
+	context->seed = GAMEPLAY_SEED_DEFAULT;
+	
+	return context;
+}
+
+/**
+ * This function frees a context and all parts of the modules. A running match
+ * has to be cleaned up before.
+ * 
+ * @param context The context.
+ */
+void game_context_destroy(game_context_t *context)
+{
+	if(context == NULL)
+	{
+		return;
+	}
+	
+	gameplay_release(context);
+	free(context);
+}
@@ -0,0 +1,75 @@
+/*
+ * Copyright (C) 2015 NIPE-SYSTEMS
+ * Copyright (C) 2015 Jonas Krug
+ * Copyright (C) 2015 Tim Gevers
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GAME_CONTEXT_H__
+#define __GAME_CONTEXT_H__
+
+// the contexts of the modules are private to the modules, every module
+// allocates its context when it is initialized for the first time
+typedef struct gameplay_context_s gameplay_context_t;
+typedef struct gameplay_timers_context_s gameplay_timers_context_t;
+typedef struct gameplay_events_context_s gameplay_events_context_t;
+typedef struct gameplay_bombs_context_s gameplay_bombs_context_t;
+typedef struct gameplay_players_context_s gameplay_players_context_t;
+typedef struct gameplay_items_context_s gameplay_items_context_t;
+typedef struct ai_jobs_context_s ai_jobs_context_t;
+typedef struct ai_pathfinding_context_s ai_pathfinding_context_t;
+typedef struct ai_simulation_context_s ai_simulation_context_t;
+typedef struct ai_heatmap_context_s ai_heatmap_context_t;
+typedef struct ai_openings_context_s ai_openings_context_t;
+typedef struct ai_mcts_context_s ai_mcts_context_t;
+typedef struct ai_beam_context_s ai_beam_context_t;
+typedef struct ai_endgame_context_s ai_endgame_context_t;
+typedef struct ai_background_context_s ai_background_context_t;
+
+/**
+ * The complete state of one match. The gameplay and the AI only work on the
+ * context which is passed to them, so every thread can run its own matches.
+ */
+typedef struct game_context_s
+{
+	// the size of the current match and the size of the next match
+	int field_width;
+	int field_height;
+	int size_width;
+	int size_height;
+	// the seed of the random numbers of the next match
+	unsigned long long seed;
+	
+	gameplay_context_t *gameplay;
+	gameplay_timers_context_t *timers;
+	gameplay_events_context_t *events;
+	gameplay_bombs_context_t *bombs;
+	gameplay_players_context_t *players;
+	gameplay_items_context_t *items;
+	ai_jobs_context_t *jobs;
+	ai_pathfinding_context_t *pathfinding;
+	ai_simulation_context_t *simulation;
+	ai_heatmap_context_t *heatmap;
+	ai_openings_context_t *openings;
+	ai_mcts_context_t *mcts;
+	ai_beam_context_t *beam;
+	ai_endgame_context_t *endgame;
+	ai_background_context_t *background;
+} game_context_t;
+
+game_context_t *game_context_create(void);
+void game_context_destroy(game_context_t *context);
+
+#endif /* __GAME_CONTEXT_H__ */
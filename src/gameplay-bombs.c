@@ -18,31 +18,97 @@
  */
 
 #include <stdlib.h>
+#include <string.h>
 
 #include "gameplay-bombs.h"
 #include "gameplay-players.h"
-#include "core.h"
+#include "gameplay-events.h"
+#include "core-log.h"
 #include "ai-simulation.h"
 #include "gameplay-items.h"
 #include "gameplay.h"
+#include "core-pool.h"
+#include "gameplay-snapshot.h"
 
-static void gameplay_bombs_trigger_explosion(int position_x, int position_y);
+static void gameplay_bombs_detonate(game_context_t *context, gameplay_bombs_bomb_t *bomb);
+static int gameplay_bombs_blast_mark(game_context_t *context, int index);
+static void gameplay_bombs_blast_add(game_context_t *context, gameplay_bombs_bomb_t *bomb);
+static void gameplay_bombs_blast_apply(game_context_t *context);
+static unsigned long long gameplay_bombs_key(game_context_t *context, gameplay_bombs_bomb_t *bomb);
 
-gameplay_bombs_bomb_t *gameplay_bombs_bombs = NULL;
+struct gameplay_bombs_context_s
+{
+	gameplay_bombs_bomb_t *bombs;
+	
+	// the bombs of a match, freed at once when the match ends
+	core_pool_t pool;
+	
+	// the bomb on each tile (the first bomb of the list on the tile)
+	gameplay_bombs_bomb_t **grid;
+	
+	// the bombs which explode in the current tick (the work queue of the
+	// chain reaction)
+	gameplay_bombs_bomb_t **queue;
+	int queue_amount;
+	
+	// the tiles which are hit by the explosions of the current tick, every
+	// tile is marked once in the bitmap and listed once
+	unsigned char *blast;
+	int *blast_tiles;
+	int blast_amount;
+};
+
+/**
+ * This function allocates the bomb grid and the blast bitmap for the size of
+ * the field.
+ * 
+ * @param context The context of the match.
+ * @return 0 on success, -1 on error.
+ */
+int gameplay_bombs_init(game_context_t *context)
+{
+	if(context->bombs == NULL)
+	{
+		context->bombs = calloc(1, sizeof(gameplay_bombs_context_t));
+		if(context->bombs == NULL)
+		{
+			return -1;
+		}
+		
+		context->bombs->pool = (core_pool_t)CORE_POOL_INITIALIZER(gameplay_bombs_bomb_t, GAMEPLAY_BOMBS_POOL_CHUNK);
+	}
+	
+	context->bombs->grid = gameplay_allocate_tiles(context, context->bombs->grid, sizeof(gameplay_bombs_bomb_t *));
+	context->bombs->queue = gameplay_allocate_tiles(context, context->bombs->queue, sizeof(gameplay_bombs_bomb_t *));
+	context->bombs->blast = gameplay_allocate_tiles(context, context->bombs->blast, sizeof(unsigned char));
+	context->bombs->blast_tiles = gameplay_allocate_tiles(context, context->bombs->blast_tiles, sizeof(int));
+	if(context->bombs->grid == NULL || context->bombs->queue == NULL || context->bombs->blast == NULL || context->bombs->blast_tiles == NULL)
+	{
+		return -1;
+	}
+	
+	memset(context->bombs->grid, 0, GAMEPLAY_FIELD_TILES(context) * sizeof(gameplay_bombs_bomb_t *));
+	memset(context->bombs->blast, 0, GAMEPLAY_FIELD_TILES(context));
+	context->bombs->queue_amount = 0;
+	context->bombs->blast_amount = 0;
+	
+	return 0;
+}
 
 /**
  * This function adds a bomb to the bomb list.
  * 
+ * @param context The context of the match.
  * @param player The player which has placed the bomb. (Owner of the bomb.)
  * @param position_x The x coordinate of the simulated bomb.
  * @param position_y The y coordinate of the simulated bomb.
  */
-void gameplay_bombs_add(gameplay_players_player_t *player, int position_x, int position_y)
+void gameplay_bombs_add(game_context_t *context, gameplay_players_player_t *player, int position_x, int position_y)
 {
 	gameplay_bombs_bomb_t *bomb = NULL;
 	gameplay_bombs_bomb_t *current = NULL;
 	
-	bomb = malloc(sizeof(gameplay_bombs_bomb_t));
+	bomb = core_pool_allocate(&context->bombs->pool);
 	if(bomb == NULL)
 	{
 		core_error("Failed to allocate bomb.");
@@ -51,63 +117,94 @@ void gameplay_bombs_add(gameplay_players_player_t *player, int position_x, int p
 	
 	bomb->position_x = position_x;
 	bomb->position_y = position_y;
-	bomb->explosion_timeout = GAMEPLAY_BOMBS_EXPLOSION_TIMEOUT;
+	// the bomb explodes after GAMEPLAY_BOMBS_EXPLOSION_TIMEOUT full bomb updates
+	bomb->explosion_tick = gameplay_timers_get_tick(context) + GAMEPLAY_BOMBS_EXPLOSION_TIMEOUT + 1;
+	bomb->explosion_radius = player->explosion_radius;
 	bomb->owner = player;
 	bomb->next = NULL;
+	bomb->timer.scheduled = 0;
+	gameplay_timers_schedule(context, GAMEPLAY_TIMERS_WHEEL_BOMBS, &(bomb->timer), bomb->explosion_tick, bomb);
+	gameplay_hash_toggle(context, gameplay_bombs_key(context, bomb));
+	gameplay_events_push(context, GAMEPLAY_EVENTS_BOMB_PLACED, position_x, position_y, player->id);
 	
 	// append to bombs list at end
-	for(current = gameplay_bombs_bombs; current != NULL && current->next != NULL; current = current->next);
+	for(current = context->bombs->bombs; current != NULL && current->next != NULL; current = current->next);
 	
 	if(current == NULL)
 	{
-		bomb->next = gameplay_bombs_bombs;
-		gameplay_bombs_bombs = bomb;
+		bomb->next = context->bombs->bombs;
+		context->bombs->bombs = bomb;
 	}
 	else
 	{
 		current->next = bomb;
 	}
 	
-	core_debug("Added bomb %p at (%i, %i)", gameplay_bombs_bombs, position_x, position_y);
+	if(GAMEPLAY_FIELD(context, context->bombs->grid, position_x, position_y) == NULL)
+	{
+		GAMEPLAY_FIELD(context, context->bombs->grid, position_x, position_y) = bomb;
+	}
+	
+	core_debug("Added bomb %p at (%i, %i)", context->bombs->bombs, position_x, position_y);
 }
 
 /**
- * This function cleans up all bombs in the bomb list.
+ * This function cleans up all bombs in the bomb list. The bombs are freed at
+ * once by resetting the pool, their timers are dropped by the next
+ * initialization of the timers and the grid is cleared by the next
+ * initialization of the bombs.
+ * 
+ * @param context The context of the match.
  */
-void gameplay_bombs_cleanup(void)
+void gameplay_bombs_cleanup(game_context_t *context)
 {
-	gameplay_bombs_bomb_t *current = NULL;
-	gameplay_bombs_bomb_t *next_backup = NULL;
-	
 	core_debug("Cleanup bombs...");
 	
-	for(current = gameplay_bombs_bombs; current != NULL; current = next_backup)
+	if(context->bombs == NULL)
 	{
-		next_backup = current->next;
-		free(current);
+		return;
+	}
+	
+	core_pool_reset(&context->bombs->pool);
+	context->bombs->bombs = NULL;
+}
+
+/**
+ * This function releases the memory of the bombs. It is called when the game
+ * is shut down.
+ * 
+ * @param context The context of the match.
+ */
+void gameplay_bombs_release(game_context_t *context)
+{
+	if(context->bombs == NULL)
+	{
+		return;
 	}
 	
-	gameplay_bombs_bombs = NULL;
+	gameplay_bombs_cleanup(context);
+	core_pool_release(&context->bombs->pool);
+	free(context->bombs->grid);
+	free(context->bombs->queue);
+	free(context->bombs->blast);
+	free(context->bombs->blast_tiles);
+	free(context->bombs);
+	context->bombs = NULL;
 }
 
 /**
  * This function removes a bomb from the bomb list.
  * 
+ * @param context The context of the match.
  * @param position_x The x coordinate of the bomb.
  * @param position_y The y coordinate of the bomb.
  */
-void gameplay_bombs_remove(int position_x, int position_y)
+void gameplay_bombs_remove(game_context_t *context, int position_x, int position_y)
 {
 	gameplay_bombs_bomb_t *current = NULL;
 	gameplay_bombs_bomb_t *next_backup = NULL;
 	
-	for(current = gameplay_bombs_bombs; current != NULL; current = current->next)
-	{
-		if(current->position_x == position_x && current->position_y == position_y)
-		{
-			break;
-		}
-	}
+	current = gameplay_bombs_get_bomb(context, position_x, position_y);
 	
 	// cancel if nothing found
 	if(current == NULL)
@@ -116,24 +213,44 @@ void gameplay_bombs_remove(int position_x, int position_y)
 	}
 	
 	// give the player the ability to place another bomb
-	current->owner->placed_bombs--;
+	if(current->owner != NULL)
+	{
+		gameplay_hash_toggle(context, gameplay_players_key(context, current->owner));
+		current->owner->placed_bombs--;
+		gameplay_hash_toggle(context, gameplay_players_key(context, current->owner));
+	}
+	
+	gameplay_hash_toggle(context, gameplay_bombs_key(context, current));
+	gameplay_timers_cancel(context, &(current->timer));
+	
+	// another bomb on the same tile takes over the tile (only possible while
+	// an exploding bomb waits for the next update)
+	GAMEPLAY_FIELD(context, context->bombs->grid, position_x, position_y) = NULL;
+	for(next_backup = current->next; next_backup != NULL; next_backup = next_backup->next)
+	{
+		if(next_backup->position_x == position_x && next_backup->position_y == position_y)
+		{
+			GAMEPLAY_FIELD(context, context->bombs->grid, position_x, position_y) = next_backup;
+			break;
+		}
+	}
 	
 	// list start
-	if(current == gameplay_bombs_bombs)
+	if(current == context->bombs->bombs)
 	{
 		next_backup = current->next;
-		free(current);
-		gameplay_bombs_bombs = next_backup;
+		core_pool_free(&context->bombs->pool, current);
+		context->bombs->bombs = next_backup;
 		return;
 	}
 	
 	// rest of the list
-	for(current = gameplay_bombs_bombs; current->next != NULL; current = current->next)
+	for(current = context->bombs->bombs; current->next != NULL; current = current->next)
 	{
 		if(current->next->position_x == position_x && current->next->position_y == position_y)
 		{
 			next_backup = current->next->next;
-			free(current->next);
+			core_pool_free(&context->bombs->pool, current->next);
 			current->next = next_backup;
 			break;
 		}
@@ -141,168 +258,362 @@ void gameplay_bombs_remove(int position_x, int position_y)
 }
 
 /**
- * This function handles the explosion of a bomb on the field.
+ * This function detaches all bombs from a player which is removed from the
+ * game. The bombs explode as usual but have no owner anymore.
  * 
- * @param position_x The x coordinate of the bomb.
- * @param position_y The y coordinate of the bomb.
+ * @param context The context of the match.
+ * @param player The player which is removed.
  */
-static void gameplay_bombs_explosion(int position_x, int position_y)
+void gameplay_bombs_disown(game_context_t *context, gameplay_players_player_t *player)
 {
-	int x = 0;
-	int y = 0;
-	
-	gameplay_bombs_bomb_t *bomb = NULL;
-	
-	bomb = gameplay_bombs_get_bomb(position_x, position_y);
-	if(bomb == NULL)
-	{
-		return;
-	}
+	gameplay_bombs_bomb_t *current = NULL;
 	
-	for(x = position_x; x < GAMEPLAY_FIELD_WIDTH && x < position_x + bomb->owner->explosion_radius; x++)
+	for(current = context->bombs->bombs; current != NULL; current = current->next)
 	{
-		gameplay_players_harm(x, position_y);
-		gameplay_bombs_trigger_explosion(x, position_y);
-		if(!gameplay_get_walkable(x, position_y, 1))
+		if(current->owner == player)
 		{
-			gameplay_destroy(x, position_y);
-			gameplay_set_fire(x, position_y);
-			break;
+			gameplay_hash_toggle(context, gameplay_bombs_key(context, current));
+			current->owner = NULL;
+			gameplay_hash_toggle(context, gameplay_bombs_key(context, current));
 		}
-		else if(gameplay_items_test_remove(x, position_y) == 1)
-		{
-			gameplay_set_fire(x, position_y);
-			break;
-		}
-		gameplay_set_fire(x, position_y);
 	}
+}
+
+/**
+ * This function adds a bomb to the bombs which explode in the current tick.
+ * The tile of the bomb is marked in the blast bitmap.
+ * 
+ * @param context The context of the match.
+ * @param bomb The bomb which explodes.
+ */
+static void gameplay_bombs_detonate(game_context_t *context, gameplay_bombs_bomb_t *bomb)
+{
+	if(context->bombs->queue_amount >= GAMEPLAY_FIELD_TILES(context))
+	{
+		core_error("Too many exploding bombs.");
+		return;
+	}
+	
+	gameplay_timers_cancel(context, &(bomb->timer));
+	gameplay_hash_toggle(context, gameplay_bombs_key(context, bomb));
+	bomb->explosion_tick = gameplay_timers_get_tick(context);
+	gameplay_hash_toggle(context, gameplay_bombs_key(context, bomb));
+	context->bombs->queue[context->bombs->queue_amount++] = bomb;
 	
-	for(x = position_x - 1; x > 0 && x > position_x - bomb->owner->explosion_radius; x--)
+	gameplay_bombs_blast_mark(context, bomb->position_y * GAMEPLAY_FIELD_WIDTH(context) + bomb->position_x);
+}
+
+/**
+ * This function marks a tile in the blast bitmap. Every tile is only marked
+ * once per tick, a bomb on a newly marked tile is triggered.
+ * 
+ * @param context The context of the match.
+ * @param index The index of the tile.
+ * @return 1 if the tile was newly marked, 0 if it was already marked.
+ */
+static int gameplay_bombs_blast_mark(game_context_t *context, int index)
+{
+	if(context->bombs->blast[index] == 1)
 	{
-		gameplay_players_harm(x, position_y);
-		gameplay_bombs_trigger_explosion(x, position_y);
-		if(!gameplay_get_walkable(x, position_y, 1))
-		{
-			gameplay_destroy(x, position_y);
-			gameplay_set_fire(x, position_y);
-			break;
-		}
-		else if(gameplay_items_test_remove(x, position_y) == 1)
-		{
-			gameplay_set_fire(x, position_y);
-			break;
-		}
-		gameplay_set_fire(x, position_y);
+		return 0;
 	}
 	
-	for(y = position_y; y < GAMEPLAY_FIELD_HEIGHT && y < position_y + bomb->owner->explosion_radius; y++)
+	context->bombs->blast[index] = 1;
+	context->bombs->blast_tiles[context->bombs->blast_amount++] = index;
+	
+	return 1;
+}
+
+/**
+ * This function marks the tiles of the explosion of a bomb in the blast
+ * bitmap. The rays stop at the first tile which is no floor or has an item.
+ * The rays are traced on the field before any tile of this tick is destroyed,
+ * so the result does not depend on the order of the bombs. Bombs on the rays
+ * are added to the exploding bombs.
+ * 
+ * @param context The context of the match.
+ * @param bomb The bomb which explodes.
+ */
+static void gameplay_bombs_blast_add(game_context_t *context, gameplay_bombs_bomb_t *bomb)
+{
+	int i = 0;
+	int distance = 0;
+	int x = 0;
+	int y = 0;
+	int index = 0;
+	int direction_x[] = { 0, 1, 0, -1 };
+	int direction_y[] = { -1, 0, 1, 0 };
+	gameplay_bombs_bomb_t *triggered = NULL;
+	
+	for(i = 0; i < 4; i++)
 	{
-		gameplay_players_harm(position_x, y);
-		gameplay_bombs_trigger_explosion(position_x, y);
-		if(!gameplay_get_walkable(position_x, y, 1))
-		{
-			gameplay_destroy(position_x, y);
-			gameplay_set_fire(position_x, y);
-			break;
-		}
-		else if(gameplay_items_test_remove(position_x, y) == 1)
+		for(distance = 1; distance < bomb->explosion_radius; distance++)
 		{
-			gameplay_set_fire(position_x, y);
-			break;
+			x = bomb->position_x + direction_x[i] * distance;
+			y = bomb->position_y + direction_y[i] * distance;
+			
+			// explosions never reach the first row and column
+			if(x <= 0 || y <= 0 || x >= GAMEPLAY_FIELD_WIDTH(context) || y >= GAMEPLAY_FIELD_HEIGHT(context))
+			{
+				break;
+			}
+			
+			index = y * GAMEPLAY_FIELD_WIDTH(context) + x;
+			if(gameplay_bombs_blast_mark(context, index) == 1)
+			{
+				triggered = context->bombs->grid[index];
+				if(triggered != NULL)
+				{
+					gameplay_bombs_detonate(context, triggered);
+				}
+			}
+			
+			if(!gameplay_get_walkable(context, x, y, 1) || gameplay_items_item_placed(context, x, y) == 1)
+			{
+				break;
+			}
 		}
-		gameplay_set_fire(position_x, y);
 	}
+}
+
+/**
+ * This function applies the marked tiles of the blast bitmap in one pass:
+ * Players are harmed, walls are destroyed, items are removed and the tiles
+ * are set on fire. Afterwards the bitmap is cleared.
+ * 
+ * @param context The context of the match.
+ */
+static void gameplay_bombs_blast_apply(game_context_t *context)
+{
+	int i = 0;
+	int x = 0;
+	int y = 0;
 	
-	for(y = position_y - 1; y > 0 && y > position_y - bomb->owner->explosion_radius; y--)
+	for(i = 0; i < context->bombs->blast_amount; i++)
 	{
-		gameplay_players_harm(position_x, y);
-		gameplay_bombs_trigger_explosion(position_x, y);
-		if(!gameplay_get_walkable(position_x, y, 1))
+		x = context->bombs->blast_tiles[i] % GAMEPLAY_FIELD_WIDTH(context);
+		y = context->bombs->blast_tiles[i] / GAMEPLAY_FIELD_WIDTH(context);
+		
+		gameplay_players_harm(context, x, y);
+		
+		if(!gameplay_get_walkable(context, x, y, 1))
 		{
-			gameplay_destroy(position_x, y);
-			gameplay_set_fire(position_x, y);
-			break;
+			gameplay_destroy(context, x, y);
 		}
-		else if(gameplay_items_test_remove(position_x, y) == 1)
+		else
 		{
-			gameplay_set_fire(position_x, y);
-			break;
+			gameplay_items_test_remove(context, x, y);
 		}
-		gameplay_set_fire(position_x, y);
+		
+		gameplay_set_fire(context, x, y);
+		
+		context->bombs->blast[context->bombs->blast_tiles[i]] = 0;
 	}
+	
+	context->bombs->blast_amount = 0;
 }
 
 /**
- * This function updates a bomb. (Timing, etc.)
+ * This function updates all bombs. The bombs which are due explode together
+ * with all bombs they trigger: The chain reaction is expanded breadth-first
+ * through the queue of exploding bombs, then all blasted tiles are applied at
+ * once. The other bombs are simulated for the AI.
  * 
- * @param bomb The bomb which should be updated.
+ * @param context The context of the match.
  */
-static void gameplay_bombs_bomb_update(gameplay_bombs_bomb_t *bomb)
+void gameplay_bombs_update(game_context_t *context)
 {
-	if(bomb->explosion_timeout == 0 )
+	int i = 0;
+	gameplay_bombs_bomb_t *current = NULL;
+	gameplay_timers_timer_t *timer = NULL;
+	
+	ai_simulation_reset(context);
+	
+	context->bombs->queue_amount = 0;
+	while((timer = gameplay_timers_next_due(context, GAMEPLAY_TIMERS_WHEEL_BOMBS)) != NULL)
 	{
-		gameplay_bombs_explosion(bomb->position_x, bomb->position_y);
-		gameplay_bombs_remove(bomb->position_x, bomb->position_y);
-		return;
+		gameplay_bombs_detonate(context, timer->data);
 	}
 	
-	if(bomb->explosion_timeout > 0)
+	// triggered bombs are appended to the queue while it is processed
+	for(i = 0; i < context->bombs->queue_amount; i++)
 	{
-		bomb->explosion_timeout--;
+		gameplay_bombs_blast_add(context, context->bombs->queue[i]);
 	}
 	
-	ai_simulation_explosion(bomb->position_x, bomb->position_y, bomb->owner->explosion_radius, 0);
+	gameplay_bombs_blast_apply(context);
+	
+	for(i = 0; i < context->bombs->queue_amount; i++)
+	{
+		current = context->bombs->queue[i];
+		gameplay_events_push(context, GAMEPLAY_EVENTS_BOMB_EXPLODED, current->position_x, current->position_y, (current->owner == NULL)?(-1):(current->owner->id));
+		gameplay_bombs_remove(context, current->position_x, current->position_y);
+	}
+	
+	context->bombs->queue_amount = 0;
+	
+	for(current = context->bombs->bombs; current != NULL; current = current->next)
+	{
+		ai_simulation_explosion(context, current->position_x, current->position_y, current->explosion_radius, 0);
+	}
+	
+	ai_simulation_copy_fire(context);
 }
 
 /**
- * This function updates a bomb. (Timing, etc.)
+ * This function returns the amount of bombs in the bomb list.
+ * 
+ * @param context The context of the match.
+ * @return The amount of bombs.
  */
-void gameplay_bombs_update(void)
+int gameplay_bombs_amount(game_context_t *context)
 {
 	gameplay_bombs_bomb_t *current = NULL;
-	gameplay_bombs_bomb_t *next_backup = NULL;
+	int amount = 0;
 	
-	ai_simulation_reset();
+	for(current = context->bombs->bombs; current != NULL; current = current->next)
+	{
+		amount++;
+	}
+	
+	return amount;
+}
+
+/**
+ * This function calculates the Zobrist key of a bomb.
+ * 
+ * @param context The context of the match.
+ * @param bomb The bomb.
+ * @return The key.
+ */
+static unsigned long long gameplay_bombs_key(game_context_t *context, gameplay_bombs_bomb_t *bomb)
+{
+	int index = 0;
+	
+	index = bomb->position_y * GAMEPLAY_FIELD_WIDTH(context) + bomb->position_x;
+	
+	return gameplay_hash_key(GAMEPLAY_HASH_BOMB + index, bomb->explosion_tick) ^ gameplay_hash_key(GAMEPLAY_HASH_BOMB_OWNER + index, (unsigned int)((bomb->owner == NULL)?(0):(bomb->owner->id + 1)) << 16 | bomb->explosion_radius);
+}
+
+/**
+ * This function calculates the part of the hash of the gameplay state which
+ * belongs to the bombs.
+ * 
+ * @param context The context of the match.
+ * @return The hash of the bombs.
+ */
+unsigned long long gameplay_bombs_hash(game_context_t *context)
+{
+	unsigned long long hash = 0;
+	gameplay_bombs_bomb_t *current = NULL;
 	
-	for(current = gameplay_bombs_bombs; current != NULL; current = next_backup)
+	for(current = context->bombs->bombs; current != NULL; current = current->next)
 	{
-		next_backup = current->next;
-		gameplay_bombs_bomb_update(current);
+		hash ^= gameplay_bombs_key(context, current);
 	}
 	
-	ai_simulation_copy_fire();
+	return hash;
 }
 
 /**
- * This function returns the amount of bombs in the bomb list.
+ * This function writes the bombs into a snapshot in the order of the bomb
+ * list. Bombs are never rescheduled, so this is also the order of their
+ * timers.
  * 
- * @return The amount of bombs.
+ * @param context The context of the match.
+ * @param snapshot The snapshot with the sections already placed.
  */
-int gameplay_bombs_amount(void)
+void gameplay_bombs_capture(game_context_t *context, gameplay_snapshot_t *snapshot)
 {
+	int i = 0;
 	gameplay_bombs_bomb_t *current = NULL;
-	int amount = 0;
+	gameplay_snapshot_bomb_t *record = NULL;
 	
-	for(current = gameplay_bombs_bombs; current != NULL; current = current->next)
+	for(current = context->bombs->bombs; current != NULL && i < snapshot->bombs_amount; current = current->next)
 	{
-		amount++;
+		record = &(GAMEPLAY_SNAPSHOT_SECTION(snapshot, gameplay_snapshot_bomb_t, bombs)[i++]);
+		record->index = current->position_y * GAMEPLAY_FIELD_WIDTH(context) + current->position_x;
+		record->owner = (current->owner == NULL)?(-1):(gameplay_players_get_index(context, current->owner));
+		record->explosion_radius = current->explosion_radius;
+		record->explosion_tick = current->explosion_tick;
+	}
+}
+
+/**
+ * This function replaces the bombs by the ones of a snapshot. The players
+ * must be restored before, the wheels must be emptied before.
+ * 
+ * @param context The context of the match.
+ * @param snapshot The snapshot.
+ * @return 0 on success, -1 on error.
+ */
+int gameplay_bombs_restore(game_context_t *context, const gameplay_snapshot_t *snapshot)
+{
+	int i = 0;
+	gameplay_bombs_bomb_t *bomb = NULL;
+	gameplay_bombs_bomb_t *last = NULL;
+	const gameplay_snapshot_bomb_t *records = NULL;
+	
+	// only the tiles of the current bombs have to be cleared in the grid
+	for(bomb = context->bombs->bombs; bomb != NULL; bomb = bomb->next)
+	{
+		GAMEPLAY_FIELD(context, context->bombs->grid, bomb->position_x, bomb->position_y) = NULL;
 	}
 	
-	return amount;
+	gameplay_bombs_cleanup(context);
+	
+	records = GAMEPLAY_SNAPSHOT_SECTION(snapshot, gameplay_snapshot_bomb_t, bombs);
+	for(i = 0; i < snapshot->bombs_amount; i++)
+	{
+		bomb = core_pool_allocate(&context->bombs->pool);
+		if(bomb == NULL)
+		{
+			core_error("Failed to allocate bomb.");
+			return -1;
+		}
+		
+		bomb->position_x = records[i].index % GAMEPLAY_FIELD_WIDTH(context);
+		bomb->position_y = records[i].index / GAMEPLAY_FIELD_WIDTH(context);
+		bomb->explosion_tick = records[i].explosion_tick;
+		bomb->explosion_radius = records[i].explosion_radius;
+		bomb->owner = (records[i].owner == -1)?(NULL):(gameplay_players_get(context, records[i].owner));
+		bomb->next = NULL;
+		bomb->timer.scheduled = 0;
+		gameplay_timers_schedule(context, GAMEPLAY_TIMERS_WHEEL_BOMBS, &(bomb->timer), bomb->explosion_tick, bomb);
+		
+		if(last == NULL)
+		{
+			context->bombs->bombs = bomb;
+		}
+		else
+		{
+			last->next = bomb;
+		}
+		
+		last = bomb;
+		
+		if(context->bombs->grid[records[i].index] == NULL)
+		{
+			context->bombs->grid[records[i].index] = bomb;
+		}
+	}
+	
+	return 0;
 }
 
 /**
  * This function returns the bomb with the given index.
  * 
+ * @param context The context of the match.
  * @param index The index of the bomb.
  * @return The selected bomb.
  */
-gameplay_bombs_bomb_t *gameplay_bombs_get(int index)
+gameplay_bombs_bomb_t *gameplay_bombs_get(game_context_t *context, int index)
 {
 	gameplay_bombs_bomb_t *current = NULL;
 	int i = 0;
 	
-	for(current = gameplay_bombs_bombs; current != NULL; current = current->next)
+	for(current = context->bombs->bombs; current != NULL; current = current->next)
 	{
 		if(index == i)
 		{
@@ -316,60 +627,66 @@ gameplay_bombs_bomb_t *gameplay_bombs_get(int index)
 }
 
 /**
- * This function returns if a bomb is placed at the given position.
+ * This function returns the first bomb of the bomb list. The other bombs
+ * follow by their "next" pointers, so all bombs are visited in linear time.
  * 
- * @param position_x The x coordinate of the tile.
- * @param position_y The y coordinate of the tile.
- * @return 1 if a bomb is placed, 0 if not.
+ * @param context The context of the match.
+ * @return The first bomb or NULL if there are no bombs.
  */
-int gameplay_bombs_get_bomb_placed(int position_x, int position_y)
+gameplay_bombs_bomb_t *gameplay_bombs_get_list(game_context_t *context)
 {
-	gameplay_bombs_bomb_t *current = NULL;
-	
-	for(current = gameplay_bombs_bombs; current != NULL; current = current->next)
+	return context->bombs->bombs;
+}
+
+/**
+ * This function returns the amount of bomb updates until a bomb explodes. A
+ * bomb with a timeout of 0 explodes at the next update.
+ * 
+ * @param context The context of the match.
+ * @param bomb The bomb.
+ * @return The explosion timeout.
+ */
+int gameplay_bombs_get_explosion_timeout(game_context_t *context, gameplay_bombs_bomb_t *bomb)
+{
+	if(bomb->explosion_tick <= gameplay_timers_get_tick(context) + 1)
 	{
-		if(current->position_x == position_x && current->position_y == position_y && current->explosion_timeout > 0)//current->fire_timeout > 0)
-		{
-			return 1;
-		}
+		return 0;
 	}
 	
-	return 0;
+	return bomb->explosion_tick - gameplay_timers_get_tick(context) - 1;
 }
 
 /**
- * This function returns the bomb at the given position.
+ * This function returns if a bomb is placed at the given position.
  * 
+ * @param context The context of the match.
  * @param position_x The x coordinate of the tile.
  * @param position_y The y coordinate of the tile.
- * @return The bomb on the tile or NULL if no bomb is on the tile.
+ * @return 1 if a bomb is placed, 0 if not.
  */
-gameplay_bombs_bomb_t *gameplay_bombs_get_bomb(int position_x, int position_y)
+int gameplay_bombs_get_bomb_placed(game_context_t *context, int position_x, int position_y)
 {
-	gameplay_bombs_bomb_t *current = NULL;
+	gameplay_bombs_bomb_t *bomb = NULL;
 	
-	for(current = gameplay_bombs_bombs; current != NULL; current = current->next)
-	{
-		if(current->position_x == position_x && current->position_y == position_y)
-		{
-			return current;
-		}
-	}
+	bomb = gameplay_bombs_get_bomb(context, position_x, position_y);
 	
-	return NULL;
+	return (bomb != NULL && gameplay_bombs_get_explosion_timeout(context, bomb) > 0);
 }
 
 /**
- * This function triggers an explosion if a bomb is placed on the given tile.
+ * This function returns the bomb at the given position.
  * 
+ * @param context The context of the match.
  * @param position_x The x coordinate of the tile.
  * @param position_y The y coordinate of the tile.
+ * @return The bomb on the tile or NULL if no bomb is on the tile.
  */
-static void gameplay_bombs_trigger_explosion(int position_x, int position_y)
+gameplay_bombs_bomb_t *gameplay_bombs_get_bomb(game_context_t *context, int position_x, int position_y)
 {
-	if(gameplay_bombs_get_bomb_placed(position_x, position_y) == 1)
+	if(position_x < 0 || position_x >= GAMEPLAY_FIELD_WIDTH(context) || position_y < 0 || position_y >= GAMEPLAY_FIELD_HEIGHT(context))
 	{
-		gameplay_bombs_bomb_t *bomb = gameplay_bombs_get_bomb(position_x, position_y);
-		bomb->explosion_timeout = 0;
+		return NULL;
 	}
-}
\ No newline at end of file
+	
+	return GAMEPLAY_FIELD(context, context->bombs->grid, position_x, position_y);
+}
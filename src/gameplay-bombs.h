@@ -22,28 +22,41 @@
 
 #include "gameplay.h"
 #include "gameplay-players.h"
+#include "gameplay-timers.h"
+#include "gameplay-snapshot.h"
 
 #define GAMEPLAY_BOMBS_EXPLOSION_TIMEOUT 20
 #define GAMEPLAY_BOMBS_FIRE_TIMEOUT 10
+#define GAMEPLAY_BOMBS_POOL_CHUNK 64
 
 typedef struct gameplay_bombs_bomb_s
 {
 	int position_x;
 	int position_y;
-	int explosion_timeout;
+	unsigned int explosion_tick;
+	int explosion_radius;
 	//int fire_timeout;
+	gameplay_timers_timer_t timer;
 	gameplay_players_player_t *owner;
 	struct gameplay_bombs_bomb_s *next;
 } gameplay_bombs_bomb_t;
 
-void gameplay_bombs_add(gameplay_players_player_t *player, int position_x, int position_y);
-void gameplay_bombs_cleanup(void);
-void gameplay_bombs_remove(int position_x, int position_y);
-void gameplay_bombs_update(void);
-int gameplay_bombs_amount(void);
-gameplay_bombs_bomb_t *gameplay_bombs_get(int index);
-int gameplay_bombs_get_bomb_placed(int position_x, int position_y);
-gameplay_bombs_bomb_t *gameplay_bombs_get_bomb(int position_x, int position_y);
+int gameplay_bombs_init(game_context_t *context);
+void gameplay_bombs_add(game_context_t *context, gameplay_players_player_t *player, int position_x, int position_y);
+void gameplay_bombs_cleanup(game_context_t *context);
+void gameplay_bombs_release(game_context_t *context);
+void gameplay_bombs_remove(game_context_t *context, int position_x, int position_y);
+void gameplay_bombs_disown(game_context_t *context, gameplay_players_player_t *player);
+void gameplay_bombs_update(game_context_t *context);
+int gameplay_bombs_amount(game_context_t *context);
+gameplay_bombs_bomb_t *gameplay_bombs_get(game_context_t *context, int index);
+gameplay_bombs_bomb_t *gameplay_bombs_get_list(game_context_t *context);
+unsigned long long gameplay_bombs_hash(game_context_t *context);
+void gameplay_bombs_capture(game_context_t *context, gameplay_snapshot_t *snapshot);
+int gameplay_bombs_restore(game_context_t *context, const gameplay_snapshot_t *snapshot);
+int gameplay_bombs_get_explosion_timeout(game_context_t *context, gameplay_bombs_bomb_t *bomb);
+int gameplay_bombs_get_bomb_placed(game_context_t *context, int position_x, int position_y);
+gameplay_bombs_bomb_t *gameplay_bombs_get_bomb(game_context_t *context, int position_x, int position_y);
 // int gameplay_bombs_get_fire(int position_x, int position_y);
 
 #endif /* __GAMEPLAY_BOMBS_H__ */
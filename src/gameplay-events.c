@@ -0,0 +1,161 @@
+/*
+ * Copyright (C) 2015 NIPE-SYSTEMS
+ * Copyright (C) 2015 Jonas Krug
+ * Copyright (C) 2015 Tim Gevers
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+
+#include "gameplay-events.h"
+#include "gameplay-timers.h"
+
+// the ring of events, the sequence numbers grow forever and are mapped into
+// the ring, events before the first sequence number are lost
+struct gameplay_events_context_s
+{
+	gameplay_events_event_t ring[GAMEPLAY_EVENTS_CAPACITY];
+	unsigned int head;
+	unsigned int first;
+};
+
+/**
+ * This function drops all events. It is called at the start of a match, the
+ * cursors of all consumers become invalid, so they rescan the new match.
+ * 
+ * @param context The context of the match.
+ * @return 0 on success, -1 if the ring could not be allocated.
+ */
+int gameplay_events_init(game_context_t *context)
+{
+	if(context->events == NULL)
+	{
+		context->events = calloc(1, sizeof(gameplay_events_context_t));
+		if(context->events == NULL)
+		{
+			return -1;
+		}
+	}
+	
+	context->events->head++;
+	context->events->first = context->events->head;
+	
+	return 0;
+}
+
+/**
+ * This function frees the ring.
+ * 
+ * @param context The context of the match.
+ */
+void gameplay_events_release(game_context_t *context)
+{
+	free(context->events);
+	context->events = NULL;
+}
+
+/**
+ * This function appends an event to the ring. The oldest event is
+ * overwritten when the ring is full.
+ * 
+ * @param context The context of the match.
+ * @param type The type of the event.
+ * @param position_x The x coordinate of the tile of the event.
+ * @param position_y The y coordinate of the tile of the event.
+ * @param value The value of the event (depends on the type).
+ */
+void gameplay_events_push(game_context_t *context, gameplay_events_type_t type, int position_x, int position_y, int value)
+{
+	gameplay_events_event_t *event = NULL;
+	
+	event = &(context->events->ring[context->events->head % GAMEPLAY_EVENTS_CAPACITY]);
+	event->type = type;
+	event->tick = gameplay_timers_get_tick(context);
+	event->position_x = position_x;
+	event->position_y = position_y;
+	event->previous_x = position_x;
+	event->previous_y = position_y;
+	event->value = value;
+	
+	context->events->head++;
+	if(context->events->head - context->events->first > GAMEPLAY_EVENTS_CAPACITY)
+	{
+		context->events->first = context->events->head - GAMEPLAY_EVENTS_CAPACITY;
+	}
+}
+
+/**
+ * This function appends a movement of a player to the ring.
+ * 
+ * @param context The context of the match.
+ * @param position_x The x coordinate of the new tile.
+ * @param position_y The y coordinate of the new tile.
+ * @param previous_x The x coordinate of the previous tile.
+ * @param previous_y The y coordinate of the previous tile.
+ * @param value The id of the player.
+ */
+void gameplay_events_push_move(game_context_t *context, int position_x, int position_y, int previous_x, int previous_y, int value)
+{
+	gameplay_events_event_t *event = NULL;
+	
+	gameplay_events_push(context, GAMEPLAY_EVENTS_PLAYER_MOVED, position_x, position_y, value);
+	
+	event = &(context->events->ring[(context->events->head - 1) % GAMEPLAY_EVENTS_CAPACITY]);
+	event->previous_x = previous_x;
+	event->previous_y = previous_y;
+}
+
+/**
+ * This function returns the cursor behind the newest event. A consumer which
+ * has rescanned the gameplay state continues reading from it.
+ * 
+ * @param context The context of the match.
+ * @return The cursor.
+ */
+unsigned int gameplay_events_cursor(game_context_t *context)
+{
+	return context->events->head;
+}
+
+/**
+ * This function reads the next event of a consumer and advances its cursor.
+ * If events of the consumer were lost (overwritten or dropped by a new
+ * match) the cursor is moved behind the newest event and the consumer has
+ * to rescan the gameplay state.
+ * 
+ * @param context The context of the match.
+ * @param cursor The cursor of the consumer (read and write by pointer).
+ * @param event The event (write by pointer).
+ * @return 1 if an event was read, 0 if there are no more events, -1 if
+ *         events were lost.
+ */
+int gameplay_events_next(game_context_t *context, unsigned int *cursor, gameplay_events_event_t *event)
+{
+	if(context->events->head - *cursor > context->events->head - context->events->first)
+	{
+		*cursor = context->events->head;
+		return -1;
+	}
+	
+	if(*cursor == context->events->head)
+	{
+		return 0;
+	}
+	
+	*event = context->events->ring[*cursor % GAMEPLAY_EVENTS_CAPACITY];
+	(*cursor)++;
+	
+	return 1;
+}
@@ -0,0 +1,67 @@
+/*
+ * Copyright (C) 2015 NIPE-SYSTEMS
+ * Copyright (C) 2015 Jonas Krug
+ * Copyright (C) 2015 Tim Gevers
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GAMEPLAY_EVENTS_H__
+#define __GAMEPLAY_EVENTS_H__
+
+// amount of events in the ring (power of two), consumers which fall further
+// behind have to rescan the gameplay state
+#define GAMEPLAY_EVENTS_CAPACITY 16384
+
+#include "game-context.h"
+
+typedef enum gameplay_events_type_e
+{
+	GAMEPLAY_EVENTS_BOMB_PLACED,
+	GAMEPLAY_EVENTS_BOMB_EXPLODED,
+	GAMEPLAY_EVENTS_TILE_DESTROYED,
+	GAMEPLAY_EVENTS_FIRE_SET,
+	GAMEPLAY_EVENTS_FIRE_EXPIRED,
+	GAMEPLAY_EVENTS_ITEM_SPAWNED,
+	GAMEPLAY_EVENTS_ITEM_REMOVED,
+	GAMEPLAY_EVENTS_PLAYER_MOVED,
+	GAMEPLAY_EVENTS_PLAYER_DAMAGED,
+	GAMEPLAY_EVENTS_PLAYER_REMOVED
+} gameplay_events_type_t;
+
+/**
+ * A change of the gameplay state. The value depends on the type: the id of
+ * the player (player events), the id of the owner (bomb events, -1 without
+ * owner) or the type of the item (item events). The previous position is
+ * only set for moved players.
+ */
+typedef struct gameplay_events_event_s
+{
+	gameplay_events_type_t type;
+	unsigned int tick;
+	int position_x;
+	int position_y;
+	int previous_x;
+	int previous_y;
+	int value;
+} gameplay_events_event_t;
+
+int gameplay_events_init(game_context_t *context);
+void gameplay_events_release(game_context_t *context);
+void gameplay_events_push(game_context_t *context, gameplay_events_type_t type, int position_x, int position_y, int value);
+void gameplay_events_push_move(game_context_t *context, int position_x, int position_y, int previous_x, int previous_y, int value);
+unsigned int gameplay_events_cursor(game_context_t *context);
+int gameplay_events_next(game_context_t *context, unsigned int *cursor, gameplay_events_event_t *event);
+
+#endif /* __GAMEPLAY_EVENTS_H__ */
@@ -18,195 +18,350 @@
  */
 
 #include <stdlib.h>
-#include <ncurses.h>
 
 #include "gameplay.h"
 #include "gameplay-items.h"
 #include "gameplay-players.h"
 #include "gameplay-bombs.h"
-#include "core.h"
+#include "core-log.h"
+#include "gameplay-events.h"
+#include "gameplay-snapshot.h"
 
-static gameplay_items_item_t *gameplay_items_items = NULL;
+static unsigned long long gameplay_items_key(game_context_t *context, gameplay_items_item_t *item);
+
+struct gameplay_items_context_s
+{
+	// the item slots of all tiles and the tile indices of all placed items
+	gameplay_items_item_t *slots;
+	int *active;
+	int active_amount;
+};
+
+/**
+ * This function allocates the item slots for the size of the field.
+ * 
+ * @param context The context of the match.
+ * @return 0 on success, -1 on error.
+ */
+int gameplay_items_init(game_context_t *context)
+{
+	int i = 0;
+	
+	if(context->items == NULL)
+	{
+		context->items = calloc(1, sizeof(gameplay_items_context_t));
+		if(context->items == NULL)
+		{
+			return -1;
+		}
+	}
+	
+	context->items->slots = gameplay_allocate_tiles(context, context->items->slots, sizeof(gameplay_items_item_t));
+	context->items->active = gameplay_allocate_tiles(context, context->items->active, sizeof(int));
+	if(context->items->slots == NULL || context->items->active == NULL)
+	{
+		return -1;
+	}
+	
+	for(i = 0; i < GAMEPLAY_FIELD_TILES(context); i++)
+	{
+		context->items->slots[i].type = 0;
+		context->items->slots[i].timer.scheduled = 0;
+	}
+	
+	context->items->active_amount = 0;
+	
+	return 0;
+}
 
 /**
- * This function adds an item to the item list.
+ * This function adds an item to the item slot of a tile. An item which is
+ * already placed on the tile is replaced.
  * 
+ * @param context The context of the match.
  * @param type The type of the array.
  * @param position_x The x coordinate of the new item.
  * @param position_y The y coordinate of the new item.
  */
-void gameplay_items_add_item(gameplay_items_item_type_t type, int position_x, int position_y)
+void gameplay_items_add_item(game_context_t *context, gameplay_items_item_type_t type, int position_x, int position_y)
 {
 	gameplay_items_item_t *item = NULL;
-	gameplay_items_item_t *current = NULL;
 	
-	item = malloc(sizeof(gameplay_items_item_t));
-	if(item == NULL)
+	item = &(GAMEPLAY_FIELD(context, context->items->slots, position_x, position_y));
+	
+	if(item->type == 0)
 	{
-		core_error("Failed to allocate item.");
-		return;
+		item->active_index = context->items->active_amount;
+		context->items->active[context->items->active_amount++] = position_y * GAMEPLAY_FIELD_WIDTH(context) + position_x;
+	}
+	else
+	{
+		gameplay_hash_toggle(context, gameplay_items_key(context, item));
 	}
+	
 	item->type = type;
 	item->position_x = position_x;
 	item->position_y = position_y;
-	item->despawn_timer = GAMEPLAY_ITEMS_ITEM_DESPAWN;
-	item->next = NULL;
 	
-	// append to bombs list at end
-	for(current = gameplay_items_items; current != NULL && current->next != NULL; current = current->next);
+	// the item update of the current tick counts as well
+	item->despawn_tick = gameplay_timers_get_tick(context) + GAMEPLAY_ITEMS_ITEM_DESPAWN - 1;
+	gameplay_hash_toggle(context, gameplay_items_key(context, item));
+	gameplay_timers_schedule(context, GAMEPLAY_TIMERS_WHEEL_ITEMS, &(item->timer), item->despawn_tick, item);
+	
+	gameplay_events_push(context, GAMEPLAY_EVENTS_ITEM_SPAWNED, position_x, position_y, type);
 	
-	if(current == NULL)
+	core_debug("Added item %p at (%i, %i)", item, position_x, position_y);
+}
+
+/**
+ * This function cleans up all items.
+ * 
+ * @param context The context of the match.
+ */
+void gameplay_items_cleanup(game_context_t *context)
+{
+	int i = 0;
+	
+	core_debug("Cleanup items...");
+	
+	if(context->items == NULL)
 	{
-		item->next = gameplay_items_items;
-		gameplay_items_items = item;
+		return;
 	}
-	else
+	
+	for(i = 0; i < context->items->active_amount; i++)
 	{
-		current->next = item;
+		context->items->slots[context->items->active[i]].type = 0;
+		gameplay_timers_cancel(context, &(context->items->slots[context->items->active[i]].timer));
 	}
 	
-	core_debug("Added item %p at (%i, %i)", gameplay_items_items, position_x, position_y);
+	context->items->active_amount = 0;
 }
 
 /**
- * This function cleans up all items in the item list.
+ * This function releases the memory of the item slots. It is called when the
+ * game is shut down.
+ * 
+ * @param context The context of the match.
  */
-void gameplay_items_cleanup(void)
+void gameplay_items_release(game_context_t *context)
 {
-	gameplay_items_item_t *current = NULL;
-	gameplay_items_item_t *next_backup = NULL;
-	
-	core_debug("Cleanup items...");
-	
-	for(current = gameplay_items_items; current != NULL; current = next_backup)
+	if(context->items == NULL)
 	{
-		next_backup = current->next;
-		free(current);
+		return;
 	}
 	
-	gameplay_items_items = NULL;
+	gameplay_items_cleanup(context);
+	free(context->items->slots);
+	free(context->items->active);
+	free(context->items);
+	context->items = NULL;
 }
 
 /**
- * This function removes a item from the item list.
+ * This function removes a item from the item slot of a tile.
  * 
+ * @param context The context of the match.
  * @param position_x The x coordinate of the item.
  * @param position_y The y coordinate of the item.
  */
-void gameplay_items_remove(int position_x, int position_y)
+void gameplay_items_remove(game_context_t *context, int position_x, int position_y)
 {
-	gameplay_items_item_t *current = NULL;
-	gameplay_items_item_t *next_backup = NULL;
+	gameplay_items_item_t *item = NULL;
+	gameplay_items_item_t *last = NULL;
 	
-	for(current = gameplay_items_items; current != NULL; current = current->next)
-	{
-		if(current->position_x == position_x && current->position_y == position_y)
-		{
-			break;
-		}
-	}
+	item = &(GAMEPLAY_FIELD(context, context->items->slots, position_x, position_y));
 	
 	// cancel if nothing found
-	if(current == NULL)
+	if(item->type == 0)
 	{
 		return;
 	}
 	
-	// list start
-	if(current == gameplay_items_items)
+	// move the last active item into the gap
+	last = &(context->items->slots[context->items->active[context->items->active_amount - 1]]);
+	last->active_index = item->active_index;
+	context->items->active[item->active_index] = context->items->active[context->items->active_amount - 1];
+	context->items->active_amount--;
+	
+	gameplay_events_push(context, GAMEPLAY_EVENTS_ITEM_REMOVED, position_x, position_y, item->type);
+	
+	gameplay_hash_toggle(context, gameplay_items_key(context, item));
+	item->type = 0;
+	gameplay_timers_cancel(context, &(item->timer));
+}
+
+/**
+ * This function updates all items. (Timing, etc.)
+ * 
+ * @param context The context of the match.
+ */
+void gameplay_items_item_update(game_context_t *context)
+{
+	gameplay_timers_timer_t *timer = NULL;
+	gameplay_items_item_t *item = NULL;
+	
+	// only the items which despawn in this tick are visited
+	while((timer = gameplay_timers_next_due(context, GAMEPLAY_TIMERS_WHEEL_ITEMS)) != NULL)
+	{
+		item = timer->data;
+		gameplay_items_remove(context, item->position_x, item->position_y);
+	}
+}
+
+/**
+ * This function calculates the Zobrist key of a placed item.
+ * 
+ * @param context The context of the match.
+ * @param item The item.
+ * @return The key.
+ */
+static unsigned long long gameplay_items_key(game_context_t *context, gameplay_items_item_t *item)
+{
+	int index = 0;
+	
+	index = item->position_y * GAMEPLAY_FIELD_WIDTH(context) + item->position_x;
+	
+	return gameplay_hash_key(GAMEPLAY_HASH_ITEM + index, item->type) ^ gameplay_hash_key(GAMEPLAY_HASH_ITEM_DESPAWN + index, item->despawn_tick);
+}
+
+/**
+ * This function calculates the part of the hash of the gameplay state which
+ * belongs to the placed items.
+ * 
+ * @param context The context of the match.
+ * @return The hash of the items.
+ */
+unsigned long long gameplay_items_hash(game_context_t *context)
+{
+	int i = 0;
+	unsigned long long hash = 0;
+	
+	for(i = 0; i < context->items->active_amount; i++)
 	{
-		next_backup = current->next;
-		free(current);
-		gameplay_items_items = next_backup;
-		return;
+		hash ^= gameplay_items_key(context, &(context->items->slots[context->items->active[i]]));
 	}
 	
-	// rest of the list
-	for(current = gameplay_items_items; current->next != NULL; current = current->next)
+	return hash;
+}
+
+/**
+ * This function returns the amount of placed items.
+ * 
+ * @param context The context of the match.
+ * @return The amount of items.
+ */
+int gameplay_items_amount(game_context_t *context)
+{
+	return context->items->active_amount;
+}
+
+/**
+ * This function writes the placed items into a snapshot in the order of
+ * their timers.
+ * 
+ * @param context The context of the match.
+ * @param snapshot The snapshot with the sections already placed.
+ */
+void gameplay_items_capture(game_context_t *context, gameplay_snapshot_t *snapshot)
+{
+	int i = 0;
+	gameplay_items_item_t *item = NULL;
+	gameplay_snapshot_item_t *records = NULL;
+	gameplay_timers_timer_t *timer = NULL;
+	
+	records = GAMEPLAY_SNAPSHOT_SECTION(snapshot, gameplay_snapshot_item_t, items);
+	for(i = 0; i < snapshot->items_amount; i++)
 	{
-		if(current->next->position_x == position_x && current->next->position_y == position_y)
+		timer = gameplay_timers_walk(context, GAMEPLAY_TIMERS_WHEEL_ITEMS, timer);
+		if(timer == NULL)
 		{
-			next_backup = current->next->next;
-			free(current->next);
-			current->next = next_backup;
 			break;
 		}
+		
+		item = timer->data;
+		records[i].index = item->position_y * GAMEPLAY_FIELD_WIDTH(context) + item->position_x;
+		records[i].active_index = item->active_index;
+		records[i].type = item->type;
+		records[i].despawn_tick = item->despawn_tick;
 	}
 }
 
 /**
- * This function updates all items. (Timing, etc.)
+ * This function replaces the placed items by the ones of a snapshot. The
+ * wheels must be emptied before.
+ * 
+ * @param context The context of the match.
+ * @param snapshot The snapshot.
  */
-void gameplay_items_item_update(void)
+void gameplay_items_restore(game_context_t *context, const gameplay_snapshot_t *snapshot)
 {
-	gameplay_items_item_t *current = NULL;
+	int i = 0;
+	gameplay_items_item_t *item = NULL;
+	const gameplay_snapshot_item_t *records = NULL;
 	
-	for(current = gameplay_items_items; current != NULL; current = current->next)
+	for(i = 0; i < context->items->active_amount; i++)
 	{
-		current->despawn_timer--;
-		if(current->despawn_timer == 0)
-		{
-			gameplay_items_remove(current->position_x, current->position_y);
-		
-		}
+		item = &(context->items->slots[context->items->active[i]]);
+		item->type = 0;
+		item->timer.scheduled = 0;
 	}
+	
+	records = GAMEPLAY_SNAPSHOT_SECTION(snapshot, gameplay_snapshot_item_t, items);
+	for(i = 0; i < snapshot->items_amount; i++)
+	{
+		item = &(context->items->slots[records[i].index]);
+		item->type = records[i].type;
+		item->position_x = records[i].index % GAMEPLAY_FIELD_WIDTH(context);
+		item->position_y = records[i].index / GAMEPLAY_FIELD_WIDTH(context);
+		item->despawn_tick = records[i].despawn_tick;
+		item->active_index = records[i].active_index;
+		context->items->active[records[i].active_index] = records[i].index;
+		gameplay_timers_schedule(context, GAMEPLAY_TIMERS_WHEEL_ITEMS, &(item->timer), item->despawn_tick, item);
+	}
+	
+	context->items->active_amount = snapshot->items_amount;
 }
 
 /**
  * This function returns if a item is placed at the given position.
  * 
+ * @param context The context of the match.
  * @param position_x The x coordinate of the tile.
  * @param position_y The y coordinate of the tile.
  * @return 1 if a item is placed, 0 if not.
  */
-int gameplay_items_item_placed(int position_x,int position_y)
+int gameplay_items_item_placed(game_context_t *context, int position_x,int position_y)
 {
-	gameplay_items_item_t *current = NULL;
-	for(current = gameplay_items_items; current != NULL; current = current->next)
-	{
-		if(current->position_x == position_x && current->position_y == position_y)
-		{
-			return 1;
-		}
-	}
-	
-	return 0;
+	return (GAMEPLAY_FIELD(context, context->items->slots, position_x, position_y).type != 0);
 }
 
 /**
  * This function returns the item type at the given position.
  * 
+ * @param context The context of the match.
  * @param position_x The x coordinate of the tile.
  * @param position_y The y coordinate of the tile.
  * @return The item type on the tile or 0 if no item is on the tile.
  */
-gameplay_items_item_type_t gameplay_items_get_item_type(int position_x, int position_y)
+gameplay_items_item_type_t gameplay_items_get_item_type(game_context_t *context, int position_x, int position_y)
 {
-	gameplay_items_item_t *current = NULL;
-	for(current = gameplay_items_items; current != NULL; current = current->next)
-	{
-		if(current->position_x == position_x && current->position_y == position_y)
-		{
-			return current->type;
-		}
-	}
-	
-	return 0;
+	return GAMEPLAY_FIELD(context, context->items->slots, position_x, position_y).type;
 }
 
 /**
- * This function removes a item from the item list and returns if it was
- * successful.
+ * This function removes a item from a tile and returns if it was successful.
  * 
+ * @param context The context of the match.
  * @param position_x The x coordinate of the item.
  * @param position_y The y coordinate of the item.
  * @return 1 on success (removal), else 0
  */
-int gameplay_items_test_remove(int position_x, int position_y)
+int gameplay_items_test_remove(game_context_t *context, int position_x, int position_y)
 {
-	if(gameplay_items_item_placed(position_x, position_y) == 1)
+	if(gameplay_items_item_placed(context, position_x, position_y) == 1)
 	{
-		gameplay_items_remove(position_x, position_y);
+		gameplay_items_remove(context, position_x, position_y);
 		return 1;
 	}
 	else
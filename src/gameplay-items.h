@@ -22,6 +22,9 @@
 
 #define GAMEPLAY_ITEMS_ITEM_DESPAWN 100
 
+#include "gameplay-timers.h"
+#include "gameplay-snapshot.h"
+
 typedef enum gameplay_items_item_type_e
 {
 	EMPTY = 2,
@@ -32,21 +35,31 @@ typedef enum gameplay_items_item_type_e
 	SHIELD = 13
 } gameplay_items_item_type_t;
 
+/**
+ * An item slot of a tile. The type is 0 if no item is placed on the tile.
+ */
 typedef struct gameplay_items_item_s
 {
 	gameplay_items_item_type_t type;
 	int position_x;
 	int position_y;
-	int despawn_timer;
-	struct gameplay_items_item_s *next;
+	unsigned int despawn_tick;
+	int active_index;
+	gameplay_timers_timer_t timer;
 } gameplay_items_item_t;
 
-void gameplay_items_add_item(gameplay_items_item_type_t type, int position_x, int position_y);
-void gameplay_items_cleanup(void);
-void gameplay_items_remove(int position_x, int position_y);
-void gameplay_items_item_update();
-int gameplay_items_item_placed(int position_x, int position_y);
-gameplay_items_item_type_t gameplay_items_get_item_type(int position_x, int position_y);
-int gameplay_items_test_remove(int position_x, int position_y);
+int gameplay_items_init(game_context_t *context);
+void gameplay_items_add_item(game_context_t *context, gameplay_items_item_type_t type, int position_x, int position_y);
+void gameplay_items_cleanup(game_context_t *context);
+void gameplay_items_release(game_context_t *context);
+void gameplay_items_remove(game_context_t *context, int position_x, int position_y);
+void gameplay_items_item_update(game_context_t *context);
+int gameplay_items_item_placed(game_context_t *context, int position_x, int position_y);
+gameplay_items_item_type_t gameplay_items_get_item_type(game_context_t *context, int position_x, int position_y);
+int gameplay_items_test_remove(game_context_t *context, int position_x, int position_y);
+unsigned long long gameplay_items_hash(game_context_t *context);
+int gameplay_items_amount(game_context_t *context);
+void gameplay_items_capture(game_context_t *context, gameplay_snapshot_t *snapshot);
+void gameplay_items_restore(game_context_t *context, const gameplay_snapshot_t *snapshot);
 
 #endif /* __GAMEPLAY_ITEMS_H__ */
@@ -18,36 +18,169 @@
  */
 
 #include <stdlib.h>
+#include <string.h>
 
 #include "gameplay-players.h"
 #include "gameplay-bombs.h"
 #include "gameplay.h"
-#include "core.h"
+#include "core-log.h"
 #include "ai-core.h"
+#include "gameplay-events.h"
+#include "core-pool.h"
+#include "gameplay-snapshot.h"
 
-gameplay_players_player_t *gameplay_players_players = NULL;
-static void gameplay_players_remove(int position_x, int position_y);
+static void gameplay_players_remove(game_context_t *context, gameplay_players_player_t *player);
+static void gameplay_players_tile_link(game_context_t *context, gameplay_players_player_t *player);
+static void gameplay_players_tile_unlink(game_context_t *context, gameplay_players_player_t *player);
+static int gameplay_players_action_append(game_context_t *context, gameplay_players_action_t *action);
+static void gameplay_players_action_apply(game_context_t *context, gameplay_players_action_t *action);
+
+struct gameplay_players_context_s
+{
+	gameplay_players_player_t *players;
+	int next_id;
+	
+	// the players of a match, freed at once when the match ends
+	core_pool_t pool;
+	
+	// the global tick of the last players update, the cooldowns are
+	// absolute ticks which are compared against it
+	unsigned int tick;
+	
+	// the players on each tile (linked by tile_next)
+	gameplay_players_player_t **tiles;
+	
+	// the actions of the AI players in the last update, or the recorded
+	// actions which replace the AI in the next update
+	gameplay_players_action_t *actions;
+	int actions_amount;
+	int actions_capacity;
+	char actions_replayed;
+};
+
+/**
+ * This function allocates the player lists of the tiles for the size of the
+ * field. Players which are left over from a match that was not cleaned up are
+ * dropped.
+ * 
+ * @param context The context of the match.
+ * @return 0 on success, -1 on error.
+ */
+int gameplay_players_init(game_context_t *context)
+{
+	if(context->players == NULL)
+	{
+		context->players = calloc(1, sizeof(gameplay_players_context_t));
+		if(context->players == NULL)
+		{
+			return -1;
+		}
+		
+		context->players->pool = (core_pool_t)CORE_POOL_INITIALIZER(gameplay_players_player_t, GAMEPLAY_PLAYERS_POOL_CHUNK);
+	}
+	
+	if(ai_jobs_init(context) == -1)
+	{
+		return -1;
+	}
+	
+	context->players->tiles = gameplay_allocate_tiles(context, context->players->tiles, sizeof(gameplay_players_player_t *));
+	if(context->players->tiles == NULL)
+	{
+		return -1;
+	}
+	
+	memset(context->players->tiles, 0, GAMEPLAY_FIELD_TILES(context) * sizeof(gameplay_players_player_t *));
+	
+	core_pool_reset(&context->players->pool);
+	ai_jobs_cleanup(context);
+	
+	context->players->players = NULL;
+	context->players->next_id = 0;
+	context->players->tick = 0;
+	context->players->actions_amount = 0;
+	context->players->actions_replayed = 0;
+	
+	return 0;
+}
+
+/**
+ * This function inserts a player into the player list of its tile.
+ * 
+ * @param context The context of the match.
+ * @param player The player.
+ */
+static void gameplay_players_tile_link(game_context_t *context, gameplay_players_player_t *player)
+{
+	player->tile_next = GAMEPLAY_FIELD(context, context->players->tiles, player->position_x, player->position_y);
+	GAMEPLAY_FIELD(context, context->players->tiles, player->position_x, player->position_y) = player;
+}
+
+/**
+ * This function removes a player from the player list of its tile.
+ * 
+ * @param context The context of the match.
+ * @param player The player.
+ */
+static void gameplay_players_tile_unlink(game_context_t *context, gameplay_players_player_t *player)
+{
+	gameplay_players_player_t **current = NULL;
+	
+	for(current = &(GAMEPLAY_FIELD(context, context->players->tiles, player->position_x, player->position_y)); *current != NULL; current = &((*current)->tile_next))
+	{
+		if(*current == player)
+		{
+			*current = player->tile_next;
+			break;
+		}
+	}
+	
+	player->tile_next = NULL;
+}
+
+/**
+ * This function moves a player to another tile and keeps the player lists of
+ * the tiles up to date. All position changes of players must use it.
+ * 
+ * @param context The context of the match.
+ * @param player The player.
+ * @param position_x The x coordinate of the new tile.
+ * @param position_y The y coordinate of the new tile.
+ */
+void gameplay_players_set_position(game_context_t *context, gameplay_players_player_t *player, int position_x, int position_y)
+{
+	gameplay_events_push_move(context, position_x, position_y, player->position_x, player->position_y, player->id);
+	
+	gameplay_players_tile_unlink(context, player);
+	gameplay_hash_toggle(context, gameplay_players_key(context, player));
+	player->position_x = position_x;
+	player->position_y = position_y;
+	gameplay_hash_toggle(context, gameplay_players_key(context, player));
+	gameplay_players_tile_link(context, player);
+}
 
 /**
  * This function adds a player to the player list.
  * 
+ * @param context The context of the match.
  * @param position_x The x coordinate of the simulated player.
  * @param position_y The y coordinate of the simulated player.
  * @param type The type of the player which can be a user player or an AI
  *             player.
  */
-void gameplay_players_add(int position_x, int position_y, gameplay_players_type_t type)
+void gameplay_players_add(game_context_t *context, int position_x, int position_y, gameplay_players_type_t type)
 {
 	gameplay_players_player_t *player = NULL;
 	
-	player = malloc(sizeof(gameplay_players_player_t));
+	player = core_pool_allocate(&context->players->pool);
 	if(player == NULL)
 	{
 		core_error("Failed to allocate player.");
 		return;
 	}
 	
-	player->movement_cooldown = 0;
+	player->id = context->players->next_id++;
+	player->movement_ready_tick = context->players->tick;
 	player->movement_cooldown_initial = GAMEPLAY_PLAYERS_MOVEMENT_COOLDOWN;
 	player->position_x = position_x;
 	player->position_y = position_y;
@@ -55,155 +188,222 @@ void gameplay_players_add(int position_x, int position_y, gameplay_players_type_
 	player->placed_bombs = 0;
 	player->explosion_radius = GAMEPLAY_PLAYERS_EXPLOSION_RADIUS;
 	player->item = EMPTY;
-	player->item_usage_time = 0;
+	player->item_usage_tick = 0;
+	
+	player->damage_ready_tick = context->players->tick;
+	player->damage_cooldown_initial = GAMEPLAY_PLAYERS_DAMAGE_COOLDOWN;
+	player->type = type;
+	player->ai = GAMEPLAY_PLAYERS_AI_DEFAULT;
+	player->jobs = NULL;
+	player->turbo_mode_activated = 0;
+	player->next = NULL;
+	player->tile_next = NULL;
 	
 	if(type == GAMEPLAY_PLAYERS_TYPE_USER)
 	{
 		player->health_points = GAMEPLAY_PLAYERS_HEALTH_POINTS_USER;
-		player->damage_cooldown = GAMEPLAY_PLAYERS_DAMAGE_COOLDOWN_START_USER;
 	}
 	else
 	{
 		player->health_points = GAMEPLAY_PLAYERS_HEALTH_POINTS_AI;
-		player->damage_cooldown = GAMEPLAY_PLAYERS_DAMAGE_COOLDOWN_START_AI;
 	}
 	
-	player->damage_cooldown_initial = GAMEPLAY_PLAYERS_DAMAGE_COOLDOWN;
-	player->type = type;
-	player->jobs = NULL;
-	player->next = NULL;
+	gameplay_hash_toggle(context, gameplay_players_key(context, player));
+	
+	if(type == GAMEPLAY_PLAYERS_TYPE_USER)
+	{
+		gameplay_players_set_damage_cooldown(context, player, GAMEPLAY_PLAYERS_DAMAGE_COOLDOWN_START_USER);
+	}
+	else
+	{
+		gameplay_players_set_damage_cooldown(context, player, GAMEPLAY_PLAYERS_DAMAGE_COOLDOWN_START_AI);
+	}
 	
 	if(type == GAMEPLAY_PLAYERS_TYPE_AI)
 	{
-		player->movement_cooldown = GAMEPLAY_PLAYERS_AI_START_COOLDOWN;
+		gameplay_players_set_movement_cooldown(context, player, GAMEPLAY_PLAYERS_AI_START_COOLDOWN);
 	}
 	
 	// append to player list
-	player->next = gameplay_players_players;
-	gameplay_players_players = player;
+	player->next = context->players->players;
+	context->players->players = player;
+	gameplay_players_tile_link(context, player);
 	
-	core_debug("Added player %p at (%i, %i)", gameplay_players_players, position_x, position_y);
+	core_debug("Added player %p at (%i, %i)", context->players->players, position_x, position_y);
 }
 
 /**
- * This function cleans up all players in the player list.
+ * This function cleans up all players in the player list. The players and
+ * their jobs are freed at once by resetting the pools, the player lists of
+ * the tiles are cleared by the next initialization of the players.
+ * 
+ * @param context The context of the match.
  */
-void gameplay_players_cleanup(void)
+void gameplay_players_cleanup(game_context_t *context)
 {
-	gameplay_players_player_t *current = NULL;
-	gameplay_players_player_t *next_backup = NULL;
-	
 	core_debug("Cleanup players...");
 	
-	for(current = gameplay_players_players; current != NULL; current = next_backup)
+	if(context->players == NULL)
 	{
-		next_backup = current->next;
-		ai_core_cleanup(current);
-		free(current);
+		return;
 	}
 	
-	gameplay_players_players = NULL;
+	core_pool_reset(&context->players->pool);
+	ai_jobs_cleanup(context);
+	
+	context->players->players = NULL;
+	context->players->next_id = 0;
+	context->players->tick = 0;
+}
+
+/**
+ * This function releases the memory of the players and their jobs. It is
+ * called when the game is shut down.
+ * 
+ * @param context The context of the match.
+ */
+void gameplay_players_release(game_context_t *context)
+{
+	if(context->players == NULL)
+	{
+		return;
+	}
+	
+	gameplay_players_cleanup(context);
+	core_pool_release(&context->players->pool);
+	ai_jobs_release(context);
+	free(context->players->tiles);
+	free(context->players->actions);
+	free(context->players);
+	context->players = NULL;
 }
 
 /**
  * This function removes a player from the player list.
  * 
- * @param position_x The x coordinate of the player.
- * @param position_y The y coordinate of the player.
+ * @param context The context of the match.
+ * @param player The player.
  */
-static void gameplay_players_remove(int position_x, int position_y)
+static void gameplay_players_remove(game_context_t *context, gameplay_players_player_t *player)
 {
 	gameplay_players_player_t *current = NULL;
-	gameplay_players_player_t *next_backup = NULL;
 	
-	for(current = gameplay_players_players; current != NULL; current = current->next)
-	{
-		if(current->position_x == position_x && current->position_y == position_y)
-		{
-			break;
-		}
-	}
+	gameplay_events_push(context, GAMEPLAY_EVENTS_PLAYER_REMOVED, player->position_x, player->position_y, player->id);
 	
-	// cancel if nothing found
-	if(current == NULL)
-	{
-		return;
-	}
+	gameplay_players_tile_unlink(context, player);
+	gameplay_bombs_disown(context, player);
+	ai_core_cleanup(context, player);
+	gameplay_hash_toggle(context, gameplay_players_key(context, player));
 	
 	// list start
-	if(current == gameplay_players_players)
+	if(player == context->players->players)
 	{
-		next_backup = current->next;
-		free(current);
-		gameplay_players_players = next_backup;
+		context->players->players = player->next;
+		core_pool_free(&context->players->pool, player);
 		return;
 	}
 	
 	// rest of the list
-	for(current = gameplay_players_players; current->next != NULL; current = current->next)
+	for(current = context->players->players; current->next != NULL; current = current->next)
 	{
-		if(current->next->position_x == position_x && current->next->position_y == position_y)
+		if(current->next == player)
 		{
-			next_backup = current->next->next;
-			free(current->next);
-			current->next = next_backup;
+			current->next = player->next;
+			core_pool_free(&context->players->pool, player);
 			break;
 		}
 	}
 }
 
 /**
- * This function updates a player. (Timing, cooldowns, etc.)
+ * This function updates the players. The cooldowns are absolute ticks, so
+ * only the tick of the players is advanced and no player is touched.
+ * 
+ * @param context The context of the match.
+ */
+void gameplay_players_update(game_context_t *context)
+{
+	context->players->tick = gameplay_timers_get_tick(context);
+}
+
+/**
+ * This function returns the amount of players updates until a player can
+ * move again.
  * 
- * @param player The player which should be updated.
+ * @param context The context of the match.
+ * @param player The player.
+ * @return The movement cooldown, 0 if the player can move.
  */
-static void gameplay_players_player_update(gameplay_players_player_t *player)
+int gameplay_players_get_movement_cooldown(game_context_t *context, gameplay_players_player_t *player)
 {
-	if(player->movement_cooldown > 0)
+	if(player->movement_ready_tick <= context->players->tick)
 	{
-		player->movement_cooldown--;
+		return 0;
 	}
 	
-	if(player->item_usage_time > 0)
+	return player->movement_ready_tick - context->players->tick;
+}
+
+/**
+ * This function sets the amount of players updates until a player can move
+ * again.
+ * 
+ * @param context The context of the match.
+ * @param player The player.
+ * @param cooldown The movement cooldown.
+ */
+void gameplay_players_set_movement_cooldown(game_context_t *context, gameplay_players_player_t *player, int cooldown)
+{
+	gameplay_hash_toggle(context, gameplay_players_key(context, player));
+	player->movement_ready_tick = context->players->tick + cooldown;
+	gameplay_hash_toggle(context, gameplay_players_key(context, player));
+}
+
+/**
+ * This function returns the amount of players updates until a player can be
+ * harmed again.
+ * 
+ * @param context The context of the match.
+ * @param player The player.
+ * @return The damage cooldown, 0 if the player can be harmed.
+ */
+int gameplay_players_get_damage_cooldown(game_context_t *context, gameplay_players_player_t *player)
+{
+	if(player->damage_ready_tick <= context->players->tick)
 	{
-		player->item_usage_time--;
-		
-		if(player->item_usage_time == 0)
-		{
-			player->item = EMPTY;
-		}
+		return 0;
 	}
 	
-	if(player->damage_cooldown > 0)
-	{
-		player->damage_cooldown--;
-	}
+	return player->damage_ready_tick - context->players->tick;
 }
 
 /**
- * This function updates a player. (Timing, cooldowns, etc.)
+ * This function sets the amount of players updates until a player can be
+ * harmed again.
+ * 
+ * @param context The context of the match.
+ * @param player The player.
+ * @param cooldown The damage cooldown.
  */
-void gameplay_players_update(void)
+void gameplay_players_set_damage_cooldown(game_context_t *context, gameplay_players_player_t *player, int cooldown)
 {
-	gameplay_players_player_t *current = NULL;
-	
-	for(current = gameplay_players_players; current != NULL; current = current->next)
-	{
-		gameplay_players_player_update(current);
-	}
+	gameplay_hash_toggle(context, gameplay_players_key(context, player));
+	player->damage_ready_tick = context->players->tick + cooldown;
+	gameplay_hash_toggle(context, gameplay_players_key(context, player));
 }
 
 /**
  * This function searches the user player and returns it.
  * 
+ * @param context The context of the match.
  * @return The user player or NULL if no user player was found in the player
  *         list.
  */
-gameplay_players_player_t *gameplay_players_get_user(void)
+gameplay_players_player_t *gameplay_players_get_user(game_context_t *context)
 {
 	gameplay_players_player_t *current = NULL;
 	
-	for(current = gameplay_players_players; current != NULL; current = current->next)
+	for(current = context->players->players; current != NULL; current = current->next)
 	{
 		if(current->type == GAMEPLAY_PLAYERS_TYPE_USER)
 		{
@@ -218,15 +418,16 @@ gameplay_players_player_t *gameplay_players_get_user(void)
  * This function tries to move the user player to a given direction. It respects
  * walking limitations (walls, bombs, etc.).
  * 
+ * @param context The context of the match.
  * @param direction The direction in which the user player should move.
  */
-void gameplay_players_move(gameplay_players_direction_t direction)
+void gameplay_players_move(game_context_t *context, gameplay_players_direction_t direction)
 {
 	gameplay_players_player_t *player = NULL;
 	int position_target_x = 0;
 	int position_target_y = 0;
 	
-	player = gameplay_players_get_user();
+	player = gameplay_players_get_user(context);
 	if(player == NULL)
 	{
 		core_error("Failed to find user controlled player.");
@@ -262,19 +463,19 @@ void gameplay_players_move(gameplay_players_direction_t direction)
 	}
 	
 	// test if a bomb is placed on target tile
-	if(gameplay_bombs_get_bomb_placed(position_target_x, position_target_y))
+	if(gameplay_bombs_get_bomb_placed(context, position_target_x, position_target_y))
 	{
 		return;
 	}
 	
 	// test movement cooldown
-	if(player->movement_cooldown > 0)
+	if(gameplay_players_get_movement_cooldown(context, player) > 0)
 	{
 		return;
 	}
 	
 	// test walkability
-	if(!gameplay_get_walkable(position_target_x, position_target_y, 0))
+	if(!gameplay_get_walkable(context, position_target_x, position_target_y, 0))
 	{
 		return;
 	}
@@ -282,22 +483,22 @@ void gameplay_players_move(gameplay_players_direction_t direction)
 	// at this point all dependencies for a movement are fulfilled
 	// now actually move the player
 	core_debug("Moving to (%i, %i)", position_target_x, position_target_y);
-	player->position_x = position_target_x;
-	player->position_y = position_target_y;
-	player->movement_cooldown = player->movement_cooldown_initial;
+	gameplay_players_set_position(context, player, position_target_x, position_target_y);
+	gameplay_players_set_movement_cooldown(context, player, player->movement_cooldown_initial);
 }
 
 /**
  * This function returns the amount of players in the player list.
  * 
+ * @param context The context of the match.
  * @return The amount of players.
  */
-int gameplay_players_amount(void)
+int gameplay_players_amount(game_context_t *context)
 {
 	gameplay_players_player_t *current = NULL;
 	int amount = 0;
 	
-	for(current = gameplay_players_players; current != NULL; current = current->next)
+	for(current = context->players->players; current != NULL; current = current->next)
 	{
 		amount++;
 	}
@@ -308,14 +509,15 @@ int gameplay_players_amount(void)
 /**
  * This function returns the amount of (living) AI players.
  * 
+ * @param context The context of the match.
  * @return The amount of AI players.
  */
-int gameplay_players_ai_amount(void)
+int gameplay_players_ai_amount(game_context_t *context)
 {
 	gameplay_players_player_t *current = NULL;
 	int amount = 0;
 	
-	for(current = gameplay_players_players; current != NULL; current = current->next)
+	for(current = context->players->players; current != NULL; current = current->next)
 	{
 		if(current->type == GAMEPLAY_PLAYERS_TYPE_AI)
 		{
@@ -329,15 +531,16 @@ int gameplay_players_ai_amount(void)
 /**
  * This function returns the player with the given index.
  * 
+ * @param context The context of the match.
  * @param index The index of the player.
  * @return The selected player.
  */
-gameplay_players_player_t *gameplay_players_get(int index)
+gameplay_players_player_t *gameplay_players_get(game_context_t *context, int index)
 {
 	gameplay_players_player_t *current = NULL;
 	int i = 0;
 	
-	for(current = gameplay_players_players; current != NULL; current = current->next)
+	for(current = context->players->players; current != NULL; current = current->next)
 	{
 		if(index == i)
 		{
@@ -351,38 +554,238 @@ gameplay_players_player_t *gameplay_players_get(int index)
 }
 
 /**
- * This function returns if a player is placed at the given position.
+ * This function returns the index of a player in the player list.
  * 
- * @param position_x The x coordinate of the tile.
- * @param position_y The y coordinate of the tile.
- * @return 1 if a player is placed, 0 if not.
+ * @param context The context of the match.
+ * @param player The player.
+ * @return The index or -1 if the player is not in the list.
  */
-int gameplay_player_get_player(int position_x, int position_y)
+int gameplay_players_get_index(game_context_t *context, gameplay_players_player_t *player)
 {
 	gameplay_players_player_t *current = NULL;
+	int i = 0;
 	
-	for(current = gameplay_players_players; current != NULL; current = current->next)
+	for(current = context->players->players; current != NULL; current = current->next)
 	{
-		if(current->position_x == position_x && current->position_y == position_y)
+		if(current == player)
 		{
-			return 1;
+			return i;
 		}
+		
+		i++;
 	}
 	
+	return -1;
+}
+
+/**
+ * This function calculates the Zobrist key of a player. It covers the
+ * position, the stats, the cooldowns and the item of the player.
+ * 
+ * @param context The context of the match.
+ * @param player The player.
+ * @return The key.
+ */
+unsigned long long gameplay_players_key(game_context_t *context, gameplay_players_player_t *player)
+{
+	unsigned long long key = 0;
+	unsigned int stats = 0;
+	unsigned int rules = 0;
+	
+	stats = (unsigned int)(unsigned char)player->health_points << 24 | (unsigned int)(unsigned char)player->placeable_bombs << 16 | (unsigned int)(unsigned char)player->placed_bombs << 8 | (unsigned char)player->explosion_radius;
+	rules = (unsigned int)(unsigned char)player->movement_cooldown_initial << 24 | (unsigned int)(unsigned short)player->damage_cooldown_initial << 8 | (unsigned int)player->turbo_mode_activated << 4 | (unsigned int)player->type << 2 | (unsigned int)player->ai;
+	
+	key ^= gameplay_hash_key(GAMEPLAY_HASH_PLAYER + player->id, player->position_y * GAMEPLAY_FIELD_WIDTH(context) + player->position_x);
+	key ^= gameplay_hash_key(GAMEPLAY_HASH_PLAYER_STATS + player->id, stats);
+	key ^= gameplay_hash_key(GAMEPLAY_HASH_PLAYER_RULES + player->id, rules);
+	key ^= gameplay_hash_key(GAMEPLAY_HASH_PLAYER_MOVEMENT + player->id, player->movement_ready_tick);
+	key ^= gameplay_hash_key(GAMEPLAY_HASH_PLAYER_DAMAGE + player->id, player->damage_ready_tick);
+	key ^= gameplay_hash_key(GAMEPLAY_HASH_PLAYER_ITEM + player->id, player->item_usage_tick * 8 + player->item);
+	
+	return key;
+}
+
+/**
+ * This function calculates the part of the hash of the gameplay state which
+ * belongs to the players.
+ * 
+ * @param context The context of the match.
+ * @return The hash of the players.
+ */
+unsigned long long gameplay_players_hash(game_context_t *context)
+{
+	unsigned long long hash = 0;
+	gameplay_players_player_t *current = NULL;
+	
+	for(current = context->players->players; current != NULL; current = current->next)
+	{
+		hash ^= gameplay_players_key(context, current);
+	}
+	
+	return hash;
+}
+
+/**
+ * This function writes the players into a snapshot in the order of the
+ * player list.
+ * 
+ * @param context The context of the match.
+ * @param snapshot The snapshot with the sections already placed.
+ */
+void gameplay_players_capture(game_context_t *context, gameplay_snapshot_t *snapshot)
+{
+	int i = 0;
+	gameplay_players_player_t *current = NULL;
+	gameplay_players_player_t *tile = NULL;
+	gameplay_snapshot_player_t *record = NULL;
+	
+	for(current = context->players->players; current != NULL && i < snapshot->players_amount; current = current->next)
+	{
+		record = &(GAMEPLAY_SNAPSHOT_SECTION(snapshot, gameplay_snapshot_player_t, players)[i++]);
+		record->id = current->id;
+		record->health_points = current->health_points;
+		record->movement_ready_tick = current->movement_ready_tick;
+		record->movement_cooldown_initial = current->movement_cooldown_initial;
+		record->position_x = current->position_x;
+		record->position_y = current->position_y;
+		record->placeable_bombs = current->placeable_bombs;
+		record->placed_bombs = current->placed_bombs;
+		record->explosion_radius = current->explosion_radius;
+		record->item = current->item;
+		record->item_usage_tick = current->item_usage_tick;
+		record->damage_ready_tick = current->damage_ready_tick;
+		record->damage_cooldown_initial = current->damage_cooldown_initial;
+		record->type = current->type;
+		record->ai = current->ai;
+		record->turbo_mode_activated = current->turbo_mode_activated;
+		record->opening = -1;
+		record->opening_step = 0;
+		
+		record->tile_rank = 0;
+		for(tile = GAMEPLAY_FIELD(context, context->players->tiles, current->position_x, current->position_y); tile != NULL && tile != current; tile = tile->tile_next)
+		{
+			record->tile_rank++;
+		}
+	}
+	
+	snapshot->players_next_id = context->players->next_id;
+}
+
+/**
+ * This function replaces the players by the ones of a snapshot. The jobs of
+ * the AI players are dropped, they are planned again at the next update.
+ * 
+ * @param context The context of the match.
+ * @param snapshot The snapshot.
+ * @return 0 on success, -1 on error.
+ */
+int gameplay_players_restore(game_context_t *context, const gameplay_snapshot_t *snapshot)
+{
+	int i = 0;
+	int rank = 0;
+	int rank_max = 0;
+	gameplay_players_player_t *player = NULL;
+	gameplay_players_player_t *last = NULL;
+	const gameplay_snapshot_player_t *records = NULL;
+	
+	// only the tiles of the current players have lists to drop
+	for(player = context->players->players; player != NULL; player = player->next)
+	{
+		GAMEPLAY_FIELD(context, context->players->tiles, player->position_x, player->position_y) = NULL;
+	}
+	
+	gameplay_players_cleanup(context);
+	
+	records = GAMEPLAY_SNAPSHOT_SECTION(snapshot, gameplay_snapshot_player_t, players);
+	for(i = 0; i < snapshot->players_amount; i++)
+	{
+		player = core_pool_allocate(&context->players->pool);
+		if(player == NULL)
+		{
+			core_error("Failed to allocate player.");
+			return -1;
+		}
+		
+		player->id = records[i].id;
+		player->health_points = records[i].health_points;
+		player->movement_ready_tick = records[i].movement_ready_tick;
+		player->movement_cooldown_initial = records[i].movement_cooldown_initial;
+		player->position_x = records[i].position_x;
+		player->position_y = records[i].position_y;
+		player->placeable_bombs = records[i].placeable_bombs;
+		player->placed_bombs = records[i].placed_bombs;
+		player->explosion_radius = records[i].explosion_radius;
+		player->item = records[i].item;
+		player->item_usage_tick = records[i].item_usage_tick;
+		player->damage_ready_tick = records[i].damage_ready_tick;
+		player->damage_cooldown_initial = records[i].damage_cooldown_initial;
+		player->type = records[i].type;
+		player->ai = records[i].ai;
+		player->turbo_mode_activated = records[i].turbo_mode_activated;
+		player->jobs = NULL;
+		player->next = NULL;
+		player->tile_next = NULL;
+		
+		if(last == NULL)
+		{
+			context->players->players = player;
+		}
+		else
+		{
+			last->next = player;
+		}
+		
+		last = player;
+		
+		if(records[i].tile_rank > rank_max)
+		{
+			rank_max = records[i].tile_rank;
+		}
+	}
+	
+	// the player which is linked last is the first of the list of its tile
+	for(rank = rank_max; rank >= 0; rank--)
+	{
+		for(player = context->players->players, i = 0; player != NULL; player = player->next, i++)
+		{
+			if(records[i].tile_rank == rank)
+			{
+				gameplay_players_tile_link(context, player);
+			}
+		}
+	}
+	
+	context->players->next_id = snapshot->players_next_id;
+	context->players->tick = snapshot->tick;
+	
 	return 0;
 }
 
+/**
+ * This function returns if a player is placed at the given position.
+ * 
+ * @param context The context of the match.
+ * @param position_x The x coordinate of the tile.
+ * @param position_y The y coordinate of the tile.
+ * @return 1 if a player is placed, 0 if not.
+ */
+int gameplay_player_get_player(game_context_t *context, int position_x, int position_y)
+{
+	return (GAMEPLAY_FIELD(context, context->players->tiles, position_x, position_y) != NULL);
+}
+
 /**
  * This function tries to place a bomb at the current position of the given
  * player. If the player is NULL the user player is selected.
  * 
+ * @param context The context of the match.
  * @param player The player which should place a bomb.
  */
-void gameplay_players_place_bomb(gameplay_players_player_t *player)
+void gameplay_players_place_bomb(game_context_t *context, gameplay_players_player_t *player)
 {
 	if(player == NULL)
 	{
-		player = gameplay_players_get_user();
+		player = gameplay_players_get_user(context);
 	}
 	
 	if(player == NULL)
@@ -398,35 +801,49 @@ void gameplay_players_place_bomb(gameplay_players_player_t *player)
 	}
 	
 	// only place one bomb on a tile
-	if(gameplay_bombs_get_bomb_placed(player->position_x, player->position_y) == 1)
+	if(gameplay_bombs_get_bomb_placed(context, player->position_x, player->position_y) == 1)
 	{
 		return;
 	}
 	
-	gameplay_items_test_remove(player->position_x, player->position_y);
+	gameplay_items_test_remove(context, player->position_x, player->position_y);
 	
 	core_debug("Placing bomb at (%i, %i)", player->position_x, player->position_y);
-	gameplay_bombs_add(player, player->position_x, player->position_y);
+	gameplay_bombs_add(context, player, player->position_x, player->position_y);
+	gameplay_hash_toggle(context, gameplay_players_key(context, player));
 	player->placed_bombs++;
+	gameplay_hash_toggle(context, gameplay_players_key(context, player));
 }
 
 /**
  * This function picks up an item on the current tile of the user player.
+ * 
+ * @param context The context of the match.
  */
-void gameplay_players_use_item(void)
+void gameplay_players_use_item(game_context_t *context)
 {
 	gameplay_players_player_t *player = NULL;
 	gameplay_items_item_type_t item = EMPTY;
 	
-	player = gameplay_players_get_user();
+	player = gameplay_players_get_user(context);
 	if(player == NULL)
 	{
 		core_error("Failed to find user controlled player.");
 		return;
 	}
 	
-	item = gameplay_items_get_item_type(player->position_x, player->position_y);
-	gameplay_items_remove(player->position_x, player->position_y);
+	item = gameplay_items_get_item_type(context, player->position_x, player->position_y);
+	gameplay_items_remove(context, player->position_x, player->position_y);
+	
+	gameplay_hash_toggle(context, gameplay_players_key(context, player));
+	
+	// items with a limited usage time expire
+	if(player->item_usage_tick != 0 && player->item_usage_tick <= context->players->tick)
+	{
+		player->item = EMPTY;
+		player->item_usage_tick = 0;
+	}
+	
 	if(item != EMPTY)
 	{
 		player->item = item;
@@ -455,7 +872,7 @@ void gameplay_players_use_item(void)
 		case SPEED:
 		{
 			core_debug("Using speed power up.");
-			player->movement_cooldown = 0;
+			player->movement_ready_tick = context->players->tick;
 			if(player->movement_cooldown_initial > 3)
 			{
 				player->movement_cooldown_initial--;
@@ -479,69 +896,225 @@ void gameplay_players_use_item(void)
 			break;
 		}
 	}
+	
+	gameplay_hash_toggle(context, gameplay_players_key(context, player));
 }
 
 /**
  * This function harms any players at the given position.
  * 
+ * @param context The context of the match.
  * @param position_x The x coordinate of the tile.
  * @param position_y The y coordinate of the tile.
  */
-void gameplay_players_harm(int position_x, int position_y)
+void gameplay_players_harm(game_context_t *context, int position_x, int position_y)
 {
 	gameplay_players_player_t *current = NULL;
 	gameplay_players_player_t *next_backup = NULL;
 	
-	for(current = gameplay_players_players; current != NULL; current = next_backup)
+	// only the players on the tile are affected
+	for(current = GAMEPLAY_FIELD(context, context->players->tiles, position_x, position_y); current != NULL; current = next_backup)
 	{
-		next_backup = current->next;
+		next_backup = current->tile_next;
 		
-		if(current->position_x == position_x && current->position_y == position_y)
+		if(gameplay_players_get_damage_cooldown(context, current) == 0 && current->health_points > 0)
 		{
-			if(current->damage_cooldown == 0 && current->health_points > 0)
-			{
-				current->health_points--;
-				current->damage_cooldown = current->damage_cooldown_initial;
-			}
-			
-			if(current->health_points == 0 && current->type == GAMEPLAY_PLAYERS_TYPE_AI)
-			{
-				gameplay_players_remove(position_x, position_y);
-			}
+			gameplay_hash_toggle(context, gameplay_players_key(context, current));
+			current->health_points--;
+			gameplay_hash_toggle(context, gameplay_players_key(context, current));
+			gameplay_players_set_damage_cooldown(context, current, current->damage_cooldown_initial);
+			gameplay_events_push(context, GAMEPLAY_EVENTS_PLAYER_DAMAGED, position_x, position_y, current->id);
+		}
+		
+		if(current->health_points == 0 && current->type == GAMEPLAY_PLAYERS_TYPE_AI)
+		{
+			gameplay_players_remove(context, current);
 		}
 	}
 }
 
 /**
- * This function updates the AI of all AI players.
+ * This function appends an action to the actions of the current update.
+ * 
+ * @param context The context of the match.
+ * @param action The action.
+ * @return 0 on success, -1 if the actions could not be allocated.
  */
-void gameplay_players_ai_update(void)
+static int gameplay_players_action_append(game_context_t *context, gameplay_players_action_t *action)
 {
+	int capacity = 0;
+	gameplay_players_action_t *actions = NULL;
+	
+	if(context->players->actions_amount == context->players->actions_capacity)
+	{
+		capacity = (context->players->actions_capacity == 0)?(GAMEPLAY_PLAYERS_ACTIONS_CHUNK):(context->players->actions_capacity * 2);
+		actions = realloc(context->players->actions, capacity * sizeof(gameplay_players_action_t));
+		if(actions == NULL)
+		{
+			core_error("Failed to allocate actions.");
+			return -1;
+		}
+		
+		context->players->actions = actions;
+		context->players->actions_capacity = capacity;
+	}
+	
+	context->players->actions[context->players->actions_amount++] = *action;
+	
+	return 0;
+}
+
+/**
+ * This function executes a recorded action of an AI player in the same way
+ * as the AI did: first the step, then the bomb.
+ * 
+ * @param context The context of the match.
+ * @param action The action.
+ */
+static void gameplay_players_action_apply(game_context_t *context, gameplay_players_action_t *action)
+{
+	gameplay_players_player_t *player = NULL;
+	
+	for(player = context->players->players; player != NULL; player = player->next)
+	{
+		if(player->id == action->id)
+		{
+			break;
+		}
+	}
+	
+	if(player == NULL)
+	{
+		core_error("Failed to find player %i of action.", action->id);
+		return;
+	}
+	
+	if(action->moved == 1)
+	{
+		gameplay_players_set_position(context, player, player->position_x + action->step_x, player->position_y + action->step_y);
+		gameplay_players_set_movement_cooldown(context, player, player->movement_cooldown_initial);
+	}
+	
+	if(action->bomb == 1)
+	{
+		gameplay_players_place_bomb(context, player);
+	}
+}
+
+/**
+ * This function updates the AI of all AI players. The actions of the AI
+ * players are kept until the next update. In replays the recorded actions
+ * are executed instead of running the AI.
+ * 
+ * @param context The context of the match.
+ */
+void gameplay_players_ai_update(game_context_t *context)
+{
+	int i = 0;
+	int position_x = 0;
+	int position_y = 0;
+	int placed_bombs = 0;
+	unsigned int movement_ready_tick = 0;
 	gameplay_players_player_t *current = NULL;
+	gameplay_players_action_t action;
 	
-	for(current = gameplay_players_players; current != NULL; current = current->next)
+	if(context->players->actions_replayed == 1)
 	{
-		ai_core_update(current);
+		for(i = 0; i < context->players->actions_amount; i++)
+		{
+			gameplay_players_action_apply(context, &(context->players->actions[i]));
+		}
+		
+		context->players->actions_amount = 0;
+		
+		return;
+	}
+	
+	context->players->actions_amount = 0;
+	
+	for(current = context->players->players; current != NULL; current = current->next)
+	{
+		position_x = current->position_x;
+		position_y = current->position_y;
+		placed_bombs = current->placed_bombs;
+		movement_ready_tick = current->movement_ready_tick;
+		
+		ai_core_update(context, current);
+		
+		if(current->movement_ready_tick == movement_ready_tick && current->placed_bombs == placed_bombs)
+		{
+			continue;
+		}
+		
+		action.id = current->id;
+		action.step_x = current->position_x - position_x;
+		action.step_y = current->position_y - position_y;
+		action.moved = (current->movement_ready_tick != movement_ready_tick);
+		action.bomb = (current->placed_bombs != placed_bombs);
+		gameplay_players_action_append(context, &action);
 	}
 }
 
+/**
+ * This function returns the actions of the AI players in the last update.
+ * 
+ * @param context The context of the match.
+ * @param actions The actions (write by pointer).
+ * @return The amount of actions.
+ */
+int gameplay_players_get_actions(game_context_t *context, gameplay_players_action_t **actions)
+{
+	*actions = context->players->actions;
+	
+	return context->players->actions_amount;
+}
+
+/**
+ * This function switches the AI players of the current match to recorded
+ * actions. The AI is not run anymore, only the actions which are added by
+ * "gameplay_players_replay_action" before an update are executed.
+ * 
+ * @param context The context of the match.
+ */
+void gameplay_players_replay_actions(game_context_t *context)
+{
+	context->players->actions_replayed = 1;
+	context->players->actions_amount = 0;
+}
+
+/**
+ * This function adds a recorded action which is executed in the next update.
+ * 
+ * @param context The context of the match.
+ * @param action The action.
+ * @return 0 on success, -1 if the action could not be added.
+ */
+int gameplay_players_replay_action(game_context_t *context, gameplay_players_action_t *action)
+{
+	return gameplay_players_action_append(context, action);
+}
+
 /**
  * This function activates the TURBO-MODE of the user player.
+ * 
+ * @param context The context of the match.
  */
-void gameplay_player_activate_turbo_mode(void)
+void gameplay_player_activate_turbo_mode(game_context_t *context)
 {
 	gameplay_players_player_t *player = NULL;
 	
-	player = gameplay_players_get_user();
+	player = gameplay_players_get_user(context);
 	if(player == NULL)
 	{
 		return;
 	}
 	
+	gameplay_hash_toggle(context, gameplay_players_key(context, player));
 	player->turbo_mode_activated = 1;
 	player->movement_cooldown_initial = 1;
 	player->health_points = 5;
 	player->placeable_bombs = 10;
 	player->explosion_radius = 9;
 	player->damage_cooldown_initial = 100;
+	gameplay_hash_toggle(context, gameplay_players_key(context, player));
 }
@@ -29,11 +29,14 @@
 #define GAMEPLAY_PLAYERS_EXPLOSION_RADIUS 2
 #define GAMEPLAY_PLAYERS_AMOUNT_BOMBS 1
 #define GAMEPLAY_PLAYERS_AI_START_COOLDOWN 100
+#define GAMEPLAY_PLAYERS_POOL_CHUNK 8
+#define GAMEPLAY_PLAYERS_ACTIONS_CHUNK 8
 #define GAMEPLAY_PLAYERS_HEALTH_POINTS_USER 3
 #define GAMEPLAY_PLAYERS_HEALTH_POINTS_AI 3
 
 #include "gameplay-items.h"
 #include "ai-jobs.h"
+#include "gameplay-snapshot.h"
 
 typedef enum gameplay_players_type_e
 {
@@ -41,10 +44,23 @@ typedef enum gameplay_players_type_e
 	GAMEPLAY_PLAYERS_TYPE_AI,
 } gameplay_players_type_t;
 
+typedef enum gameplay_players_ai_e
+{
+	GAMEPLAY_PLAYERS_AI_JOBS,
+	GAMEPLAY_PLAYERS_AI_MCTS,
+	GAMEPLAY_PLAYERS_AI_BEAM
+} gameplay_players_ai_t;
+
+// the AI which is used by new AI players
+#ifndef GAMEPLAY_PLAYERS_AI_DEFAULT
+#define GAMEPLAY_PLAYERS_AI_DEFAULT GAMEPLAY_PLAYERS_AI_JOBS
+#endif /* GAMEPLAY_PLAYERS_AI_DEFAULT */
+
 typedef struct gameplay_players_player_s
 {
+	int id;
 	int health_points;
-	int movement_cooldown;
+	unsigned int movement_ready_tick;
 	int movement_cooldown_initial;
 	int position_y;
 	int position_x;
@@ -52,15 +68,31 @@ typedef struct gameplay_players_player_s
 	int placed_bombs;
 	int explosion_radius;
 	gameplay_items_item_type_t item;
-	int item_usage_time;
-	int damage_cooldown;
+	unsigned int item_usage_tick;
+	unsigned int damage_ready_tick;
 	int damage_cooldown_initial;
 	gameplay_players_type_t type;
+	gameplay_players_ai_t ai;
 	ai_jobs_t *jobs;
 	char turbo_mode_activated;
 	struct gameplay_players_player_s *next;
+	struct gameplay_players_player_s *tile_next;
 } gameplay_players_player_t;
 
+/**
+ * What an AI player did in one update: a step to a neighbouring tile (or a
+ * step on the same tile which only restarts the movement cooldown) and a
+ * placed bomb.
+ */
+typedef struct gameplay_players_action_s
+{
+	int id;
+	signed char step_x;
+	signed char step_y;
+	char moved;
+	char bomb;
+} gameplay_players_action_t;
+
 typedef enum gameplay_players_direction_e
 {
 	GAMEPLAY_PLAYERS_DIRECTION_UP,
@@ -69,19 +101,34 @@ typedef enum gameplay_players_direction_e
 	GAMEPLAY_PLAYERS_DIRECTION_LEFT
 } gameplay_players_direction_t;
 
-void gameplay_players_add(int position_x, int position_y, gameplay_players_type_t type);
-void gameplay_players_cleanup(void);
-void gameplay_players_update(void);
-gameplay_players_player_t *gameplay_players_get_user(void);
-void gameplay_players_move(gameplay_players_direction_t direction);
-int gameplay_players_amount(void);
-int gameplay_players_ai_amount(void);
-gameplay_players_player_t *gameplay_players_get(int index);
-int gameplay_player_get_player(int position_x, int position_y);
-void gameplay_players_place_bomb(gameplay_players_player_t *player);
-void gameplay_players_use_item(void);
-void gameplay_players_harm(int position_x, int position_y);
-void gameplay_players_ai_update(void);
-void gameplay_player_activate_turbo_mode(void);
+int gameplay_players_init(game_context_t *context);
+void gameplay_players_add(game_context_t *context, int position_x, int position_y, gameplay_players_type_t type);
+void gameplay_players_cleanup(game_context_t *context);
+void gameplay_players_release(game_context_t *context);
+void gameplay_players_update(game_context_t *context);
+gameplay_players_player_t *gameplay_players_get_user(game_context_t *context);
+void gameplay_players_set_position(game_context_t *context, gameplay_players_player_t *player, int position_x, int position_y);
+int gameplay_players_get_movement_cooldown(game_context_t *context, gameplay_players_player_t *player);
+void gameplay_players_set_movement_cooldown(game_context_t *context, gameplay_players_player_t *player, int cooldown);
+int gameplay_players_get_damage_cooldown(game_context_t *context, gameplay_players_player_t *player);
+void gameplay_players_set_damage_cooldown(game_context_t *context, gameplay_players_player_t *player, int cooldown);
+void gameplay_players_move(game_context_t *context, gameplay_players_direction_t direction);
+int gameplay_players_amount(game_context_t *context);
+int gameplay_players_ai_amount(game_context_t *context);
+gameplay_players_player_t *gameplay_players_get(game_context_t *context, int index);
+int gameplay_players_get_index(game_context_t *context, gameplay_players_player_t *player);
+unsigned long long gameplay_players_key(game_context_t *context, gameplay_players_player_t *player);
+unsigned long long gameplay_players_hash(game_context_t *context);
+void gameplay_players_capture(game_context_t *context, gameplay_snapshot_t *snapshot);
+int gameplay_players_restore(game_context_t *context, const gameplay_snapshot_t *snapshot);
+int gameplay_player_get_player(game_context_t *context, int position_x, int position_y);
+void gameplay_players_place_bomb(game_context_t *context, gameplay_players_player_t *player);
+void gameplay_players_use_item(game_context_t *context);
+void gameplay_players_harm(game_context_t *context, int position_x, int position_y);
+void gameplay_players_ai_update(game_context_t *context);
+int gameplay_players_get_actions(game_context_t *context, gameplay_players_action_t **actions);
+void gameplay_players_replay_actions(game_context_t *context);
+int gameplay_players_replay_action(game_context_t *context, gameplay_players_action_t *action);
+void gameplay_player_activate_turbo_mode(game_context_t *context);
 
 #endif /* __GAMEPLAY_PLAYERS_H__ */
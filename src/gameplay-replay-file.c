@@ -0,0 +1,641 @@
+/*
+ * Copyright (C) 2015 NIPE-SYSTEMS
+ * Copyright (C) 2015 Jonas Krug
+ * Copyright (C) 2015 Tim Gevers
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "gameplay-replay-file.h"
+#include "gameplay.h"
+#include "core-log.h"
+
+static unsigned char *gameplay_replay_file_put_varint(unsigned char *position, unsigned int value);
+static const unsigned char *gameplay_replay_file_get_varint(const unsigned char *position, const unsigned char *end, unsigned int *value);
+static unsigned int gameplay_replay_file_encode(gameplay_replay_t *replay, unsigned char *inputs);
+static int gameplay_replay_file_decode(gameplay_replay_file_t *file);
+static int gameplay_replay_file_write(FILE *stream, const void *data, unsigned int size, unsigned int *offset);
+static int gameplay_replay_file_write_keyframes(FILE *stream, gameplay_replay_t *replay, game_context_t *context, gameplay_replay_file_keyframe_t *keyframes, unsigned int *keyframes_amount, unsigned int *offset);
+static int gameplay_replay_file_validate(gameplay_replay_file_t *file);
+
+/**
+ * This function writes an unsigned number as varint: 7 bits per byte, the
+ * highest bit marks that another byte follows.
+ * 
+ * @param position The position in the buffer.
+ * @param value The number.
+ * @return The position behind the varint.
+ */
+static unsigned char *gameplay_replay_file_put_varint(unsigned char *position, unsigned int value)
+{
+	while(value >= 0x80)
+	{
+		*position++ = (value & 0x7f) | 0x80;
+		value >>= 7;
+	}
+	
+	*position++ = value;
+	
+	return position;
+}
+
+/**
+ * This function reads a varint.
+ * 
+ * @param position The position in the buffer.
+ * @param end The end of the buffer.
+ * @param value The number (write by pointer).
+ * @return The position behind the varint or NULL if the varint is invalid.
+ */
+static const unsigned char *gameplay_replay_file_get_varint(const unsigned char *position, const unsigned char *end, unsigned int *value)
+{
+	int shift = 0;
+	
+	*value = 0;
+	
+	for(shift = 0; shift < 32 && position < end; shift += 7)
+	{
+		*value |= (unsigned int)(*position & 0x7f) << shift;
+		if((*position++ & 0x80) == 0)
+		{
+			return position;
+		}
+	}
+	
+	return NULL;
+}
+
+/**
+ * This function encodes the records of a replay. Every record starts with a
+ * varint of the ticks since the previous record and the type of the record,
+ * followed by the key, the packed action or the 8 bytes of the hash.
+ * 
+ * @param replay The replay.
+ * @param inputs The buffer with at least 16 bytes per record.
+ * @return The size of the encoded records in bytes.
+ */
+static unsigned int gameplay_replay_file_encode(gameplay_replay_t *replay, unsigned char *inputs)
+{
+	int i = 0;
+	int j = 0;
+	unsigned int tick = 0;
+	unsigned char *position = NULL;
+	gameplay_replay_record_t *record = NULL;
+	
+	position = inputs;
+	
+	for(i = 0; i < replay->records_amount; i++)
+	{
+		record = &(replay->records[i]);
+		position = gameplay_replay_file_put_varint(position, (record->tick - tick) << 2 | record->type);
+		tick = record->tick;
+		
+		switch(record->type)
+		{
+			case GAMEPLAY_REPLAY_KEY:
+			{
+				*position++ = record->key;
+				break;
+			}
+			case GAMEPLAY_REPLAY_ACTION:
+			{
+				position = gameplay_replay_file_put_varint(position, record->action.id);
+				*position++ = (record->action.step_x + 1) | (record->action.step_y + 1) << 2 | record->action.moved << 4 | record->action.bomb << 5;
+				break;
+			}
+			case GAMEPLAY_REPLAY_HASH:
+			{
+				for(j = 0; j < 8; j++)
+				{
+					*position++ = record->hash >> (8 * j);
+				}
+				
+				break;
+			}
+		}
+	}
+	
+	return position - inputs;
+}
+
+/**
+ * This function decodes the inputs of an opened file into the records of its
+ * replay.
+ * 
+ * @param file The file.
+ * @return 0 on success, -1 if the inputs are invalid.
+ */
+static int gameplay_replay_file_decode(gameplay_replay_file_t *file)
+{
+	int j = 0;
+	unsigned int i = 0;
+	unsigned int value = 0;
+	const unsigned char *position = NULL;
+	const unsigned char *end = NULL;
+	gameplay_replay_record_t record;
+	
+	position = file->data + file->header->inputs_offset;
+	end = position + file->header->inputs_size;
+	record.tick = 0;
+	
+	for(i = 0; i < file->header->records_amount; i++)
+	{
+		record.key = 0;
+		record.action.id = 0;
+		record.action.step_x = 0;
+		record.action.step_y = 0;
+		record.action.moved = 0;
+		record.action.bomb = 0;
+		record.hash = 0;
+		
+		position = gameplay_replay_file_get_varint(position, end, &value);
+		if(position == NULL || (value & 3) > GAMEPLAY_REPLAY_HASH)
+		{
+			return -1;
+		}
+		
+		record.tick += value >> 2;
+		record.type = value & 3;
+		
+		if(record.type == GAMEPLAY_REPLAY_KEY && position < end)
+		{
+			record.key = *position++;
+		}
+		else if(record.type == GAMEPLAY_REPLAY_ACTION && (position = gameplay_replay_file_get_varint(position, end, &value)) != NULL && position < end)
+		{
+			record.action.id = value;
+			record.action.step_x = (*position & 3) - 1;
+			record.action.step_y = ((*position >> 2) & 3) - 1;
+			record.action.moved = (*position >> 4) & 1;
+			record.action.bomb = (*position >> 5) & 1;
+			position++;
+		}
+		else if(record.type == GAMEPLAY_REPLAY_HASH && end - position >= 8)
+		{
+			for(j = 0; j < 8; j++)
+			{
+				record.hash |= (unsigned long long)*position++ << (8 * j);
+			}
+		}
+		else
+		{
+			return -1;
+		}
+		
+		if(record.tick > file->replay.ticks || gameplay_replay_append(&(file->replay), &record) == -1)
+		{
+			return -1;
+		}
+	}
+	
+	return 0;
+}
+
+/**
+ * This function writes data into a file and pads it to the alignment of the
+ * sections.
+ * 
+ * @param stream The file.
+ * @param data The data.
+ * @param size The size of the data in bytes.
+ * @param offset The offset in the file, advanced by the written bytes (write
+ *               by pointer).
+ * @return 0 on success, -1 on failure.
+ */
+static int gameplay_replay_file_write(FILE *stream, const void *data, unsigned int size, unsigned int *offset)
+{
+	static const unsigned char padding[GAMEPLAY_REPLAY_FILE_ALIGNMENT];
+	unsigned int padding_size = 0;
+	
+	padding_size = (GAMEPLAY_REPLAY_FILE_ALIGNMENT - size % GAMEPLAY_REPLAY_FILE_ALIGNMENT) % GAMEPLAY_REPLAY_FILE_ALIGNMENT;
+	
+	if((size > 0 && fwrite(data, size, 1, stream) != 1) || (padding_size > 0 && fwrite(padding, padding_size, 1, stream) != 1))
+	{
+		return -1;
+	}
+	
+	*offset += size + padding_size;
+	
+	return 0;
+}
+
+/**
+ * This function plays a replay back and writes a snapshot of the state after
+ * every keyframe period. The playback also verifies the recorded hashes, so
+ * only reproducible replays are written.
+ * 
+ * @param stream The file.
+ * @param replay The replay.
+ * @param context The context in which the match is simulated.
+ * @param keyframes The index of the keyframes (write by pointer).
+ * @param keyframes_amount The amount of keyframes (write by pointer).
+ * @param offset The offset in the file (write by pointer).
+ * @return 0 on success, -1 on failure.
+ */
+static int gameplay_replay_file_write_keyframes(FILE *stream, gameplay_replay_t *replay, game_context_t *context, gameplay_replay_file_keyframe_t *keyframes, unsigned int *keyframes_amount, unsigned int *offset)
+{
+	int result = 0;
+	size_t size = 0;
+	size_t capacity = 0;
+	gameplay_snapshot_t *snapshot = NULL;
+	gameplay_snapshot_t *allocated = NULL;
+	gameplay_sim_state_t state;
+	gameplay_replay_playback_t playback;
+	
+	*keyframes_amount = 0;
+	
+	if(gameplay_replay_playback_init(&playback, replay, &state, context) == -1)
+	{
+		return -1;
+	}
+	
+	while(result == 0)
+	{
+		if(state.tick % GAMEPLAY_REPLAY_FILE_KEYFRAME_PERIOD == 0)
+		{
+			size = gameplay_snapshot_size(context);
+			if(size > capacity)
+			{
+				allocated = realloc(snapshot, size);
+				if(allocated == NULL)
+				{
+					result = -1;
+					break;
+				}
+				
+				snapshot = allocated;
+				capacity = size;
+			}
+			
+			keyframes[*keyframes_amount].tick = state.tick;
+			keyframes[*keyframes_amount].record = playback.record;
+			keyframes[*keyframes_amount].snapshot_offset = *offset;
+			keyframes[*keyframes_amount].snapshot_size = size;
+			(*keyframes_amount)++;
+			
+			if(gameplay_snapshot_capture(context, snapshot, capacity) == -1 || gameplay_replay_file_write(stream, snapshot, size, offset) == -1)
+			{
+				result = -1;
+			}
+		}
+		
+		if(gameplay_replay_playback_finished(&playback) == 1)
+		{
+			break;
+		}
+		
+		gameplay_replay_playback_step(&playback);
+	}
+	
+	if(playback.mismatches > 0 || state.tick != replay->ticks || state.result != replay->result)
+	{
+		core_error("Replay is not reproducible.");
+		result = -1;
+	}
+	
+	gameplay_sim_cleanup(&state);
+	free(snapshot);
+	
+	return result;
+}
+
+/**
+ * This function writes a replay into a file which can be memory mapped and
+ * seeked. The replay is played back to create the keyframes.
+ * 
+ * @param replay The replay.
+ * @param context The context in which the match is simulated, no match may
+ *                run in it.
+ * @param path The path of the file.
+ * @return 0 on success, -1 on failure.
+ */
+int gameplay_replay_file_save(gameplay_replay_t *replay, game_context_t *context, const char *path)
+{
+	int result = 0;
+	unsigned int offset = 0;
+	unsigned char *inputs = NULL;
+	gameplay_replay_file_keyframe_t *keyframes = NULL;
+	FILE *stream = NULL;
+	gameplay_replay_file_header_t header;
+	
+	core_debug("Writing replay: %s", path);
+	
+	memset(&header, 0, sizeof(gameplay_replay_file_header_t));
+	header.magic = GAMEPLAY_REPLAY_FILE_MAGIC;
+	header.version = GAMEPLAY_REPLAY_FILE_VERSION;
+	header.seed = replay->seed;
+	header.field_width = replay->field_width;
+	header.field_height = replay->field_height;
+	header.hash_period = replay->hash_period;
+	header.actions_recorded = replay->actions_recorded;
+	header.ticks = replay->ticks;
+	header.result = replay->result;
+	header.keyframe_period = GAMEPLAY_REPLAY_FILE_KEYFRAME_PERIOD;
+	header.records_amount = replay->records_amount;
+	
+	inputs = malloc(replay->records_amount * 16 + 1);
+	keyframes = malloc((replay->ticks / GAMEPLAY_REPLAY_FILE_KEYFRAME_PERIOD + 1) * sizeof(gameplay_replay_file_keyframe_t));
+	stream = fopen(path, "wb");
+	if(inputs == NULL || keyframes == NULL || stream == NULL)
+	{
+		core_error("Failed to open replay: %s", path);
+		result = -1;
+	}
+	
+	// the header is written again when the offsets are known
+	if(result == 0)
+	{
+		header.inputs_size = gameplay_replay_file_encode(replay, inputs);
+		result = gameplay_replay_file_write(stream, &header, sizeof(gameplay_replay_file_header_t), &offset);
+	}
+	
+	if(result == 0)
+	{
+		header.inputs_offset = offset;
+		result = gameplay_replay_file_write(stream, inputs, header.inputs_size, &offset);
+	}
+	
+	if(result == 0)
+	{
+		result = gameplay_replay_file_write_keyframes(stream, replay, context, keyframes, &(header.keyframes_amount), &offset);
+	}
+	
+	if(result == 0)
+	{
+		header.index_offset = offset;
+		result = gameplay_replay_file_write(stream, keyframes, header.keyframes_amount * sizeof(gameplay_replay_file_keyframe_t), &offset);
+	}
+	
+	if(result == 0 && (fseek(stream, 0, SEEK_SET) != 0 || fwrite(&header, sizeof(gameplay_replay_file_header_t), 1, stream) != 1))
+	{
+		result = -1;
+	}
+	
+	if(stream != NULL && fclose(stream) != 0)
+	{
+		result = -1;
+	}
+	
+	if(result == -1)
+	{
+		core_error("Failed to write replay: %s", path);
+	}
+	
+	free(inputs);
+	free(keyframes);
+	
+	return result;
+}
+
+/**
+ * This function tests the header and the index of an opened file.
+ * 
+ * @param file The file.
+ * @return 0 if the file is valid, otherwise -1.
+ */
+static int gameplay_replay_file_validate(gameplay_replay_file_t *file)
+{
+	unsigned int i = 0;
+	const gameplay_replay_file_header_t *header = NULL;
+	const gameplay_replay_file_keyframe_t *keyframe = NULL;
+	const gameplay_snapshot_t *snapshot = NULL;
+	
+	header = file->header;
+	
+	if(header->magic != GAMEPLAY_REPLAY_FILE_MAGIC || header->version != GAMEPLAY_REPLAY_FILE_VERSION || header->field_width < GAMEPLAY_FIELD_SIZE_MIN || header->field_width > GAMEPLAY_FIELD_SIZE_MAX || header->field_height < GAMEPLAY_FIELD_SIZE_MIN || header->field_height > GAMEPLAY_FIELD_SIZE_MAX)
+	{
+		return -1;
+	}
+	
+	// the result is cast to gameplay_sim_result_t and keyframes are only
+	// found with a period
+	if(header->hash_period < 0 || header->result < GAMEPLAY_SIM_RUNNING || header->result > GAMEPLAY_SIM_GAME_OVER || header->keyframe_period == 0)
+	{
+		return -1;
+	}
+	
+	if(header->inputs_offset > file->size || header->inputs_size > file->size - header->inputs_offset || header->index_offset % GAMEPLAY_REPLAY_FILE_ALIGNMENT != 0 || header->index_offset > file->size || header->keyframes_amount == 0 || header->keyframes_amount > (file->size - header->index_offset) / sizeof(gameplay_replay_file_keyframe_t))
+	{
+		return -1;
+	}
+	
+	// the playback starts at the first keyframe, so it has to be the start
+	// of the match, and the keyframes are searched by bisection, so their
+	// ticks have to increase
+	for(i = 0; i < header->keyframes_amount; i++)
+	{
+		keyframe = &(file->keyframes[i]);
+		if(keyframe->tick != i * header->keyframe_period || (i > 0 && keyframe->tick <= file->keyframes[i - 1].tick) || keyframe->tick > header->ticks || keyframe->record > header->records_amount || keyframe->snapshot_offset % GAMEPLAY_REPLAY_FILE_ALIGNMENT != 0 || keyframe->snapshot_offset > file->size || keyframe->snapshot_size < sizeof(gameplay_snapshot_t) || keyframe->snapshot_size > file->size - keyframe->snapshot_offset)
+		{
+			return -1;
+		}
+		
+		snapshot = (const gameplay_snapshot_t *)(file->data + keyframe->snapshot_offset);
+		if(snapshot->size != keyframe->snapshot_size || snapshot->tick != keyframe->tick || snapshot->field_width != header->field_width || snapshot->field_height != header->field_height || gameplay_snapshot_validate(snapshot) == -1)
+		{
+			return -1;
+		}
+	}
+	
+	return 0;
+}
+
+/**
+ * This function opens a replay file. The file is memory mapped and its
+ * inputs are decoded.
+ * 
+ * @param file The opened file (write by pointer).
+ * @param path The path of the file.
+ * @return 0 on success, -1 on failure.
+ */
+int gameplay_replay_file_open(gameplay_replay_file_t *file, const char *path)
+{
+	int descriptor = 0;
+	void *data = NULL;
+	struct stat status;
+	
+	memset(file, 0, sizeof(gameplay_replay_file_t));
+	
+	core_debug("Reading replay: %s", path);
+	
+	descriptor = open(path, O_RDONLY);
+	if(descriptor == -1)
+	{
+		core_error("Failed to open replay: %s", path);
+		return -1;
+	}
+	
+	if(fstat(descriptor, &status) == -1 || status.st_size < (off_t)sizeof(gameplay_replay_file_header_t))
+	{
+		core_error("Invalid replay: %s", path);
+		close(descriptor);
+		return -1;
+	}
+	
+	data = mmap(NULL, status.st_size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+	close(descriptor);
+	if(data == MAP_FAILED)
+	{
+		core_error("Failed to map replay: %s", path);
+		return -1;
+	}
+	
+	file->data = data;
+	file->size = status.st_size;
+	file->header = data;
+	file->keyframes = (const gameplay_replay_file_keyframe_t *)(file->data + file->header->index_offset);
+	
+	if(gameplay_replay_file_validate(file) == -1)
+	{
+		core_error("Invalid replay: %s", path);
+		gameplay_replay_file_close(file);
+		return -1;
+	}
+	
+	file->replay.seed = file->header->seed;
+	file->replay.field_width = file->header->field_width;
+	file->replay.field_height = file->header->field_height;
+	file->replay.hash_period = file->header->hash_period;
+	file->replay.actions_recorded = (file->header->actions_recorded == 1);
+	file->replay.ticks = file->header->ticks;
+	file->replay.result = file->header->result;
+	
+	if(gameplay_replay_file_decode(file) == -1)
+	{
+		core_error("Invalid inputs in replay: %s", path);
+		gameplay_replay_file_close(file);
+		return -1;
+	}
+	
+	return 0;
+}
+
+/**
+ * This function closes a replay file.
+ * 
+ * @param file The file.
+ */
+void gameplay_replay_file_close(gameplay_replay_file_t *file)
+{
+	if(file->data != NULL)
+	{
+		munmap((void *)file->data, file->size);
+	}
+	
+	gameplay_replay_release(&(file->replay));
+	file->data = NULL;
+	file->size = 0;
+	file->header = NULL;
+	file->keyframes = NULL;
+}
+
+/**
+ * This function returns the snapshot of a keyframe. It points into the
+ * mapping of the file.
+ * 
+ * @param file The file.
+ * @param index The index of the keyframe.
+ * @return The snapshot.
+ */
+const gameplay_snapshot_t *gameplay_replay_file_keyframe(gameplay_replay_file_t *file, int index)
+{
+	return (const gameplay_snapshot_t *)(file->data + file->keyframes[index].snapshot_offset);
+}
+
+/**
+ * This function finds the last keyframe at or before a tick by a binary
+ * search in the index.
+ * 
+ * @param file The file.
+ * @param tick The tick.
+ * @return The index of the keyframe.
+ */
+int gameplay_replay_file_find_keyframe(gameplay_replay_file_t *file, unsigned int tick)
+{
+	int low = 0;
+	int high = 0;
+	int middle = 0;
+	
+	high = file->header->keyframes_amount - 1;
+	
+	while(low < high)
+	{
+		middle = (low + high + 1) / 2;
+		if(file->keyframes[middle].tick <= tick)
+		{
+			low = middle;
+		}
+		else
+		{
+			high = middle - 1;
+		}
+	}
+	
+	return low;
+}
+
+/**
+ * This function moves the playback of a replay file to a tick. The nearest
+ * keyframe is restored unless the tick is reached faster by playing on, so at
+ * most one keyframe period is simulated. The playback has to be initialized
+ * with the replay of the file.
+ * 
+ * @param file The file.
+ * @param playback The playback.
+ * @param tick The tick, it is limited to the end of the replay.
+ * @return 0 on success, -1 if the keyframe could not be restored.
+ */
+int gameplay_replay_file_seek(gameplay_replay_file_t *file, gameplay_replay_playback_t *playback, unsigned int tick)
+{
+	int index = 0;
+	const gameplay_snapshot_t *snapshot = NULL;
+	gameplay_sim_state_t *state = NULL;
+	
+	state = playback->state;
+	
+	if(tick > file->header->ticks)
+	{
+		tick = file->header->ticks;
+	}
+	
+	index = gameplay_replay_file_find_keyframe(file, tick);
+	
+	if(state->tick > tick || state->tick < file->keyframes[index].tick)
+	{
+		snapshot = gameplay_replay_file_keyframe(file, index);
+		if(gameplay_snapshot_restore(state->context, snapshot) == -1)
+		{
+			return -1;
+		}
+		
+		state->tick = snapshot->tick;
+		state->result = (snapshot->tick == file->header->ticks)?((gameplay_sim_result_t)file->header->result):(GAMEPLAY_SIM_RUNNING);
+		playback->record = file->keyframes[index].record;
+	}
+	
+	while(state->tick < tick && gameplay_replay_playback_finished(playback) == 0)
+	{
+		gameplay_replay_playback_step(playback);
+	}
+	
+	return 0;
+}
@@ -0,0 +1,94 @@
+/*
+ * Copyright (C) 2015 NIPE-SYSTEMS
+ * Copyright (C) 2015 Jonas Krug
+ * Copyright (C) 2015 Tim Gevers
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GAMEPLAY_REPLAY_FILE_H__
+#define __GAMEPLAY_REPLAY_FILE_H__
+
+#include <stddef.h>
+
+#include "game-context.h"
+#include "gameplay-sim.h"
+#include "gameplay-replay.h"
+#include "gameplay-snapshot.h"
+
+#define GAMEPLAY_REPLAY_FILE_MAGIC 0x50524254 // "TBRP"
+#define GAMEPLAY_REPLAY_FILE_VERSION 1
+// a snapshot of the state is stored every this many ticks
+#define GAMEPLAY_REPLAY_FILE_KEYFRAME_PERIOD 256
+// the sections of the file start at multiples of this alignment
+#define GAMEPLAY_REPLAY_FILE_ALIGNMENT 8
+
+/**
+ * The header at the start of a replay file. It is followed by the inputs,
+ * the keyframes and the index of the keyframes. All offsets are counted from
+ * the start of the file.
+ */
+typedef struct gameplay_replay_file_header_s
+{
+	unsigned int magic;
+	unsigned int version;
+	unsigned long long seed;
+	int field_width;
+	int field_height;
+	int hash_period;
+	int actions_recorded;
+	unsigned int ticks;
+	int result;
+	unsigned int keyframe_period;
+	unsigned int keyframes_amount;
+	unsigned int records_amount;
+	unsigned int inputs_offset;
+	unsigned int inputs_size;
+	unsigned int index_offset;
+} gameplay_replay_file_header_t;
+
+/**
+ * An entry of the index: the snapshot of the state after a tick and the
+ * first record which is played back after it.
+ */
+typedef struct gameplay_replay_file_keyframe_s
+{
+	unsigned int tick;
+	unsigned int record;
+	unsigned int snapshot_offset;
+	unsigned int snapshot_size;
+} gameplay_replay_file_keyframe_t;
+
+/**
+ * An opened replay file. The file is memory mapped, the keyframes are
+ * restored directly from the mapping. Only the inputs are decoded into the
+ * records of the replay when the file is opened.
+ */
+typedef struct gameplay_replay_file_s
+{
+	const unsigned char *data;
+	size_t size;
+	const gameplay_replay_file_header_t *header;
+	const gameplay_replay_file_keyframe_t *keyframes;
+	gameplay_replay_t replay;
+} gameplay_replay_file_t;
+
+int gameplay_replay_file_save(gameplay_replay_t *replay, game_context_t *context, const char *path);
+int gameplay_replay_file_open(gameplay_replay_file_t *file, const char *path);
+void gameplay_replay_file_close(gameplay_replay_file_t *file);
+const gameplay_snapshot_t *gameplay_replay_file_keyframe(gameplay_replay_file_t *file, int index);
+int gameplay_replay_file_find_keyframe(gameplay_replay_file_t *file, unsigned int tick);
+int gameplay_replay_file_seek(gameplay_replay_file_t *file, gameplay_replay_playback_t *playback, unsigned int tick);
+
+#endif /* __GAMEPLAY_REPLAY_FILE_H__ */
@@ -0,0 +1,496 @@
+/*
+ * Copyright (C) 2015 NIPE-SYSTEMS
+ * Copyright (C) 2015 Jonas Krug
+ * Copyright (C) 2015 Tim Gevers
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "gameplay-replay.h"
+#include "gameplay.h"
+#include "core-log.h"
+
+/**
+ * This function starts the recording of a match. It has to be called before
+ * the match is initialized because it takes the seed and the size of the
+ * next match from the context.
+ * 
+ * @param replay The replay which will be recorded.
+ * @param context The context of the match.
+ * @param hash_period The hash of the state is recorded every hash_period
+ *                    ticks, 0 records no hashes.
+ * @param actions_recorded 1 if the actions of the AI players should be
+ *                         recorded, otherwise 0.
+ */
+void gameplay_replay_init(gameplay_replay_t *replay, game_context_t *context, int hash_period, char actions_recorded)
+{
+	replay->seed = context->seed;
+	replay->field_width = context->size_width;
+	replay->field_height = context->size_height;
+	replay->hash_period = hash_period;
+	replay->actions_recorded = actions_recorded;
+	replay->ticks = 0;
+	replay->result = GAMEPLAY_SIM_RUNNING;
+	replay->records = NULL;
+	replay->records_amount = 0;
+	replay->records_capacity = 0;
+}
+
+/**
+ * This function appends a record to a replay.
+ * 
+ * @param replay The replay.
+ * @param record The record.
+ * @return 0 on success, -1 if the records could not be allocated.
+ */
+int gameplay_replay_append(gameplay_replay_t *replay, gameplay_replay_record_t *record)
+{
+	int capacity = 0;
+	gameplay_replay_record_t *records = NULL;
+	
+	if(replay->records_amount == replay->records_capacity)
+	{
+		capacity = (replay->records_capacity == 0)?(GAMEPLAY_REPLAY_RECORDS_CHUNK):(replay->records_capacity * 2);
+		records = realloc(replay->records, capacity * sizeof(gameplay_replay_record_t));
+		if(records == NULL)
+		{
+			core_error("Failed to allocate replay records.");
+			return -1;
+		}
+		
+		replay->records = records;
+		replay->records_capacity = capacity;
+	}
+	
+	replay->records[replay->records_amount++] = *record;
+	
+	return 0;
+}
+
+/**
+ * This function records one tick of a match. It has to be called after every
+ * step of the simulation with the inputs of the step. The hash is also
+ * recorded at the end of the match.
+ * 
+ * @param replay The replay.
+ * @param state The state of the match after the step.
+ * @param inputs The inputs of the step, may be NULL.
+ * @return 0 on success, -1 if the tick could not be recorded.
+ */
+int gameplay_replay_record(gameplay_replay_t *replay, gameplay_sim_state_t *state, gameplay_sim_inputs_t *inputs)
+{
+	int i = 0;
+	int actions_amount = 0;
+	gameplay_players_action_t *actions = NULL;
+	gameplay_replay_record_t record;
+	
+	// finished matches are not stepped anymore
+	if(state->tick == replay->ticks)
+	{
+		return 0;
+	}
+	
+	record.tick = state->tick;
+	record.key = 0;
+	record.action.id = 0;
+	record.action.step_x = 0;
+	record.action.step_y = 0;
+	record.action.moved = 0;
+	record.action.bomb = 0;
+	record.hash = 0;
+	
+	// the actions are executed in the update before the keys
+	if(replay->actions_recorded == 1)
+	{
+		record.type = GAMEPLAY_REPLAY_ACTION;
+		actions_amount = gameplay_players_get_actions(state->context, &actions);
+		for(i = 0; i < actions_amount; i++)
+		{
+			record.action = actions[i];
+			if(gameplay_replay_append(replay, &record) == -1)
+			{
+				return -1;
+			}
+		}
+		
+		record.action.id = 0;
+		record.action.step_x = 0;
+		record.action.step_y = 0;
+		record.action.moved = 0;
+		record.action.bomb = 0;
+	}
+	
+	record.type = GAMEPLAY_REPLAY_KEY;
+	for(i = 0; inputs != NULL && i < inputs->amount; i++)
+	{
+		record.key = inputs->keys[i];
+		if(gameplay_replay_append(replay, &record) == -1)
+		{
+			return -1;
+		}
+	}
+	
+	record.key = 0;
+	
+	if((replay->hash_period > 0 && state->tick % replay->hash_period == 0) || state->result != GAMEPLAY_SIM_RUNNING)
+	{
+		record.type = GAMEPLAY_REPLAY_HASH;
+		record.hash = gameplay_get_hash(state->context);
+		if(gameplay_replay_append(replay, &record) == -1)
+		{
+			return -1;
+		}
+	}
+	
+	replay->ticks = state->tick;
+	replay->result = state->result;
+	
+	return 0;
+}
+
+/**
+ * This function frees the records of a replay.
+ * 
+ * @param replay The replay.
+ */
+void gameplay_replay_release(gameplay_replay_t *replay)
+{
+	free(replay->records);
+	replay->records = NULL;
+	replay->records_amount = 0;
+	replay->records_capacity = 0;
+}
+
+/**
+ * This function writes a replay as plain text input log: a header followed by
+ * one line per record.
+ * 
+ * @param replay The replay.
+ * @param path The path of the file.
+ * @return 0 on success, -1 on failure.
+ */
+int gameplay_replay_save(gameplay_replay_t *replay, const char *path)
+{
+	int i = 0;
+	int written = 0;
+	FILE *file = NULL;
+	gameplay_replay_record_t *record = NULL;
+	
+	core_debug("Writing replay: %s", path);
+	
+	file = fopen(path, "w");
+	if(file == NULL)
+	{
+		core_error("Failed to open replay: %s", path);
+		return -1;
+	}
+	
+	written = fprintf(file, "turbo-bomber-replay %i\nseed %llu\nfield %i %i\nhash-period %i\nactions %i\nticks %u %i\nrecords %i\n", GAMEPLAY_REPLAY_VERSION, replay->seed, replay->field_width, replay->field_height, replay->hash_period, replay->actions_recorded, replay->ticks, replay->result, replay->records_amount);
+	
+	for(i = 0; i < replay->records_amount && written > 0; i++)
+	{
+		record = &(replay->records[i]);
+		
+		switch(record->type)
+		{
+			case GAMEPLAY_REPLAY_KEY:
+			{
+				written = fprintf(file, "%u k %i\n", record->tick, record->key);
+				break;
+			}
+			case GAMEPLAY_REPLAY_ACTION:
+			{
+				written = fprintf(file, "%u a %i %i %i %i %i\n", record->tick, record->action.id, record->action.step_x, record->action.step_y, record->action.moved, record->action.bomb);
+				break;
+			}
+			case GAMEPLAY_REPLAY_HASH:
+			{
+				written = fprintf(file, "%u h %016llx\n", record->tick, record->hash);
+				break;
+			}
+		}
+	}
+	
+	if(written <= 0 || fclose(file) != 0)
+	{
+		core_error("Failed to write replay: %s", path);
+		return -1;
+	}
+	
+	return 0;
+}
+
+/**
+ * This function reads a replay which was written by "gameplay_replay_save".
+ * The replay has to be released afterwards, also on failure.
+ * 
+ * @param replay The replay (write by pointer).
+ * @param path The path of the file.
+ * @return 0 on success, -1 on failure.
+ */
+int gameplay_replay_load(gameplay_replay_t *replay, const char *path)
+{
+	int i = 0;
+	int version = 0;
+	int actions_recorded = 0;
+	int result = 0;
+	int amount = 0;
+	int values[5];
+	char type = 0;
+	FILE *file = NULL;
+	gameplay_replay_record_t record;
+	
+	replay->records = NULL;
+	replay->records_amount = 0;
+	replay->records_capacity = 0;
+	
+	core_debug("Reading replay: %s", path);
+	
+	file = fopen(path, "r");
+	if(file == NULL)
+	{
+		core_error("Failed to open replay: %s", path);
+		return -1;
+	}
+	
+	if(fscanf(file, "turbo-bomber-replay %i seed %llu field %i %i hash-period %i actions %i ticks %u %i records %i", &version, &(replay->seed), &(replay->field_width), &(replay->field_height), &(replay->hash_period), &actions_recorded, &(replay->ticks), &result, &amount) != 9 || version != GAMEPLAY_REPLAY_VERSION || amount < 0)
+	{
+		core_error("Invalid replay: %s", path);
+		fclose(file);
+		return -1;
+	}
+	
+	replay->actions_recorded = (actions_recorded == 1);
+	replay->result = result;
+	
+	for(i = 0; i < amount; i++)
+	{
+		record.key = 0;
+		record.action.id = 0;
+		record.action.step_x = 0;
+		record.action.step_y = 0;
+		record.action.moved = 0;
+		record.action.bomb = 0;
+		record.hash = 0;
+		
+		if(fscanf(file, "%u %c", &(record.tick), &type) != 2)
+		{
+			break;
+		}
+		
+		if(type == 'k' && fscanf(file, "%i", &values[0]) == 1)
+		{
+			record.type = GAMEPLAY_REPLAY_KEY;
+			record.key = values[0];
+		}
+		else if(type == 'a' && fscanf(file, "%i %i %i %i %i", &values[0], &values[1], &values[2], &values[3], &values[4]) == 5)
+		{
+			record.type = GAMEPLAY_REPLAY_ACTION;
+			record.action.id = values[0];
+			record.action.step_x = values[1];
+			record.action.step_y = values[2];
+			record.action.moved = values[3];
+			record.action.bomb = values[4];
+		}
+		else if(type == 'h' && fscanf(file, "%llx", &(record.hash)) == 1)
+		{
+			record.type = GAMEPLAY_REPLAY_HASH;
+		}
+		else
+		{
+			break;
+		}
+		
+		// the playback relies on records ordered by tick
+		if((i > 0 && record.tick < replay->records[i - 1].tick) || record.tick > replay->ticks || gameplay_replay_append(replay, &record) == -1)
+		{
+			break;
+		}
+	}
+	
+	fclose(file);
+	
+	if(i < amount)
+	{
+		core_error("Invalid record %i in replay: %s", i, path);
+		return -1;
+	}
+	
+	return 0;
+}
+
+/**
+ * This function starts the playback of a replay. The match is initialized
+ * with the seed and the size of the field of the replay.
+ * 
+ * @param playback The playback (write by pointer).
+ * @param replay The replay.
+ * @param state The state of the match which will be initialized.
+ * @param context The context which holds the match.
+ * @return 0 on success, -1 if the match could not be initialized.
+ */
+int gameplay_replay_playback_init(gameplay_replay_playback_t *playback, gameplay_replay_t *replay, gameplay_sim_state_t *state, game_context_t *context)
+{
+	playback->replay = replay;
+	playback->state = state;
+	playback->record = 0;
+	playback->mismatches = 0;
+	playback->mismatch_tick = 0;
+	
+	if(gameplay_set_size(context, replay->field_width, replay->field_height) == -1)
+	{
+		return -1;
+	}
+	
+	gameplay_set_seed(context, replay->seed);
+	
+	if(gameplay_sim_init(state, context) == -1)
+	{
+		return -1;
+	}
+	
+	if(replay->actions_recorded == 1)
+	{
+		gameplay_players_replay_actions(context);
+	}
+	
+	return 0;
+}
+
+/**
+ * This function advances the playback by one tick. The recorded keys and
+ * actions of the tick are applied and the recorded hashes are compared with
+ * the hash of the simulated state.
+ * 
+ * @param playback The playback.
+ * @return The result of the match after the tick.
+ */
+gameplay_sim_result_t gameplay_replay_playback_step(gameplay_replay_playback_t *playback)
+{
+	unsigned int tick = 0;
+	gameplay_replay_record_t *record = NULL;
+	gameplay_replay_t *replay = NULL;
+	gameplay_sim_inputs_t inputs;
+	
+	replay = playback->replay;
+	
+	if(gameplay_replay_playback_finished(playback) == 1)
+	{
+		return playback->state->result;
+	}
+	
+	tick = playback->state->tick + 1;
+	gameplay_sim_inputs_clear(&inputs);
+	
+	for(; playback->record < replay->records_amount; playback->record++)
+	{
+		record = &(replay->records[playback->record]);
+		if(record->tick != tick || record->type == GAMEPLAY_REPLAY_HASH)
+		{
+			break;
+		}
+		
+		if(record->type == GAMEPLAY_REPLAY_KEY)
+		{
+			gameplay_sim_inputs_add(&inputs, record->key);
+		}
+		else
+		{
+			gameplay_players_replay_action(playback->state->context, &(record->action));
+		}
+	}
+	
+	gameplay_sim_step(playback->state, &inputs);
+	
+	for(; playback->record < replay->records_amount; playback->record++)
+	{
+		record = &(replay->records[playback->record]);
+		if(record->tick != tick)
+		{
+			break;
+		}
+		
+		if(record->type == GAMEPLAY_REPLAY_HASH && record->hash != gameplay_get_hash(playback->state->context))
+		{
+			core_error("Replay diverged at tick %u.", tick);
+			if(playback->mismatches == 0)
+			{
+				playback->mismatch_tick = tick;
+			}
+			
+			playback->mismatches++;
+		}
+	}
+	
+	return playback->state->result;
+}
+
+/**
+ * This function tests whether all ticks of a replay are played back.
+ * 
+ * @param playback The playback.
+ * @return 1 if the playback is finished, otherwise 0.
+ */
+int gameplay_replay_playback_finished(gameplay_replay_playback_t *playback)
+{
+	return (playback->state->result != GAMEPLAY_SIM_RUNNING || playback->state->tick >= playback->replay->ticks);
+}
+
+/**
+ * This function plays back a complete replay as fast as possible without
+ * rendering and verifies the recorded hashes and the result of the match.
+ * 
+ * @param replay The replay.
+ * @param context The context in which the match is simulated.
+ * @param mismatch_tick The first tick which differs from the recording
+ *                      (write by pointer).
+ * @return 0 if the match was reproduced, otherwise -1.
+ */
+int gameplay_replay_play(gameplay_replay_t *replay, game_context_t *context, unsigned int *mismatch_tick)
+{
+	int result = 0;
+	gameplay_sim_state_t state;
+	gameplay_replay_playback_t playback;
+	
+	*mismatch_tick = 0;
+	
+	if(gameplay_replay_playback_init(&playback, replay, &state, context) == -1)
+	{
+		core_error("Failed to initialize playback.");
+		return -1;
+	}
+	
+	while(gameplay_replay_playback_finished(&playback) == 0)
+	{
+		gameplay_replay_playback_step(&playback);
+	}
+	
+	if(playback.mismatches > 0)
+	{
+		*mismatch_tick = playback.mismatch_tick;
+		result = -1;
+	}
+	else if(state.tick != replay->ticks || state.result != replay->result)
+	{
+		*mismatch_tick = state.tick;
+		result = -1;
+	}
+	
+	gameplay_sim_cleanup(&state);
+	
+	return result;
+}
@@ -0,0 +1,93 @@
+/*
+ * Copyright (C) 2015 NIPE-SYSTEMS
+ * Copyright (C) 2015 Jonas Krug
+ * Copyright (C) 2015 Tim Gevers
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GAMEPLAY_REPLAY_H__
+#define __GAMEPLAY_REPLAY_H__
+
+#include "game-context.h"
+#include "gameplay-sim.h"
+#include "gameplay-players.h"
+
+#define GAMEPLAY_REPLAY_VERSION 1
+#define GAMEPLAY_REPLAY_RECORDS_CHUNK 1024
+// the hash of the state is recorded every this many ticks
+#define GAMEPLAY_REPLAY_HASH_PERIOD 64
+
+typedef enum gameplay_replay_type_e
+{
+	GAMEPLAY_REPLAY_KEY,
+	GAMEPLAY_REPLAY_ACTION,
+	GAMEPLAY_REPLAY_HASH
+} gameplay_replay_type_t;
+
+/**
+ * One entry of the input log: a key of the user player, an action of an AI
+ * player or the hash of the state after the tick.
+ */
+typedef struct gameplay_replay_record_s
+{
+	unsigned int tick;
+	gameplay_replay_type_t type;
+	char key;
+	gameplay_players_action_t action;
+	unsigned long long hash;
+} gameplay_replay_record_t;
+
+/**
+ * A recorded match. The seed and the size of the field together with the
+ * inputs of every tick are enough to simulate the match again.
+ */
+typedef struct gameplay_replay_s
+{
+	unsigned long long seed;
+	int field_width;
+	int field_height;
+	int hash_period;
+	// whether the actions of the AI players are recorded (needed if the AI
+	// depends on time budgets or runs in the background)
+	char actions_recorded;
+	unsigned int ticks;
+	gameplay_sim_result_t result;
+	gameplay_replay_record_t *records;
+	int records_amount;
+	int records_capacity;
+} gameplay_replay_t;
+
+typedef struct gameplay_replay_playback_s
+{
+	gameplay_replay_t *replay;
+	gameplay_sim_state_t *state;
+	// the next record which is applied
+	int record;
+	int mismatches;
+	unsigned int mismatch_tick;
+} gameplay_replay_playback_t;
+
+void gameplay_replay_init(gameplay_replay_t *replay, game_context_t *context, int hash_period, char actions_recorded);
+int gameplay_replay_append(gameplay_replay_t *replay, gameplay_replay_record_t *record);
+int gameplay_replay_record(gameplay_replay_t *replay, gameplay_sim_state_t *state, gameplay_sim_inputs_t *inputs);
+void gameplay_replay_release(gameplay_replay_t *replay);
+int gameplay_replay_save(gameplay_replay_t *replay, const char *path);
+int gameplay_replay_load(gameplay_replay_t *replay, const char *path);
+int gameplay_replay_playback_init(gameplay_replay_playback_t *playback, gameplay_replay_t *replay, gameplay_sim_state_t *state, game_context_t *context);
+gameplay_sim_result_t gameplay_replay_playback_step(gameplay_replay_playback_t *playback);
+int gameplay_replay_playback_finished(gameplay_replay_playback_t *playback);
+int gameplay_replay_play(gameplay_replay_t *replay, game_context_t *context, unsigned int *mismatch_tick);
+
+#endif /* __GAMEPLAY_REPLAY_H__ */
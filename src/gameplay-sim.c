@@ -0,0 +1,141 @@
+/*
+ * Copyright (C) 2015 NIPE-SYSTEMS
+ * Copyright (C) 2015 Jonas Krug
+ * Copyright (C) 2015 Tim Gevers
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+
+#include "gameplay-sim.h"
+#include "gameplay.h"
+#include "gameplay-players.h"
+#include "gameplay-timers.h"
+#include "core-log.h"
+
+/**
+ * This function starts a new match on the field size set with
+ * "gameplay_set_size". The simulation has no terminal dependency, callers
+ * decide how fast the ticks are stepped. Matches with different contexts are
+ * independent of each other and may be stepped by different threads. The
+ * context is left clean when the match fails to start, so it can be
+ * initialized again.
+ * 
+ * @param state The state of the match which will be initialized.
+ * @param context The context which holds the match.
+ * @return 0 on success, -1 if the field could not be initialized.
+ */
+int gameplay_sim_init(gameplay_sim_state_t *state, game_context_t *context)
+{
+	state->context = context;
+	state->tick = 0;
+	state->result = GAMEPLAY_SIM_RUNNING;
+	
+	if(gameplay_init(state->context) == -1)
+	{
+		core_error("Failed to initialize simulation.");
+		gameplay_cleanup(state->context);
+		return -1;
+	}
+	
+	return 0;
+}
+
+/**
+ * This function removes all keys from inputs.
+ * 
+ * @param inputs The inputs to clear.
+ */
+void gameplay_sim_inputs_clear(gameplay_sim_inputs_t *inputs)
+{
+	inputs->amount = 0;
+}
+
+/**
+ * This function appends a key of the user player to inputs.
+ * 
+ * @param inputs The inputs of one tick.
+ * @param key The pressed key.
+ * @return 0 on success, -1 if the inputs are full.
+ */
+int gameplay_sim_inputs_add(gameplay_sim_inputs_t *inputs, char key)
+{
+	if(inputs->amount >= GAMEPLAY_SIM_INPUTS_MAX)
+	{
+		core_error("Too many inputs in one tick, dropped key %i.", key);
+		return -1;
+	}
+	
+	inputs->keys[inputs->amount] = key;
+	inputs->amount++;
+	
+	return 0;
+}
+
+/**
+ * This function advances the match by one tick. The inputs are applied after
+ * the update of the tick in the order of the keys, like the game loop does.
+ * Finished matches are not advanced anymore.
+ * 
+ * @param state The state of the match.
+ * @param inputs The inputs of the user player in this tick, may be NULL.
+ * @return The result of the match after the tick.
+ */
+gameplay_sim_result_t gameplay_sim_step(gameplay_sim_state_t *state, gameplay_sim_inputs_t *inputs)
+{
+	int i = 0;
+	gameplay_players_player_t *player = NULL;
+	
+	if(state->result != GAMEPLAY_SIM_RUNNING)
+	{
+		return state->result;
+	}
+	
+	gameplay_update(state->context);
+	
+	if(inputs != NULL)
+	{
+		for(i = 0; i < inputs->amount; i++)
+		{
+			gameplay_key(state->context, inputs->keys[i]);
+		}
+	}
+	
+	state->tick = gameplay_timers_get_tick(state->context);
+	
+	player = gameplay_players_get_user(state->context);
+	if(player == NULL || player->health_points == 0)
+	{
+		state->result = GAMEPLAY_SIM_GAME_OVER;
+	}
+	else if(gameplay_players_ai_amount(state->context) == 0)
+	{
+		state->result = GAMEPLAY_SIM_WIN;
+	}
+	
+	return state->result;
+}
+
+/**
+ * This function ends a match and frees all entities of it. The field memory
+ * is kept in the context for the next match until "game_context_destroy" is
+ * called.
+ * 
+ * @param state The state of the match.
+ */
+void gameplay_sim_cleanup(gameplay_sim_state_t *state)
+{
+	gameplay_cleanup(state->context);
+}
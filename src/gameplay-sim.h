@@ -0,0 +1,58 @@
+/*
+ * Copyright (C) 2015 NIPE-SYSTEMS
+ * Copyright (C) 2015 Jonas Krug
+ * Copyright (C) 2015 Tim Gevers
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GAMEPLAY_SIM_H__
+#define __GAMEPLAY_SIM_H__
+
+#include "game-context.h"
+
+// maximum amount of keys of the user player per tick
+#define GAMEPLAY_SIM_INPUTS_MAX 16
+
+typedef enum gameplay_sim_result_e
+{
+	GAMEPLAY_SIM_RUNNING,
+	GAMEPLAY_SIM_WIN,
+	GAMEPLAY_SIM_GAME_OVER
+} gameplay_sim_result_t;
+
+/**
+ * The keys of the user player which are applied in one tick. The keys are the
+ * same as in the game (e.g. 'w' moves up, ' ' places a bomb).
+ */
+typedef struct gameplay_sim_inputs_s
+{
+	int amount;
+	char keys[GAMEPLAY_SIM_INPUTS_MAX];
+} gameplay_sim_inputs_t;
+
+typedef struct gameplay_sim_state_s
+{
+	game_context_t *context;
+	unsigned int tick;
+	gameplay_sim_result_t result;
+} gameplay_sim_state_t;
+
+int gameplay_sim_init(gameplay_sim_state_t *state, game_context_t *context);
+void gameplay_sim_inputs_clear(gameplay_sim_inputs_t *inputs);
+int gameplay_sim_inputs_add(gameplay_sim_inputs_t *inputs, char key);
+gameplay_sim_result_t gameplay_sim_step(gameplay_sim_state_t *state, gameplay_sim_inputs_t *inputs);
+void gameplay_sim_cleanup(gameplay_sim_state_t *state);
+
+#endif /* __GAMEPLAY_SIM_H__ */
@@ -0,0 +1,280 @@
+/*
+ * Copyright (C) 2015 NIPE-SYSTEMS
+ * Copyright (C) 2015 Jonas Krug
+ * Copyright (C) 2015 Tim Gevers
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "gameplay-snapshot.h"
+#include "gameplay.h"
+#include "gameplay-timers.h"
+#include "gameplay-events.h"
+#include "gameplay-players.h"
+#include "gameplay-bombs.h"
+#include "gameplay-items.h"
+#include "ai-openings.h"
+#include "core-log.h"
+
+static void gameplay_snapshot_layout(game_context_t *context, gameplay_snapshot_t *snapshot);
+
+/**
+ * This function counts the entities of a match and places the sections of a
+ * snapshot behind the header.
+ * 
+ * @param context The context of the match.
+ * @param snapshot The header of the snapshot (write by pointer).
+ */
+static void gameplay_snapshot_layout(game_context_t *context, gameplay_snapshot_t *snapshot)
+{
+	snapshot->field_width = GAMEPLAY_FIELD_WIDTH(context);
+	snapshot->field_height = GAMEPLAY_FIELD_HEIGHT(context);
+	snapshot->players_amount = gameplay_players_amount(context);
+	snapshot->bombs_amount = gameplay_bombs_amount(context);
+	snapshot->items_amount = gameplay_items_amount(context);
+	snapshot->fire_amount = gameplay_fire_amount(context);
+	
+	// all records consist of 4 byte members, the bytes of the tiles follow
+	// at the end
+	snapshot->players_offset = sizeof(gameplay_snapshot_t);
+	snapshot->bombs_offset = snapshot->players_offset + snapshot->players_amount * sizeof(gameplay_snapshot_player_t);
+	snapshot->items_offset = snapshot->bombs_offset + snapshot->bombs_amount * sizeof(gameplay_snapshot_bomb_t);
+	snapshot->fire_offset = snapshot->items_offset + snapshot->items_amount * sizeof(gameplay_snapshot_item_t);
+	snapshot->field_offset = snapshot->fire_offset + snapshot->fire_amount * sizeof(gameplay_snapshot_fire_t);
+	snapshot->size = snapshot->field_offset + 2 * GAMEPLAY_FIELD_TILES(context);
+}
+
+/**
+ * This function returns the size of a snapshot of the current state of a
+ * match. It changes with the amount of entities.
+ * 
+ * @param context The context of the match.
+ * @return The size in bytes.
+ */
+size_t gameplay_snapshot_size(game_context_t *context)
+{
+	gameplay_snapshot_t snapshot;
+	
+	gameplay_snapshot_layout(context, &snapshot);
+	
+	return snapshot.size;
+}
+
+/**
+ * This function writes the state of a match into a snapshot. It must be
+ * called between two gameplay updates.
+ * 
+ * @param context The context of the match.
+ * @param snapshot The block which is written.
+ * @param capacity The size of the block in bytes.
+ * @return 0 on success, -1 if the block is too small.
+ */
+int gameplay_snapshot_capture(game_context_t *context, gameplay_snapshot_t *snapshot, size_t capacity)
+{
+	if(capacity < sizeof(gameplay_snapshot_t))
+	{
+		core_error("Snapshot block too small.");
+		return -1;
+	}
+	
+	gameplay_snapshot_layout(context, snapshot);
+	if(capacity < snapshot->size)
+	{
+		core_error("Snapshot block too small (%u bytes needed).", snapshot->size);
+		return -1;
+	}
+	
+	snapshot->tick = gameplay_timers_get_tick(context);
+	
+	gameplay_capture(context, snapshot);
+	gameplay_items_capture(context, snapshot);
+	gameplay_players_capture(context, snapshot);
+	gameplay_bombs_capture(context, snapshot);
+	ai_openings_capture(context, snapshot);
+	
+	return 0;
+}
+
+/**
+ * This function tests that the sections of a snapshot lie inside its block
+ * and that its records only refer to tiles of its field and to records of
+ * its sections. Snapshots which are read from files are tested before they
+ * are used.
+ * 
+ * @param snapshot The snapshot, at least its header must be readable.
+ * @return 0 if the snapshot is valid, otherwise -1.
+ */
+int gameplay_snapshot_validate(const gameplay_snapshot_t *snapshot)
+{
+	int i = 0;
+	int tiles = 0;
+	unsigned long long offset = 0;
+	const gameplay_snapshot_player_t *players = NULL;
+	const gameplay_snapshot_bomb_t *bombs = NULL;
+	const gameplay_snapshot_item_t *items = NULL;
+	const gameplay_snapshot_fire_t *fire = NULL;
+	
+	if(snapshot->field_width < GAMEPLAY_FIELD_SIZE_MIN || snapshot->field_width > GAMEPLAY_FIELD_SIZE_MAX || snapshot->field_height < GAMEPLAY_FIELD_SIZE_MIN || snapshot->field_height > GAMEPLAY_FIELD_SIZE_MAX)
+	{
+		return -1;
+	}
+	
+	if(snapshot->players_amount < 0 || snapshot->bombs_amount < 0 || snapshot->items_amount < 0 || snapshot->fire_amount < 0)
+	{
+		return -1;
+	}
+	
+	// the sections have to be placed exactly like gameplay_snapshot_layout
+	// does, the sums are calculated in 64 bit so they cannot overflow
+	tiles = snapshot->field_width * snapshot->field_height;
+	offset = sizeof(gameplay_snapshot_t);
+	if(snapshot->players_offset != offset)
+	{
+		return -1;
+	}
+	
+	offset += (unsigned long long)snapshot->players_amount * sizeof(gameplay_snapshot_player_t);
+	if(snapshot->bombs_offset != offset)
+	{
+		return -1;
+	}
+	
+	offset += (unsigned long long)snapshot->bombs_amount * sizeof(gameplay_snapshot_bomb_t);
+	if(snapshot->items_offset != offset)
+	{
+		return -1;
+	}
+	
+	offset += (unsigned long long)snapshot->items_amount * sizeof(gameplay_snapshot_item_t);
+	if(snapshot->fire_offset != offset)
+	{
+		return -1;
+	}
+	
+	offset += (unsigned long long)snapshot->fire_amount * sizeof(gameplay_snapshot_fire_t);
+	if(snapshot->field_offset != offset || snapshot->size != offset + 2 * tiles)
+	{
+		return -1;
+	}
+	
+	players = GAMEPLAY_SNAPSHOT_SECTION(snapshot, gameplay_snapshot_player_t, players);
+	for(i = 0; i < snapshot->players_amount; i++)
+	{
+		if(players[i].position_x < 0 || players[i].position_x >= snapshot->field_width || players[i].position_y < 0 || players[i].position_y >= snapshot->field_height || players[i].tile_rank < 0 || players[i].tile_rank >= snapshot->players_amount || players[i].opening < -1 || players[i].opening_step < 0)
+		{
+			return -1;
+		}
+	}
+	
+	bombs = GAMEPLAY_SNAPSHOT_SECTION(snapshot, gameplay_snapshot_bomb_t, bombs);
+	for(i = 0; i < snapshot->bombs_amount; i++)
+	{
+		if(bombs[i].index < 0 || bombs[i].index >= tiles || bombs[i].owner < -1 || bombs[i].owner >= snapshot->players_amount)
+		{
+			return -1;
+		}
+	}
+	
+	items = GAMEPLAY_SNAPSHOT_SECTION(snapshot, gameplay_snapshot_item_t, items);
+	for(i = 0; i < snapshot->items_amount; i++)
+	{
+		if(items[i].index < 0 || items[i].index >= tiles || items[i].active_index < 0 || items[i].active_index >= snapshot->items_amount)
+		{
+			return -1;
+		}
+	}
+	
+	fire = GAMEPLAY_SNAPSHOT_SECTION(snapshot, gameplay_snapshot_fire_t, fire);
+	for(i = 0; i < snapshot->fire_amount; i++)
+	{
+		if(fire[i].index < 0 || fire[i].index >= tiles || fire[i].active_index < 0 || fire[i].active_index >= snapshot->fire_amount)
+		{
+			return -1;
+		}
+	}
+	
+	return 0;
+}
+
+/**
+ * This function replaces the state of a match by a snapshot. The match must
+ * be initialized with the size of the field of the snapshot. All consumers
+ * of the gameplay events rescan the restored state. If the restore fails the
+ * match has to be initialized again.
+ * 
+ * @param context The context of the match.
+ * @param snapshot The snapshot.
+ * @return 0 on success, -1 if the snapshot is invalid or does not fit the
+ *         match.
+ */
+int gameplay_snapshot_restore(game_context_t *context, const gameplay_snapshot_t *snapshot)
+{
+	if(gameplay_snapshot_validate(snapshot) == -1)
+	{
+		core_error("Invalid snapshot.");
+		return -1;
+	}
+	
+	if(snapshot->field_width != GAMEPLAY_FIELD_WIDTH(context) || snapshot->field_height != GAMEPLAY_FIELD_HEIGHT(context))
+	{
+		core_error("Snapshot of a %ix%i field does not fit.", snapshot->field_width, snapshot->field_height);
+		return -1;
+	}
+	
+	// the wheels are emptied first, the modules schedule the timers of the
+	// restored entities again
+	gameplay_timers_restore(context, snapshot->tick);
+	
+	gameplay_restore(context, snapshot);
+	gameplay_items_restore(context, snapshot);
+	if(gameplay_players_restore(context, snapshot) == -1 || gameplay_bombs_restore(context, snapshot) == -1)
+	{
+		core_error("Failed to restore snapshot.");
+		return -1;
+	}
+	
+	ai_openings_restore(context, snapshot);
+	
+	// the events of the replaced state are dropped
+	gameplay_events_init(context);
+	
+	gameplay_hash_rebuild(context);
+	
+	return 0;
+}
+
+/**
+ * This function copies a snapshot into a new block.
+ * 
+ * @param snapshot The snapshot.
+ * @return The copy (freed by the caller) or NULL on error.
+ */
+gameplay_snapshot_t *gameplay_snapshot_clone(const gameplay_snapshot_t *snapshot)
+{
+	gameplay_snapshot_t *clone = NULL;
+	
+	clone = malloc(snapshot->size);
+	if(clone == NULL)
+	{
+		core_error("Failed to allocate snapshot.");
+		return NULL;
+	}
+	
+	memcpy(clone, snapshot, snapshot->size);
+	
+	return clone;
+}
@@ -0,0 +1,132 @@
+/*
+ * Copyright (C) 2015 NIPE-SYSTEMS
+ * Copyright (C) 2015 Jonas Krug
+ * Copyright (C) 2015 Tim Gevers
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GAMEPLAY_SNAPSHOT_H__
+#define __GAMEPLAY_SNAPSHOT_H__
+
+#include <stddef.h>
+
+#include "game-context.h"
+
+// the records of a section of a snapshot, the sections are addressed by byte
+// offsets from the start of the block
+#define GAMEPLAY_SNAPSHOT_SECTION(snapshot, type, section) ((type *)((char *)(snapshot) + (snapshot)->section##_offset))
+
+/**
+ * A player of a snapshot. The players are stored in the order of the player
+ * list.
+ */
+typedef struct gameplay_snapshot_player_s
+{
+	int id;
+	int health_points;
+	unsigned int movement_ready_tick;
+	int movement_cooldown_initial;
+	int position_x;
+	int position_y;
+	int placeable_bombs;
+	int placed_bombs;
+	int explosion_radius;
+	int item;
+	unsigned int item_usage_tick;
+	unsigned int damage_ready_tick;
+	int damage_cooldown_initial;
+	int type;
+	int ai;
+	int turbo_mode_activated;
+	// the position in the player list of the tile
+	int tile_rank;
+	// the plan and the step of the AI opening (-1 if no opening is replayed)
+	int opening;
+	int opening_step;
+} gameplay_snapshot_player_t;
+
+/**
+ * A bomb of a snapshot. The bombs are stored in the order of the bomb list,
+ * which is the order in which their timers were scheduled. The owner is the
+ * index of the player in the players section (-1 without owner).
+ */
+typedef struct gameplay_snapshot_bomb_s
+{
+	int index;
+	int owner;
+	int explosion_radius;
+	unsigned int explosion_tick;
+} gameplay_snapshot_bomb_t;
+
+/**
+ * An item of a snapshot. The items are stored in the order of their timers,
+ * the active index is the position in the list of placed items.
+ */
+typedef struct gameplay_snapshot_item_s
+{
+	int index;
+	int active_index;
+	int type;
+	unsigned int despawn_tick;
+} gameplay_snapshot_item_t;
+
+/**
+ * A burning tile of a snapshot. The tiles are stored in the order of their
+ * timers, the active index is the position in the list of burning tiles.
+ */
+typedef struct gameplay_snapshot_fire_s
+{
+	int index;
+	int active_index;
+	unsigned int despawn_tick;
+} gameplay_snapshot_fire_t;
+
+/**
+ * A snapshot of a match in one contiguous block without pointers. The header
+ * is followed by the sections of the players, bombs, items and burning tiles
+ * and by the types and fire flags of all tiles. Entities refer to tiles and
+ * to each other by indices, so a block can be copied with memcpy, moved to
+ * another address or written to a file.
+ */
+typedef struct gameplay_snapshot_s
+{
+	// the size of the complete block in bytes
+	unsigned int size;
+	int field_width;
+	int field_height;
+	unsigned int tick;
+	// the state of the random drops in 32 bit halves
+	unsigned int random[8];
+	// the letters of the turbo mode which were already typed (one bit each)
+	unsigned int turbo;
+	int players_next_id;
+	int players_amount;
+	int bombs_amount;
+	int items_amount;
+	int fire_amount;
+	unsigned int players_offset;
+	unsigned int bombs_offset;
+	unsigned int items_offset;
+	unsigned int fire_offset;
+	unsigned int field_offset;
+} gameplay_snapshot_t;
+
+size_t gameplay_snapshot_size(game_context_t *context);
+int gameplay_snapshot_capture(game_context_t *context, gameplay_snapshot_t *snapshot, size_t capacity);
+int gameplay_snapshot_validate(const gameplay_snapshot_t *snapshot);
+int gameplay_snapshot_restore(game_context_t *context, const gameplay_snapshot_t *snapshot);
+gameplay_snapshot_t *gameplay_snapshot_clone(const gameplay_snapshot_t *snapshot);
+
+#endif /* __GAMEPLAY_SNAPSHOT_H__ */
@@ -0,0 +1,337 @@
+/*
+ * Copyright (C) 2015 NIPE-SYSTEMS
+ * Copyright (C) 2015 Jonas Krug
+ * Copyright (C) 2015 Tim Gevers
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+
+#include "gameplay-timers.h"
+#include "core-log.h"
+
+static int gameplay_timers_get_list(game_context_t *context, unsigned int tick);
+static void gameplay_timers_append(game_context_t *context, gameplay_timers_timer_t *timer);
+static void gameplay_timers_unlink(game_context_t *context, gameplay_timers_timer_t *timer, int list);
+
+struct gameplay_timers_context_s
+{
+	unsigned int tick;
+	
+	// one hashed timing wheel for each kind of entity, so every gameplay
+	// module can expire its timers at its own point of the update. The slots
+	// only hold the timers of the current round of the wheel, the timers of
+	// later rounds wait in the overflow list behind the slots (index
+	// GAMEPLAY_TIMERS_SLOTS) until their round starts.
+	gameplay_timers_timer_t *heads[GAMEPLAY_TIMERS_WHEELS][GAMEPLAY_TIMERS_SLOTS + 1];
+	gameplay_timers_timer_t *tails[GAMEPLAY_TIMERS_WHEELS][GAMEPLAY_TIMERS_SLOTS + 1];
+};
+
+/**
+ * This function empties all wheels and resets the tick. The modules must
+ * cancel the timers of their entities before.
+ * 
+ * @param context The context of the match.
+ * @return 0 on success, -1 if the wheels could not be allocated.
+ */
+int gameplay_timers_init(game_context_t *context)
+{
+	if(context->timers == NULL)
+	{
+		context->timers = malloc(sizeof(gameplay_timers_context_t));
+		if(context->timers == NULL)
+		{
+			return -1;
+		}
+	}
+	
+	gameplay_timers_restore(context, 0);
+	
+	return 0;
+}
+
+/**
+ * This function empties all wheels and sets the tick. It is used when a
+ * snapshot is restored, the modules schedule the timers of their restored
+ * entities afterwards.
+ * 
+ * @param context The context of the match.
+ * @param tick The tick.
+ */
+void gameplay_timers_restore(game_context_t *context, unsigned int tick)
+{
+	int wheel = 0;
+	int slot = 0;
+	
+	for(wheel = 0; wheel < GAMEPLAY_TIMERS_WHEELS; wheel++)
+	{
+		for(slot = 0; slot <= GAMEPLAY_TIMERS_SLOTS; slot++)
+		{
+			context->timers->heads[wheel][slot] = NULL;
+			context->timers->tails[wheel][slot] = NULL;
+		}
+	}
+	
+	context->timers->tick = tick;
+}
+
+/**
+ * This function frees the wheels.
+ * 
+ * @param context The context of the match.
+ */
+void gameplay_timers_release(game_context_t *context)
+{
+	free(context->timers);
+	context->timers = NULL;
+}
+
+/**
+ * This function advances the global tick. It is called once at the start of
+ * every gameplay update. When a new round of the wheels starts, the timers of
+ * this round are moved from the overflow lists into the slots in the order
+ * they were scheduled.
+ * 
+ * @param context The context of the match.
+ */
+void gameplay_timers_advance(game_context_t *context)
+{
+	int wheel = 0;
+	gameplay_timers_timer_t *current = NULL;
+	gameplay_timers_timer_t *next_backup = NULL;
+	
+	context->timers->tick++;
+	
+	if(context->timers->tick % GAMEPLAY_TIMERS_SLOTS != 0)
+	{
+		return;
+	}
+	
+	for(wheel = 0; wheel < GAMEPLAY_TIMERS_WHEELS; wheel++)
+	{
+		for(current = context->timers->heads[wheel][GAMEPLAY_TIMERS_SLOTS]; current != NULL; current = next_backup)
+		{
+			next_backup = current->next;
+			
+			if(gameplay_timers_get_list(context, current->tick) != GAMEPLAY_TIMERS_SLOTS)
+			{
+				gameplay_timers_unlink(context, current, GAMEPLAY_TIMERS_SLOTS);
+				gameplay_timers_append(context, current);
+			}
+		}
+	}
+}
+
+/**
+ * This function returns the global tick.
+ * 
+ * @param context The context of the match.
+ * @return The number of the current gameplay update.
+ */
+unsigned int gameplay_timers_get_tick(game_context_t *context)
+{
+	return context->timers->tick;
+}
+
+/**
+ * This function calculates the list of a wheel which holds the timers of a
+ * tick: the slot of the tick if it belongs to the current round of the
+ * wheel, otherwise the overflow list.
+ * 
+ * @param context The context of the match.
+ * @param tick The tick at which the timers expire.
+ * @return The index of the slot or GAMEPLAY_TIMERS_SLOTS for the overflow
+ *         list.
+ */
+static int gameplay_timers_get_list(game_context_t *context, unsigned int tick)
+{
+	unsigned int round = 0;
+	
+	round = context->timers->tick - context->timers->tick % GAMEPLAY_TIMERS_SLOTS;
+	
+	if(tick >= round + GAMEPLAY_TIMERS_SLOTS)
+	{
+		return GAMEPLAY_TIMERS_SLOTS;
+	}
+	
+	return tick % GAMEPLAY_TIMERS_SLOTS;
+}
+
+/**
+ * This function appends a timer to the end of its list, so timers expire in
+ * the order they were scheduled.
+ * 
+ * @param context The context of the match.
+ * @param timer The timer which is not in a list yet.
+ */
+static void gameplay_timers_append(game_context_t *context, gameplay_timers_timer_t *timer)
+{
+	int list = 0;
+	
+	list = gameplay_timers_get_list(context, timer->tick);
+	
+	timer->scheduled = 1;
+	timer->next = NULL;
+	timer->previous = context->timers->tails[timer->wheel][list];
+	
+	if(timer->previous == NULL)
+	{
+		context->timers->heads[timer->wheel][list] = timer;
+	}
+	else
+	{
+		timer->previous->next = timer;
+	}
+	
+	context->timers->tails[timer->wheel][list] = timer;
+}
+
+/**
+ * This function removes a timer from a list of its wheel.
+ * 
+ * @param context The context of the match.
+ * @param timer The timer which is scheduled.
+ * @param list The index of the slot or GAMEPLAY_TIMERS_SLOTS for the overflow
+ *             list which holds the timer.
+ */
+static void gameplay_timers_unlink(game_context_t *context, gameplay_timers_timer_t *timer, int list)
+{
+	if(timer->previous != NULL)
+	{
+		timer->previous->next = timer->next;
+	}
+	else
+	{
+		context->timers->heads[timer->wheel][list] = timer->next;
+	}
+	
+	if(timer->next != NULL)
+	{
+		timer->next->previous = timer->previous;
+	}
+	else
+	{
+		context->timers->tails[timer->wheel][list] = timer->previous;
+	}
+	
+	timer->scheduled = 0;
+	timer->previous = NULL;
+	timer->next = NULL;
+}
+
+/**
+ * This function schedules a timer. An already scheduled timer is moved to
+ * the new tick. Timers which are scheduled for the current tick (or earlier)
+ * are due in the current tick, after the timers which are already due.
+ * 
+ * @param context The context of the match.
+ * @param wheel The wheel of the timer.
+ * @param timer The timer.
+ * @param tick The tick at which the timer expires.
+ * @param data The entity of the timer.
+ */
+void gameplay_timers_schedule(game_context_t *context, gameplay_timers_wheel_t wheel, gameplay_timers_timer_t *timer, unsigned int tick, void *data)
+{
+	gameplay_timers_cancel(context, timer);
+	
+	if(tick < context->timers->tick)
+	{
+		tick = context->timers->tick;
+	}
+	
+	timer->tick = tick;
+	timer->data = data;
+	timer->wheel = wheel;
+	
+	gameplay_timers_append(context, timer);
+}
+
+/**
+ * This function removes a timer from its wheel. Timers which are not
+ * scheduled are ignored.
+ * 
+ * @param context The context of the match.
+ * @param timer The timer.
+ */
+void gameplay_timers_cancel(game_context_t *context, gameplay_timers_timer_t *timer)
+{
+	if(timer->scheduled == 0)
+	{
+		return;
+	}
+	
+	gameplay_timers_unlink(context, timer, gameplay_timers_get_list(context, timer->tick));
+}
+
+/**
+ * This function iterates over the timers of a wheel, slot by slot and within
+ * a slot in the order they expire, the overflow list comes last. Timers which
+ * are scheduled again in this order rebuild the same wheel.
+ * 
+ * @param context The context of the match.
+ * @param wheel The wheel.
+ * @param previous The previous timer of the iteration or NULL to start.
+ * @return The next timer or NULL if all timers were visited.
+ */
+gameplay_timers_timer_t *gameplay_timers_walk(game_context_t *context, gameplay_timers_wheel_t wheel, gameplay_timers_timer_t *previous)
+{
+	int slot = 0;
+	
+	if(previous != NULL)
+	{
+		if(previous->next != NULL)
+		{
+			return previous->next;
+		}
+		
+		slot = gameplay_timers_get_list(context, previous->tick) + 1;
+	}
+	
+	for(; slot <= GAMEPLAY_TIMERS_SLOTS; slot++)
+	{
+		if(context->timers->heads[wheel][slot] != NULL)
+		{
+			return context->timers->heads[wheel][slot];
+		}
+	}
+	
+	return NULL;
+}
+
+/**
+ * This function takes the next due timer of the current tick from a wheel.
+ * Timers which are scheduled while the due timers are processed are returned
+ * as well, if they are due in the current tick.
+ * 
+ * @param context The context of the match.
+ * @param wheel The wheel.
+ * @return The due timer (not scheduled anymore) or NULL if no timer is due.
+ */
+gameplay_timers_timer_t *gameplay_timers_next_due(game_context_t *context, gameplay_timers_wheel_t wheel)
+{
+	gameplay_timers_timer_t *current = NULL;
+	
+	// the slot only holds timers of the current round of the wheel, so they
+	// are all due and the first one is taken
+	current = context->timers->heads[wheel][context->timers->tick % GAMEPLAY_TIMERS_SLOTS];
+	if(current == NULL || current->tick != context->timers->tick)
+	{
+		return NULL;
+	}
+	
+	gameplay_timers_cancel(context, current);
+	
+	return current;
+}
@@ -0,0 +1,61 @@
+/*
+ * Copyright (C) 2015 NIPE-SYSTEMS
+ * Copyright (C) 2015 Jonas Krug
+ * Copyright (C) 2015 Tim Gevers
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GAMEPLAY_TIMERS_H__
+#define __GAMEPLAY_TIMERS_H__
+
+// amount of slots of the wheels, timers further in the future share slots
+#define GAMEPLAY_TIMERS_SLOTS 128
+
+#include "game-context.h"
+
+typedef enum gameplay_timers_wheel_e
+{
+	GAMEPLAY_TIMERS_WHEEL_FIRE,
+	GAMEPLAY_TIMERS_WHEEL_BOMBS,
+	GAMEPLAY_TIMERS_WHEEL_ITEMS
+} gameplay_timers_wheel_t;
+
+#define GAMEPLAY_TIMERS_WHEELS 3
+
+/**
+ * A timer which is embedded into the entity it belongs to (e.g. a bomb). The
+ * data points back to the entity.
+ */
+typedef struct gameplay_timers_timer_s
+{
+	unsigned int tick;
+	char scheduled;
+	gameplay_timers_wheel_t wheel;
+	void *data;
+	struct gameplay_timers_timer_s *previous;
+	struct gameplay_timers_timer_s *next;
+} gameplay_timers_timer_t;
+
+int gameplay_timers_init(game_context_t *context);
+void gameplay_timers_release(game_context_t *context);
+void gameplay_timers_restore(game_context_t *context, unsigned int tick);
+void gameplay_timers_advance(game_context_t *context);
+unsigned int gameplay_timers_get_tick(game_context_t *context);
+void gameplay_timers_schedule(game_context_t *context, gameplay_timers_wheel_t wheel, gameplay_timers_timer_t *timer, unsigned int tick, void *data);
+void gameplay_timers_cancel(game_context_t *context, gameplay_timers_timer_t *timer);
+gameplay_timers_timer_t *gameplay_timers_walk(game_context_t *context, gameplay_timers_wheel_t wheel, gameplay_timers_timer_t *previous);
+gameplay_timers_timer_t *gameplay_timers_next_due(game_context_t *context, gameplay_timers_wheel_t wheel);
+
+#endif /* __GAMEPLAY_TIMERS_H__ */
@@ -19,142 +19,347 @@
 
 #include <stdlib.h>
 #include <string.h>
-#include <unistd.h>
-#include <ncurses.h>
 
 #include "gameplay.h"
 #include "gameplay-players.h"
 #include "gameplay-bombs.h"
-#include "core.h"
+#include "gameplay-events.h"
+#include "core-log.h"
 #include "random-drop.h"
+#include "core-random.h"
 #include "ai-simulation.h"
 #include "gameplay-items.h"
+#include "ai-background.h"
+#include "ai-heatmap.h"
+#include "ai-openings.h"
+#include "ai-pathfinding.h"
+#include "ai-jobs.h"
+#include "ai-mcts.h"
+#include "ai-beam.h"
+#include "ai-endgame.h"
+#include "gameplay-snapshot.h"
 
-static gameplay_field_t gameplay_field[GAMEPLAY_FIELD_WIDTH * GAMEPLAY_FIELD_HEIGHT];
-static gameplay_turbo_t gameplay_turbo;
+static int gameplay_allocate(game_context_t *context);
+static unsigned long long gameplay_fire_key(game_context_t *context, int index);
+
+struct gameplay_context_s
+{
+	gameplay_field_t field;
+	gameplay_fire_t *fire;
+	gameplay_turbo_t turbo;
+	
+	// the tile indices of all burning tiles
+	int *fire_active;
+	int fire_active_amount;
+	
+	// the Zobrist hash of the gameplay state, updated by every change
+	unsigned long long hash;
+	
+	// the random drops of the match, seeded at the start of the match
+	core_random_t drops;
+};
+
+/**
+ * This function sets the size of the field. It is used from the next match
+ * on.
+ * 
+ * @param context The context of the match.
+ * @param width The width of the field.
+ * @param height The height of the field.
+ * @return 0 on success, -1 if the size is out of range.
+ */
+int gameplay_set_size(game_context_t *context, int width, int height)
+{
+	if(width < GAMEPLAY_FIELD_SIZE_MIN || width > GAMEPLAY_FIELD_SIZE_MAX || height < GAMEPLAY_FIELD_SIZE_MIN || height > GAMEPLAY_FIELD_SIZE_MAX)
+	{
+		core_error("Invalid field size %ix%i.", width, height);
+		return -1;
+	}
+	
+	context->size_width = width;
+	context->size_height = height;
+	
+	return 0;
+}
+
+/**
+ * This function sets the seed of the random numbers. It is used from the next
+ * match on, so matches with the same seed and the same inputs are identical.
+ * 
+ * @param context The context of the match.
+ * @param seed The seed.
+ */
+void gameplay_set_seed(game_context_t *context, unsigned long long seed)
+{
+	context->seed = seed;
+}
+
+/**
+ * This function (re)allocates an array with one element per tile of the
+ * field. The content of the array is undefined afterwards.
+ * 
+ * @param context The context of the match.
+ * @param tiles The previous array or NULL.
+ * @param size The size of one element.
+ * @return The array or NULL on error (the previous array is freed).
+ */
+void *gameplay_allocate_tiles(game_context_t *context, void *tiles, size_t size)
+{
+	void *allocated = NULL;
+	
+	allocated = realloc(tiles, GAMEPLAY_FIELD_TILES(context) * size);
+	if(allocated == NULL)
+	{
+		core_error("Failed to allocate %ix%i tiles.", GAMEPLAY_FIELD_WIDTH(context), GAMEPLAY_FIELD_HEIGHT(context));
+		free(tiles);
+		return NULL;
+	}
+	
+	return allocated;
+}
+
+/**
+ * This function allocates the arrays of the field and of all submodules for
+ * the size of the next match.
+ * 
+ * @param context The context of the match.
+ * @return 0 on success, -1 on error.
+ */
+static int gameplay_allocate(game_context_t *context)
+{
+	if(context->gameplay == NULL)
+	{
+		context->gameplay = calloc(1, sizeof(gameplay_context_t));
+		if(context->gameplay == NULL)
+		{
+			return -1;
+		}
+	}
+	
+	context->field_width = context->size_width;
+	context->field_height = context->size_height;
+	
+	context->gameplay->field.type = gameplay_allocate_tiles(context, context->gameplay->field.type, sizeof(unsigned char));
+	context->gameplay->field.fire = gameplay_allocate_tiles(context, context->gameplay->field.fire, sizeof(unsigned char));
+	context->gameplay->fire = gameplay_allocate_tiles(context, context->gameplay->fire, sizeof(gameplay_fire_t));
+	context->gameplay->fire_active = gameplay_allocate_tiles(context, context->gameplay->fire_active, sizeof(int));
+	
+	if(context->gameplay->field.type == NULL || context->gameplay->field.fire == NULL || context->gameplay->fire == NULL || context->gameplay->fire_active == NULL)
+	{
+		return -1;
+	}
+	
+	if(gameplay_bombs_init(context) == -1 || gameplay_items_init(context) == -1 || gameplay_players_init(context) == -1 || ai_simulation_init(context) == -1 || ai_pathfinding_init(context) == -1 || ai_heatmap_allocate(context) == -1 || ai_mcts_init(context) == -1 || ai_beam_init(context) == -1 || ai_endgame_init(context) == -1)
+	{
+		return -1;
+	}
+	
+	return 0;
+}
 
 /**
  * This function fills the field array before the game starts with all 
- * neccesary informations.
+ * neccesary informations. A match which fails to start is cleaned up again.
+ * 
+ * @param context The context of the match.
+ * @return 0 on success, -1 if the field could not be allocated.
  */
-void gameplay_init(void)
+int gameplay_init(game_context_t *context)
 {
 	int x = 0;
 	int y = 0;
 	
 	core_debug("Initializing field...");
 	
+	if(gameplay_allocate(context) == -1)
+	{
+		core_error("Failed to initialize field.");
+		return -1;
+	}
+	
+	if(gameplay_timers_init(context) == -1 || gameplay_events_init(context) == -1)
+	{
+		core_error("Failed to initialize timers and events.");
+		return -1;
+	}
+	
 	// initialize complete field with default values
-	for(y = 0; y < GAMEPLAY_FIELD_HEIGHT; y++)
+	for(y = 0; y < GAMEPLAY_FIELD_HEIGHT(context); y++)
 	{
-		for(x = 0; x < GAMEPLAY_FIELD_WIDTH; x++)
+		for(x = 0; x < GAMEPLAY_FIELD_WIDTH(context); x++)
 		{
-			GAMEPLAY_FIELD(gameplay_field, x, y).type = DESTRUCTIVE;
-			// GAMEPLAY_FIELD(gameplay_field, x, y).type = FLOOR;
-			GAMEPLAY_FIELD(gameplay_field, x, y).ai_position_x = x;
-			GAMEPLAY_FIELD(gameplay_field, x, y).ai_position_y = y;
-			GAMEPLAY_FIELD(gameplay_field, x, y).ai_pathfinding_number = -1;
-			GAMEPLAY_FIELD(gameplay_field, x, y).ai_pathfinding_next = NULL;
-			GAMEPLAY_FIELD(gameplay_field, x, y).ai_simulation_walkable = 1;
-			GAMEPLAY_FIELD(gameplay_field, x, y).ai_simulation_walkable_simulated = 1;
-			GAMEPLAY_FIELD(gameplay_field, x, y).fire = 0;
-			GAMEPLAY_FIELD(gameplay_field, x, y).fire_despawn_timer = 0;
+			GAMEPLAY_FIELD(context, context->gameplay->field.type, x, y) = DESTRUCTIVE;
+			// GAMEPLAY_FIELD(context, context->gameplay->field.type, x, y) = FLOOR;
+			GAMEPLAY_FIELD(context, context->gameplay->field.fire, x, y) = 0;
+			GAMEPLAY_FIELD(context, context->gameplay->fire, x, y).despawn_tick = 0;
+			GAMEPLAY_FIELD(context, context->gameplay->fire, x, y).active_index = -1;
+			GAMEPLAY_FIELD(context, context->gameplay->fire, x, y).timer.scheduled = 0;
 		}
 	}
 	
+	context->gameplay->fire_active_amount = 0;
+	core_random_seed(&(context->gameplay->drops), context->seed, CORE_RANDOM_STREAM_DROPS);
+	
 	// set outer walls in x dimension
-	for(x = 0; x < GAMEPLAY_FIELD_WIDTH; x++)
+	for(x = 0; x < GAMEPLAY_FIELD_WIDTH(context); x++)
 	{
-		GAMEPLAY_FIELD(gameplay_field, x, 0).type = WALL;
-		GAMEPLAY_FIELD(gameplay_field, x, (GAMEPLAY_FIELD_HEIGHT - 1)).type = WALL;
+		GAMEPLAY_FIELD(context, context->gameplay->field.type, x, 0) = WALL;
+		GAMEPLAY_FIELD(context, context->gameplay->field.type, x, (GAMEPLAY_FIELD_HEIGHT(context) - 1)) = WALL;
 	}
 	
 	// set outer walls in y dimension
-	for(y = 0; y < GAMEPLAY_FIELD_HEIGHT; y++)
+	for(y = 0; y < GAMEPLAY_FIELD_HEIGHT(context); y++)
 	{
-		GAMEPLAY_FIELD(gameplay_field, 0, y).type = WALL;
-		GAMEPLAY_FIELD(gameplay_field, (GAMEPLAY_FIELD_WIDTH - 1), y).type = WALL;
+		GAMEPLAY_FIELD(context, context->gameplay->field.type, 0, y) = WALL;
+		GAMEPLAY_FIELD(context, context->gameplay->field.type, (GAMEPLAY_FIELD_WIDTH(context) - 1), y) = WALL;
 	}
 	
 	// set walls in the inner field
-	for(y = 2; y < GAMEPLAY_FIELD_HEIGHT - 1; y += 2)
+	for(y = 2; y < GAMEPLAY_FIELD_HEIGHT(context) - 1; y += 2)
 	{
-		for(x = 2; x < GAMEPLAY_FIELD_WIDTH - 1; x += 2)
+		for(x = 2; x < GAMEPLAY_FIELD_WIDTH(context) - 1; x += 2)
 		{
-			GAMEPLAY_FIELD(gameplay_field, x, y).type = WALL;
+			GAMEPLAY_FIELD(context, context->gameplay->field.type, x, y) = WALL;
 		}
 	}
 	
 	// remove upper left corner
-	GAMEPLAY_FIELD(gameplay_field, 1, 1).type = FLOOR; // remove wall at (1, 1)
-	GAMEPLAY_FIELD(gameplay_field, 2, 1).type = FLOOR; // remove wall at (2, 1)
-	GAMEPLAY_FIELD(gameplay_field, 1, 2).type = FLOOR; // remove wall at (1, 2)
+	GAMEPLAY_FIELD(context, context->gameplay->field.type, 1, 1) = FLOOR; // remove wall at (1, 1)
+	GAMEPLAY_FIELD(context, context->gameplay->field.type, 2, 1) = FLOOR; // remove wall at (2, 1)
+	GAMEPLAY_FIELD(context, context->gameplay->field.type, 1, 2) = FLOOR; // remove wall at (1, 2)
 	
 	// remove upper right corner
-	GAMEPLAY_FIELD(gameplay_field, GAMEPLAY_FIELD_WIDTH - 2, 1).type = FLOOR; // remove wall at (width - 2, 1)
-	GAMEPLAY_FIELD(gameplay_field, GAMEPLAY_FIELD_WIDTH - 3, 1).type = FLOOR; // remove wall at (width - 3, 1)
-	GAMEPLAY_FIELD(gameplay_field, GAMEPLAY_FIELD_WIDTH - 2, 2).type = FLOOR; // remove wall at (width - 2, 2)
+	GAMEPLAY_FIELD(context, context->gameplay->field.type, GAMEPLAY_FIELD_WIDTH(context) - 2, 1) = FLOOR; // remove wall at (width - 2, 1)
+	GAMEPLAY_FIELD(context, context->gameplay->field.type, GAMEPLAY_FIELD_WIDTH(context) - 3, 1) = FLOOR; // remove wall at (width - 3, 1)
+	GAMEPLAY_FIELD(context, context->gameplay->field.type, GAMEPLAY_FIELD_WIDTH(context) - 2, 2) = FLOOR; // remove wall at (width - 2, 2)
 	
 	// remove lower left corner
-	GAMEPLAY_FIELD(gameplay_field, 1, GAMEPLAY_FIELD_HEIGHT - 2).type = FLOOR; // remove wall at (1, height - 2)
-	GAMEPLAY_FIELD(gameplay_field, 2, GAMEPLAY_FIELD_HEIGHT - 2).type = FLOOR; // remove wall at (2, height - 2)
-	GAMEPLAY_FIELD(gameplay_field, 1, GAMEPLAY_FIELD_HEIGHT - 3).type = FLOOR; // remove wall at (1, height - 3)
+	GAMEPLAY_FIELD(context, context->gameplay->field.type, 1, GAMEPLAY_FIELD_HEIGHT(context) - 2) = FLOOR; // remove wall at (1, height - 2)
+	GAMEPLAY_FIELD(context, context->gameplay->field.type, 2, GAMEPLAY_FIELD_HEIGHT(context) - 2) = FLOOR; // remove wall at (2, height - 2)
+	GAMEPLAY_FIELD(context, context->gameplay->field.type, 1, GAMEPLAY_FIELD_HEIGHT(context) - 3) = FLOOR; // remove wall at (1, height - 3)
 	
 	// remove lower right corner
-	GAMEPLAY_FIELD(gameplay_field, GAMEPLAY_FIELD_WIDTH - 2, GAMEPLAY_FIELD_HEIGHT - 2).type = FLOOR; // remove wall at (width - 2, height - 2)
-	GAMEPLAY_FIELD(gameplay_field, GAMEPLAY_FIELD_WIDTH - 3, GAMEPLAY_FIELD_HEIGHT - 2).type = FLOOR; // remove wall at (width - 3, height - 2)
-	GAMEPLAY_FIELD(gameplay_field, GAMEPLAY_FIELD_WIDTH - 2, GAMEPLAY_FIELD_HEIGHT - 3).type = FLOOR; // remove wall at (width - 2, height - 3)
-	
-	gameplay_players_add(1, 1, GAMEPLAY_PLAYERS_TYPE_USER);
-	gameplay_players_add(GAMEPLAY_FIELD_WIDTH - 2, 1, GAMEPLAY_PLAYERS_TYPE_AI);
-	gameplay_players_add(1, GAMEPLAY_FIELD_HEIGHT - 2, GAMEPLAY_PLAYERS_TYPE_AI);
-	gameplay_players_add(GAMEPLAY_FIELD_WIDTH - 2, GAMEPLAY_FIELD_HEIGHT - 2, GAMEPLAY_PLAYERS_TYPE_AI);
-	
-	gameplay_turbo.t = 0;
-	gameplay_turbo.u = 0;
-	gameplay_turbo.r = 0;
-	gameplay_turbo.b = 0;
-	gameplay_turbo.o = 0;
+	GAMEPLAY_FIELD(context, context->gameplay->field.type, GAMEPLAY_FIELD_WIDTH(context) - 2, GAMEPLAY_FIELD_HEIGHT(context) - 2) = FLOOR; // remove wall at (width - 2, height - 2)
+	GAMEPLAY_FIELD(context, context->gameplay->field.type, GAMEPLAY_FIELD_WIDTH(context) - 3, GAMEPLAY_FIELD_HEIGHT(context) - 2) = FLOOR; // remove wall at (width - 3, height - 2)
+	GAMEPLAY_FIELD(context, context->gameplay->field.type, GAMEPLAY_FIELD_WIDTH(context) - 2, GAMEPLAY_FIELD_HEIGHT(context) - 3) = FLOOR; // remove wall at (width - 2, height - 3)
+	
+	gameplay_players_add(context, 1, 1, GAMEPLAY_PLAYERS_TYPE_USER);
+	gameplay_players_add(context, GAMEPLAY_FIELD_WIDTH(context) - 2, 1, GAMEPLAY_PLAYERS_TYPE_AI);
+	gameplay_players_add(context, 1, GAMEPLAY_FIELD_HEIGHT(context) - 2, GAMEPLAY_PLAYERS_TYPE_AI);
+	gameplay_players_add(context, GAMEPLAY_FIELD_WIDTH(context) - 2, GAMEPLAY_FIELD_HEIGHT(context) - 2, GAMEPLAY_PLAYERS_TYPE_AI);
+	
+	context->gameplay->turbo.t = 0;
+	context->gameplay->turbo.u = 0;
+	context->gameplay->turbo.r = 0;
+	context->gameplay->turbo.b = 0;
+	context->gameplay->turbo.o = 0;
+	
+	gameplay_hash_rebuild(context);
+	
+	ai_heatmap_init(context);
+	if(ai_openings_start(context) == -1)
+	{
+		core_error("Failed to initialize openings.");
+		gameplay_cleanup(context);
+		return -1;
+	}
+
+#ifdef AI_BACKGROUND
+	if(ai_background_init(context) == -1)
+	{
+		core_error("Failed to initialize AI background thread.");
+		gameplay_cleanup(context);
+		return -1;
+	}
+#endif /* AI_BACKGROUND */
+	
+	return 0;
 }
 
 /**
  * This function cleans up all of the submodules.
+ * 
+ * @param context The context of the match.
  */
-void gameplay_cleanup(void)
+void gameplay_cleanup(game_context_t *context)
 {
-	gameplay_players_cleanup();
-	gameplay_bombs_cleanup();
-	gameplay_items_cleanup();
+#ifdef AI_BACKGROUND
+	ai_background_cleanup(context);
+#endif /* AI_BACKGROUND */
+	
+	gameplay_players_cleanup(context);
+	gameplay_bombs_cleanup(context);
+	gameplay_items_cleanup(context);
+}
+
+/**
+ * This function releases the memory of the submodules which is kept between
+ * the matches.
+ * 
+ * @param context The context of the match.
+ */
+void gameplay_release(game_context_t *context)
+{
+#ifdef AI_BACKGROUND
+	ai_background_cleanup(context);
+#endif /* AI_BACKGROUND */
+	
+	gameplay_players_release(context);
+	gameplay_bombs_release(context);
+	gameplay_items_release(context);
+	ai_simulation_release(context);
+	ai_pathfinding_release(context);
+	ai_heatmap_release(context);
+	ai_openings_release(context);
+	ai_mcts_release(context);
+	ai_beam_release(context);
+	ai_endgame_release(context);
+	gameplay_events_release(context);
+	gameplay_timers_release(context);
+	
+	if(context->gameplay == NULL)
+	{
+		return;
+	}
+	
+	free(context->gameplay->field.type);
+	free(context->gameplay->field.fire);
+	free(context->gameplay->fire);
+	free(context->gameplay->fire_active);
+	free(context->gameplay);
+	context->gameplay = NULL;
 }
 
 /**
  * This function tests if a tile is walkable. It can interpret bombs as walls.
  * 
+ * @param context The context of the match.
  * @param position_x The x coordinate of the tile.
  * @param position_y The y coordinate of the tile.
  * @param bomb_is_walkable 1 means that bombs are interpreted as floor tiles, 0
  *                         means that bombs are interpreted as wall tiles.
  * @return 0 if the tile is not walkable, 1 if it is walkable.
  */
-int gameplay_get_walkable(int position_x, int position_y, char bomb_is_walkable)
+int gameplay_get_walkable(game_context_t *context, int position_x, int position_y, char bomb_is_walkable)
 {
 	if(bomb_is_walkable == 1)
 	{
-		return (GAMEPLAY_FIELD(gameplay_field, position_x, position_y).type == FLOOR);
+		return (GAMEPLAY_FIELD(context, context->gameplay->field.type, position_x, position_y) == FLOOR);
 	}
 	else
 	{
-		return (GAMEPLAY_FIELD(gameplay_field, position_x, position_y).type == FLOOR && gameplay_bombs_get_bomb_placed(position_x, position_y) == 0);
+		return (GAMEPLAY_FIELD(context, context->gameplay->field.type, position_x, position_y) == FLOOR && gameplay_bombs_get_bomb_placed(context, position_x, position_y) == 0);
 	}
 }
 
 /**
  * This function destroys a wall and potentially drops an item (random drops).
  * 
+ * @param context The context of the match.
  * @param position_x The x coordinate of the tile.
  * @param position_y The y coordinate of the tile.
  */
-void gameplay_destroy(int position_x, int position_y)
+void gameplay_destroy(game_context_t *context, int position_x, int position_y)
 {
 	random_drop_t drop_list[] =
 	{
@@ -168,91 +373,95 @@ void gameplay_destroy(int position_x, int position_y)
 	size_t drop_list_amount = sizeof(drop_list) / sizeof(drop_list[0]);
 	random_drop_t *picked_drop = NULL;
 	
-	if(GAMEPLAY_FIELD(gameplay_field, position_x, position_y).type == DESTRUCTIVE)
+	if(GAMEPLAY_FIELD(context, context->gameplay->field.type, position_x, position_y) == DESTRUCTIVE)
 	{
-		GAMEPLAY_FIELD(gameplay_field, position_x, position_y).type = FLOOR;
-		picked_drop = random_drop_choose(drop_list, drop_list_amount);
+		GAMEPLAY_FIELD(context, context->gameplay->field.type, position_x, position_y) = FLOOR;
+		gameplay_hash_toggle(context, gameplay_hash_key(GAMEPLAY_HASH_DESTRUCTIVE, position_y * GAMEPLAY_FIELD_WIDTH(context) + position_x));
+		picked_drop = random_drop_choose(&(context->gameplay->drops), drop_list, drop_list_amount);
 		if(picked_drop != NULL && picked_drop->id != EMPTY)
 		{
-			gameplay_items_add_item(picked_drop->id, position_x, position_y);
+			gameplay_items_add_item(context, picked_drop->id, position_x, position_y);
 		}
+		
+		gameplay_events_push(context, GAMEPLAY_EVENTS_TILE_DESTROYED, position_x, position_y, 0);
 	}
 }
 
 /**
  * This function interprets all keyboard events.
  * 
+ * @param context The context of the match.
  * @param key The keycode as ASCII character.
  */
-void gameplay_key(char key)
+void gameplay_key(game_context_t *context, char key)
 {
 	switch(key)
 	{
 		case 'w':
 		{
-			gameplay_players_move(GAMEPLAY_PLAYERS_DIRECTION_UP);
+			gameplay_players_move(context, GAMEPLAY_PLAYERS_DIRECTION_UP);
 			break;
 		}
 		case 'd':
 		{
-			gameplay_players_move(GAMEPLAY_PLAYERS_DIRECTION_RIGHT);
+			gameplay_players_move(context, GAMEPLAY_PLAYERS_DIRECTION_RIGHT);
 			break;
 		}
 		case 's':
 		{
-			gameplay_players_move(GAMEPLAY_PLAYERS_DIRECTION_DOWN);
+			gameplay_players_move(context, GAMEPLAY_PLAYERS_DIRECTION_DOWN);
 			break;
 		}
 		case 'a':
 		{
-			gameplay_players_move(GAMEPLAY_PLAYERS_DIRECTION_LEFT);
+			gameplay_players_move(context, GAMEPLAY_PLAYERS_DIRECTION_LEFT);
 			break;
 		}
 		case ' ':
 		{
-			gameplay_players_place_bomb(NULL);
+			gameplay_players_place_bomb(context, NULL);
 			break;
 		}
 		case 'e':
 		{
-			gameplay_players_use_item();
+			gameplay_players_use_item(context);
 			break;
 		}
 		case 't':
 		{
-			gameplay_turbo.t =1;
+			context->gameplay->turbo.t =1;
 			break;
 		}
 		case 'u':
 		{
-			if(gameplay_turbo.t == 1)
+			if(context->gameplay->turbo.t == 1)
 			{
-				gameplay_turbo.u = 1;
+				context->gameplay->turbo.u = 1;
 			}
 			break;
 		}
 		case 'r':
 		{
-			if(gameplay_turbo.u == 1)
+			if(context->gameplay->turbo.u == 1)
 			{
-				gameplay_turbo.r = 1;
+				context->gameplay->turbo.r = 1;
 			}
 			break;
 		}
 		case 'b':
 		{
-			if(gameplay_turbo.r == 1)
+			if(context->gameplay->turbo.r == 1)
 			{
-				gameplay_turbo.b = 1;
+				context->gameplay->turbo.b = 1;
 			}
 			break;
 		}
 		case 'o':
 		{
-			if(gameplay_turbo.b == 1)
+			if(context->gameplay->turbo.b == 1)
 			{
-				gameplay_turbo.o = 1;
-				gameplay_player_activate_turbo_mode();
+				context->gameplay->turbo.o = 1;
+				gameplay_player_activate_turbo_mode(context);
 			}
 			break;
 		}
@@ -261,78 +470,338 @@ void gameplay_key(char key)
 
 /**
  * This function updates all fire on the field. (Timing, etc.)
+ * 
+ * @param context The context of the match.
  */
-void gameplay_fire_update(void)
+void gameplay_fire_update(game_context_t *context)
 {
-	int x = 0;
-	int y = 0;
+	int i = 0;
+	int index = 0;
+	gameplay_fire_t *fire = NULL;
+	gameplay_timers_timer_t *timer = NULL;
 	
-	for(y = 0; y < GAMEPLAY_FIELD_HEIGHT; y++)
+	// only the burning tiles are visited
+	for(i = 0; i < context->gameplay->fire_active_amount; i++)
 	{
-		for(x = 0; x < GAMEPLAY_FIELD_WIDTH; x++)
-		{
-			if(GAMEPLAY_FIELD(gameplay_field,x,y).fire == 1)
-			{
-				GAMEPLAY_FIELD(gameplay_field, x, y).fire_despawn_timer--;
-				gameplay_players_harm(x,y);
-				if(GAMEPLAY_FIELD(gameplay_field, x, y).fire_despawn_timer == 0)
-				{
-					GAMEPLAY_FIELD(gameplay_field, x, y).fire = 0;
-				}
-			}
-		}
+		index = context->gameplay->fire_active[i];
+		gameplay_players_harm(context, index % GAMEPLAY_FIELD_WIDTH(context), index / GAMEPLAY_FIELD_WIDTH(context));
+	}
+	
+	// extinguished tiles are replaced by the last burning tile
+	while((timer = gameplay_timers_next_due(context, GAMEPLAY_TIMERS_WHEEL_FIRE)) != NULL)
+	{
+		fire = timer->data;
+		gameplay_hash_toggle(context, gameplay_fire_key(context, fire - context->gameplay->fire));
+		context->gameplay->field.fire[fire - context->gameplay->fire] = 0;
+		gameplay_events_push(context, GAMEPLAY_EVENTS_FIRE_EXPIRED, (fire - context->gameplay->fire) % GAMEPLAY_FIELD_WIDTH(context), (fire - context->gameplay->fire) / GAMEPLAY_FIELD_WIDTH(context), 0);
+		
+		index = context->gameplay->fire_active[--context->gameplay->fire_active_amount];
+		context->gameplay->fire_active[fire->active_index] = index;
+		context->gameplay->fire[index].active_index = fire->active_index;
+		fire->active_index = -1;
 	}
 }
 
+/**
+ * This function returns the amount of burning tiles.
+ * 
+ * @param context The context of the match.
+ * @return The amount of burning tiles.
+ */
+int gameplay_fire_amount(game_context_t *context)
+{
+	return context->gameplay->fire_active_amount;
+}
+
+/**
+ * This function returns the burning tile with the given index.
+ * 
+ * @param context The context of the match.
+ * @param index The index of the burning tile.
+ * @return The tile index (y * width + x) of the burning tile.
+ */
+int gameplay_fire_get(game_context_t *context, int index)
+{
+	return context->gameplay->fire_active[index];
+}
+
 /**
  * This function updates all modules at every frame. It is called periodically.
+ * 
+ * @param context The context of the match.
  */
-void gameplay_update(void)
+void gameplay_update(game_context_t *context)
 {
-	gameplay_fire_update();
-	gameplay_players_update();
-	gameplay_bombs_update();
-	gameplay_players_ai_update();
-	gameplay_items_item_update();
+	gameplay_timers_advance(context);
+	
+	gameplay_fire_update(context);
+	gameplay_players_update(context);
+	gameplay_bombs_update(context);
+	gameplay_players_ai_update(context);
+	gameplay_items_item_update(context);
+
+#ifdef DEBUG
+	if(context->gameplay->hash != gameplay_hash_compute(context))
+	{
+		core_error("Hash differs from the gameplay state at tick %u.", gameplay_timers_get_tick(context));
+	}
+#endif /* DEBUG */
+
+#ifdef AI_BACKGROUND
+	ai_background_publish(context);
+#endif /* AI_BACKGROUND */
 }
 
 /**
  * This function returns the complete field.
  * 
+ * @param context The context of the match.
  * @return The complete field.
  */
-gameplay_field_t *gameplay_get_field(void)
+gameplay_field_t *gameplay_get_field(game_context_t *context)
+{
+	return &context->gameplay->field;
+}
+
+/**
+ * This function calculates the Zobrist key of a feature of the gameplay
+ * state. Like the keys of the AI states they are derived from the feature and
+ * its value by the SplitMix64 finalizer instead of a table, so the keys are
+ * the same in every process and for every field size.
+ * 
+ * @param feature The feature (e.g. the fire of a tile).
+ * @param value The value of the feature.
+ * @return The key.
+ */
+unsigned long long gameplay_hash_key(unsigned int feature, unsigned int value)
 {
-	return gameplay_field;
+	return core_random_mix64(((unsigned long long)feature << 32 | value) + 0x9e3779b97f4a7c15ULL);
+}
+
+/**
+ * This function adds a key to the hash or removes it again. Every change of
+ * the gameplay state removes the key of the old value and adds the key of the
+ * new value.
+ * 
+ * @param context The context of the match.
+ * @param key The key.
+ */
+void gameplay_hash_toggle(game_context_t *context, unsigned long long key)
+{
+	context->gameplay->hash ^= key;
+}
+
+/**
+ * This function calculates the key of a burning tile.
+ * 
+ * @param context The context of the match.
+ * @param index The index of the tile.
+ * @return The key.
+ */
+static unsigned long long gameplay_fire_key(game_context_t *context, int index)
+{
+	return gameplay_hash_key(GAMEPLAY_HASH_FIRE + index, context->gameplay->fire[index].despawn_tick);
+}
+
+/**
+ * This function calculates the hash of the gameplay state from scratch. The
+ * timers are hashed by their absolute ticks, the global tick is not part of
+ * the hash.
+ * 
+ * @param context The context of the match.
+ * @return The hash.
+ */
+unsigned long long gameplay_hash_compute(game_context_t *context)
+{
+	int i = 0;
+	unsigned long long hash = 0;
+	
+	// walls are fixed and floor is the default, only the rest is hashed
+	for(i = 0; i < GAMEPLAY_FIELD_TILES(context); i++)
+	{
+		if(context->gameplay->field.type[i] == DESTRUCTIVE)
+		{
+			hash ^= gameplay_hash_key(GAMEPLAY_HASH_DESTRUCTIVE, i);
+		}
+	}
+	
+	for(i = 0; i < context->gameplay->fire_active_amount; i++)
+	{
+		hash ^= gameplay_fire_key(context, context->gameplay->fire_active[i]);
+	}
+	
+	hash ^= gameplay_items_hash(context);
+	hash ^= gameplay_bombs_hash(context);
+	hash ^= gameplay_players_hash(context);
+	
+	return hash;
+}
+
+/**
+ * This function replaces the incrementally updated hash by a hash calculated
+ * from scratch. It is used after the state was replaced at once.
+ * 
+ * @param context The context of the match.
+ */
+void gameplay_hash_rebuild(game_context_t *context)
+{
+	context->gameplay->hash = gameplay_hash_compute(context);
+}
+
+/**
+ * This function returns the hash of the gameplay state. It is updated by all
+ * changes, so reading it is free.
+ * 
+ * @param context The context of the match.
+ * @return The hash.
+ */
+unsigned long long gameplay_get_hash(game_context_t *context)
+{
+	return context->gameplay->hash;
+}
+
+/**
+ * This function writes the field, the burning tiles and the turbo mode into
+ * a snapshot. The burning tiles are written in the order of their timers.
+ * 
+ * @param context The context of the match.
+ * @param snapshot The snapshot with the sections already placed.
+ */
+void gameplay_capture(game_context_t *context, gameplay_snapshot_t *snapshot)
+{
+	int i = 0;
+	unsigned char *field = NULL;
+	gameplay_fire_t *fire = NULL;
+	gameplay_snapshot_fire_t *records = NULL;
+	gameplay_timers_timer_t *timer = NULL;
+	
+	field = GAMEPLAY_SNAPSHOT_SECTION(snapshot, unsigned char, field);
+	memcpy(field, context->gameplay->field.type, GAMEPLAY_FIELD_TILES(context));
+	memcpy(field + GAMEPLAY_FIELD_TILES(context), context->gameplay->field.fire, GAMEPLAY_FIELD_TILES(context));
+	
+	// the walk stops at the last burning tile instead of visiting the
+	// remaining empty slots
+	records = GAMEPLAY_SNAPSHOT_SECTION(snapshot, gameplay_snapshot_fire_t, fire);
+	for(i = 0; i < snapshot->fire_amount; i++)
+	{
+		timer = gameplay_timers_walk(context, GAMEPLAY_TIMERS_WHEEL_FIRE, timer);
+		if(timer == NULL)
+		{
+			break;
+		}
+		
+		fire = timer->data;
+		records[i].index = fire - context->gameplay->fire;
+		records[i].active_index = fire->active_index;
+		records[i].despawn_tick = fire->despawn_tick;
+	}
+	
+	snapshot->turbo = context->gameplay->turbo.t | context->gameplay->turbo.u << 1 | context->gameplay->turbo.r << 2 | context->gameplay->turbo.b << 3 | context->gameplay->turbo.o << 4;
+	
+	for(i = 0; i < 4; i++)
+	{
+		snapshot->random[2 * i] = (unsigned int)context->gameplay->drops.state[i];
+		snapshot->random[2 * i + 1] = (unsigned int)(context->gameplay->drops.state[i] >> 32);
+	}
+}
+
+/**
+ * This function replaces the field, the burning tiles and the turbo mode by
+ * the ones of a snapshot. The wheels must be emptied before.
+ * 
+ * @param context The context of the match.
+ * @param snapshot The snapshot.
+ */
+void gameplay_restore(game_context_t *context, const gameplay_snapshot_t *snapshot)
+{
+	int i = 0;
+	gameplay_fire_t *fire = NULL;
+	const unsigned char *field = NULL;
+	const gameplay_snapshot_fire_t *records = NULL;
+	
+	// only the currently burning tiles have bookkeeping to drop
+	for(i = 0; i < context->gameplay->fire_active_amount; i++)
+	{
+		fire = &(context->gameplay->fire[context->gameplay->fire_active[i]]);
+		fire->active_index = -1;
+		fire->timer.scheduled = 0;
+	}
+	
+	field = GAMEPLAY_SNAPSHOT_SECTION(snapshot, unsigned char, field);
+	memcpy(context->gameplay->field.type, field, GAMEPLAY_FIELD_TILES(context));
+	memcpy(context->gameplay->field.fire, field + GAMEPLAY_FIELD_TILES(context), GAMEPLAY_FIELD_TILES(context));
+	
+	records = GAMEPLAY_SNAPSHOT_SECTION(snapshot, gameplay_snapshot_fire_t, fire);
+	for(i = 0; i < snapshot->fire_amount; i++)
+	{
+		fire = &(context->gameplay->fire[records[i].index]);
+		fire->despawn_tick = records[i].despawn_tick;
+		fire->active_index = records[i].active_index;
+		context->gameplay->fire_active[records[i].active_index] = records[i].index;
+		gameplay_timers_schedule(context, GAMEPLAY_TIMERS_WHEEL_FIRE, &(fire->timer), fire->despawn_tick, fire);
+	}
+	
+	context->gameplay->fire_active_amount = snapshot->fire_amount;
+	
+	context->gameplay->turbo.t = (snapshot->turbo >> 0) & 1;
+	context->gameplay->turbo.u = (snapshot->turbo >> 1) & 1;
+	context->gameplay->turbo.r = (snapshot->turbo >> 2) & 1;
+	context->gameplay->turbo.b = (snapshot->turbo >> 3) & 1;
+	context->gameplay->turbo.o = (snapshot->turbo >> 4) & 1;
+	
+	for(i = 0; i < 4; i++)
+	{
+		context->gameplay->drops.state[i] = (unsigned long long)snapshot->random[2 * i + 1] << 32 | snapshot->random[2 * i];
+	}
 }
 
 /**
  * This function sets fire to a given position.
  * 
+ * @param context The context of the match.
  * @param position_x The x coordinate of the tile.
  * @param position_y The y coordinate of the tile.
  */
-void gameplay_set_fire(int position_x, int position_y)
+void gameplay_set_fire(game_context_t *context, int position_x, int position_y)
 {
-	if(GAMEPLAY_FIELD(gameplay_field, position_x, position_y).type != FLOOR)
+	gameplay_fire_t *fire = NULL;
+	
+	if(GAMEPLAY_FIELD(context, context->gameplay->field.type, position_x, position_y) != FLOOR)
 	{
 		return;
 	}
 	
-	GAMEPLAY_FIELD(gameplay_field, position_x, position_y).fire = 1;
-	GAMEPLAY_FIELD(gameplay_field, position_x, position_y).fire_despawn_timer = GAMEPLAY_FIRE_DESPAWN;
+	fire = &(GAMEPLAY_FIELD(context, context->gameplay->fire, position_x, position_y));
+	
+	if(GAMEPLAY_FIELD(context, context->gameplay->field.fire, position_x, position_y) == 0)
+	{
+		fire->active_index = context->gameplay->fire_active_amount;
+		context->gameplay->fire_active[context->gameplay->fire_active_amount++] = position_y * GAMEPLAY_FIELD_WIDTH(context) + position_x;
+		gameplay_events_push(context, GAMEPLAY_EVENTS_FIRE_SET, position_x, position_y, 0);
+	}
+	else
+	{
+		gameplay_hash_toggle(context, gameplay_fire_key(context, position_y * GAMEPLAY_FIELD_WIDTH(context) + position_x));
+	}
+	
+	// the fire burns for the next GAMEPLAY_FIRE_DESPAWN fire updates
+	GAMEPLAY_FIELD(context, context->gameplay->field.fire, position_x, position_y) = 1;
+	fire->despawn_tick = gameplay_timers_get_tick(context) + GAMEPLAY_FIRE_DESPAWN;
+	gameplay_hash_toggle(context, gameplay_fire_key(context, position_y * GAMEPLAY_FIELD_WIDTH(context) + position_x));
+	gameplay_timers_schedule(context, GAMEPLAY_TIMERS_WHEEL_FIRE, &(fire->timer), fire->despawn_tick, fire);
 }
 
 /**
  * This function returns if a fire at a given position.
  * 
+ * @param context The context of the match.
  * @param position_x The x coordinate of the tile.
  * @param position_y The y coordinate of the tile.
  * @return 1 if fire is on the tile, 0 if not.
  */
-int gameplay_get_fire(int position_x, int position_y)
+int gameplay_get_fire(game_context_t *context, int position_x, int position_y)
 {
-	if(GAMEPLAY_FIELD(gameplay_field, position_x, position_y).fire == 1)
+	if(GAMEPLAY_FIELD(context, context->gameplay->field.fire, position_x, position_y) == 1)
 	{
 		return 1;
 	}
@@ -341,3 +810,22 @@ int gameplay_get_fire(int position_x, int position_y)
 		return 0;
 	}
 }
+
+/**
+ * This function returns the amount of fire updates until the fire on a tile
+ * is extinguished.
+ * 
+ * @param context The context of the match.
+ * @param position_x The x coordinate of the tile.
+ * @param position_y The y coordinate of the tile.
+ * @return The fire timeout, 0 if there is no fire on the tile.
+ */
+int gameplay_get_fire_timeout(game_context_t *context, int position_x, int position_y)
+{
+	if(GAMEPLAY_FIELD(context, context->gameplay->field.fire, position_x, position_y) == 0)
+	{
+		return 0;
+	}
+	
+	return GAMEPLAY_FIELD(context, context->gameplay->fire, position_x, position_y).despawn_tick - gameplay_timers_get_tick(context);
+}
@@ -20,14 +20,42 @@
 #ifndef __GAMEPLAY_H__
 #define __GAMEPLAY_H__
 
-#define GAMEPLAY_FIELD_HEIGHT 9
-#define GAMEPLAY_FIELD_WIDTH 9
+#include <stddef.h>
+
+#include "game-context.h"
+#include "gameplay-snapshot.h"
+
+#define GAMEPLAY_FIELD_SIZE_DEFAULT 9
+#define GAMEPLAY_FIELD_SIZE_MIN 9
+#define GAMEPLAY_FIELD_SIZE_MAX 1000
 #define GAMEPLAY_FIRE_DESPAWN 10
+#define GAMEPLAY_SEED_DEFAULT 1
+
+// the size of the field is chosen at the start of a match
+#define GAMEPLAY_FIELD_HEIGHT(context) ((context)->field_height)
+#define GAMEPLAY_FIELD_WIDTH(context) ((context)->field_width)
+#define GAMEPLAY_FIELD_TILES(context) ((context)->field_width * (context)->field_height)
 
-#define GAMEPLAY_FIELD(field, x, y) ((field)[(y) * GAMEPLAY_FIELD_WIDTH + (x)])
+#define GAMEPLAY_FIELD(context, field, x, y) ((field)[(y) * GAMEPLAY_FIELD_WIDTH(context) + (x)])
+
+// features of the Zobrist hash (features per tile or player are added to the
+// tile index or the player id)
+#define GAMEPLAY_HASH_DESTRUCTIVE 0x01000000
+#define GAMEPLAY_HASH_FIRE 0x02000000
+#define GAMEPLAY_HASH_ITEM 0x03000000
+#define GAMEPLAY_HASH_ITEM_DESPAWN 0x04000000
+#define GAMEPLAY_HASH_BOMB 0x05000000
+#define GAMEPLAY_HASH_BOMB_OWNER 0x06000000
+#define GAMEPLAY_HASH_PLAYER 0x07000000
+#define GAMEPLAY_HASH_PLAYER_STATS 0x08000000
+#define GAMEPLAY_HASH_PLAYER_RULES 0x09000000
+#define GAMEPLAY_HASH_PLAYER_MOVEMENT 0x0a000000
+#define GAMEPLAY_HASH_PLAYER_DAMAGE 0x0b000000
+#define GAMEPLAY_HASH_PLAYER_ITEM 0x0c000000
 
 #include "gameplay-items.h"
 #include "gameplay-players.h"
+#include "gameplay-timers.h"
 
 typedef enum gameplay_field_type_e
 {
@@ -36,20 +64,23 @@ typedef enum gameplay_field_type_e
 	FLOOR = 2,
 } gameplay_field_type_t;
 
+// the field is stored as packed arrays per property, so scans over one
+// property only read the bytes of this property
 typedef struct gameplay_field_s
 {
-	gameplay_field_type_t type;
-	gameplay_items_item_t item;
-	int ai_position_x;
-	int ai_position_y;
-	int ai_pathfinding_number;
-	struct gameplay_field_s *ai_pathfinding_next;
-	char ai_simulation_walkable;
-	char ai_simulation_walkable_simulated;
-	int fire;
-	int fire_despawn_timer;
+	unsigned char *type;
+	unsigned char *fire;
 } gameplay_field_t;
 
+// the bookkeeping of a burning tile which is only needed when the fire is
+// set or extinguished
+typedef struct gameplay_fire_s
+{
+	unsigned int despawn_tick;
+	int active_index;
+	gameplay_timers_timer_t timer;
+} gameplay_fire_t;
+
 typedef struct gameplay_turbo_s
 {
 	int t;
@@ -59,17 +90,30 @@ typedef struct gameplay_turbo_s
 	int o;
 } gameplay_turbo_t;
 
-void gameplay_init(void);
-void gameplay_cleanup(void);
-int gameplay_get_walkable(int position_x, int position_y, char bomb_is_walkable);
+int gameplay_set_size(game_context_t *context, int width, int height);
+void gameplay_set_seed(game_context_t *context, unsigned long long seed);
+void *gameplay_allocate_tiles(game_context_t *context, void *tiles, size_t size);
+int gameplay_init(game_context_t *context);
+void gameplay_cleanup(game_context_t *context);
+void gameplay_release(game_context_t *context);
+int gameplay_get_walkable(game_context_t *context, int position_x, int position_y, char bomb_is_walkable);
 //gameplay_items_item_t gameplay_get_item(int position_x, int position_y);
-void gameplay_destroy(int position_x, int position_y);
-void gameplay_key(char gameplay_pressed_key);
-void gameplay_fire_update(void);
-void gameplay_update(void);
-void gameplay_explosion(int x, int y);
-gameplay_field_t *gameplay_get_field(void);
-void gameplay_set_fire(int position_x, int position_y);
-int gameplay_get_fire(int position_x, int position_y);
+void gameplay_destroy(game_context_t *context, int position_x, int position_y);
+void gameplay_key(game_context_t *context, char gameplay_pressed_key);
+void gameplay_fire_update(game_context_t *context);
+int gameplay_fire_amount(game_context_t *context);
+int gameplay_fire_get(game_context_t *context, int index);
+void gameplay_update(game_context_t *context);
+gameplay_field_t *gameplay_get_field(game_context_t *context);
+void gameplay_set_fire(game_context_t *context, int position_x, int position_y);
+int gameplay_get_fire(game_context_t *context, int position_x, int position_y);
+int gameplay_get_fire_timeout(game_context_t *context, int position_x, int position_y);
+unsigned long long gameplay_hash_key(unsigned int feature, unsigned int value);
+void gameplay_hash_toggle(game_context_t *context, unsigned long long key);
+unsigned long long gameplay_hash_compute(game_context_t *context);
+void gameplay_hash_rebuild(game_context_t *context);
+unsigned long long gameplay_get_hash(game_context_t *context);
+void gameplay_capture(game_context_t *context, gameplay_snapshot_t *snapshot);
+void gameplay_restore(game_context_t *context, const gameplay_snapshot_t *snapshot);
 
 #endif /* __GAMEPLAY_H__ */
@@ -25,9 +25,13 @@
 
 #include "graphics-sprites.h"
 #include "core.h"
+#include "core-random.h"
 
 static char *graphics_sprites_read(char *path, int width, int height);
 static graphics_sprites_sprite_t *graphics_sprites_get(graphics_sprites_type_t type);
+// the random colors have their own stream, rendering does not change the
+// random numbers of the gameplay
+static core_random_t graphics_sprites_random;
 static graphics_sprites_sprite_t graphics_sprites_sprites[] =
 {
 	{ GRAPHICS_SPRITES_TYPE_UNDESTROYABLE, "assets/undestructable.sprite", 5, 3, NULL, GRAPHICS_SPRITES_COLOR_WHITE },
@@ -205,13 +209,16 @@ char *graphics_sprites_read(char *path, int width, int height)
 
 /**
  * This function initializes all sprites.
+ * 
+ * @param seed The seed of the random colors.
  */
-void graphics_sprites_init(void)
+void graphics_sprites_init(unsigned long long seed)
 {
 	int i = 0;
 	
 	core_debug("Loading sprites...");
 	
+	core_random_seed(&graphics_sprites_random, seed, CORE_RANDOM_STREAM_COSMETIC);
 	graphics_sprites_init_colors();
 	
 	for(i = 0; i < (int)(sizeof(graphics_sprites_sprites) / sizeof(graphics_sprites_sprites[0])); i++)
@@ -286,7 +293,7 @@ void graphics_sprites_render(int render_x, int render_y, graphics_sprites_type_t
 	else if(sprite->color == GRAPHICS_SPRITES_COLOR_RANDOM_FILL)
 	{
 		// get random number in [2, 8]
-		render_color = rand() % 7 + 2;
+		render_color = core_random_range(&graphics_sprites_random, 7) + 2;
 	}
 	
 	attron(COLOR_PAIR(render_color));
@@ -300,14 +307,14 @@ void graphics_sprites_render(int render_x, int render_y, graphics_sprites_type_t
 			{
 				if(sprite->color == GRAPHICS_SPRITES_COLOR_RANDOM)
 				{
-					attron(COLOR_PAIR(rand() % 7 + 2));
+					attron(COLOR_PAIR(core_random_range(&graphics_sprites_random, 7) + 2));
 				}
 				
 				mvaddch(render_y + y, render_x + x, sprite->data[y * sprite->width + x]);
 				
 				if(sprite->color == GRAPHICS_SPRITES_COLOR_RANDOM)
 				{
-					attroff(COLOR_PAIR(rand() % 7 + 2));
+					attroff(COLOR_PAIR(core_random_range(&graphics_sprites_random, 7) + 2));
 				}
 			}
 		}
@@ -152,7 +152,7 @@ typedef struct graphics_sprites_sprite_s
 } graphics_sprites_sprite_t;
 
 void graphics_sprites_init_colors(void);
-void graphics_sprites_init(void);
+void graphics_sprites_init(unsigned long long seed);
 void graphics_sprites_cleanup(void);
 void graphics_sprites_render(int render_x, int render_y, graphics_sprites_type_t type, char transparency);
 void graphics_sprites_render_box(int render_x, int render_y, int width, int height);
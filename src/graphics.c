@@ -30,6 +30,19 @@
 #include "core.h"
 #include "gameplay-items.h"
 #include "ai-core.h"
+#include "ai-mcts.h"
+#include "ai-endgame.h"
+#include "gameplay-events.h"
+
+static void graphics_get_viewport(game_context_t *context, int *position_x, int *position_y);
+static graphics_sprites_type_t graphics_get_tile_sprite(game_context_t *context, int position_x, int position_y);
+
+// the sprites of the tiles in the viewport, they are only updated for the
+// tiles of gameplay events and rebuilt when the viewport moves
+static graphics_sprites_type_t graphics_field_sprites[GRAPHICS_VIEWPORT_WIDTH * GRAPHICS_VIEWPORT_HEIGHT];
+static int graphics_field_viewport_x = -1;
+static int graphics_field_viewport_y = -1;
+static unsigned int graphics_field_cursor = 0;
 
 /**
  * This function renders the menu of the game.
@@ -74,8 +87,10 @@ void graphics_render_menu(void)
 
 /**
  * This function renders the debug informations of the game.
+ * 
+ * @param context The context of the match.
  */
-void graphics_render_debug(void)
+void graphics_render_debug(game_context_t *context)
 {
 	int i = 0;
 	int offset_line = 0;
@@ -83,36 +98,46 @@ void graphics_render_debug(void)
 	gameplay_players_player_t *player = NULL;
 	int bomb_amount = 0;
 	gameplay_bombs_bomb_t *bomb = NULL;
+	ai_mcts_statistics_t *statistics = NULL;
+	ai_endgame_statistics_t *endgame_statistics = NULL;
 	
 	mvprintw(GRAPHICS_DEBUG_Y + offset_line++, GRAPHICS_DEBUG_X, "Players [");
-	player_amount = gameplay_players_amount();
+	player_amount = gameplay_players_amount(context);
 	for(i = 0; i < player_amount; i++)
 	{
-		player = gameplay_players_get(i);
+		player = gameplay_players_get(context, i);
 		if(player == NULL)
 		{
 			continue;
 		}
 		
-		mvprintw(GRAPHICS_DEBUG_Y + offset_line++, GRAPHICS_DEBUG_X + 2, "%s { h: %i, m: %i (%i), p: (%i, %i), b: %i (%i), e: %i, d: %i (%i) }", ((player->type == GAMEPLAY_PLAYERS_TYPE_AI)?("AI  "):("USER")), player->health_points, player->movement_cooldown, player->movement_cooldown_initial, player->position_x, player->position_y, player->placed_bombs, player->placeable_bombs, player->explosion_radius, player->damage_cooldown, player->damage_cooldown_initial);
+		mvprintw(GRAPHICS_DEBUG_Y + offset_line++, GRAPHICS_DEBUG_X + 2, "%s { h: %i, m: %i (%i), p: (%i, %i), b: %i (%i), e: %i, d: %i (%i) }", ((player->type == GAMEPLAY_PLAYERS_TYPE_AI)?("AI  "):("USER")), player->health_points, gameplay_players_get_movement_cooldown(context, player), player->movement_cooldown_initial, player->position_x, player->position_y, player->placed_bombs, player->placeable_bombs, player->explosion_radius, gameplay_players_get_damage_cooldown(context, player), player->damage_cooldown_initial);
 	}
 	mvprintw(GRAPHICS_DEBUG_Y + offset_line++, GRAPHICS_DEBUG_X, "]");
 	
 	offset_line++;
 	
 	mvprintw(GRAPHICS_DEBUG_Y + offset_line++, GRAPHICS_DEBUG_X, "Bombs [");
-	bomb_amount = gameplay_bombs_amount();
+	bomb_amount = gameplay_bombs_amount(context);
 	for(i = 0; i < bomb_amount; i++)
 	{
-		bomb = gameplay_bombs_get(i);
+		bomb = gameplay_bombs_get(context, i);
 		if(bomb == NULL)
 		{
 			continue;
 		}
 		
-		mvprintw(GRAPHICS_DEBUG_Y + offset_line++, GRAPHICS_DEBUG_X + 2, "{ o: %s, p: (%i, %i), e: %i }", ((bomb->owner->type == GAMEPLAY_PLAYERS_TYPE_AI)?("AI"):("USER")), bomb->position_x, bomb->position_y, bomb->explosion_timeout);
+		mvprintw(GRAPHICS_DEBUG_Y + offset_line++, GRAPHICS_DEBUG_X + 2, "{ o: %s, p: (%i, %i), e: %i }", ((bomb->owner == NULL || bomb->owner->type == GAMEPLAY_PLAYERS_TYPE_AI)?("AI"):("USER")), bomb->position_x, bomb->position_y, gameplay_bombs_get_explosion_timeout(context, bomb));
 	}
 	mvprintw(GRAPHICS_DEBUG_Y + offset_line++, GRAPHICS_DEBUG_X, "]");
+	
+	offset_line++;
+	
+	statistics = ai_mcts_get_statistics(context);
+	mvprintw(GRAPHICS_DEBUG_Y + offset_line++, GRAPHICS_DEBUG_X, "MCTS { r: %i, n: %i, t: %li us, r/s: %li }", statistics->rollouts, statistics->nodes, statistics->elapsed, statistics->rollouts_per_second);
+	
+	endgame_statistics = ai_endgame_get_statistics(context);
+	mvprintw(GRAPHICS_DEBUG_Y + offset_line++, GRAPHICS_DEBUG_X, "Endgame { d: %i, n: %li, h: %li, t: %li us }", endgame_statistics->depth, endgame_statistics->nodes, endgame_statistics->hits, endgame_statistics->elapsed);
 }
 
 /**
@@ -194,29 +219,87 @@ void graphics_render_win_screen(char reset_screens)
 }
 
 /**
- * This function renders all players of the game.
+ * This function calculates the upper left tile of the visible part of the
+ * field. The viewport follows the user player and is moved into the field at
+ * the borders.
+ * 
+ * @param context The context of the match.
+ * @param position_x The x coordinate of the upper left tile (write by
+ *                   pointer).
+ * @param position_y The y coordinate of the upper left tile (write by
+ *                   pointer).
+ */
+static void graphics_get_viewport(game_context_t *context, int *position_x, int *position_y)
+{
+	gameplay_players_player_t *player = NULL;
+	
+	*position_x = 0;
+	*position_y = 0;
+	
+	player = gameplay_players_get_user(context);
+	if(player != NULL)
+	{
+		*position_x = player->position_x - GRAPHICS_VIEWPORT_WIDTH / 2;
+		*position_y = player->position_y - GRAPHICS_VIEWPORT_HEIGHT / 2;
+	}
+	
+	if(*position_x > GAMEPLAY_FIELD_WIDTH(context) - GRAPHICS_VIEWPORT_WIDTH)
+	{
+		*position_x = GAMEPLAY_FIELD_WIDTH(context) - GRAPHICS_VIEWPORT_WIDTH;
+	}
+	
+	if(*position_y > GAMEPLAY_FIELD_HEIGHT(context) - GRAPHICS_VIEWPORT_HEIGHT)
+	{
+		*position_y = GAMEPLAY_FIELD_HEIGHT(context) - GRAPHICS_VIEWPORT_HEIGHT;
+	}
+	
+	if(*position_x < 0)
+	{
+		*position_x = 0;
+	}
+	
+	if(*position_y < 0)
+	{
+		*position_y = 0;
+	}
+}
+
+/**
+ * This function renders all players of the game which are inside of the
+ * viewport.
+ * 
+ * @param context The context of the match.
  */
-void graphics_render_players(void)
+void graphics_render_players(game_context_t *context)
 {
 	static char animation_blinking = 0;
 	gameplay_players_player_t *player = NULL;
 	int player_amount = 0;
 	int render_x = 0;
 	int render_y = 0;
+	int viewport_x = 0;
+	int viewport_y = 0;
 	int i = 0;
 	graphics_sprites_type_t player_sprite = GRAPHICS_SPRITES_TYPE_PLAYER;
 	
-	player_amount = gameplay_players_amount();
+	graphics_get_viewport(context, &viewport_x, &viewport_y);
+	
+	player_amount = gameplay_players_amount(context);
 	for(i = 0; i < player_amount; i++)
 	{
-		player = gameplay_players_get(i);
+		player = gameplay_players_get(context, i);
 		if(player == NULL)
 		{
 			continue;
 		}
 		
-		render_x = (player->position_x * GRAPHICS_OFFSET_X) + GRAPHICS_OFFSET_X - GRAPHICS_SPRITE_WIDTH;
-		render_y = (player->position_y * GRAPHICS_OFFSET_Y) + GRAPHICS_OFFSET_Y - GRAPHICS_SPRITE_HEIGHT;
+		if(player->position_x < viewport_x || player->position_y < viewport_y || player->position_x >= viewport_x + GRAPHICS_VIEWPORT_WIDTH || player->position_y >= viewport_y + GRAPHICS_VIEWPORT_HEIGHT)
+		{
+			continue;
+		}
+		
+		render_x = ((player->position_x - viewport_x) * GRAPHICS_OFFSET_X) + GRAPHICS_OFFSET_X - GRAPHICS_SPRITE_WIDTH;
+		render_y = ((player->position_y - viewport_y) * GRAPHICS_OFFSET_Y) + GRAPHICS_OFFSET_Y - GRAPHICS_SPRITE_HEIGHT;
 		
 		if(player->type == GAMEPLAY_PLAYERS_TYPE_USER)
 		{
@@ -234,12 +317,12 @@ void graphics_render_players(void)
 			player_sprite = GRAPHICS_SPRITES_ENEMY;
 		}
 		
-		if(player->movement_cooldown > 0)
+		if(gameplay_players_get_movement_cooldown(context, player) > 0)
 		{
 			player_sprite += 1;
 		}
 		
-		if(player->damage_cooldown == 0 || (player->damage_cooldown > 0 && animation_blinking == 0))
+		if(gameplay_players_get_damage_cooldown(context, player) == 0 || animation_blinking == 0)
 		{
 			graphics_sprites_render(render_x, render_y, player_sprite, 1);
 		}
@@ -257,13 +340,15 @@ void graphics_render_players(void)
 
 /**
  * This function renders the information panel of the game.
+ * 
+ * @param context The context of the match.
  */
-void graphics_render_information(void)
+void graphics_render_information(game_context_t *context)
 {
 	int i = 0;
 	gameplay_players_player_t *player = NULL;
 	
-	player = gameplay_players_get_user();
+	player = gameplay_players_get_user(context);
 	
 	// hearts
 	mvprintw(GRAPHICS_HEALTH_Y, GRAPHICS_HEALTH_X, "Health:");
@@ -304,44 +389,113 @@ void graphics_render_information(void)
 }
 
 /**
- * This function renders the field of the game.
+ * This function returns the sprite of a tile of the field (without players).
+ * 
+ * @param context The context of the match.
+ * @param position_x The x coordinate of the tile.
+ * @param position_y The y coordinate of the tile.
+ * @return The sprite of the tile.
  */
-void graphics_render_field(void)
+static graphics_sprites_type_t graphics_get_tile_sprite(game_context_t *context, int position_x, int position_y)
+{
+	gameplay_field_t *gameplay_field = NULL;
+	
+	// a bomb is shown until it explodes
+	if(gameplay_bombs_get_bomb(context, position_x, position_y) != NULL) // bomb
+	{
+		return GRAPHICS_SPRITES_TYPE_BOMB;
+	}
+	else if(gameplay_get_fire(context, position_x, position_y) == 1) // fire
+	{
+		return GRAPHICS_SPRITES_TYPE_EXPLOSION_1;
+	}
+	else if(gameplay_items_item_placed(context, position_x, position_y) != 0) // item
+	{
+		return (graphics_sprites_type_t)gameplay_items_get_item_type(context, position_x, position_y);
+	}
+	
+	// field
+	gameplay_field = gameplay_get_field(context);
+	
+	return (graphics_sprites_type_t)GAMEPLAY_FIELD(context, gameplay_field->type, position_x, position_y);
+}
+
+/**
+ * This function renders the part of the field of the game which is inside of
+ * the viewport. The sprites of the tiles are cached, only the tiles of the
+ * gameplay events since the last frame are looked up again.
+ * 
+ * @param context The context of the match.
+ */
+void graphics_render_field(game_context_t *context)
 {
 	static char animation_blinking = 0;
 	int x = 0;
 	int y = 0;
-	int field_index = 0;
+	int result = 0;
 	int render_x = 0;
 	int render_y = 0;
-	gameplay_field_t *gameplay_field = NULL;
+	int viewport_x = 0;
+	int viewport_y = 0;
+	char rebuild = 0;
+	graphics_sprites_type_t sprite = GRAPHICS_SPRITES_TYPE_UNDESTROYABLE;
+	gameplay_events_event_t event;
+	
+	graphics_get_viewport(context, &viewport_x, &viewport_y);
 	
-	gameplay_field = gameplay_get_field();
+	rebuild = (viewport_x != graphics_field_viewport_x || viewport_y != graphics_field_viewport_y);
 	
-	for(y = 0; y < GAMEPLAY_FIELD_HEIGHT; y++)
+	while(rebuild == 0 && (result = gameplay_events_next(context, &graphics_field_cursor, &event)) != 0)
 	{
-		for(x = 0; x < GAMEPLAY_FIELD_WIDTH; x++)
+		// events were lost (e.g. a new match), look up all tiles
+		if(result == -1)
+		{
+			rebuild = 1;
+			break;
+		}
+		
+		if(event.type == GAMEPLAY_EVENTS_PLAYER_MOVED || event.type == GAMEPLAY_EVENTS_PLAYER_DAMAGED || event.type == GAMEPLAY_EVENTS_PLAYER_REMOVED)
+		{
+			continue;
+		}
+		
+		x = event.position_x - viewport_x;
+		y = event.position_y - viewport_y;
+		if(x >= 0 && y >= 0 && x < GRAPHICS_VIEWPORT_WIDTH && y < GRAPHICS_VIEWPORT_HEIGHT)
+		{
+			graphics_field_sprites[y * GRAPHICS_VIEWPORT_WIDTH + x] = graphics_get_tile_sprite(context, event.position_x, event.position_y);
+		}
+	}
+	
+	if(rebuild == 1)
+	{
+		for(y = 0; y < GRAPHICS_VIEWPORT_HEIGHT && viewport_y + y < GAMEPLAY_FIELD_HEIGHT(context); y++)
+		{
+			for(x = 0; x < GRAPHICS_VIEWPORT_WIDTH && viewport_x + x < GAMEPLAY_FIELD_WIDTH(context); x++)
+			{
+				graphics_field_sprites[y * GRAPHICS_VIEWPORT_WIDTH + x] = graphics_get_tile_sprite(context, viewport_x + x, viewport_y + y);
+			}
+		}
+		
+		graphics_field_viewport_x = viewport_x;
+		graphics_field_viewport_y = viewport_y;
+		graphics_field_cursor = gameplay_events_cursor(context);
+	}
+	
+	for(y = 0; y < GRAPHICS_VIEWPORT_HEIGHT && viewport_y + y < GAMEPLAY_FIELD_HEIGHT(context); y++)
+	{
+		for(x = 0; x < GRAPHICS_VIEWPORT_WIDTH && viewport_x + x < GAMEPLAY_FIELD_WIDTH(context); x++)
 		{
-			field_index = y * GAMEPLAY_FIELD_WIDTH + x;
 			render_x = (x * GRAPHICS_OFFSET_X) + GRAPHICS_OFFSET_X - GRAPHICS_SPRITE_WIDTH;
 			render_y = (y * GRAPHICS_OFFSET_Y) + GRAPHICS_OFFSET_Y - GRAPHICS_SPRITE_HEIGHT;
 			
-			if(gameplay_bombs_get_bomb_placed(x, y) == 1) // bomb
-			{
-				graphics_sprites_render(render_x, render_y, GRAPHICS_SPRITES_BOMB, 0);
-			}
-			else if(gameplay_get_fire(x, y) == 1) // fire
+			sprite = graphics_field_sprites[y * GRAPHICS_VIEWPORT_WIDTH + x];
+			if(sprite == GRAPHICS_SPRITES_TYPE_EXPLOSION_1 && animation_blinking == 1)
 			{
-				graphics_sprites_render(render_x, render_y, GRAPHICS_SPRITES_EXPLOSION_1 + animation_blinking, 0);
-			}
-			else if(gameplay_items_item_placed(x, y) != 0) // item
-			{
-				graphics_sprites_render(render_x, render_y, gameplay_items_get_item_type(x, y), 0);
-			}
-			else // field
-			{
-				graphics_sprites_render(render_x, render_y, gameplay_field[field_index].type, 0);
+				sprite = GRAPHICS_SPRITES_TYPE_EXPLOSION_2;
 			}
+			
+			graphics_sprites_render(render_x, render_y, sprite, 0);
 		}
 	}
 	
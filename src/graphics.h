@@ -20,10 +20,15 @@
 #ifndef __GRAPHICS_H__
 #define __GRAPHICS_H__
 
+#include "game-context.h"
+
 #define GRAPHICS_OFFSET_X 8
 #define GRAPHICS_OFFSET_Y 4
 #define GRAPHICS_SPRITE_WIDTH 5
 #define GRAPHICS_SPRITE_HEIGHT 3
+// the amount of tiles which are visible around the user player
+#define GRAPHICS_VIEWPORT_WIDTH 9
+#define GRAPHICS_VIEWPORT_HEIGHT 9
 #define GRAPHICS_HEALTH_X 77
 #define GRAPHICS_HEALTH_Y 3
 #define GRAPHICS_HEALTH_OFFSET_X 6
@@ -81,13 +86,13 @@ typedef struct graphics_sprite_s
 } graphics_sprite_t;
 
 void graphics_render_menu(void);
-void graphics_render_debug(void);
+void graphics_render_debug(game_context_t *context);
 int graphics_render_start_screen();
 void graphics_render_game_over_screen(char reset_screens);
 void graphics_render_win_screen(char reset_screens);
-void graphics_render_players(void);
-void graphics_render_information(void);
-void graphics_render_field(void);
+void graphics_render_players(game_context_t *context);
+void graphics_render_information(game_context_t *context);
+void graphics_render_field(game_context_t *context);
 void graphics_render_qr_code(void);
 
 #endif /* __GRAPHICS_H__ */
@@ -18,14 +18,70 @@
  */
 
 #include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
 
 #include "core.h"
+#include "gameplay.h"
 
-int main(void)
+int main(int argc, char **argv)
 {
-	core_init();
+	int arguments = 0;
+	const char *record_path = NULL;
+	const char *play_path = NULL;
+	game_context_t *context = NULL;
+	
+	// a replay can be recorded or played back with "-r file" or "-p file"
+	arguments = argc;
+	if(argc >= 3 && strcmp(argv[argc - 2], "-r") == 0)
+	{
+		record_path = argv[argc - 1];
+		arguments -= 2;
+	}
+	else if(argc >= 3 && strcmp(argv[argc - 2], "-p") == 0)
+	{
+		play_path = argv[argc - 1];
+		arguments -= 2;
+	}
+	
+	if(arguments != 1 && arguments != 3)
+	{
+		fprintf(stderr, "Usage: %s [width height] [-r replay-file | -p replay-file]\n", argv[0]);
+		return 1;
+	}
+	
+	context = game_context_create();
+	if(context == NULL)
+	{
+		fprintf(stderr, "Failed to allocate the game context.\n");
+		return 1;
+	}
+	
+	// the size of the field can be passed as width and height
+	if(arguments == 3 && gameplay_set_size(context, atoi(argv[1]), atoi(argv[2])) == -1)
+	{
+		fprintf(stderr, "The field size has to be between %i and %i.\n", GAMEPLAY_FIELD_SIZE_MIN, GAMEPLAY_FIELD_SIZE_MAX);
+		game_context_destroy(context);
+		return 1;
+	}
+	
+	if(record_path != NULL)
+	{
+		core_replay_record(record_path);
+	}
+	
+	// the replay brings its own field size
+	if(play_path != NULL && core_replay_play(play_path) == -1)
+	{
+		fprintf(stderr, "Failed to read replay: %s\n", play_path);
+		game_context_destroy(context);
+		return 1;
+	}
+	
+	core_init(context);
 	core_main();
 	core_cleanup();
+	game_context_destroy(context);
 	
 	return 0;
 }
@@ -18,28 +18,20 @@
  */
 
 #include <stdlib.h>
-#include <time.h>
 
 #include "random-drop.h"
 
-/**
- * This function initializes random drops.
- */
-void random_drop_init(void)
-{
-	srand(time(NULL));
-}
-
 /**
  * This function chooses a random drop from a drop list. It chooses with care
  * about probabilities.
  * 
+ * @param generator The generator of the drops.
  * @param drop_list The drop list.
  * @param drop_list_amount The amount of drops in the drop list.
  * @return A pointer to the choosed drop in the list. This pointer can be a NULL
  *         pointer if no drop was choosed.
  */
-random_drop_t *random_drop_choose(random_drop_t *drop_list, size_t drop_list_amount)
+random_drop_t *random_drop_choose(core_random_t *generator, random_drop_t *drop_list, size_t drop_list_amount)
 {
 	unsigned int i = 0;
 	float random = 0;
@@ -47,7 +39,7 @@ random_drop_t *random_drop_choose(random_drop_t *drop_list, size_t drop_list_amo
 	float passed_random = 0;
 	
 	// generates a random number in [0, 1] with accuracy
-	random = (float)(rand() % RANDOM_DROP_ACCURACY) / RANDOM_DROP_ACCURACY;
+	random = (float)core_random_range(generator, RANDOM_DROP_ACCURACY) / RANDOM_DROP_ACCURACY;
 	
 	// retrieve overall probability (adding all probabilities)
 	for(i = 0; i < drop_list_amount; i++)
@@ -20,6 +20,10 @@
 #ifndef __RANDOM_DROP_H__
 #define __RANDOM_DROP_H__
 
+#include <stddef.h>
+
+#include "core-random.h"
+
 #define RANDOM_DROP_ACCURACY 10000 // a lower value will decrease the accuracy
 
 typedef struct random_drop_t
@@ -28,7 +32,6 @@ typedef struct random_drop_t
 	float probability; // [0, 1]
 } random_drop_t;
 
-void random_drop_init(void);
-random_drop_t *random_drop_choose(random_drop_t *drop_list, size_t drop_list_amount);
+random_drop_t *random_drop_choose(core_random_t *generator, random_drop_t *drop_list, size_t drop_list_amount);
 
 #endif /* __RANDOM_DROP_H__ */
\ No newline at end of file
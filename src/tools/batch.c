@@ -0,0 +1,567 @@
+/*
+ * Copyright (C) 2015 NIPE-SYSTEMS
+ * Copyright (C) 2015 Jonas Krug
+ * Copyright (C) 2015 Tim Gevers
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "gameplay.h"
+#include "gameplay-sim.h"
+#include "gameplay-players.h"
+#include "gameplay-events.h"
+#include "core-random.h"
+#include "core-log.h"
+#include "ai-state.h"
+#include "ai-beam.h"
+#include "ai-mcts.h"
+
+#define BATCH_MATCHES_DEFAULT 64
+#define BATCH_TICKS_DEFAULT 20000
+#define BATCH_PATH_DEFAULT "batch.csv"
+#define BATCH_SEED_DEFAULT 1
+// rollouts of one MCTS search, about the time budget of the game on a
+// desktop core, but independent of the machine and its load
+#define BATCH_ROLLOUTS_DEFAULT 256
+#define BATCH_OPTIONS_MAX 8
+#define BATCH_THREADS_MAX 256
+
+typedef enum batch_winner_e
+{
+	BATCH_WINNER_NONE,
+	BATCH_WINNER_USER,
+	BATCH_WINNER_AI
+} batch_winner_t;
+
+/**
+ * The configuration of a match: the field size, the AI of the AI players and
+ * the AI which plays the user player.
+ */
+typedef struct batch_config_s
+{
+	int width;
+	int height;
+	gameplay_players_ai_t ai;
+	gameplay_players_ai_t user_ai;
+} batch_config_t;
+
+/**
+ * The result of a match. The damage is counted by the side which took it,
+ * because the fire does not know the bomb which caused it. A match whose
+ * events were lost is incomplete, its counts are too low.
+ */
+typedef struct batch_match_s
+{
+	unsigned long long seed;
+	int config;
+	batch_winner_t winner;
+	unsigned int ticks;
+	int ai_left;
+	int damage_user;
+	int damage_ai;
+	int bombs_user;
+	int bombs_ai;
+	int incomplete;
+	double time;
+} batch_match_t;
+
+/**
+ * The matches which are shared by the workers. The workers only share the
+ * index of the next match, every worker plays in its own game context and
+ * writes only the results of its own matches.
+ */
+typedef struct batch_pool_s
+{
+	batch_config_t *configs;
+	int configs_amount;
+	batch_match_t *matches;
+	int matches_amount;
+	unsigned int ticks_max;
+	int rollouts;
+	int next;
+	int failed;
+	pthread_mutex_t mutex;
+} batch_pool_t;
+
+static const char batch_keys[AI_STATE_ACTIONS] = { 0, 'w', 'd', 's', 'a', ' ' };
+static const char *batch_ai_names[] = { "jobs", "mcts", "beam" };
+static const char *batch_winner_names[] = { "none", "user", "ai" };
+
+static double batch_time(void);
+static int batch_parse_ai(const char *name, gameplay_players_ai_t *ai);
+static void batch_user_decide(game_context_t *context, gameplay_players_ai_t user_ai, gameplay_sim_inputs_t *inputs);
+static int batch_play(game_context_t *context, batch_config_t *config, unsigned int ticks_max, int rollouts, batch_match_t *match);
+static void *batch_worker_main(void *argument);
+static int batch_write(batch_pool_t *pool, const char *path);
+
+/**
+ * This function returns the current time of a monotonic clock.
+ * 
+ * @return The time in milliseconds.
+ */
+static double batch_time(void)
+{
+	struct timespec now;
+	
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	
+	return now.tv_sec * 1000.0 + now.tv_nsec / 1000000.0;
+}
+
+/**
+ * This function parses the name of an AI.
+ * 
+ * @param name The name ("jobs", "mcts" or "beam").
+ * @param ai The AI (write by pointer).
+ * @return 0 on success, -1 if the name is unknown.
+ */
+static int batch_parse_ai(const char *name, gameplay_players_ai_t *ai)
+{
+	int i = 0;
+	
+	for(i = 0; i < (int)(sizeof(batch_ai_names) / sizeof(batch_ai_names[0])); i++)
+	{
+		if(strcmp(name, batch_ai_names[i]) == 0)
+		{
+			*ai = i;
+			return 0;
+		}
+	}
+	
+	return -1;
+}
+
+/**
+ * This function lets an AI decide for the user player. The decision is
+ * passed as key, so the user player follows the same rules as in the game.
+ * The AI only decides when the user player is able to move.
+ * 
+ * @param context The context of the match.
+ * @param user_ai The AI of the user player (GAMEPLAY_PLAYERS_AI_MCTS or
+ *        GAMEPLAY_PLAYERS_AI_BEAM).
+ * @param inputs The inputs of the tick (write by pointer).
+ */
+static void batch_user_decide(game_context_t *context, gameplay_players_ai_t user_ai, gameplay_sim_inputs_t *inputs)
+{
+	int player_index = 0;
+	ai_state_action_t action = AI_STATE_ACTION_WAIT;
+	gameplay_players_player_t *player = NULL;
+	ai_state_t state;
+	
+	player = gameplay_players_get_user(context);
+	if(player == NULL || gameplay_players_get_movement_cooldown(context, player) > 0)
+	{
+		return;
+	}
+	
+	ai_state_capture(context, &state, 0, player->position_x, player->position_y);
+	player_index = ai_state_find_user(&state);
+	if(player_index == -1)
+	{
+		return;
+	}
+	
+	if(user_ai == GAMEPLAY_PLAYERS_AI_MCTS)
+	{
+		action = ai_mcts_decide(context, &state, player_index, AI_MCTS_BUDGET);
+	}
+	else
+	{
+		action = ai_beam_decide(context, &state, player_index);
+	}
+	
+	if(action != AI_STATE_ACTION_WAIT)
+	{
+		gameplay_sim_inputs_add(inputs, batch_keys[action]);
+	}
+}
+
+/**
+ * This function plays a match without rendering until one side has won or
+ * the tick limit is reached and collects its result from the events.
+ * 
+ * @param context The context in which the match is played.
+ * @param config The configuration of the match.
+ * @param ticks_max The tick limit, the match is a draw afterwards.
+ * @param rollouts The rollouts of every MCTS search.
+ * @param match The match with its seed, the result is written into it.
+ * @return 0 on success, -1 if the match could not be started.
+ */
+static int batch_play(game_context_t *context, batch_config_t *config, unsigned int ticks_max, int rollouts, batch_match_t *match)
+{
+	int i = 0;
+	int user_id = 0;
+	int events = 0;
+	unsigned int cursor = 0;
+	double start = 0;
+	gameplay_players_player_t *player = NULL;
+	gameplay_events_event_t event;
+	gameplay_sim_inputs_t inputs;
+	gameplay_sim_state_t state;
+	
+	start = batch_time();
+	
+	if(gameplay_set_size(context, config->width, config->height) == -1)
+	{
+		return -1;
+	}
+	
+	gameplay_set_seed(context, match->seed);
+	if(gameplay_sim_init(&state, context) == -1)
+	{
+		return -1;
+	}
+	
+	// the time budget would make the searches depend on the machine
+	ai_mcts_set_rollouts(context, rollouts);
+	
+	for(i = 0; i < gameplay_players_amount(context); i++)
+	{
+		player = gameplay_players_get(context, i);
+		if(player->type == GAMEPLAY_PLAYERS_TYPE_AI)
+		{
+			gameplay_hash_toggle(context, gameplay_players_key(context, player));
+			player->ai = config->ai;
+			gameplay_hash_toggle(context, gameplay_players_key(context, player));
+		}
+	}
+	
+	user_id = gameplay_players_get_user(context)->id;
+	cursor = gameplay_events_cursor(context);
+	
+	while(state.result == GAMEPLAY_SIM_RUNNING && state.tick < ticks_max)
+	{
+		gameplay_sim_inputs_clear(&inputs);
+		batch_user_decide(context, config->user_ai, &inputs);
+		gameplay_sim_step(&state, &inputs);
+		
+		while((events = gameplay_events_next(context, &cursor, &event)) != 0)
+		{
+			if(events == -1)
+			{
+				core_error("Lost events in match with seed %llu", match->seed);
+				match->incomplete = 1;
+			}
+			else if(event.type == GAMEPLAY_EVENTS_PLAYER_DAMAGED)
+			{
+				*((event.value == user_id)?(&(match->damage_user)):(&(match->damage_ai))) += 1;
+			}
+			else if(event.type == GAMEPLAY_EVENTS_BOMB_PLACED)
+			{
+				*((event.value == user_id)?(&(match->bombs_user)):(&(match->bombs_ai))) += 1;
+			}
+		}
+	}
+	
+	match->winner = (state.result == GAMEPLAY_SIM_WIN)?(BATCH_WINNER_USER):((state.result == GAMEPLAY_SIM_GAME_OVER)?(BATCH_WINNER_AI):(BATCH_WINNER_NONE));
+	match->ticks = state.tick;
+	match->ai_left = gameplay_players_ai_amount(context);
+	
+	gameplay_sim_cleanup(&state);
+	
+	match->time = batch_time() - start;
+	
+	return 0;
+}
+
+/**
+ * This function is the main function of a worker thread. The worker takes
+ * the next match of the pool until all matches are played. One match is
+ * played at a time in the game context of the worker.
+ * 
+ * @param argument The pool.
+ * @return NULL
+ */
+static void *batch_worker_main(void *argument)
+{
+	int index = 0;
+	batch_pool_t *pool = argument;
+	batch_match_t *match = NULL;
+	game_context_t *context = NULL;
+	
+	context = game_context_create();
+	if(context == NULL)
+	{
+		pthread_mutex_lock(&pool->mutex);
+		pool->failed++;
+		pthread_mutex_unlock(&pool->mutex);
+		return NULL;
+	}
+	
+	while(1)
+	{
+		pthread_mutex_lock(&pool->mutex);
+		index = pool->next;
+		if(index < pool->matches_amount)
+		{
+			pool->next++;
+		}
+		pthread_mutex_unlock(&pool->mutex);
+		
+		if(index >= pool->matches_amount)
+		{
+			break;
+		}
+		
+		match = &(pool->matches[index]);
+		if(batch_play(context, &(pool->configs[match->config]), pool->ticks_max, pool->rollouts, match) == -1)
+		{
+			fprintf(stderr, "Failed to play match %i.\n", index);
+			pthread_mutex_lock(&pool->mutex);
+			pool->failed++;
+			pthread_mutex_unlock(&pool->mutex);
+		}
+	}
+	
+	game_context_destroy(context);
+	
+	return NULL;
+}
+
+/**
+ * This function writes the results of all matches as CSV in the order of the
+ * matches.
+ * 
+ * @param pool The pool with the played matches.
+ * @param path The path of the CSV file.
+ * @return 0 on success, -1 if the file could not be written.
+ */
+static int batch_write(batch_pool_t *pool, const char *path)
+{
+	int i = 0;
+	FILE *file = NULL;
+	batch_match_t *match = NULL;
+	batch_config_t *config = NULL;
+	
+	file = fopen(path, "w");
+	if(file == NULL)
+	{
+		return -1;
+	}
+	
+	fprintf(file, "match,seed,width,height,ai,user_ai,winner,ticks,ai_left,damage_user,damage_ai,bombs_user,bombs_ai,incomplete,time_ms\n");
+	
+	for(i = 0; i < pool->matches_amount; i++)
+	{
+		match = &(pool->matches[i]);
+		config = &(pool->configs[match->config]);
+		fprintf(file, "%i,%llu,%i,%i,%s,%s,%s,%u,%i,%i,%i,%i,%i,%i,%.3f\n", i, match->seed, config->width, config->height, batch_ai_names[config->ai], batch_ai_names[config->user_ai], batch_winner_names[match->winner], match->ticks, match->ai_left, match->damage_user, match->damage_ai, match->bombs_user, match->bombs_ai, match->incomplete, match->time);
+	}
+	
+	if(fclose(file) != 0)
+	{
+		return -1;
+	}
+	
+	return 0;
+}
+
+/**
+ * This tool plays many matches without rendering on all cores, e.g. to tune
+ * the AI. Every match gets its own seed from the base seed and cycles through
+ * all combinations of the given field sizes and AIs. The user player is
+ * played by an AI as well. The MCTS searches use a fixed amount of rollouts,
+ * so a batch has the same results on every machine. The results are written
+ * as CSV.
+ */
+int main(int argc, char **argv)
+{
+	int i = 0;
+	int result = 0;
+	int threads = 0;
+	int started = 0;
+	int sizes_amount = 0;
+	int ais_amount = 0;
+	int user_ais_amount = 0;
+	int incomplete = 0;
+	int wins[3] = { 0, 0, 0 };
+	unsigned long long seed = BATCH_SEED_DEFAULT;
+	unsigned long long ticks = 0;
+	double start = 0;
+	double elapsed = 0;
+	const char *path = BATCH_PATH_DEFAULT;
+	int widths[BATCH_OPTIONS_MAX] = { GAMEPLAY_FIELD_SIZE_DEFAULT };
+	int heights[BATCH_OPTIONS_MAX] = { GAMEPLAY_FIELD_SIZE_DEFAULT };
+	gameplay_players_ai_t ais[BATCH_OPTIONS_MAX] = { GAMEPLAY_PLAYERS_AI_DEFAULT };
+	gameplay_players_ai_t user_ais[BATCH_OPTIONS_MAX] = { GAMEPLAY_PLAYERS_AI_BEAM };
+	pthread_t workers[BATCH_THREADS_MAX];
+	core_random_t seeds;
+	batch_pool_t pool;
+	
+	memset(&pool, 0, sizeof(batch_pool_t));
+	pool.matches_amount = BATCH_MATCHES_DEFAULT;
+	pool.ticks_max = BATCH_TICKS_DEFAULT;
+	pool.rollouts = BATCH_ROLLOUTS_DEFAULT;
+	threads = sysconf(_SC_NPROCESSORS_ONLN);
+	
+	for(i = 1; i < argc; i++)
+	{
+		if(i + 1 >= argc)
+		{
+			result = -1;
+		}
+		else if(strcmp(argv[i], "-n") == 0)
+		{
+			pool.matches_amount = atoi(argv[++i]);
+			result = (pool.matches_amount > 0)?(0):(-1);
+		}
+		else if(strcmp(argv[i], "-j") == 0)
+		{
+			threads = atoi(argv[++i]);
+			result = (threads > 0)?(0):(-1);
+		}
+		else if(strcmp(argv[i], "-s") == 0)
+		{
+			seed = strtoull(argv[++i], NULL, 10);
+		}
+		else if(strcmp(argv[i], "-t") == 0)
+		{
+			pool.ticks_max = strtoul(argv[++i], NULL, 10);
+		}
+		else if(strcmp(argv[i], "-r") == 0)
+		{
+			pool.rollouts = atoi(argv[++i]);
+			result = (pool.rollouts > 0)?(0):(-1);
+		}
+		else if(strcmp(argv[i], "-o") == 0)
+		{
+			path = argv[++i];
+		}
+		else if(strcmp(argv[i], "-f") == 0 && sizes_amount < BATCH_OPTIONS_MAX && sscanf(argv[++i], "%ix%i", &widths[sizes_amount], &heights[sizes_amount]) == 2)
+		{
+			result = (widths[sizes_amount] < GAMEPLAY_FIELD_SIZE_MIN || widths[sizes_amount] > GAMEPLAY_FIELD_SIZE_MAX || heights[sizes_amount] < GAMEPLAY_FIELD_SIZE_MIN || heights[sizes_amount] > GAMEPLAY_FIELD_SIZE_MAX)?(-1):(0);
+			sizes_amount++;
+		}
+		else if(strcmp(argv[i], "-a") == 0 && ais_amount < BATCH_OPTIONS_MAX)
+		{
+			result = batch_parse_ai(argv[++i], &ais[ais_amount++]);
+		}
+		else if(strcmp(argv[i], "-u") == 0 && user_ais_amount < BATCH_OPTIONS_MAX)
+		{
+			result = batch_parse_ai(argv[++i], &user_ais[user_ais_amount]);
+			result = (result == 0 && user_ais[user_ais_amount++] != GAMEPLAY_PLAYERS_AI_JOBS)?(0):(-1);
+		}
+		else
+		{
+			result = -1;
+		}
+		
+		if(result == -1)
+		{
+			fprintf(stderr, "Usage: %s [-n matches] [-j threads] [-s seed] [-t ticks] [-r rollouts] [-o results.csv] [-f widthxheight]... [-a jobs|mcts|beam]... [-u mcts|beam]...\n", argv[0]);
+			return 1;
+		}
+	}
+	
+	sizes_amount = (sizes_amount == 0)?(1):(sizes_amount);
+	ais_amount = (ais_amount == 0)?(1):(ais_amount);
+	user_ais_amount = (user_ais_amount == 0)?(1):(user_ais_amount);
+	threads = (threads > BATCH_THREADS_MAX)?(BATCH_THREADS_MAX):(threads);
+	threads = (threads > pool.matches_amount)?(pool.matches_amount):(threads);
+	threads = (threads < 1)?(1):(threads);
+	
+	// the errors of the workers go to the same log files as in the game
+	core_log_init();
+	
+	// all combinations of the options
+	pool.configs_amount = sizes_amount * ais_amount * user_ais_amount;
+	pool.configs = malloc(pool.configs_amount * sizeof(batch_config_t));
+	pool.matches = calloc(pool.matches_amount, sizeof(batch_match_t));
+	if(pool.configs == NULL || pool.matches == NULL)
+	{
+		fprintf(stderr, "Failed to allocate %i matches.\n", pool.matches_amount);
+		free(pool.configs);
+		free(pool.matches);
+		core_log_cleanup();
+		return 1;
+	}
+	
+	for(i = 0; i < pool.configs_amount; i++)
+	{
+		pool.configs[i].width = widths[i % sizes_amount];
+		pool.configs[i].height = heights[i % sizes_amount];
+		pool.configs[i].ai = ais[(i / sizes_amount) % ais_amount];
+		pool.configs[i].user_ai = user_ais[(i / sizes_amount / ais_amount) % user_ais_amount];
+	}
+	
+	// the seeds only depend on the base seed, so a batch can be repeated
+	core_random_seed(&seeds, seed, CORE_RANDOM_STREAM_SEEDS);
+	for(i = 0; i < pool.matches_amount; i++)
+	{
+		pool.matches[i].seed = core_random_next(&seeds);
+		pool.matches[i].config = i % pool.configs_amount;
+	}
+	
+	pthread_mutex_init(&pool.mutex, NULL);
+	
+	start = batch_time();
+	
+	for(started = 0; started < threads; started++)
+	{
+		if(pthread_create(&workers[started], NULL, batch_worker_main, &pool) != 0)
+		{
+			fprintf(stderr, "Failed to start worker %i.\n", started);
+			break;
+		}
+	}
+	
+	// the started workers also play the matches of the missing ones
+	for(i = 0; i < started; i++)
+	{
+		pthread_join(workers[i], NULL);
+	}
+	
+	elapsed = (batch_time() - start) / 1000.0;
+	
+	pthread_mutex_destroy(&pool.mutex);
+	
+	for(i = 0; i < pool.matches_amount; i++)
+	{
+		wins[pool.matches[i].winner]++;
+		ticks += pool.matches[i].ticks;
+		incomplete += pool.matches[i].incomplete;
+	}
+	
+	result = (started == 0 || pool.failed > 0)?(-1):(0);
+	
+	if(batch_write(&pool, path) == -1)
+	{
+		fprintf(stderr, "Failed to write results: %s\n", path);
+		result = -1;
+	}
+	else
+	{
+		printf("Played %i matches with %i threads in %.3f s (%.1f matches/s, %.0f ticks/s).\n", pool.matches_amount, started, elapsed, pool.matches_amount / elapsed, ticks / elapsed);
+		printf("Won by the user player: %i, by the AI players: %i, draws: %i.\n", wins[BATCH_WINNER_USER], wins[BATCH_WINNER_AI], wins[BATCH_WINNER_NONE]);
+	}
+	
+	if(incomplete > 0)
+	{
+		fprintf(stderr, "Lost events in %i matches, their rows are marked as incomplete.\n", incomplete);
+	}
+	
+	free(pool.configs);
+	free(pool.matches);
+	
+	core_log_cleanup();
+	
+	return (result == -1)?(1):(0);
+}
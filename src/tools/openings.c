@@ -0,0 +1,65 @@
+/*
+ * Copyright (C) 2015 NIPE-SYSTEMS
+ * Copyright (C) 2015 Jonas Krug
+ * Copyright (C) 2015 Tim Gevers
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "gameplay.h"
+#include "ai-openings.h"
+
+/**
+ * This tool precomputes the AI openings of all spawn corners and writes them
+ * into the cache file of the current field size. The game reads the cache
+ * file at start.
+ */
+int main(void)
+{
+	int result = 0;
+	game_context_t *context = NULL;
+	
+	context = game_context_create();
+	if(context == NULL)
+	{
+		fprintf(stderr, "Failed to allocate the game context.\n");
+		return 1;
+	}
+	
+	if(gameplay_init(context) == -1)
+	{
+		fprintf(stderr, "Failed to initialize field.\n");
+		game_context_destroy(context);
+		return 1;
+	}
+	
+	ai_openings_compute_all(context);
+	result = ai_openings_save(context);
+	gameplay_cleanup(context);
+	
+	if(result == -1)
+	{
+		fprintf(stderr, "Failed to write openings.\n");
+		game_context_destroy(context);
+		return 1;
+	}
+	
+	printf("Openings written for a %ix%i field.\n", GAMEPLAY_FIELD_WIDTH(context), GAMEPLAY_FIELD_HEIGHT(context));
+	game_context_destroy(context);
+	
+	return 0;
+}
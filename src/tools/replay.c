@@ -0,0 +1,341 @@
+/*
+ * Copyright (C) 2015 NIPE-SYSTEMS
+ * Copyright (C) 2015 Jonas Krug
+ * Copyright (C) 2015 Tim Gevers
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "gameplay.h"
+#include "gameplay-replay.h"
+#include "gameplay-replay-file.h"
+#include "gameplay-snapshot.h"
+
+static double replay_time(void);
+static int replay_verify(game_context_t *context, const char *path);
+static int replay_verify_file(game_context_t *context, gameplay_replay_file_t *file);
+static int replay_dump(const char *path);
+static int replay_convert(game_context_t *context, const char *input, const char *output);
+static int replay_seek(game_context_t *context, const char *path, unsigned int tick);
+
+/**
+ * This function returns the current time of a monotonic clock.
+ * 
+ * @return The time in milliseconds.
+ */
+static double replay_time(void)
+{
+	struct timespec now;
+	
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	
+	return now.tv_sec * 1000.0 + now.tv_nsec / 1000000.0;
+}
+
+/**
+ * This function plays a replay file back from the start and compares the
+ * recorded hashes and every keyframe with the simulated state.
+ * 
+ * @param context The context in which the match is simulated.
+ * @param file The opened file.
+ * @return 0 if the replay is reproduced, otherwise -1.
+ */
+static int replay_verify_file(game_context_t *context, gameplay_replay_file_t *file)
+{
+	int result = 0;
+	unsigned int keyframe = 0;
+	size_t size = 0;
+	gameplay_snapshot_t *snapshot = NULL;
+	const gameplay_snapshot_t *recorded = NULL;
+	gameplay_sim_state_t state;
+	gameplay_replay_playback_t playback;
+	
+	if(gameplay_replay_playback_init(&playback, &(file->replay), &state, context) == -1)
+	{
+		return -1;
+	}
+	
+	while(result == 0)
+	{
+		if(keyframe < file->header->keyframes_amount && file->keyframes[keyframe].tick == state.tick)
+		{
+			recorded = gameplay_replay_file_keyframe(file, keyframe);
+			size = gameplay_snapshot_size(context);
+			snapshot = malloc(size);
+			if(snapshot == NULL || gameplay_snapshot_capture(context, snapshot, size) == -1 || size != recorded->size || memcmp(snapshot, recorded, size) != 0)
+			{
+				printf("Keyframe %u at tick %u differs.\n", keyframe, state.tick);
+				result = -1;
+			}
+			
+			free(snapshot);
+			keyframe++;
+		}
+		
+		if(gameplay_replay_playback_finished(&playback) == 1)
+		{
+			break;
+		}
+		
+		gameplay_replay_playback_step(&playback);
+	}
+	
+	if(playback.mismatches > 0)
+	{
+		printf("Replay diverged at tick %u of %u.\n", playback.mismatch_tick, file->replay.ticks);
+		result = -1;
+	}
+	else if(state.tick != file->replay.ticks || state.result != file->replay.result)
+	{
+		printf("Replay ended at tick %u with result %i instead of tick %u with result %i.\n", state.tick, state.result, file->replay.ticks, file->replay.result);
+		result = -1;
+	}
+	
+	gameplay_sim_cleanup(&state);
+	
+	return result;
+}
+
+/**
+ * This function plays a replay back as fast as possible and verifies it. Both
+ * the replay files and the plain text input logs are accepted.
+ * 
+ * @param context The context in which the match is simulated.
+ * @param path The path of the replay.
+ * @return 0 if the replay is reproduced, otherwise -1.
+ */
+static int replay_verify(game_context_t *context, const char *path)
+{
+	int result = 0;
+	unsigned int mismatch_tick = 0;
+	double start = 0;
+	gameplay_replay_file_t file;
+	gameplay_replay_t replay;
+	
+	if(gameplay_replay_file_open(&file, path) == 0)
+	{
+		start = replay_time();
+		result = replay_verify_file(context, &file);
+		if(result == 0)
+		{
+			printf("Replayed %u ticks on a %ix%i field in %.3f ms, result %i, %u keyframes equal.\n", file.replay.ticks, file.replay.field_width, file.replay.field_height, replay_time() - start, file.replay.result, file.header->keyframes_amount);
+		}
+		
+		gameplay_replay_file_close(&file);
+		
+		return result;
+	}
+	
+	if(gameplay_replay_load(&replay, path) == -1)
+	{
+		fprintf(stderr, "Failed to read replay: %s\n", path);
+		gameplay_replay_release(&replay);
+		return -1;
+	}
+	
+	start = replay_time();
+	result = gameplay_replay_play(&replay, context, &mismatch_tick);
+	
+	if(result == -1)
+	{
+		printf("Replay diverged at tick %u of %u.\n", mismatch_tick, replay.ticks);
+	}
+	else
+	{
+		printf("Replayed %u ticks on a %ix%i field in %.3f ms, result %i.\n", replay.ticks, replay.field_width, replay.field_height, replay_time() - start, replay.result);
+	}
+	
+	gameplay_replay_release(&replay);
+	
+	return result;
+}
+
+/**
+ * This function prints the header, the index and the records of a replay
+ * file.
+ * 
+ * @param path The path of the replay file.
+ * @return 0 on success, -1 if the file could not be read.
+ */
+static int replay_dump(const char *path)
+{
+	int i = 0;
+	gameplay_replay_record_t *record = NULL;
+	gameplay_replay_file_t file;
+	
+	if(gameplay_replay_file_open(&file, path) == -1)
+	{
+		fprintf(stderr, "Failed to read replay file: %s\n", path);
+		return -1;
+	}
+	
+	printf("version %u\nseed %llu\nfield %i %i\nhash-period %i\nactions %i\nticks %u %i\n", file.header->version, file.header->seed, file.header->field_width, file.header->field_height, file.header->hash_period, file.header->actions_recorded, file.header->ticks, file.header->result);
+	printf("inputs %u records in %u bytes at %u\n", file.header->records_amount, file.header->inputs_size, file.header->inputs_offset);
+	printf("index %u keyframes every %u ticks at %u\n", file.header->keyframes_amount, file.header->keyframe_period, file.header->index_offset);
+	
+	for(i = 0; i < (int)file.header->keyframes_amount; i++)
+	{
+		printf("keyframe %u record %u snapshot %u bytes at %u\n", file.keyframes[i].tick, file.keyframes[i].record, file.keyframes[i].snapshot_size, file.keyframes[i].snapshot_offset);
+	}
+	
+	for(i = 0; i < file.replay.records_amount; i++)
+	{
+		record = &(file.replay.records[i]);
+		
+		switch(record->type)
+		{
+			case GAMEPLAY_REPLAY_KEY:
+			{
+				printf("%u key %i\n", record->tick, record->key);
+				break;
+			}
+			case GAMEPLAY_REPLAY_ACTION:
+			{
+				printf("%u action %i step %i %i moved %i bomb %i\n", record->tick, record->action.id, record->action.step_x, record->action.step_y, record->action.moved, record->action.bomb);
+				break;
+			}
+			case GAMEPLAY_REPLAY_HASH:
+			{
+				printf("%u hash %016llx\n", record->tick, record->hash);
+				break;
+			}
+		}
+	}
+	
+	gameplay_replay_file_close(&file);
+	
+	return 0;
+}
+
+/**
+ * This function converts a plain text input log into a replay file.
+ * 
+ * @param context The context in which the match is simulated.
+ * @param input The path of the input log.
+ * @param output The path of the replay file.
+ * @return 0 on success, -1 on failure.
+ */
+static int replay_convert(game_context_t *context, const char *input, const char *output)
+{
+	int result = 0;
+	gameplay_replay_t replay;
+	
+	if(gameplay_replay_load(&replay, input) == -1)
+	{
+		fprintf(stderr, "Failed to read replay: %s\n", input);
+		gameplay_replay_release(&replay);
+		return -1;
+	}
+	
+	result = gameplay_replay_file_save(&replay, context, output);
+	if(result == -1)
+	{
+		fprintf(stderr, "Failed to write replay file: %s\n", output);
+	}
+	
+	gameplay_replay_release(&replay);
+	
+	return result;
+}
+
+/**
+ * This function seeks to a tick of a replay file and prints the hash of the
+ * state there.
+ * 
+ * @param context The context in which the match is simulated.
+ * @param path The path of the replay file.
+ * @param tick The tick.
+ * @return 0 on success, -1 on failure.
+ */
+static int replay_seek(game_context_t *context, const char *path, unsigned int tick)
+{
+	int result = 0;
+	double start = 0;
+	gameplay_replay_file_t file;
+	gameplay_sim_state_t state;
+	gameplay_replay_playback_t playback;
+	
+	if(gameplay_replay_file_open(&file, path) == -1)
+	{
+		fprintf(stderr, "Failed to read replay file: %s\n", path);
+		return -1;
+	}
+	
+	if(gameplay_replay_playback_init(&playback, &(file.replay), &state, context) == -1)
+	{
+		gameplay_replay_file_close(&file);
+		return -1;
+	}
+	
+	start = replay_time();
+	result = gameplay_replay_file_seek(&file, &playback, tick);
+	if(result == 0)
+	{
+		printf("Seeked to tick %u in %.3f ms, hash %016llx.\n", state.tick, replay_time() - start, gameplay_get_hash(context));
+	}
+	
+	gameplay_sim_cleanup(&state);
+	gameplay_replay_file_close(&file);
+	
+	return result;
+}
+
+/**
+ * This tool verifies, dumps, converts and seeks recorded matches. Replays are
+ * played back as fast as possible without rendering.
+ */
+int main(int argc, char **argv)
+{
+	int result = 0;
+	game_context_t *context = NULL;
+	
+	if(!(argc == 2 || (argc == 3 && strcmp(argv[1], "-d") == 0) || (argc == 4 && (strcmp(argv[1], "-c") == 0 || strcmp(argv[1], "-s") == 0))))
+	{
+		fprintf(stderr, "Usage: %s replay | -d replay-file | -c input-log replay-file | -s replay-file tick\n", argv[0]);
+		return 1;
+	}
+	
+	context = game_context_create();
+	if(context == NULL)
+	{
+		fprintf(stderr, "Failed to allocate the game context.\n");
+		return 1;
+	}
+	
+	if(argc == 2)
+	{
+		result = replay_verify(context, argv[1]);
+	}
+	else if(strcmp(argv[1], "-d") == 0)
+	{
+		result = replay_dump(argv[2]);
+	}
+	else if(strcmp(argv[1], "-c") == 0)
+	{
+		result = replay_convert(context, argv[2], argv[3]);
+	}
+	else
+	{
+		result = replay_seek(context, argv[2], strtoul(argv[3], NULL, 10));
+	}
+	
+	game_context_destroy(context);
+	
+	return (result == -1)?(1):(0);
+}